@@ -0,0 +1,151 @@
+/*
+ * Enhanced C/C++ Code Dependency Analyzer - Bibliotheks-API (v1.4)
+ *
+ * Der gesamte Zustand einer Analyse liegt in einem AnalysisContext. Mehrere Kontexte
+ * können gleichzeitig existieren und in verschiedenen Threads laufen; ein einzelner
+ * Kontext darf nur von einem Thread zur Zeit benutzt werden.
+ *
+ * Library build: gcc -O2 -c -DANALYZER_LIBRARY analyzer_v1-3.c
+ *
+ *   AnalyzerOptions options;
+ *   analyzer_default_options(&options);
+ *   AnalysisContext* ctx = analyzer_create(".\\root", &options);
+ *   if (ctx && analyzer_run(ctx, "main.c") == 0) {
+ *       for (int i = 0; i < analyzer_file_count(ctx); i++) { ... }
+ *   }
+ *   analyzer_destroy(ctx);
+ */
+
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AnalysisContext AnalysisContext;
+
+typedef struct {
+    const char* stream_report_file; // Report beim Parsen schreiben (begrenzter Speicher), sonst NULL
+    const char* unity_output_dir;   // Unity-Batches planen (analyzer_write_unity_batches), sonst NULL
+    long unity_line_budget;
+    const char* depfile_dir;        // Depfiles schreiben (analyzer_write_depfiles), sonst NULL
+    int split_declaration_headers;
+    int readahead;                  // Dateien im Hintergrund vorlesen
+    int verbose;                    // Fortschritt und Warnungen auf stdout
+    int git_index;                  // Dateiliste aus .git/index statt Verzeichnislauf
+    const char* parse_cache_file;   // Parse-Ergebnisse unveränderter Dateien wiederverwenden, sonst NULL
+    const char* changed_since;      // mit parse_cache_file: Git-Revision, seit der geänderte Dateien neu geparst werden
+} AnalyzerOptions;
+
+typedef struct {
+    const char* name;
+    const char* path;               // vollständiger Pfad
+    const char* directory;          // Verzeichnis relativ zu source_path ("." für das Root)
+    int is_used;
+    int include_depth;
+    int line_count;
+    long file_size;
+    int is_circular_include;
+    int is_performance_problem;
+    int duplicate_of;               // Dateiindex mit identischem Inhalt oder -1
+    int include_count;
+    int build_level;                // topologische Ebene (0: keine Includes), Zyklen zusammengefasst
+} AnalyzerFile;
+
+enum { ANALYZER_EDGE_INCLUDE, ANALYZER_EDGE_MACRO };
+// POINTER_ONLY: nur Structs/Typedefs des Headers, und zwar nur als Zeiger - durch Vorwärtsdeklarationen ersetzbar
+enum { ANALYZER_USAGE_UNKNOWN, ANALYZER_USAGE_USED, ANALYZER_USAGE_UNUSED, ANALYZER_USAGE_MACRO_ONLY,
+       ANALYZER_USAGE_POINTER_ONLY };
+
+typedef struct {
+    int target;                     // Dateiindex
+    int type;                       // ANALYZER_EDGE_*
+    int line;                       // Include-Zeile, 0 bei Makro-Kanten
+    int usage;                      // ANALYZER_USAGE_* (nur Include-Kanten)
+    int weight;                     // Makro-Kanten: Anzahl verschiedener Makros
+} AnalyzerDependency;
+
+enum {
+    ANALYZER_ELEMENT_INCLUDE,
+    ANALYZER_ELEMENT_VOID_FUNCTION,
+    ANALYZER_ELEMENT_FUNCTION,
+    ANALYZER_ELEMENT_ACTION,
+    ANALYZER_ELEMENT_STRUCT,
+    ANALYZER_ELEMENT_TYPEDEF_STRUCT,
+    ANALYZER_ELEMENT_STATIC_VAR,
+    ANALYZER_ELEMENT_MACRO
+};
+
+typedef struct {
+    int kind;                       // ANALYZER_ELEMENT_*
+    const char* name;
+    int line;
+    const char* detail;             // Include: aufgelöster Pfad, Makro: Body ohne führende Leerzeichen
+                                    // (Funktionsmakro: mit der Parameterliste vorn), Static: Funktion
+    int is_prototype;
+} AnalyzerElement;
+
+void analyzer_default_options(AnalyzerOptions* options);
+
+// NULL, wenn source_path nicht existiert oder kein Speicher frei ist
+AnalysisContext* analyzer_create(const char* source_path, const AnalyzerOptions* options);
+
+// main_file NULL oder "": alle .c/.h-Dateien; sonst Include-Tracking ab main_file.
+// Ein erneuter Aufruf verwirft das vorige Ergebnis. 0 bei Erfolg, -1 bei Fehler.
+int analyzer_run(AnalysisContext* ctx, const char* main_file);
+
+int analyzer_write_report(AnalysisContext* ctx, const char* output_file);
+int analyzer_write_header(AnalysisContext* ctx, const char* header_file);
+int analyzer_write_unity_batches(AnalysisContext* ctx);
+// Eine .d-Datei je Translation Unit und dependencies.json nach depfile_dir, nur bei geändertem
+// Inhalt. Rückgabe: Anzahl neu geschriebener Dateien, -1 ohne depfile_dir
+int analyzer_write_depfiles(AnalysisContext* ctx);
+
+int analyzer_file_count(AnalysisContext* ctx);
+int analyzer_get_file(AnalysisContext* ctx, int file_index, AnalyzerFile* out);
+int analyzer_find_file(AnalysisContext* ctx, const char* path); // Pfad oder Dateiname, -1 wenn unbekannt
+
+// Schreiben höchstens max Einträge nach out und liefern die Gesamtzahl (-1 bei ungültigem Index).
+// Die Strings gehören dem Kontext und bleiben bis zum nächsten analyzer_run gültig.
+// Include-Abhängigkeiten ohne aufgelöste Datei haben target -1. Elemente gibt es nur ohne
+// Streaming-Modus, weil die Tabellen dort nach dem Schreiben freigegeben werden.
+int analyzer_get_dependencies(AnalysisContext* ctx, int file_index, AnalyzerDependency* out, int max);
+int analyzer_get_elements(AnalysisContext* ctx, int file_index, AnalyzerElement* out, int max);
+
+// Snapshot (Include-Graph, Hüllen, Zyklen, Überladungen, PRAGMA_PATHs) für späteren Vergleich.
+// analyzer_diff_snapshots schreibt die Unterschiede nach out und liefert ihre Anzahl (-1 bei Lesefehler).
+int analyzer_save_snapshot(AnalysisContext* ctx, const char* snapshot_file);
+int analyzer_diff_snapshots(const char* old_file, const char* new_file, FILE* out);
+
+// Include-Budgets aus einer Konfigurationsdatei prüfen (maximale transitive Includes, Zeilen je
+// Translation Unit, Include-Tiefe, keine neuen Zyklen, Include-Guards). Verstöße mit Include-Kette
+// nach out; mit baseline_snapshot zählen nur Zyklen, die dort nicht vorkamen.
+// Rückgabe: Anzahl Verstöße oder -1 bei Lesefehler.
+int analyzer_check_budgets(AnalysisContext* ctx, const char* budget_file, const char* baseline_snapshot, FILE* out);
+
+// Verlauf: jeden Commit aus revision_range ("v1.0..HEAD", erste Eltern, älteste zuerst) direkt aus
+// den Git-Objekten analysieren, ohne Checkout, und je Commit eine CSV-Zeile mit Kennzahlen des
+// Include-Graphen nach out schreiben. Neu geparst werden nur Dateien mit geändertem Blob und ihre
+// Includer. Danach enthält ctx die Analyse des letzten Commits.
+// Rückgabe: Anzahl analysierter Commits oder -1 (ungültiger Bereich, kein Repository).
+int analyzer_history(AnalysisContext* ctx, const char* main_file, const char* revision_range, FILE* out);
+
+// JSON-RPC 2.0 Server (eine Anfrage/Antwort pro Zeile) auf einer bereits analysierten Quelle.
+// Methoden: includersOf, includeClosure, definitionOf, cyclesContaining, reanalyze, shutdown.
+// reanalyze hält die Parse-Ergebnisse ab dem ersten Aufruf im Speicher und parst nur die genannte
+// Datei und ihre Includer neu.
+// Rückgabe 1 nach shutdown, 0 bei EOF.
+int analyzer_serve(AnalysisContext* ctx, FILE* in, FILE* out);
+// Wie analyzer_serve über einen lokalen Unix-Socket (Clients nacheinander); -1 unter Windows
+int analyzer_serve_unix_socket(AnalysisContext* ctx, const char* socket_path);
+
+void analyzer_destroy(AnalysisContext* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
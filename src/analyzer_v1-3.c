@@ -10,6 +10,8 @@
  *
  * Visual Studio 2019+ Compatible
  * Compile: cl analyzer_v1-3.c /Fe:analyzer.exe
+ * Linux/Mac: gcc -O2 analyzer_v1-3.c -o analyzer -lpthread
+ * Library (API in analyzer.h, ohne main): gcc -O2 -c -DANALYZER_LIBRARY analyzer_v1-3.c
  * Usage: analyzer.exe <source_path> [main_file] [output_file] [header_file]
  * Example: analyzer.exe .\root main.c analysis.txt declarations.h
  */
@@ -18,8 +20,72 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#ifdef _WIN32
 #include <windows.h>
 #include <direct.h>
+#include <process.h>
+#include <time.h>
+#define PATH_SEP "\\"
+#define POPEN_READ_BINARY "rb"
+#define DEFAULT_TEMP_DIR "."
+#define local_time_r(time, result) (localtime_s(result, time) == 0 ? (result) : NULL)
+#define utc_time_r(time, result) (gmtime_s(result, time) == 0 ? (result) : NULL)
+#else
+// v1.4: POSIX-Kompatibilität (Linux/Mac)
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define PATH_SEP "/"
+#define _getcwd getcwd
+#define _strdup strdup
+#define _strnicmp strncasecmp
+#define _popen popen
+#define _pclose pclose
+#define _getpid getpid
+#define POPEN_READ_BINARY "r"
+#define DEFAULT_TEMP_DIR "/tmp"
+#define _mkdir(path) mkdir(path, 0755)
+#define local_time_r localtime_r
+#define utc_time_r gmtime_r
+#endif
+
+// Aktuelle Uhrzeit als HH:MM:SS (buffer mindestens 9 Zeichen)
+static char* format_clock_time(char* buffer) {
+    time_t now = time(NULL);
+    struct tm local;
+    if (!local_time_r(&now, &local)) {
+        strcpy(buffer, "00:00:00");
+        return buffer;
+    }
+    strftime(buffer, 9, "%H:%M:%S", &local);
+    return buffer;
+}
+
+// v1.4: io_uring für Read-Ahead (nur Linux, Kernel-Header genügen - kein liburing nötig)
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#define ANALYZER_HAVE_IO_URING
+#endif
+#endif
+
+// v1.4: Bibliotheks-API (analyzer.h) - Zustand je Analyse im AnalysisContext
+#include "analyzer.h"
+#ifdef _MSC_VER
+#define ANALYZER_THREAD_LOCAL __declspec(thread)
+#else
+#define ANALYZER_THREAD_LOCAL __thread
+#endif
 
 #define MAX_PATH_LEN 512
 #define MAX_LINE_LEN 1024
@@ -30,12 +96,8 @@
 #define MAX_PRAGMA_PATHS 50
 
 // Forward declarations
-void normalize_path_separators(char* path);
-
-// Global variables
-char base_path[MAX_PATH_LEN];
-int use_include_tracking = 0;
-int file_count = 0;
+static void normalize_path_separators(char* path);
+static int probe_include_candidate(const char* candidate, char* found_path);
 
 // Struktur für PRAGMA_PATH
 typedef struct {
@@ -55,6 +117,8 @@ typedef struct {
     int has_backslash;
     int is_system_include;
     int found_via_pragma;
+    int target_index;               // Index in files[] oder -1
+    int usage;                      // v1.4: INCLUDE_USAGE_* (Symbol des Headers referenziert?)
 } IncludeElement;
 
 // Struktur für Code-Elemente
@@ -65,8 +129,18 @@ typedef struct {
     char function_context[MAX_NAME_LEN];
     int is_duplicate;
     int duplicate_count;
+    int is_prototype;               // v1.4: Deklaration ohne Rumpf ("void f();")
 } CodeElement;
 
+// v1.4: Makro-Definition (#define)
+typedef struct {
+    char name[MAX_NAME_LEN];
+    char body[MAX_NAME_LEN];        // gekürzt für den Report
+    int has_parameters;             // Funktionsmakro: body beginnt mit der Parameterliste
+    int line;
+    int definition;                 // Index in macro_defs
+} MacroElement;
+
 // Struktur für verwendete Verzeichnisse
 typedef struct {
     char path[MAX_PATH_LEN];
@@ -77,6 +151,7 @@ typedef struct {
 // v1.3: Struktur für Directory Statistics
 typedef struct {
     char directory[MAX_PATH_LEN];
+    char native_directory[MAX_PATH_LEN];  // directory mit Trennern des Betriebssystems (API)
     int file_count;
     int total_functions;
     int total_structs;
@@ -84,18 +159,14 @@ typedef struct {
     int total_static_vars;
     int total_overloads;
     int total_duplicates;
+    int internal_includes;          // Includes innerhalb des Verzeichnisses
+    int external_includes;          // Includes in andere Verzeichnisse
+    int afferent_coupling;          // Anzahl Verzeichnisse, die dieses inkludieren
+    int efferent_coupling;          // Anzahl Verzeichnisse, die dieses inkludiert
 } DirectoryStats;
 
-// Struktur für Datei-Analyse
+// v1.4: Element-Tabellen einer Datei - werden im Streaming-Modus nach dem Schreiben freigegeben
 typedef struct {
-    char filename[MAX_PATH_LEN];
-    char filepath[MAX_PATH_LEN];
-    char relative_dir[MAX_PATH_LEN];
-    int is_used;
-    int include_depth;
-    int is_performance_problem;
-    int is_circular_include;
-    int multiple_include_count;
     IncludeElement includes[MAX_ITEMS_PER_FILE];
     CodeElement void_functions[MAX_ITEMS_PER_FILE];
     CodeElement functions[MAX_ITEMS_PER_FILE];
@@ -105,7 +176,67 @@ typedef struct {
     CodeElement static_vars[MAX_ITEMS_PER_FILE];
     CodeElement function_overloads[MAX_ITEMS_PER_FILE];
     CodeElement static_duplicates[MAX_ITEMS_PER_FILE];
+    MacroElement macros[MAX_ITEMS_PER_FILE];
     PragmaPath pragma_paths[MAX_PRAGMA_PATHS];
+} FileElementStorage;
+
+// Struktur für Datei-Analyse
+typedef struct {
+    char filename[MAX_PATH_LEN];
+    char filepath[MAX_PATH_LEN];
+    char relative_dir[MAX_PATH_LEN];
+    int is_used;
+    int include_depth;
+    int is_performance_problem;
+    int is_circular_include;
+    int multiple_include_count;
+    int line_count;
+    long file_size;
+    unsigned long long content_hash;
+    int duplicate_of;               // Index der Datei mit identischem Inhalt oder -1
+    int included_from;              // Datei, die diese zuerst inkludiert hat, oder -1
+    int has_include_guard;          // #ifndef/#define-Guard oder #pragma once
+    int parse_complete;
+    FileElementStorage* elements;   // NULL, sobald die Datei gestreamt wurde
+    IncludeElement* includes;
+    CodeElement* void_functions;
+    CodeElement* functions;
+    CodeElement* actions;
+    CodeElement* structs;
+    CodeElement* typedef_structs;
+    CodeElement* static_vars;
+    CodeElement* function_overloads;
+    CodeElement* static_duplicates;
+    MacroElement* macros;
+    PragmaPath* pragma_paths;
+    // Skelett - bleibt nach dem Freigeben der Elemente erhalten
+    int* include_targets;           // Index der inkludierten Datei je Include oder -1
+    int* include_lines;
+    unsigned char* include_usage;   // INCLUDE_USAGE_* je Include
+    int* type_name_ids;             // Structs und Typedef-Structs
+    int type_name_count;
+    int* global_static_ids;         // interne String-IDs der globalen statischen Variablen
+    int global_static_count;
+    int* macro_name_ids;            // in dieser Datei definierte Makros
+    int backslash_include_count;
+    int pragma_include_count;
+    int pragma_backslash_count;
+    int first_symbol;               // Bereich in symbols[]
+    int symbol_total;
+    int call_ref_first;             // Bereich in call_refs[]
+    int call_ref_total;
+    int macro_use_first;            // Bereich in macro_uses[]
+    int macro_use_total;
+    int struct_layout_first;        // Bereich in struct_layouts[]
+    int struct_layout_total;
+    int static_storage_first;       // statische Variablen, Bereich in data_members[]
+    int static_storage_total;
+    int frame_loop_first;           // Bereich in frame_loops[]
+    int frame_loop_total;
+    int asset_ref_first;            // Bereich in asset_refs[]
+    int asset_ref_total;
+    int forward_decl_first;         // Bereich in forward_decls[]
+    int forward_decl_total;
     int include_count;
     int void_function_count;
     int function_count;
@@ -115,42 +246,507 @@ typedef struct {
     int static_var_count;
     int overload_count;
     int static_duplicate_count;
+    int macro_count;
     int pragma_path_count;
 } FileAnalysis;
 
-// Global file analysis array
-FileAnalysis files[MAX_FILES];
-
 // Struktur für Include-Stack (Cycle Detection)
 typedef struct {
     char filepath[MAX_PATH_LEN];
     int depth;
 } IncludeStackEntry;
 
-IncludeStackEntry include_stack[50];
-int stack_depth = 0;
-
-// Globale PRAGMA_PATH Liste
-PragmaPath global_pragma_paths[MAX_PRAGMA_PATHS * MAX_FILES];
-int global_pragma_path_count = 0;
-
-// Verzeichnis-Nutzung tracking
-DirectoryUsage used_directories[MAX_FILES];
-int used_directory_count = 0;
-
 // Hash-Tables für Duplikatserkennung
 typedef struct {
     char name[MAX_NAME_LEN];
     int count;
 } NameCounter;
 
-NameCounter function_names[MAX_FILES * 5];
-NameCounter static_var_names[MAX_FILES * 5];
-int function_name_count = 0;
-int static_var_name_count = 0;
+// v1.4: Unity-Build Planung
+#define UNITY_DEFAULT_LINE_BUDGET 50000
+#define UNITY_MIN_SHARED_RATIO 0.5
+
+typedef struct {
+    int* members;                   // Indizes der Translation Units
+    int member_count;
+    unsigned char* contained;       // Bitset aller Dateien im Batch
+    long total_lines;               // Geschätzte präprozessierte Zeilen
+    long separate_lines;            // Summe der Einzel-Kosten der Members
+} UnityBatch;
+
+// v1.4: Hash-Index (String -> int), offene Adressierung mit FNV-1a
+typedef struct {
+    char** keys;
+    int* values;
+    int capacity;                   // Zweierpotenz
+    int count;
+} HashIndex;
+
+// v1.4: Verzeichnis-Snapshot
+#define SNAPSHOT_NOT_FOUND -1
+#define SNAPSHOT_OUTSIDE -2
+
+typedef struct {
+    int parent;
+    char* name;                     // Name wie auf der Platte
+    char* path;                     // Vollständiger Pfad mit nativen Trennern
+    int is_directory;
+    long size;
+    char blob[41];                  // Git-Blob-ID (hex) aus dem Index, sonst leer
+    long long mtime;                // Änderungszeit laut Index (Sekunden)
+} TreeEntry;
+
+// v1.4: Verlauf - Blob-Inhalte, die über mehrere Commits im Speicher bleiben
+typedef struct {
+    char* data;
+    long size;
+} HistoryBlob;
+
+// v1.4: Parse-Cache - ein Eintrag je Datei, die Zeilen werden erst beim Wiederverwenden gelesen
+typedef struct {
+    const char* path;               // relativ zum Projekt-Root
+    const char* record;             // erste Zeile nach der F-Zeile
+    int record_lines;
+    char blob[41];                  // "" wenn die Datei beim Speichern vom Index abwich
+    long file_size;
+    unsigned long long content_hash;
+    int line_count;
+    int has_include_guard;
+    int reusable;                   // unverändert und keine geänderte Datei in der Include-Hülle
+} ParseCacheEntry;
+
+// v1.4: Read-Ahead Puffer
+#define PREFETCH_SLOTS 32
+#define PREFETCH_MAX_BYTES (16L * 1024 * 1024)
+#define PREFETCH_THREADS 4
+
+enum { PREFETCH_FREE, PREFETCH_QUEUED, PREFETCH_OPENING, PREFETCH_READING, PREFETCH_DONE, PREFETCH_FAILED };
+enum { READAHEAD_OFF, READAHEAD_URING, READAHEAD_THREADS };
+
+typedef struct {
+    char path[MAX_PATH_LEN];
+    char* data;
+    long size;
+    long done;
+    int state;
+    int fd;
+    unsigned long sequence;         // Reihenfolge der Anforderung (FIFO für den Thread-Pool)
+} PrefetchSlot;
+
+#ifdef ANALYZER_HAVE_IO_URING
+// Minimaler io_uring-Zugriff ohne liburing: Ringe per mmap, Submit/Reap über Syscalls
+typedef struct {
+    int ring_fd;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    void* cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    int in_flight;
+} UringState;
+#endif
+
+// v1.4: Makro-Tabelle
+typedef struct {
+    int name_id;
+    int body_id;                    // interner String des normalisierten Bodys
+    int has_parameters;
+    int file_index;
+    int line;
+} MacroDefinition;
+
+// Makro-Verwendung: pro Datei und Definition ein Eintrag mit Anzahl
+typedef struct {
+    int file_index;
+    int definition;
+    int line;                       // erste Verwendung
+    int count;
+} MacroUse;
+
+// v1.4: Symbol-Tabelle und Rumpf-Referenzen
+typedef struct {
+    int name_id;
+    int kind;
+    int file_index;
+    int line;
+    int is_prototype;
+} SymbolDefinition;
+
+typedef struct {
+    int caller;                     // beim Sammeln: Zeile der Definition, danach Symbol-Index
+    int name_id;
+    int line;                       // erste Verwendung im Rumpf
+    int count;
+} CallReference;
+
+// v1.4: Aho-Corasick-Automat für ungenutzte Includes
+typedef struct {
+    int first_child;
+    int next_sibling;
+    int fail;
+    int output;                     // nächster Knoten der Fail-Kette, an dem ein Muster endet, oder -1
+    int length;                     // Musterlänge, falls hier ein Muster endet, sonst 0
+    char is_macro;                  // Muster ist nur als Makro bekannt
+    char is_type;                   // Muster ist nur als Struct/Typedef bekannt
+    char c;
+} AutomatonNode;
+
+typedef struct {
+    AutomatonNode* nodes;
+    int node_count;
+    int node_capacity;
+    int pattern_count;
+    int type_pattern_count;
+} SymbolAutomaton;
+
+// v1.4: Gerichteter Graph in CSR-Form (Datei-, Verzeichnis- und Aufrufgraph)
+enum { EDGE_INCLUDE, EDGE_MACRO, EDGE_CALL };
+
+typedef struct {
+    int node_count;
+    int edge_count;
+    int* first_edge;                // node_count + 1 Einträge
+    int* edge_target;
+    int* edge_weight;
+    unsigned char* edge_type;       // EDGE_*
+} DepGraph;
+
+// v1.4: Deklaration für die Header-Generierung
+typedef struct {
+    int kind;
+    int name_id;                    // interner String (intern_string)
+    int directory_id;               // interner String des relativen Verzeichnisses
+} Declaration;
+
+// v1.4: Struct-Layout und statischer Speicher. Member-Deklarationen werden beim Parsen gesammelt,
+// die Größen erst nach dem Parsen aller Dateien berechnet (eingebettete Structs aus anderen Dateien).
+typedef struct {
+    int type_id;                    // interner Typname ohne Qualifier und '*'
+    int name_id;
+    int dims_id;                    // Array-Dimensionen wie geschrieben ("4][MAX_ENEMIES") oder -1
+    int is_pointer;                 // auch Funktionszeiger
+    int line;
+    long offset;                    // ab hier von resolve_struct_layouts berechnet
+    long size;
+    int align;
+    int size_known;                 // 0: unbekannter Typ oder Array-Größe, mit Zeigergröße gezählt
+} DataMember;
+
+typedef struct {
+    int name_id;                    // Typedef-Name, sonst Struct-Name
+    int tag_id;                     // Struct-Name bei "typedef struct TAG {...} NAME;" oder -1
+    int file_index;
+    int line;
+    int member_first;               // Bereich in data_members[]
+    int member_count;
+    long size;
+    int align;
+    long padding;
+    int unknown_members;
+    int state;                      // LAYOUT_*
+} StructLayout;
+
+// v1.4: Per-Frame-Schleifen - Schleifen mit wait() im Rumpf laufen einmal pro Frame (und Entity)
+typedef struct {
+    int file_index;
+    int function_name_id;
+    int line;
+    int call_first;                 // Bereich in loop_calls[]
+    int call_count;
+    long cost;                      // compute_hot_loop_costs
+} FrameLoop;
+
+typedef struct {
+    int loop;                       // beim Sammeln: Schleife im Collector, danach Index in frame_loops
+    int name_id;
+    int line;                       // erster Aufruf
+    int nesting;                    // Schleifen ohne wait() zwischen Aufruf und Frame-Schleife
+    int count;
+    long cost;
+} LoopCall;
+
+// v1.4: Zyklen-Auflösung - Include-Kanten, nach deren Entfernen der Include-Graph azyklisch ist
+typedef struct {
+    int file_index;
+    int include_slot;               // Index in include_targets[] / include_lines[]
+    long weight;                    // Zeilen, die das Ziel ohne den Rest des Zyklus hereinholt
+} CycleBreak;
+
+typedef struct {
+    int component;                  // file_component
+    int file_count;
+    int break_first;                // Bereich in cycle_breaks[]
+    int break_count;
+    long cycle_lines_before;        // Summe der präprozessierten Zeilen aller Dateien im Zyklus
+    long cycle_lines_after;
+    int unit_count;                 // Translation Units, die den Zyklus erreichen
+    long unit_lines_before;
+    long unit_lines_after;
+} CycleComponent;
+
+// v1.4: Asset-Referenzen - Modelle, Texturen, Sounds und Level aus String-Literalen und PRAGMA_BIND
+#define ASSET_LARGEST_SHOWN 3
+
+typedef struct {
+    int caller;                     // beim Sammeln: Zeile der Definition (0 global), danach Symbol-Index oder -1
+    int owner_id;                   // globale Definition "BMAP* name = ..." / "#define NAME ...": Name, sonst -1
+    int name_id;                    // Dateiname wie im Literal
+    int line;
+    int is_bind;                    // #define PRAGMA_BIND
+    int asset;                      // Index in asset_files nach dem Auflösen
+    int file_index;                 // referenzierende Datei
+} AssetReference;
+
+typedef struct {
+    int path_id;                    // relativ zum Projekt-Root, fehlende Assets: Name wie im Literal
+    long size;                      // -1, wenn die Datei nicht gefunden wurde
+} AssetFile;
+
+typedef struct {
+    int symbol;                     // Action oder main()
+    int asset_count;
+    long bytes;
+    int largest[ASSET_LARGEST_SHOWN]; // größte Assets (asset_files) oder -1
+} AssetFootprint;
+
+// v1.4: Vorwärtsdeklaration - Struct/Typedef, den ein Include nur über Zeiger liefert
+typedef struct {
+    int include_slot;               // Index in include_targets[] / include_lines[]
+    int name_id;
+} ForwardDeclaration;
+
+// v1.4: Analyse-Kontext - der gesamte Zustand einer Analyse (früher globale Variablen).
+// Jeder Thread arbeitet auf seinem aktuellen Kontext (ctx), den die API-Funktionen setzen;
+// so können mehrere Analysen in einem Prozess parallel laufen.
+struct AnalysisContext {
+    // Optionen
+    char base_path[MAX_PATH_LEN];
+    int use_include_tracking;
+    char unity_output_dir[MAX_PATH_LEN];
+    char depfile_dir[MAX_PATH_LEN];
+    long unity_line_budget;
+    int split_declaration_headers;
+    int streaming_mode;
+    char stream_report_file[MAX_PATH_LEN];
+    int readahead_enabled;
+    int verbose;                    // Fortschritt und Warnungen auf stdout
+    int use_git_index;
+    char parse_cache_file[MAX_PATH_LEN];
+    char changed_since[MAX_NAME_LEN];
+    char main_file[MAX_PATH_LEN];   // leer = alle Dateien
+    int analysis_done;
+
+    // Parse-Cache des vorigen Laufs im Speicher statt in einer Datei (Verlauf, Server)
+    int keep_parse_cache;
+    char* memory_parse_cache;
+    long memory_parse_cache_size;
+    char reanalyze_file[MAX_PATH_LEN]; // Server: nur diese Datei (relativ) gilt als geändert, sonst leer
+
+    // Verlauf (analyzer_history) - bleibt über die Analysen der einzelnen Commits erhalten
+    char history_commit[48];        // analysierter Commit, leer außerhalb des Verlaufs
+    HistoryBlob* history_blobs;
+    int history_blob_count;
+    int history_blob_capacity;
+    HashIndex history_blob_index;   // Blob-ID -> history_blobs
+
+    // Dateien
+    FileAnalysis files[MAX_FILES];
+    int file_count;
+    IncludeStackEntry include_stack[50];
+    int stack_depth;
+    PragmaPath* global_pragma_paths;
+    int global_pragma_path_count;
+    int global_pragma_path_capacity;
+    DirectoryUsage used_directories[MAX_FILES];
+    int used_directory_count;
+    NameCounter function_names[MAX_FILES * 5];
+    NameCounter static_var_names[MAX_FILES * 5];
+    int function_name_count;
+    int static_var_name_count;
+    HashIndex content_index;        // Erster vollständig geparster Inhalt je Hash+Größe
+
+    // String-Interning
+    HashIndex string_pool_index;
+    const char** string_pool;
+    int string_pool_count;
+    int string_pool_capacity;
+
+    // Verzeichnis-Snapshot
+    TreeEntry* tree_entries;
+    int tree_entry_count;
+    int tree_entry_capacity;
+    HashIndex tree_index;
+    char snapshot_root[MAX_PATH_LEN];
+
+    // Parse-Cache
+    ParseCacheEntry* parse_cache;
+    int parse_cache_count;
+    int parse_cache_capacity;
+    HashIndex parse_cache_index;    // relativer Pfad -> Eintrag
+    char* parse_cache_text;         // Inhalt der Cache-Datei, die Einträge zeigen hinein
+    int parse_cache_hits;
+
+    // Read-Ahead
+    PrefetchSlot prefetch_slots[PREFETCH_SLOTS];
+    int readahead_backend;
+    long prefetch_bytes;
+    unsigned long prefetch_sequence;
+    int prefetch_requests;
+    int prefetch_hits;
+#ifdef ANALYZER_HAVE_IO_URING
+    UringState uring;
+#endif
+#ifdef _WIN32
+    CRITICAL_SECTION prefetch_mutex;
+    CONDITION_VARIABLE prefetch_cond;
+    HANDLE prefetch_threads[PREFETCH_THREADS];
+#else
+    pthread_mutex_t prefetch_mutex;
+    pthread_cond_t prefetch_cond;
+    pthread_t prefetch_threads[PREFETCH_THREADS];
+#endif
+    int prefetch_thread_count;
+    int prefetch_stopping;
+
+    // Makros
+    MacroDefinition* macro_defs;
+    int macro_def_count;
+    int macro_def_capacity;
+    HashIndex macro_index;          // Makroname -> aktuell gültige Definition
+    MacroUse* macro_uses;
+    int macro_use_count;
+    int macro_use_capacity;
+
+    // Symbole und Rumpf-Referenzen
+    SymbolDefinition* symbols;
+    int symbol_count;
+    int symbol_capacity;
+    CallReference* call_refs;
+    int call_ref_count;
+    int call_ref_capacity;
+    int* reference_mark_serial;     // Pro String-ID: in welchem Rumpf (Serial) zuletzt gesehen
+    int* reference_mark_slot;       // und an welcher Stelle gespeichert
+    int reference_mark_capacity;
+    int reference_serial;
+
+    // Ungenutzte Includes
+    SymbolAutomaton* header_automata[MAX_FILES];
+    long automaton_nodes_cached;
+    int closure_visit_stamp[MAX_FILES];
+    int closure_visit_serial;
+
+    // Transitive Include-Hüllen (Bitset pro Datei)
+    unsigned char* include_closure;
+    int closure_stride;
+    int* file_component;            // SCC des Include-Graphen je Datei
+
+    // Aufrufgraph
+    DepGraph call_graph;
+    int call_graph_built;
+    int* symbol_incoming;
+    int resolved_call_refs;
+    int dead_function_count;
+    int* symbol_name_first;
+    int* symbol_name_next;
+
+    // Datei-Abhängigkeitsgraph (Include- und Makro-Kanten)
+    DepGraph file_dependency_graph;
+    int file_dependency_graph_built;
+    int macro_edge_count;
+
+    // Verzeichnis-Aggregation
+    DirectoryStats directory_stats[MAX_FILES];
+    int directory_stats_count;
+    int* file_directory;
+    DepGraph directory_graph;
+    int* directory_component;
+    int directory_component_count;
+
+    // Struct-Layouts und statischer Speicher
+    StructLayout* struct_layouts;
+    int struct_layout_count;
+    int struct_layout_capacity;
+    DataMember* data_members;
+    int data_member_count;
+    int data_member_capacity;
+    HashIndex struct_layout_index;  // Struct- und Typedef-Name -> erstes Layout
+
+    // Per-Frame-Schleifen
+    FrameLoop* frame_loops;
+    int frame_loop_count;
+    int frame_loop_capacity;
+    LoopCall* loop_calls;
+    int loop_call_count;
+    int loop_call_capacity;
+
+    // Zyklen-Auflösung (Feedback-Arc-Set je Komponente)
+    CycleComponent* cycle_components;
+    int cycle_component_count;
+    CycleBreak* cycle_breaks;
+    int cycle_break_count;
+    int cycle_unit_count;           // Translation Units, die kleiner werden, wenn alle Zyklen aufgelöst sind
+    long cycle_unit_lines_saved;
+
+    // Build-Ebenen und kritischer Pfad
+    int* file_level;                // Ebene der Komponente je Datei
+    int build_level_count;
+    int* critical_path;             // Dateien von der Translation Unit bis zum Blatt
+    int critical_path_length;
+    long critical_path_lines;
+
+    // Asset-Referenzen und Footprints
+    AssetReference* asset_refs;
+    int asset_ref_count;
+    int asset_ref_capacity;
+    AssetFile* asset_files;
+    int asset_file_count;
+    HashIndex asset_index;          // relativer Pfad -> asset_files
+    AssetFootprint* asset_footprints;
+    int asset_footprint_count;
+    int global_asset_count;         // PRAGMA_BIND und globale Literale ohne Namen
+    long global_asset_bytes;
+
+    // Includes, die durch Vorwärtsdeklarationen ersetzbar sind
+    ForwardDeclaration* forward_decls;
+    int forward_decl_count;
+    int forward_decl_capacity;
+
+    // Unity-Build Planung
+    UnityBatch* unity_batches;
+    int unity_batch_count;
+    int unity_tu_count;
+
+    // Report und Header
+    FILE* stream_report;
+    Declaration* declarations;
+    int declaration_count;
+    int declaration_capacity;
+    HashIndex declaration_index;
+};
+
+static ANALYZER_THREAD_LOCAL AnalysisContext* ctx = NULL;
+
+// Fortschritt und Warnungen der Analyse - nur mit verbose, damit Bibliotheks-Nutzer
+// (z.B. ein Server auf stdin/stdout) einen sauberen stdout behalten
+static void analyzer_log(const char* format, ...) {
+    if (!ctx || !ctx->verbose) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
 
 // Hilfsfunktionen
-void trim_whitespace(char* str) {
+static void trim_whitespace(char* str) {
     char* end;
     while (*str == ' ' || *str == '\t') str++;
     if (*str == 0) return;
@@ -159,54 +755,79 @@ void trim_whitespace(char* str) {
     end[1] = '\0';
 }
 
-int starts_with(const char* str, const char* prefix) {
+static int starts_with(const char* str, const char* prefix) {
     return strncmp(str, prefix, strlen(prefix)) == 0;
 }
 
-void normalize_path_separators(char* path) {
+static int is_identifier_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int is_identifier_char(char c) {
+    return is_identifier_start(c) || (c >= '0' && c <= '9');
+}
+
+static void normalize_path_separators(char* path) {
     for (int i = 0; path[i]; i++) {
         if (path[i] == '\\') path[i] = '/';
     }
 }
 
-int has_backslash(const char* path) {
+static int has_backslash(const char* path) {
     return strchr(path, '\\') != NULL;
 }
 
-void add_directory_usage(const char* dir_path) {
+// Trenner des Betriebssystems ('\\' unter Windows, '/' sonst)
+static void to_native_separators(char* path) {
+    for (int i = 0; path[i]; i++) {
+        if (path[i] == '/' || path[i] == '\\') path[i] = PATH_SEP[0];
+    }
+}
+
+static int path_exists(const char* path) {
+#ifdef _WIN32
+    return GetFileAttributes(path) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+    return stat(path, &info) == 0;
+#endif
+}
+
+static void add_directory_usage(const char* dir_path) {
     char normalized[MAX_PATH_LEN];
     strcpy(normalized, dir_path);
     normalize_path_separators(normalized);
 
-    for (int i = 0; i < used_directory_count; i++) {
+    for (int i = 0; i < ctx->used_directory_count; i++) {
         char existing_normalized[MAX_PATH_LEN];
-        strcpy(existing_normalized, used_directories[i].path);
+        strcpy(existing_normalized, ctx->used_directories[i].path);
         normalize_path_separators(existing_normalized);
 
         if (strcmp(existing_normalized, normalized) == 0) {
-            used_directories[i].usage_count++;
+            ctx->used_directories[i].usage_count++;
             return;
         }
     }
 
-    if (used_directory_count < MAX_FILES) {
-        strcpy(used_directories[used_directory_count].path, dir_path);
-        used_directories[used_directory_count].usage_count = 1;
-        used_directories[used_directory_count].has_backslash = has_backslash(dir_path);
-        used_directory_count++;
+    if (ctx->used_directory_count < MAX_FILES) {
+        strcpy(ctx->used_directories[ctx->used_directory_count].path, dir_path);
+        ctx->used_directories[ctx->used_directory_count].usage_count = 1;
+        ctx->used_directories[ctx->used_directory_count].has_backslash = has_backslash(dir_path);
+        ctx->used_directory_count++;
     }
 }
 
-char* get_relative_path(const char* full_path, const char* base_path) {
-    static char relative[MAX_PATH_LEN];
-    const char* rel_start = strstr(full_path, base_path);
+static char* get_relative_path(const char* full_path, const char* root_path) {
+    static ANALYZER_THREAD_LOCAL char relative[MAX_PATH_LEN];
+    const char* rel_start = strstr(full_path, root_path);
     if (rel_start) {
-        rel_start += strlen(base_path);
+        rel_start += strlen(root_path);
         if (*rel_start == '\\' || *rel_start == '/') rel_start++;
         strcpy(relative, ".\\");
         strcat(relative, rel_start);
         char* last_slash = strrchr(relative, '\\');
-        if (!last_slash) last_slash = strrchr(relative, '/');
+        char* last_forward = strrchr(relative, '/');
+        if (!last_slash || (last_forward && last_forward > last_slash)) last_slash = last_forward;
         if (last_slash && last_slash != relative + 1) {
             *last_slash = '\0';
         }
@@ -216,82 +837,65 @@ char* get_relative_path(const char* full_path, const char* base_path) {
 }
 
 // Zirkuläre Include Detection
-int check_circular_include(const char* filepath) {
+static int check_circular_include(const char* filepath) {
     char normalized_path[MAX_PATH_LEN];
     strcpy(normalized_path, filepath);
     normalize_path_separators(normalized_path);
 
-    for (int i = 0; i < stack_depth; i++) {
+    for (int i = 0; i < ctx->stack_depth; i++) {
         char stack_normalized[MAX_PATH_LEN];
-        strcpy(stack_normalized, include_stack[i].filepath);
+        strcpy(stack_normalized, ctx->include_stack[i].filepath);
         normalize_path_separators(stack_normalized);
 
         if (strcmp(stack_normalized, normalized_path) == 0) {
-            printf("CIRCULAR INCLUDE DETECTED:\n");
-            for (int j = i; j < stack_depth; j++) {
-                const char* filename = strrchr(include_stack[j].filepath, '\\');
-                if (!filename) filename = strrchr(include_stack[j].filepath, '/');
-                if (filename) filename++; else filename = include_stack[j].filepath;
-                printf("  [%d] %s\n", include_stack[j].depth, filename);
+            analyzer_log("CIRCULAR INCLUDE DETECTED:\n");
+            for (int j = i; j < ctx->stack_depth; j++) {
+                const char* filename = strrchr(ctx->include_stack[j].filepath, '\\');
+                if (!filename) filename = strrchr(ctx->include_stack[j].filepath, '/');
+                if (filename) filename++; else filename = ctx->include_stack[j].filepath;
+                analyzer_log("  [%d] %s\n", ctx->include_stack[j].depth, filename);
             }
             const char* current_filename = strrchr(filepath, '\\');
             if (!current_filename) current_filename = strrchr(filepath, '/');
             if (current_filename) current_filename++; else current_filename = filepath;
-            printf("  [%d] %s ← CREATES CYCLE\n", stack_depth, current_filename);
-            printf("\n");
+            analyzer_log("  [%d] %s ← CREATES CYCLE\n", ctx->stack_depth, current_filename);
+            analyzer_log("\n");
             return 1;
         }
     }
     return 0;
 }
 
-// Include-Datei-Suche mit PRAGMA_PATH Support
-char* find_include_file_enhanced(const char* include_name, const char* current_dir, char* found_directory) {
-    static char found_path[MAX_PATH_LEN];
+// Include-Datei-Suche mit PRAGMA_PATH Support (Lookups über den Verzeichnis-Snapshot)
+static char* find_include_file_enhanced(const char* include_name, const char* current_dir, char* found_directory) {
+    static ANALYZER_THREAD_LOCAL char found_path[MAX_PATH_LEN];
     char test_path[MAX_PATH_LEN];
+    int length;
 
+    // Zu lange Kandidaten überspringen statt abgeschnitten (also falsch) zu prüfen
     // 1. Versuche im aktuellen Verzeichnis
-    sprintf(test_path, "%s/%s", current_dir, include_name);
-    normalize_path_separators(test_path);
-
-    char windows_path[MAX_PATH_LEN];
-    strcpy(windows_path, test_path);
-    for (int i = 0; windows_path[i]; i++) {
-        if (windows_path[i] == '/') windows_path[i] = '\\';
-    }
-
-    if (GetFileAttributes(windows_path) != INVALID_FILE_ATTRIBUTES) {
-        strcpy(found_path, windows_path);
+    length = snprintf(test_path, sizeof(test_path), "%s/%s", current_dir, include_name);
+    if (length >= 0 && length < (int)sizeof(test_path) && probe_include_candidate(test_path, found_path)) {
         strcpy(found_directory, current_dir);
         return found_path;
     }
 
     // 2. Versuche im Root-Verzeichnis
-    sprintf(test_path, "%s/%s", base_path, include_name);
-    normalize_path_separators(test_path);
-    strcpy(windows_path, test_path);
-    for (int i = 0; windows_path[i]; i++) {
-        if (windows_path[i] == '/') windows_path[i] = '\\';
-    }
-
-    if (GetFileAttributes(windows_path) != INVALID_FILE_ATTRIBUTES) {
-        strcpy(found_path, windows_path);
-        strcpy(found_directory, base_path);
+    length = snprintf(test_path, sizeof(test_path), "%s/%s", ctx->base_path, include_name);
+    if (length >= 0 && length < (int)sizeof(test_path) && probe_include_candidate(test_path, found_path)) {
+        strcpy(found_directory, ctx->base_path);
         return found_path;
     }
 
     // 3. Versuche in allen PRAGMA_PATH Verzeichnissen
-    for (int i = 0; i < global_pragma_path_count; i++) {
-        sprintf(test_path, "%s/%s/%s", base_path, global_pragma_paths[i].path, include_name);
-        normalize_path_separators(test_path);
-        strcpy(windows_path, test_path);
-        for (int j = 0; windows_path[j]; j++) {
-            if (windows_path[j] == '/') windows_path[j] = '\\';
-        }
-
-        if (GetFileAttributes(windows_path) != INVALID_FILE_ATTRIBUTES) {
-            strcpy(found_path, windows_path);
-            sprintf(found_directory, "%s/%s", base_path, global_pragma_paths[i].path);
+    for (int i = 0; i < ctx->global_pragma_path_count; i++) {
+        length = snprintf(test_path, sizeof(test_path), "%s/%s/%s", ctx->base_path,
+                          ctx->global_pragma_paths[i].path, include_name);
+        if (length < 0 || length >= (int)sizeof(test_path)) continue;
+        if (probe_include_candidate(test_path, found_path)) {
+            int directory_length = length - (int)strlen(include_name) - 1;
+            memcpy(found_directory, test_path, directory_length);
+            found_directory[directory_length] = '\0';
             normalize_path_separators(found_directory);
             return found_path;
         }
@@ -301,9 +905,9 @@ char* find_include_file_enhanced(const char* include_name, const char* current_d
     return NULL;
 }
 
-int find_file_index(const char* filepath) {
-    for (int i = 0; i < file_count; i++) {
-        if (strcmp(files[i].filepath, filepath) == 0) {
+static int find_file_index(const char* filepath) {
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (strcmp(ctx->files[i].filepath, filepath) == 0) {
             return i;
         }
     }
@@ -311,7 +915,7 @@ int find_file_index(const char* filepath) {
 }
 
 // Pattern Matching Funktionen
-int match_pragma_path(const char* line, char* path_value, int* has_backslash_ptr) {
+static int match_pragma_path(const char* line, char* path_value, int* has_backslash_ptr) {
     char* start = strstr(line, "#define PRAGMA_PATH");
     if (!start) return 0;
 
@@ -332,7 +936,82 @@ int match_pragma_path(const char* line, char* path_value, int* has_backslash_ptr
     return 0;
 }
 
-int match_include_enhanced(const char* line, IncludeElement* include_elem) {
+// v1.4: Makro-Definition "#define NAME body" - body ist der Rest hinter dem Namen ohne führende
+// Leerzeichen (bei Funktionsmakros mit der Parameterliste vorn), Leerzeichen zusammengefasst, ohne
+// Zeilenkommentar. has_parameters (darf NULL sein): Parameterliste direkt hinter dem Namen.
+// PRAGMA_* sind Compiler-Anweisungen und zählen nicht als Makro.
+static int match_define(const char* line, char* macro_name, char* body, int* has_parameters) {
+    const char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != '#') return 0;
+    p++;
+    while (*p == ' ' || *p == '\t') p++;
+    if (strncmp(p, "define", 6) != 0 || (p[6] != ' ' && p[6] != '\t')) return 0;
+    p += 6;
+    while (*p == ' ' || *p == '\t') p++;
+    if (!is_identifier_start(*p)) return 0;
+
+    int len = 0;
+    while (is_identifier_char(*p)) {
+        if (len < MAX_NAME_LEN - 1) macro_name[len++] = *p;
+        p++;
+    }
+    macro_name[len] = '\0';
+    if (strncmp(macro_name, "PRAGMA_", 7) == 0) return 0;
+    if (has_parameters) *has_parameters = *p == '(';
+
+    int k = 0, pending_space = 0;
+    while (*p && k < MAX_LINE_LEN - 2) {
+        if (p[0] == '/' && p[1] == '/') break;
+        if (*p == ' ' || *p == '\t') {
+            pending_space = 1;
+            p++;
+            continue;
+        }
+        if (pending_space && k > 0) body[k++] = ' ';
+        pending_space = 0;
+        body[k++] = *p++;
+    }
+    body[k] = '\0';
+    return 1;
+}
+
+// v1.4: Nächster Bezeichner ab p in einer Zeile; Strings, Zeichen und Zeilenkommentare werden
+// übersprungen. is_member: Member-Zugriff (my.skill1, ptr->x). Liefert die Position hinter dem
+// Bezeichner oder NULL am Zeilenende.
+static const char* next_identifier(const char* text, const char* p, char* name, int* is_member) {
+    while (*p) {
+        if (*p == '"' || *p == '\'') {
+            char quote = *p++;
+            while (*p && *p != quote) {
+                if (*p == '\\' && p[1]) p++;
+                p++;
+            }
+            if (*p) p++;
+            continue;
+        }
+        if (p[0] == '/' && p[1] == '/') return NULL;
+
+        if (is_identifier_start(*p) && (p == text || !is_identifier_char(p[-1]))) {
+            const char* before = p;
+            while (before > text && (before[-1] == ' ' || before[-1] == '\t')) before--;
+            *is_member = before > text &&
+                         (before[-1] == '.' || (before[-1] == '>' && before - 1 > text && before[-2] == '-'));
+
+            int len = 0;
+            while (is_identifier_char(*p)) {
+                if (len < MAX_NAME_LEN - 1) name[len++] = *p;
+                p++;
+            }
+            name[len] = '\0';
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static int match_include_enhanced(const char* line, IncludeElement* include_elem) {
     char* start = strstr(line, "#include");
     if (!start) return 0;
 
@@ -367,7 +1046,7 @@ int match_include_enhanced(const char* line, IncludeElement* include_elem) {
     return 0;
 }
 
-int match_function_declaration(const char* line, const char* type, char* func_name) {
+static int match_function_declaration(const char* line, const char* type, char* func_name) {
     char pattern[64];
     sprintf(pattern, "%s ", type);
 
@@ -388,7 +1067,16 @@ int match_function_declaration(const char* line, const char* type, char* func_na
     return 0;
 }
 
-int match_struct(const char* line, char* struct_name) {
+// v1.4: Prototyp ("function f(var a);") - nach der Parameterliste folgt nur noch ';'
+static int is_prototype_line(const char* line) {
+    const char* paren = strrchr(line, ')');
+    if (!paren || strchr(line, '{')) return 0;
+    paren++;
+    while (*paren == ' ' || *paren == '\t') paren++;
+    return *paren == ';';
+}
+
+static int match_struct(const char* line, char* struct_name) {
     char* start = strstr(line, "struct ");
     if (!start || start != line + strspn(line, " \t")) return 0;
 
@@ -406,7 +1094,7 @@ int match_struct(const char* line, char* struct_name) {
     return 0;
 }
 
-int match_typedef_struct(const char* line, char* struct_name) {
+static int match_typedef_struct(const char* line, char* struct_name) {
     char* start = strstr(line, "typedef struct ");
     if (start && start == line + strspn(line, " \t")) {
         start += 15;
@@ -443,7 +1131,7 @@ int match_typedef_struct(const char* line, char* struct_name) {
     return 0;
 }
 
-int match_static_var(const char* line, char* var_name) {
+static int match_static_var(const char* line, char* var_name) {
     char* start = strstr(line, "static ");
     if (!start || start != line + strspn(line, " \t")) return 0;
 
@@ -468,604 +1156,8996 @@ int match_static_var(const char* line, char* var_name) {
     return 0;
 }
 
-// Hash-Table Funktionen
-int find_or_add_function_name(const char* name) {
-    for (int i = 0; i < function_name_count; i++) {
-        if (strcmp(function_names[i].name, name) == 0) {
-            function_names[i].count++;
-            return function_names[i].count;
-        }
+static unsigned int hash_string(const char* str) {
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
     }
-    if (function_name_count < MAX_FILES * 5) {
-        strcpy(function_names[function_name_count].name, name);
-        function_names[function_name_count].count = 1;
-        function_name_count++;
-        return 1;
+    return hash;
+}
+
+static int hash_index_slot(const HashIndex* index, const char* key) {
+    int mask = index->capacity - 1;
+    int slot = (int)(hash_string(key) & (unsigned int)mask);
+    while (index->keys[slot] && strcmp(index->keys[slot], key) != 0) {
+        slot = (slot + 1) & mask;
     }
-    return 1;
+    return slot;
+}
+
+// Liefert den gespeicherten Wert oder -1
+static int hash_index_find(const HashIndex* index, const char* key) {
+    if (index->capacity == 0) return -1;
+    int slot = hash_index_slot(index, key);
+    return index->keys[slot] ? index->values[slot] : -1;
 }
 
-int find_or_add_static_var(const char* name, const char* context) {
-    char full_name[MAX_NAME_LEN * 2];
-    sprintf(full_name, "%s::%s", context ? context : "global", name);
+// Gespeicherte Kopie des Schlüssels (bleibt bis hash_index_free gültig) oder NULL
+static const char* hash_index_stored_key(const HashIndex* index, const char* key) {
+    if (index->capacity == 0) return NULL;
+    return index->keys[hash_index_slot(index, key)];
+}
 
-    for (int i = 0; i < static_var_name_count; i++) {
-        if (strcmp(static_var_names[i].name, full_name) == 0) {
-            static_var_names[i].count++;
-            return static_var_names[i].count;
+static void hash_index_put(HashIndex* index, const char* key, int value) {
+    if ((index->count + 1) * 2 > index->capacity) {
+        HashIndex grown;
+        grown.capacity = index->capacity ? index->capacity * 2 : 256;
+        grown.count = 0;
+        grown.keys = (char**)calloc(grown.capacity, sizeof(char*));
+        grown.values = (int*)malloc(sizeof(int) * grown.capacity);
+        for (int i = 0; i < index->capacity; i++) {
+            if (!index->keys[i]) continue;
+            int slot = hash_index_slot(&grown, index->keys[i]);
+            grown.keys[slot] = index->keys[i];
+            grown.values[slot] = index->values[i];
+            grown.count++;
         }
+        free(index->keys);
+        free(index->values);
+        *index = grown;
     }
-    if (static_var_name_count < MAX_FILES * 5) {
-        strcpy(static_var_names[static_var_name_count].name, full_name);
-        static_var_names[static_var_name_count].count = 1;
-        static_var_name_count++;
-        return 1;
+
+    int slot = hash_index_slot(index, key);
+    if (!index->keys[slot]) {
+        index->keys[slot] = _strdup(key);
+        index->count++;
     }
-    return 1;
+    index->values[slot] = value;
 }
 
-// Hauptanalyse-Funktion
-void analyze_file_with_includes(const char* filepath, int depth) {
-    if (depth > 10) {
-        printf("Warning: Include depth limit reached for %s\n", filepath);
-        return;
-    }
+static void hash_index_free(HashIndex* index) {
+    for (int i = 0; i < index->capacity; i++) free(index->keys[i]);
+    free(index->keys);
+    free(index->values);
+    memset(index, 0, sizeof(HashIndex));
+}
 
-    int existing_index = find_file_index(filepath);
-    if (existing_index >= 0) {
-        files[existing_index].is_used = 1;
-        files[existing_index].multiple_include_count++;
-        return;
-    }
+// v1.4: String-Interning - stabile IDs für Namen im Skelett
 
-    if (file_count >= MAX_FILES) return;
+static int intern_string(const char* str) {
+    int id = hash_index_find(&ctx->string_pool_index, str);
+    if (id >= 0) return id;
 
-    if (stack_depth < 50) {
-        strcpy(include_stack[stack_depth].filepath, filepath);
-        include_stack[stack_depth].depth = depth;
-        stack_depth++;
+    if (ctx->string_pool_count == ctx->string_pool_capacity) {
+        ctx->string_pool_capacity = ctx->string_pool_capacity ? ctx->string_pool_capacity * 2 : 1024;
+        ctx->string_pool = (const char**)realloc((void*)ctx->string_pool, sizeof(char*) * ctx->string_pool_capacity);
     }
+    hash_index_put(&ctx->string_pool_index, str, ctx->string_pool_count);
+    ctx->string_pool[ctx->string_pool_count] = hash_index_stored_key(&ctx->string_pool_index, str);
+    return ctx->string_pool_count++;
+}
 
-    int is_circular = check_circular_include(filepath);
+static const char* interned_string(int id) {
+    return ctx->string_pool[id];
+}
 
-    FILE* file = fopen(filepath, "r");
-    if (!file) {
-        printf("Warning: Could not read file: %s\n", filepath);
-        if (stack_depth > 0) stack_depth--;
-        return;
+// v1.4: Wachsender Text-Puffer für Ausgaben, die vor dem Schreiben verglichen werden
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+static void buffer_append(TextBuffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (needed < 0) return;
+
+    if (buffer->length + needed + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (buffer->length + needed + 1 > capacity) capacity *= 2;
+        char* grown = (char*)realloc(buffer->data, capacity);
+        if (!grown) return;
+        buffer->data = grown;
+        buffer->capacity = capacity;
     }
 
-    FileAnalysis* analysis = &files[file_count];
-    memset(analysis, 0, sizeof(FileAnalysis));
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, needed + 1, format, args);
+    va_end(args);
+    buffer->length += needed;
+}
 
-    const char* filename = strrchr(filepath, '\\');
-    if (!filename) filename = strrchr(filepath, '/');
-    if (filename) filename++;
-    else filename = filepath;
-    strcpy(analysis->filename, filename);
-    strcpy(analysis->filepath, filepath);
-    strcpy(analysis->relative_dir, get_relative_path(filepath, base_path));
-    analysis->is_used = 1;
-    analysis->include_depth = depth;
-    analysis->is_performance_problem = (depth > 10) ? 1 : 0;
-    analysis->is_circular_include = is_circular;
-    analysis->multiple_include_count = 1;
+static void buffer_free(TextBuffer* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(TextBuffer));
+}
 
-    char current_dir[MAX_PATH_LEN];
-    strcpy(current_dir, filepath);
-    char* last_slash = strrchr(current_dir, '\\');
-    if (!last_slash) last_slash = strrchr(current_dir, '/');
-    if (last_slash) *last_slash = '\0';
+// Schreibt nur, wenn sich der Inhalt unterscheidet - der Zeitstempel bleibt sonst erhalten,
+// damit abhängige Translation Units nicht unnötig neu gebaut werden.
+// Rückgabe: 1 = geschrieben, 0 = unverändert, -1 = Fehler
+static int write_if_changed(const char* path, const TextBuffer* buffer) {
+    FILE* existing = fopen(path, "rb");
+    if (existing) {
+        fseek(existing, 0, SEEK_END);
+        long size = ftell(existing);
+        int same = 0;
+        if (size == (long)buffer->length) {
+            fseek(existing, 0, SEEK_SET);
+            char* content = (char*)malloc(size + 1);
+            if (content && fread(content, 1, size, existing) == (size_t)size) {
+                same = size == 0 || memcmp(content, buffer->data, size) == 0;
+            }
+            free(content);
+        }
+        fclose(existing);
+        if (same) return 0;
+    }
 
-    printf("Analyzing: %s (depth %d) -> %s%s\n", filename, depth, analysis->relative_dir,
-           is_circular ? " [CIRCULAR]" : "");
+    FILE* file = fopen(path, "wb");
+    if (!file) return -1;
+    if (buffer->length > 0) fwrite(buffer->data, 1, buffer->length, file);
+    fclose(file);
+    return 1;
+}
 
-    char line[MAX_LINE_LEN];
-    int line_num = 0;
-    char current_function[MAX_NAME_LEN] = "";
-    int brace_level = 0;
-    int in_function = 0;
+// v1.4: Verzeichnis-Snapshot
+// Der Projektbaum wird einmal eingelesen; danach ist jede Include-Auflösung (auch über
+// PRAGMA_PATH) ein Hash-Lookup ohne Dateisystemzugriff. Namen werden wie unter Windows
+// ohne Beachtung der Groß-/Kleinschreibung verglichen - auch unter Linux.
 
-    int current_file_index = file_count++;
+static void make_tree_key(int parent, const char* name, char* key) {
+    int len = sprintf(key, "%d/", parent);
+    for (int i = 0; name[i] && len < MAX_PATH_LEN + 15; i++) {
+        char c = name[i];
+        key[len++] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    key[len] = '\0';
+}
 
-    while (fgets(line, sizeof(line), file)) {
-        line_num++;
-        trim_whitespace(line);
+static int add_tree_entry(int parent, const char* name, const char* path, int is_directory, long size) {
+    if (ctx->tree_entry_count == ctx->tree_entry_capacity) {
+        ctx->tree_entry_capacity = ctx->tree_entry_capacity ? ctx->tree_entry_capacity * 2 : 1024;
+        ctx->tree_entries = (TreeEntry*)realloc(ctx->tree_entries, sizeof(TreeEntry) * ctx->tree_entry_capacity);
+    }
+    TreeEntry* entry = &ctx->tree_entries[ctx->tree_entry_count];
+    entry->parent = parent;
+    entry->name = _strdup(name);
+    entry->path = _strdup(path);
+    entry->is_directory = is_directory;
+    entry->size = size;
+    entry->blob[0] = '\0';
+    entry->mtime = 0;
+
+    if (parent >= 0) {
+        char key[MAX_PATH_LEN + 16];
+        make_tree_key(parent, name, key);
+        hash_index_put(&ctx->tree_index, key, ctx->tree_entry_count);
+    }
+    return ctx->tree_entry_count++;
+}
 
-        if (starts_with(line, "//") || starts_with(line, "/*")) continue;
+// Einträge werden in derselben Tiefensuche-Reihenfolge aufgenommen, in der scan_all_files
+// früher die Platte durchlaufen hat
+static void snapshot_directory(int directory_entry) {
+    char directory_path[MAX_PATH_LEN];
+    strcpy(directory_path, ctx->tree_entries[directory_entry].path);
 
-        // PRAGMA_PATH Erkennung
-        char pragma_path_value[MAX_PATH_LEN];
-        int pragma_has_backslash = 0;
-        if (match_pragma_path(line, pragma_path_value, &pragma_has_backslash)) {
-            if (analysis->pragma_path_count < MAX_PRAGMA_PATHS) {
-                PragmaPath* pp = &analysis->pragma_paths[analysis->pragma_path_count];
-                strcpy(pp->path, pragma_path_value);
-                strcpy(pp->source_file, filepath);
-                pp->line = line_num;
-                pp->has_backslash = pragma_has_backslash;
-                analysis->pragma_path_count++;
+#ifdef _WIN32
+    WIN32_FIND_DATA find_data;
+    char search_path[MAX_PATH_LEN];
+    sprintf(search_path, "%s\\*", directory_path);
 
-                if (global_pragma_path_count < MAX_PRAGMA_PATHS * MAX_FILES) {
-                    global_pragma_paths[global_pragma_path_count] = *pp;
-                    global_pragma_path_count++;
-                    printf("Found PRAGMA_PATH: \"%s\" in %s:%d%s\n",
-                           pragma_path_value, filename, line_num,
-                           pragma_has_backslash ? " [BACKSLASH]" : "");
-                }
-            }
-        }
+    HANDLE handle = FindFirstFile(search_path, &find_data);
+    if (handle == INVALID_HANDLE_VALUE) return;
 
-        // Include-Verarbeitung
-        IncludeElement include_elem;
-        memset(&include_elem, 0, sizeof(IncludeElement));
-        int include_result = match_include_enhanced(line, &include_elem);
+    do {
+        if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0) continue;
 
-        if (include_result == 1) {
-            include_elem.line = line_num;
+        // Zu lange Pfade überspringen statt abgeschnitten (also falsch) einzutragen
+        char full_path[MAX_PATH_LEN];
+        int length = snprintf(full_path, sizeof(full_path), "%s\\%s", directory_path, find_data.cFileName);
+        if (length < 0 || length >= (int)sizeof(full_path)) continue;
+        int is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        int entry = add_tree_entry(directory_entry, find_data.cFileName, full_path, is_directory,
+                                   (long)find_data.nFileSizeLow);
+        if (is_directory) snapshot_directory(entry);
+    } while (FindNextFile(handle, &find_data));
 
-            char found_dir[MAX_PATH_LEN];
-            char* include_path = find_include_file_enhanced(include_elem.name, current_dir, found_dir);
+    FindClose(handle);
+#else
+    DIR* dir = opendir(directory_path);
+    if (!dir) return;
 
-            if (include_path) {
-                strcpy(include_elem.resolved_path, include_path);
-                strcpy(include_elem.found_in_directory, found_dir);
+    struct dirent* dir_entry;
+    while ((dir_entry = readdir(dir)) != NULL) {
+        if (strcmp(dir_entry->d_name, ".") == 0 || strcmp(dir_entry->d_name, "..") == 0) continue;
 
-                char normalized_found[MAX_PATH_LEN];
-                strcpy(normalized_found, found_dir);
-                normalize_path_separators(normalized_found);
+        // Zu lange Pfade überspringen statt abgeschnitten (also falsch) einzutragen
+        char full_path[MAX_PATH_LEN];
+        int length = snprintf(full_path, sizeof(full_path), "%s/%s", directory_path, dir_entry->d_name);
+        if (length < 0 || length >= (int)sizeof(full_path)) continue;
+        struct stat info;
+        if (stat(full_path, &info) != 0) continue;
+        int is_directory = S_ISDIR(info.st_mode);
+        int entry = add_tree_entry(directory_entry, dir_entry->d_name, full_path, is_directory,
+                                   (long)info.st_size);
+        if (is_directory) snapshot_directory(entry);
+    }
+    closedir(dir);
+#endif
+}
 
-                char normalized_base[MAX_PATH_LEN];
-                strcpy(normalized_base, base_path);
-                normalize_path_separators(normalized_base);
+static void begin_tree_snapshot(const char* root) {
+    strcpy(ctx->snapshot_root, root);
+    normalize_path_separators(ctx->snapshot_root);
+    size_t len = strlen(ctx->snapshot_root);
+    while (len > 1 && ctx->snapshot_root[len - 1] == '/') ctx->snapshot_root[--len] = '\0';
 
-                char normalized_current[MAX_PATH_LEN];
-                strcpy(normalized_current, current_dir);
-                normalize_path_separators(normalized_current);
+    add_tree_entry(-1, "", root, 1, 0);
+}
 
-                if (strcmp(normalized_found, normalized_base) != 0 &&
-                    strcmp(normalized_found, normalized_current) != 0) {
-                    include_elem.found_via_pragma = 1;
-                }
+static void build_tree_snapshot(const char* root) {
+    begin_tree_snapshot(root);
+    snapshot_directory(0);
+}
 
-                add_directory_usage(found_dir);
-                analyze_file_with_includes(include_path, depth + 1);
-            } else {
-                printf("Warning: Include file not found: %s (in %s:%d)\n",
-                       include_elem.name, filename, line_num);
-                strcpy(include_elem.resolved_path, "NOT FOUND");
-                strcpy(include_elem.found_in_directory, "");
-            }
+static void free_tree_snapshot() {
+    for (int i = 0; i < ctx->tree_entry_count; i++) {
+        free(ctx->tree_entries[i].name);
+        free(ctx->tree_entries[i].path);
+    }
+    free(ctx->tree_entries);
+    ctx->tree_entries = NULL;
+    ctx->tree_entry_count = 0;
+    ctx->tree_entry_capacity = 0;
+    hash_index_free(&ctx->tree_index);
+}
 
-            if (analysis->include_count < MAX_ITEMS_PER_FILE) {
-                analysis->includes[analysis->include_count] = include_elem;
-                analysis->include_count++;
-            }
-        } else if (include_result == 2) {
-            printf("Skipping system include: <%s> in %s:%d\n", include_elem.name, filename, line_num);
-        }
+static int lookup_tree_entry(int parent, const char* name) {
+    char key[MAX_PATH_LEN + 16];
+    make_tree_key(parent, name, key);
+    return hash_index_find(&ctx->tree_index, key);
+}
 
-        // Funktionsblock-Tracking
-        char temp_name[MAX_NAME_LEN];
-        if (match_function_declaration(line, "void", temp_name) ||
-            match_function_declaration(line, "function", temp_name) ||
-            match_function_declaration(line, "action", temp_name)) {
-            strcpy(current_function, temp_name);
-            in_function = 1;
-            brace_level = 0;
-        }
+// Pfad (beliebige Trenner, ".", "..") im Snapshot suchen.
+// Rückgabe: Entry-Index, SNAPSHOT_NOT_FOUND oder SNAPSHOT_OUTSIDE (nicht unter base_path)
+static int snapshot_find_path(const char* path) {
+    if (ctx->tree_entry_count == 0) return SNAPSHOT_OUTSIDE;
 
-        for (int i = 0; line[i]; i++) {
-            if (line[i] == '{') brace_level++;
-            if (line[i] == '}') brace_level--;
-        }
+    char normalized[MAX_PATH_LEN];
+    strcpy(normalized, path);
+    normalize_path_separators(normalized);
 
-        if (in_function && brace_level <= 0 && strchr(line, '}')) {
-            in_function = 0;
-            current_function[0] = '\0';
+    size_t root_len = strlen(ctx->snapshot_root);
+    if (_strnicmp(normalized, ctx->snapshot_root, root_len) != 0 ||
+        (normalized[root_len] != '/' && normalized[root_len] != '\0')) {
+        return SNAPSHOT_OUTSIDE;
+    }
+
+    // Komponenten von Hand trennen - strtok hat globalen Zustand und ist nicht thread-sicher
+    int current = 0;
+    char* next = normalized + root_len;
+    while (*next) {
+        char* component = next;
+        char* slash = strchr(component, '/');
+        if (slash) {
+            *slash = '\0';
+            next = slash + 1;
+        } else {
+            next = component + strlen(component);
         }
+        if (!component[0] || strcmp(component, ".") == 0) {
+            // bleibt im selben Verzeichnis
+        } else if (strcmp(component, "..") == 0) {
+            if (current == 0) return SNAPSHOT_OUTSIDE;
+            current = ctx->tree_entries[current].parent;
+        } else {
+            if (!ctx->tree_entries[current].is_directory) return SNAPSHOT_NOT_FOUND;
+            current = lookup_tree_entry(current, component);
+            if (current < 0) return SNAPSHOT_NOT_FOUND;
+        }
+    }
+    return current;
+}
 
-        char name[MAX_NAME_LEN];
+// Kandidat für eine Include-Datei prüfen: im Projekt über den Snapshot, außerhalb auf der Platte.
+// found_path erhält den tatsächlichen Pfad (echte Schreibweise, native Trenner).
+static int probe_include_candidate(const char* candidate, char* found_path) {
+    int entry = snapshot_find_path(candidate);
+    if (entry >= 0) {
+        if (ctx->tree_entries[entry].is_directory) return 0;
+        strcpy(found_path, ctx->tree_entries[entry].path);
+        return 1;
+    }
+    if (entry == SNAPSHOT_OUTSIDE) {
+        char native_path[MAX_PATH_LEN];
+        strcpy(native_path, candidate);
+        to_native_separators(native_path);
+        if (path_exists(native_path)) {
+            strcpy(found_path, native_path);
+            return 1;
+        }
+    }
+    return 0;
+}
 
-        // Void functions
-        if (match_function_declaration(line, "void", name)) {
-            CodeElement* elem = &analysis->void_functions[analysis->void_function_count];
-            strcpy(elem->name, name);
-            elem->line = line_num;
-            strcpy(elem->type, "void");
+// Hash-Table Funktionen
+static int find_or_add_function_name(const char* name) {
+    for (int i = 0; i < ctx->function_name_count; i++) {
+        if (strcmp(ctx->function_names[i].name, name) == 0) {
+            ctx->function_names[i].count++;
+            return ctx->function_names[i].count;
+        }
+    }
+    if (ctx->function_name_count < MAX_FILES * 5) {
+        strcpy(ctx->function_names[ctx->function_name_count].name, name);
+        ctx->function_names[ctx->function_name_count].count = 1;
+        ctx->function_name_count++;
+        return 1;
+    }
+    return 1;
+}
 
-            int count = find_or_add_function_name(name);
-            if (count > 1) {
-                elem->is_duplicate = 1;
-                elem->duplicate_count = count;
-                analysis->function_overloads[analysis->overload_count] = *elem;
-                analysis->overload_count++;
-            }
-            analysis->void_function_count++;
+static int find_or_add_static_var(const char* name, const char* context) {
+    // Schlüssel muss in NameCounter.name passen; längere gelten als einmalig
+    char full_name[MAX_NAME_LEN];
+    int length = snprintf(full_name, sizeof(full_name), "%s::%s", context ? context : "global", name);
+    if (length < 0 || length >= (int)sizeof(full_name)) return 1;
+
+    for (int i = 0; i < ctx->static_var_name_count; i++) {
+        if (strcmp(ctx->static_var_names[i].name, full_name) == 0) {
+            ctx->static_var_names[i].count++;
+            return ctx->static_var_names[i].count;
         }
+    }
+    if (ctx->static_var_name_count < MAX_FILES * 5) {
+        strcpy(ctx->static_var_names[ctx->static_var_name_count].name, full_name);
+        ctx->static_var_names[ctx->static_var_name_count].count = 1;
+        ctx->static_var_name_count++;
+        return 1;
+    }
+    return 1;
+}
 
-        // Functions
-        if (match_function_declaration(line, "function", name)) {
-            CodeElement* elem = &analysis->functions[analysis->function_count];
-            strcpy(elem->name, name);
-            elem->line = line_num;
-            strcpy(elem->type, "function");
+// Zählerstand ohne Inkrement (für Auswertungen nach dem Parsen)
+static int get_static_var_count(const char* name, const char* context) {
+    char full_name[MAX_NAME_LEN];
+    int length = snprintf(full_name, sizeof(full_name), "%s::%s", context ? context : "global", name);
+    if (length < 0 || length >= (int)sizeof(full_name)) return 1;
 
-            int count = find_or_add_function_name(name);
-            if (count > 1) {
-                elem->is_duplicate = 1;
-                elem->duplicate_count = count;
-                analysis->function_overloads[analysis->overload_count] = *elem;
-                analysis->overload_count++;
-            }
-            analysis->function_count++;
+    for (int i = 0; i < ctx->static_var_name_count; i++) {
+        if (strcmp(ctx->static_var_names[i].name, full_name) == 0) {
+            return ctx->static_var_names[i].count;
         }
+    }
+    return 0;
+}
 
-        // Actions
-        if (match_function_declaration(line, "action", name)) {
-            CodeElement* elem = &analysis->actions[analysis->action_count];
-            strcpy(elem->name, name);
-            elem->line = line_num;
-            strcpy(elem->type, "action");
+// v1.4: Datei-Ingestion - Inhalt komplett lesen und hashen
+static char* read_file_from_disk(const char* filepath, long* size_out) {
+    FILE* file = fopen(filepath, "rb");
+    if (!file) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) size = 0;
+
+    char* content = (char*)malloc(size + 1);
+    if (!content) {
+        fclose(file);
+        return NULL;
+    }
+    size = (long)fread(content, 1, size, file);
+    content[size] = '\0';
+    fclose(file);
+
+    *size_out = size;
+    return content;
+}
+
+// FNV-1a 64 Bit - schnell, nicht kryptographisch
+static unsigned long long hash_content(const char* data, long size) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (long i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Liest wie fgets die nächste Zeile (max. max_len - 1 Zeichen) aus dem Puffer
+static int next_content_line(const char** cursor, const char* end, char* line, int max_len) {
+    const char* start = *cursor;
+    if (start >= end) return 0;
+
+    int len = 0;
+    while (start + len < end && len < max_len - 1) {
+        if (start[len++] == '\n') break;
+    }
+    memcpy(line, start, len);
+    line[len] = '\0';
+    *cursor = start + len;
+    return 1;
+}
+
+// v1.4: Verzeichnis-Snapshot aus dem Git-Index
+// Statt die Platte zu durchlaufen, werden die versionierten Dateien unter base_path aus
+// .git/index übernommen (Version 2 bis 4). Build-Ausgaben und andere nicht versionierte
+// Dateien fehlen dann im Snapshot. Blob-ID und Änderungszeit bleiben für den Parse-Cache erhalten.
+
+// Größe und Änderungszeit (Sekunden seit 1970) einer Datei
+static int get_file_stat(const char* path, long* size, long long* mtime) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(path, GetFileExInfoStandard, &data)) return 0;
+    ULARGE_INTEGER write_time;
+    write_time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+    write_time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+    *size = (long)data.nFileSizeLow;
+    *mtime = (long long)((write_time.QuadPart - 116444736000000000ULL) / 10000000ULL);
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) return 0;
+    *size = (long)info.st_size;
+    *mtime = (long long)info.st_mtime;
+#endif
+    return 1;
+}
+
+// Absoluter Pfad mit '/' als Trenner, "." und ".." aufgelöst (ohne Symlinks)
+static void make_absolute_path(const char* path, char* out) {
+    char combined[MAX_PATH_LEN * 2];
+    int is_absolute = path[0] == '/' || path[0] == '\\' || (path[0] && path[1] == ':');
+    if (is_absolute) {
+        snprintf(combined, sizeof(combined), "%s", path);
+    } else {
+        char cwd[MAX_PATH_LEN];
+        if (!_getcwd(cwd, sizeof(cwd))) cwd[0] = '\0';
+        snprintf(combined, sizeof(combined), "%s/%s", cwd, path);
+    }
+    normalize_path_separators(combined);
+
+    int rooted = combined[0] == '/';
+    size_t len = 0;
+    out[0] = '\0';
+    for (char* component = combined; *component; ) {
+        char* next = strchr(component, '/');
+        if (next) *next = '\0';
+        if (strcmp(component, "..") == 0) {
+            char* slash = strrchr(out, '/');
+            if (slash && (slash != out || rooted)) *slash = '\0';
+            len = strlen(out);
+        } else if (component[0] && strcmp(component, ".") != 0 &&
+                   len + strlen(component) + 2 < MAX_PATH_LEN) {
+            if (len || rooted) out[len++] = '/';
+            strcpy(out + len, component);
+            len += strlen(component);
+        }
+        if (!next) break;
+        component = next + 1;
+    }
+    if (!out[0] && rooted) strcpy(out, "/");
+}
+
+// Sucht ab directory aufwärts nach .git (Verzeichnis oder "gitdir:"-Datei eines Worktrees)
+static int find_git_directory(const char* directory, char* worktree, char* git_dir) {
+    char current[MAX_PATH_LEN];
+    strcpy(current, directory);
+    while (1) {
+        // Abgeschnittene Pfade würden auf ein fremdes Verzeichnis zeigen: dann lieber kein Repository
+        char candidate[MAX_PATH_LEN + 16];
+        int candidate_len = snprintf(candidate, sizeof(candidate), "%s/.git", strcmp(current, "/") == 0 ? "" : current);
+        if (candidate_len < 0 || candidate_len >= MAX_PATH_LEN) return 0;
+        char index_path[MAX_PATH_LEN + 32];
+        snprintf(index_path, sizeof(index_path), "%s/index", candidate);
+        if (path_exists(index_path)) {
+            strcpy(worktree, current);
+            strcpy(git_dir, candidate);
+            return 1;
+        }
+        if (path_exists(candidate)) {
+            // Worktree oder Submodul: ".git" ist eine Datei mit dem Pfad des Git-Verzeichnisses
+            char line[MAX_PATH_LEN];
+            FILE* file = fopen(candidate, "r");
+            int ok = file && fgets(line, sizeof(line), file) && starts_with(line, "gitdir: ");
+            if (file) fclose(file);
+            if (!ok) return 0;
+            char* target = line + 8;
+            target[strcspn(target, "\r\n")] = '\0';
+            char combined[MAX_PATH_LEN * 2];
+            int is_absolute = target[0] == '/' || target[0] == '\\' || (target[0] && target[1] == ':');
+            int combined_len = snprintf(combined, sizeof(combined), "%s%s%s", is_absolute ? "" : current,
+                                        is_absolute ? "" : "/", target);
+            if (combined_len < 0 || combined_len >= MAX_PATH_LEN) return 0;
+            make_absolute_path(combined, git_dir);
+            strcpy(worktree, current);
+            return 1;
+        }
+        char* slash = strrchr(current, '/');
+        if (!slash || strcmp(current, "/") == 0) return 0;
+        if (slash == current) slash[1] = '\0';
+        else *slash = '\0';
+    }
+}
+
+static unsigned int read_be32(const unsigned char* p) {
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+// Wie lookup_tree_entry, aber mit exakter Schreibweise: der Index kann "Game/" und "game/"
+// nebeneinander enthalten (Linux), der Snapshot-Schlüssel faltet beide zusammen
+static int lookup_tree_entry_exact(int parent, const char* name) {
+    int entry = lookup_tree_entry(parent, name);
+    if (entry < 0 || strcmp(ctx->tree_entries[entry].name, name) == 0) return entry;
+    for (int i = ctx->tree_entry_count - 1; i > 0; i--) {
+        if (ctx->tree_entries[i].parent == parent && strcmp(ctx->tree_entries[i].name, name) == 0) return i;
+    }
+    return -1;
+}
 
-            int count = find_or_add_function_name(name);
-            if (count > 1) {
-                elem->is_duplicate = 1;
-                elem->duplicate_count = count;
-                analysis->function_overloads[analysis->overload_count] = *elem;
-                analysis->overload_count++;
+// Datei (Pfad relativ zu base_path, '/' als Trenner) mit fehlenden Verzeichnissen eintragen
+static void add_git_index_file(const char* relative, const unsigned char* sha, long size, long long mtime) {
+    int parent = 0;
+    const char* component = relative;
+    while (1) {
+        const char* slash = strchr(component, '/');
+        char name[MAX_PATH_LEN];
+        size_t len = slash ? (size_t)(slash - component) : strlen(component);
+        if (len == 0 || len >= MAX_PATH_LEN) return;
+        memcpy(name, component, len);
+        name[len] = '\0';
+
+        int entry = lookup_tree_entry_exact(parent, name);
+        if (entry < 0) {
+            char path[MAX_PATH_LEN];
+            if (snprintf(path, sizeof(path), "%s" PATH_SEP "%s", ctx->tree_entries[parent].path, name) >= (int)sizeof(path)) return;
+            entry = add_tree_entry(parent, name, path, slash != NULL, slash ? 0 : size);
+            if (!slash) {
+                for (int i = 0; i < 20; i++) sprintf(ctx->tree_entries[entry].blob + i * 2, "%02x", sha[i]);
+                ctx->tree_entries[entry].mtime = mtime;
             }
-            analysis->action_count++;
         }
+        if (!slash) return;
+        if (!ctx->tree_entries[entry].is_directory) return;
+        parent = entry;
+        component = slash + 1;
+    }
+}
 
-        // Structs
-        if (match_struct(line, name)) {
-            CodeElement* elem = &analysis->structs[analysis->struct_count];
-            strcpy(elem->name, name);
-            elem->line = line_num;
-            strcpy(elem->type, "struct");
-            analysis->struct_count++;
+// Rückgabe: Anzahl übernommener Dateien oder -1 (kein Repository, unbekanntes Format)
+static int build_tree_from_git_index(const char* root) {
+    char absolute[MAX_PATH_LEN], worktree[MAX_PATH_LEN], git_dir[MAX_PATH_LEN];
+    make_absolute_path(root, absolute);
+    if (!find_git_directory(absolute, worktree, git_dir)) return -1;
+
+    char index_path[MAX_PATH_LEN + 8];
+    snprintf(index_path, sizeof(index_path), "%s/index", git_dir);
+    long size = 0;
+    unsigned char* data = (unsigned char*)read_file_from_disk(index_path, &size);
+    if (!data) return -1;
+    unsigned int version = size >= 12 ? read_be32(data + 4) : 0;
+    if (size < 12 || memcmp(data, "DIRC", 4) != 0 || version < 2 || version > 4) {
+        free(data);
+        return -1;
+    }
+    unsigned int count = read_be32(data + 8);
+
+    // Präfix von root im Worktree ("" oder "sub/dir/")
+    char prefix[MAX_PATH_LEN];
+    const char* rest = absolute + strlen(worktree);
+    if (*rest == '/') rest++;
+    snprintf(prefix, sizeof(prefix), "%s%s", rest, *rest ? "/" : "");
+    size_t prefix_len = strlen(prefix);
+
+    begin_tree_snapshot(root);
+    char name[MAX_PATH_LEN * 2] = "";
+    long offset = 12;
+    int files = 0, ok = 1;
+    for (unsigned int i = 0; i < count && ok; i++) {
+        if (offset + 62 > size) {
+            ok = 0;
+            break;
+        }
+        const unsigned char* entry = data + offset;
+        long long mtime = read_be32(entry + 8);
+        unsigned int mode = read_be32(entry + 24);
+        long file_size = (long)read_be32(entry + 36);
+        const unsigned char* sha = entry + 40;
+        unsigned int flags = ((unsigned int)entry[60] << 8) | entry[61];
+        long name_offset = offset + 62;
+        int skip_worktree = 0;
+        if (version >= 3 && (flags & 0x4000)) {
+            if (name_offset + 2 > size) {
+                ok = 0;
+                break;
+            }
+            skip_worktree = (data[name_offset] & 0x40) != 0;
+            name_offset += 2;
         }
 
-        // Typedef structs
-        int typedef_result = match_typedef_struct(line, name);
-        if (typedef_result > 0) {
-            int found = 0;
-            for (int k = 0; k < analysis->typedef_struct_count; k++) {
-                if (strcmp(analysis->typedef_structs[k].name, name) == 0) {
-                    found = 1;
+        size_t kept = 0;
+        if (version == 4) {
+            // Präfix-Kompression: Anzahl Zeichen, die vom vorigen Namen wegfallen, dann der Rest
+            unsigned long strip = 0;
+            unsigned char c;
+            do {
+                if (name_offset >= size) {
+                    ok = 0;
                     break;
                 }
+                c = data[name_offset++];
+                strip = (strip << 7) | (c & 127);
+                if (c & 128) strip++;
+            } while (c & 128);
+            kept = strlen(name);
+            if (!ok || strip > kept) {
+                ok = 0;
+                break;
             }
-            if (!found && analysis->typedef_struct_count < MAX_ITEMS_PER_FILE) {
-                CodeElement* elem = &analysis->typedef_structs[analysis->typedef_struct_count];
-                strcpy(elem->name, name);
-                elem->line = line_num;
-                strcpy(elem->type, "typedef_struct");
-                analysis->typedef_struct_count++;
+            kept -= strip;
+        }
+        const char* suffix = (const char*)data + name_offset;
+        const char* suffix_end = memchr(suffix, '\0', size - name_offset);
+        if (!suffix_end || kept + (suffix_end - suffix) >= sizeof(name)) {
+            ok = 0;
+            break;
+        }
+        memcpy(name + kept, suffix, suffix_end - suffix + 1);
+        if (version == 4) {
+            offset = (long)(suffix_end - (const char*)data) + 1;
+        } else {
+            // Einträge sind mit 1 bis 8 Nullbytes auf ein Vielfaches von 8 aufgefüllt
+            offset += ((name_offset - offset) + (suffix_end - suffix) + 8) & ~7L;
+        }
+
+        // Nur reguläre Dateien und Symlinks, bei Konflikten die eigene Seite (Stufe 2)
+        int stage = (flags >> 12) & 3;
+        unsigned int type = mode & 0170000;
+        if (skip_worktree || (stage != 0 && stage != 2) || (type != 0100000 && type != 0120000)) continue;
+        if (strncmp(name, prefix, prefix_len) != 0) continue;
+        add_git_index_file(name + prefix_len, sha, file_size, mtime);
+        files++;
+    }
+    free(data);
+
+    if (!ok) {
+        free_tree_snapshot();
+        return -1;
+    }
+    return files;
+}
+
+// v1.4: Verlauf - Snapshot und Dateiinhalte eines Commits direkt aus den Git-Objekten
+// Statt eines Checkouts liefert "git ls-tree" die Dateien mit Blob-ID und Größe und
+// "git cat-file --batch" die Inhalte. Blobs bleiben im Speicher, solange sie im Baum des
+// aktuellen Commits vorkommen; pro Commit werden nur neue Blobs nachgeladen.
+
+// Revisionen und Bereiche nur mit harmlosen Zeichen an die Shell geben
+static int is_safe_revision(const char* revision) {
+    if (!revision[0] || revision[0] == '-') return 0;
+    for (const char* p = revision; *p; p++) {
+        int safe = (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') ||
+                   strchr("._-/~^@{}", *p) != NULL;
+        if (!safe) return 0;
+    }
+    return 1;
+}
+
+static int parse_hex_sha(const char* hex, unsigned char* sha) {
+    if (strlen(hex) != 40) return 0;           // SHA-256-Repositories passen nicht in TreeEntry.blob
+    for (int i = 0; i < 20; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) return 0;
+        sha[i] = (unsigned char)byte;
+    }
+    return 1;
+}
+
+// Rückgabe: Anzahl Dateien oder -1 (kein Repository, unbekannter Commit)
+static int build_tree_from_git_commit(const char* root, const char* commit) {
+    char command[MAX_PATH_LEN + MAX_NAME_LEN + 96];
+    snprintf(command, sizeof(command), "git -C \"%s\" -c core.quotepath=off ls-tree -r -l %s", root, commit);
+    FILE* pipe = _popen(command, "r");
+    if (!pipe) return -1;
+
+    begin_tree_snapshot(root);
+    char line[MAX_PATH_LEN + 128];
+    int files = 0;
+    while (fgets(line, sizeof(line), pipe)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        // "<modus> <typ> <blob> <größe>\t<pfad relativ zu root>"
+        unsigned int mode = 0;
+        char type[16], hex[72];
+        long size = 0;
+        int offset = 0;
+        if (sscanf(line, "%o %15s %71s %ld%n", &mode, type, hex, &size, &offset) != 4 || line[offset] != '\t') continue;
+        // Nur reguläre Dateien (keine Symlinks und Submodule), Pfade mit Sonderzeichen kommen in Anführungszeichen
+        if (strcmp(type, "blob") != 0 || (mode & 0170000) != 0100000 || line[offset + 1] == '"') continue;
+        unsigned char sha[20];
+        if (!parse_hex_sha(hex, sha)) continue;
+        add_git_index_file(line + offset + 1, sha, size, 0);
+        files++;
+    }
+    if (_pclose(pipe) != 0) {
+        free_tree_snapshot();
+        return -1;
+    }
+    return files;
+}
+
+static void add_history_blob(const char* id, char* data, long size) {
+    if (ctx->history_blob_count == ctx->history_blob_capacity) {
+        ctx->history_blob_capacity = ctx->history_blob_capacity ? ctx->history_blob_capacity * 2 : 256;
+        ctx->history_blobs = (HistoryBlob*)realloc(ctx->history_blobs, sizeof(HistoryBlob) * ctx->history_blob_capacity);
+    }
+    ctx->history_blobs[ctx->history_blob_count].data = data;
+    ctx->history_blobs[ctx->history_blob_count].size = size;
+    hash_index_put(&ctx->history_blob_index, id, ctx->history_blob_count++);
+}
+
+static void free_history_blobs() {
+    for (int b = 0; b < ctx->history_blob_count; b++) free(ctx->history_blobs[b].data);
+    free(ctx->history_blobs);
+    ctx->history_blobs = NULL;
+    ctx->history_blob_count = 0;
+    ctx->history_blob_capacity = 0;
+    hash_index_free(&ctx->history_blob_index);
+}
+
+// Nur die Blobs behalten, die im Snapshot des aktuellen Commits vorkommen
+static void prune_history_blobs() {
+    HashIndex old_index = ctx->history_blob_index;
+    HistoryBlob* old_blobs = ctx->history_blobs;
+    int old_count = ctx->history_blob_count;
+    memset(&ctx->history_blob_index, 0, sizeof(HashIndex));
+    ctx->history_blobs = NULL;
+    ctx->history_blob_count = 0;
+    ctx->history_blob_capacity = 0;
+    for (int e = 0; e < ctx->tree_entry_count; e++) {
+        const TreeEntry* entry = &ctx->tree_entries[e];
+        if (entry->is_directory || !entry->blob[0]) continue;
+        int old = hash_index_find(&old_index, entry->blob);
+        if (old < 0 || !old_blobs[old].data) continue;
+        add_history_blob(entry->blob, old_blobs[old].data, old_blobs[old].size);
+        old_blobs[old].data = NULL;
+    }
+    for (int b = 0; b < old_count; b++) free(old_blobs[b].data);
+    free(old_blobs);
+    hash_index_free(&old_index);
+}
+
+static char* read_pipe_content(FILE* pipe, long size) {
+    char* data = (char*)malloc(size + 1);
+    if (!data) return NULL;
+    if ((long)fread(data, 1, size, pipe) != size) {
+        free(data);
+        return NULL;
+    }
+    data[size] = '\0';
+    return data;
+}
+
+static int is_source_entry(int entry);
+
+// Alle noch fehlenden .c/.h-Blobs des Snapshots mit einem einzigen "git cat-file --batch" laden
+static void fetch_history_blobs() {
+    prune_history_blobs();
+    TextBuffer wanted;
+    memset(&wanted, 0, sizeof(TextBuffer));
+    HashIndex requested;
+    memset(&requested, 0, sizeof(HashIndex));
+    for (int e = 0; e < ctx->tree_entry_count; e++) {
+        const char* id = ctx->tree_entries[e].blob;
+        if (!is_source_entry(e) || !id[0]) continue;
+        if (hash_index_find(&ctx->history_blob_index, id) >= 0 || hash_index_find(&requested, id) >= 0) continue;
+        hash_index_put(&requested, id, 1);
+        buffer_append(&wanted, "%s\n", id);
+    }
+    hash_index_free(&requested);
+    if (wanted.length == 0) {
+        buffer_free(&wanted);
+        return;
+    }
+
+    // Blob-Liste als Datei, weil _popen nur in eine Richtung liest
+    char list_path[MAX_PATH_LEN];
+    const char* temp_dir = getenv("TMPDIR");
+    if (!temp_dir) temp_dir = getenv("TEMP");
+    if (!temp_dir) temp_dir = DEFAULT_TEMP_DIR;
+    snprintf(list_path, sizeof(list_path), "%s" PATH_SEP "analyzer_blobs_%d_%p.txt", temp_dir, (int)_getpid(), (void*)ctx);
+    FILE* list = fopen(list_path, "wb");
+    if (list) {
+        fwrite(wanted.data, 1, wanted.length, list);
+        fclose(list);
+    }
+    buffer_free(&wanted);
+    if (!list) {
+        analyzer_log("Warning: Could not write %s - reading blobs one by one\n", list_path);
+        return;
+    }
+
+    char command[MAX_PATH_LEN * 2 + 64];
+    snprintf(command, sizeof(command), "git -C \"%s\" cat-file --batch < \"%s\"", ctx->base_path, list_path);
+    FILE* pipe = _popen(command, POPEN_READ_BINARY);
+    if (pipe) {
+        // Je Blob "<id> blob <größe>\n<inhalt>\n", unbekannte Objekte nur "<id> missing\n"
+        char header[160];
+        while (fgets(header, sizeof(header), pipe)) {
+            char id[72], type[16];
+            long size = 0;
+            if (sscanf(header, "%71s %15s %ld", id, type, &size) != 3) continue;
+            char* data = read_pipe_content(pipe, size);
+            if (!data) break;
+            fgetc(pipe);
+            if (strcmp(type, "blob") == 0 && hash_index_find(&ctx->history_blob_index, id) < 0) add_history_blob(id, data, size);
+            else free(data);
+        }
+        _pclose(pipe);
+    }
+    remove(list_path);
+}
+
+// Datei des aktuellen Commits lesen; Dateien außerhalb des Projekts kommen von der Platte
+static char* read_history_file(const char* filepath, long* size_out) {
+    int entry = snapshot_find_path(filepath);
+    if (entry == SNAPSHOT_OUTSIDE) return read_file_from_disk(filepath, size_out);
+    if (entry < 0 || ctx->tree_entries[entry].is_directory || !ctx->tree_entries[entry].blob[0]) return NULL;
+
+    const char* id = ctx->tree_entries[entry].blob;
+    int blob = hash_index_find(&ctx->history_blob_index, id);
+    if (blob < 0) {
+        // Nicht vorab geladen (Include mit anderer Endung als .c/.h)
+        char command[MAX_PATH_LEN + 96];
+        snprintf(command, sizeof(command), "git -C \"%s\" cat-file blob %s", ctx->base_path, id);
+        FILE* pipe = _popen(command, POPEN_READ_BINARY);
+        if (!pipe) return NULL;
+        char* data = read_pipe_content(pipe, ctx->tree_entries[entry].size);
+        _pclose(pipe);
+        if (!data) return NULL;
+        add_history_blob(id, data, ctx->tree_entries[entry].size);
+        blob = ctx->history_blob_count - 1;
+    }
+
+    const HistoryBlob* source = &ctx->history_blobs[blob];
+    char* content = (char*)malloc(source->size + 1);
+    if (!content) return NULL;
+    memcpy(content, source->data, source->size + 1);
+    *size_out = source->size;
+    return content;
+}
+
+// v1.4: Read-Ahead
+// Sobald ein Include aufgelöst ist (bzw. der Snapshot die nächsten Dateien kennt), wird die
+// Datei im Hintergrund gelesen, damit der Parser beim Folgen des Includes nicht blockiert.
+// Backends: io_uring (Linux, direkte Syscalls), sonst ein kleiner Thread-Pool.
+// Der Puffer-Pool ist begrenzt; ist er voll, wird einfach synchron gelesen.
+
+static char* read_file_from_disk(const char* filepath, long* size_out);
+static int reusable_parse_cache_entry(const char* filepath);
+
+#ifdef ANALYZER_HAVE_IO_URING
+
+static int uring_setup() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(&ctx->uring, 0, sizeof(ctx->uring));
+
+    ctx->uring.ring_fd = (int)syscall(__NR_io_uring_setup, PREFETCH_SLOTS * 2, &params);
+    if (ctx->uring.ring_fd < 0) return 0;
+
+    ctx->uring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ctx->uring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ctx->uring.cq_ring_size > ctx->uring.sq_ring_size) ctx->uring.sq_ring_size = ctx->uring.cq_ring_size;
+        ctx->uring.cq_ring_size = ctx->uring.sq_ring_size;
+    }
+
+    ctx->uring.sq_ring = mmap(NULL, ctx->uring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ctx->uring.ring_fd, IORING_OFF_SQ_RING);
+    if (ctx->uring.sq_ring == MAP_FAILED) {
+        close(ctx->uring.ring_fd);
+        return 0;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ctx->uring.cq_ring = ctx->uring.sq_ring;
+    } else {
+        ctx->uring.cq_ring = mmap(NULL, ctx->uring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ctx->uring.ring_fd, IORING_OFF_CQ_RING);
+        if (ctx->uring.cq_ring == MAP_FAILED) {
+            munmap(ctx->uring.sq_ring, ctx->uring.sq_ring_size);
+            close(ctx->uring.ring_fd);
+            return 0;
+        }
+    }
+    ctx->uring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ctx->uring.sqes = (struct io_uring_sqe*)mmap(NULL, ctx->uring.sqes_size, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, ctx->uring.ring_fd, IORING_OFF_SQES);
+    if (ctx->uring.sqes == MAP_FAILED) {
+        if (ctx->uring.cq_ring != ctx->uring.sq_ring) munmap(ctx->uring.cq_ring, ctx->uring.cq_ring_size);
+        munmap(ctx->uring.sq_ring, ctx->uring.sq_ring_size);
+        close(ctx->uring.ring_fd);
+        return 0;
+    }
+
+    char* sq = (char*)ctx->uring.sq_ring;
+    char* cq = (char*)ctx->uring.cq_ring;
+    ctx->uring.sq_head = (unsigned*)(sq + params.sq_off.head);
+    ctx->uring.sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ctx->uring.sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ctx->uring.sq_array = (unsigned*)(sq + params.sq_off.array);
+    ctx->uring.cq_head = (unsigned*)(cq + params.cq_off.head);
+    ctx->uring.cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ctx->uring.cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ctx->uring.cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 1;
+}
+
+static void uring_teardown() {
+    munmap(ctx->uring.sqes, ctx->uring.sqes_size);
+    if (ctx->uring.cq_ring != ctx->uring.sq_ring) munmap(ctx->uring.cq_ring, ctx->uring.cq_ring_size);
+    munmap(ctx->uring.sq_ring, ctx->uring.sq_ring_size);
+    close(ctx->uring.ring_fd);
+}
+
+// Jeder Slot hat höchstens eine Anforderung im Ring - der Ring ist doppelt so groß wie der Pool
+static void uring_submit(int slot_index) {
+    PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+    unsigned tail = *ctx->uring.sq_tail;
+    unsigned index = tail & *ctx->uring.sq_mask;
+    struct io_uring_sqe* sqe = &ctx->uring.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+
+    if (slot->state == PREFETCH_OPENING) {
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (unsigned long)slot->path;
+        sqe->open_flags = O_RDONLY;
+    } else {
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = slot->fd;
+        sqe->addr = (unsigned long)(slot->data + slot->done);
+        sqe->len = (unsigned)(slot->size - slot->done);
+        sqe->off = (unsigned long long)slot->done;
+    }
+    sqe->user_data = (unsigned long long)slot_index;
+    ctx->uring.sq_array[index] = index;
+    __atomic_store_n(ctx->uring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (syscall(__NR_io_uring_enter, ctx->uring.ring_fd, 1, 0, 0, NULL, 0) < 0) {
+        // Nicht angenommen: Slot fällt auf synchrones Lesen zurück
+        __atomic_store_n(ctx->uring.sq_tail, tail, __ATOMIC_RELEASE);
+        if (slot->fd >= 0) close(slot->fd);
+        slot->fd = -1;
+        slot->state = PREFETCH_FAILED;
+        return;
+    }
+    ctx->uring.in_flight++;
+}
+
+static void uring_complete(int slot_index, int result) {
+    PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+    ctx->uring.in_flight--;
+
+    if (result < 0) {
+        if (slot->fd >= 0) close(slot->fd);
+        slot->fd = -1;
+        slot->state = PREFETCH_FAILED;
+        return;
+    }
+
+    if (slot->state == PREFETCH_OPENING) {
+        slot->fd = result;
+        slot->state = PREFETCH_READING;
+    } else {
+        if (result == 0) slot->size = slot->done;    // Datei ist seit dem Snapshot geschrumpft
+        slot->done += result;
+    }
+
+    if (slot->done < slot->size) {
+        uring_submit(slot_index);
+        return;
+    }
+    close(slot->fd);
+    slot->fd = -1;
+    slot->data[slot->size] = '\0';
+    slot->state = PREFETCH_DONE;
+}
+
+// Fertige Completions abholen; wait = 1 blockiert bis mindestens eine vorliegt
+static void uring_reap(int wait) {
+    if (wait && ctx->uring.in_flight > 0) {
+        syscall(__NR_io_uring_enter, ctx->uring.ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+    unsigned head = *ctx->uring.cq_head;
+    while (head != __atomic_load_n(ctx->uring.cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe* cqe = &ctx->uring.cqes[head & *ctx->uring.cq_mask];
+        int slot_index = (int)cqe->user_data;
+        int result = cqe->res;
+        head++;
+        __atomic_store_n(ctx->uring.cq_head, head, __ATOMIC_RELEASE);
+        uring_complete(slot_index, result);
+    }
+}
+#endif
+
+// Thread-Pool Fallback: Worker lesen die Dateien blockierend
+#ifdef _WIN32
+#define prefetch_lock() EnterCriticalSection(&ctx->prefetch_mutex)
+#define prefetch_unlock() LeaveCriticalSection(&ctx->prefetch_mutex)
+#define prefetch_wait() SleepConditionVariableCS(&ctx->prefetch_cond, &ctx->prefetch_mutex, INFINITE)
+#define prefetch_broadcast() WakeAllConditionVariable(&ctx->prefetch_cond)
+#else
+#define prefetch_lock() pthread_mutex_lock(&ctx->prefetch_mutex)
+#define prefetch_unlock() pthread_mutex_unlock(&ctx->prefetch_mutex)
+#define prefetch_wait() pthread_cond_wait(&ctx->prefetch_cond, &ctx->prefetch_mutex)
+#define prefetch_broadcast() pthread_cond_broadcast(&ctx->prefetch_cond)
+#endif
+
+// Ältester wartender Slot (nur unter prefetch_lock aufrufen)
+static int next_queued_slot() {
+    int best = -1;
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (ctx->prefetch_slots[i].state != PREFETCH_QUEUED) continue;
+        if (best < 0 || ctx->prefetch_slots[i].sequence < ctx->prefetch_slots[best].sequence) best = i;
+    }
+    return best;
+}
+
+static void prefetch_worker_loop() {
+    prefetch_lock();
+    while (!ctx->prefetch_stopping) {
+        int slot_index = next_queued_slot();
+        if (slot_index < 0) {
+            prefetch_wait();
+            continue;
+        }
+        PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+        slot->state = PREFETCH_READING;
+        char path[MAX_PATH_LEN];
+        strcpy(path, slot->path);
+        prefetch_unlock();
+
+        long size = 0;
+        char* data = read_file_from_disk(path, &size);
+
+        prefetch_lock();
+        ctx->prefetch_bytes += size - slot->size;
+        slot->data = data;
+        slot->size = size;
+        slot->state = data ? PREFETCH_DONE : PREFETCH_FAILED;
+        prefetch_broadcast();
+    }
+    prefetch_unlock();
+}
+
+// Der Worker übernimmt den Kontext des startenden Threads
+#ifdef _WIN32
+static DWORD WINAPI prefetch_worker(LPVOID context) {
+    ctx = (AnalysisContext*)context;
+    prefetch_worker_loop();
+    return 0;
+}
+#else
+static void* prefetch_worker(void* context) {
+    ctx = (AnalysisContext*)context;
+    prefetch_worker_loop();
+    return NULL;
+}
+#endif
+
+static void destroy_prefetch_lock() {
+#ifdef _WIN32
+    DeleteCriticalSection(&ctx->prefetch_mutex);
+#else
+    pthread_mutex_destroy(&ctx->prefetch_mutex);
+    pthread_cond_destroy(&ctx->prefetch_cond);
+#endif
+}
+
+static int start_prefetch_threads() {
+#ifdef _WIN32
+    InitializeCriticalSection(&ctx->prefetch_mutex);
+    InitializeConditionVariable(&ctx->prefetch_cond);
+#else
+    pthread_mutex_init(&ctx->prefetch_mutex, NULL);
+    pthread_cond_init(&ctx->prefetch_cond, NULL);
+#endif
+    ctx->prefetch_stopping = 0;
+    for (int i = 0; i < PREFETCH_THREADS; i++) {
+#ifdef _WIN32
+        ctx->prefetch_threads[i] = CreateThread(NULL, 0, prefetch_worker, ctx, 0, NULL);
+        if (!ctx->prefetch_threads[i]) break;
+#else
+        if (pthread_create(&ctx->prefetch_threads[i], NULL, prefetch_worker, ctx) != 0) break;
+#endif
+        ctx->prefetch_thread_count++;
+    }
+    if (ctx->prefetch_thread_count == 0) destroy_prefetch_lock();
+    return ctx->prefetch_thread_count > 0;
+}
+
+static void stop_prefetch_threads() {
+    prefetch_lock();
+    ctx->prefetch_stopping = 1;
+    prefetch_broadcast();
+    prefetch_unlock();
+    for (int i = 0; i < ctx->prefetch_thread_count; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(ctx->prefetch_threads[i], INFINITE);
+        CloseHandle(ctx->prefetch_threads[i]);
+#else
+        pthread_join(ctx->prefetch_threads[i], NULL);
+#endif
+    }
+    ctx->prefetch_thread_count = 0;
+    destroy_prefetch_lock();
+}
+
+static void init_readahead() {
+    memset(ctx->prefetch_slots, 0, sizeof(ctx->prefetch_slots));
+    ctx->readahead_backend = READAHEAD_OFF;
+    if (!ctx->readahead_enabled) return;
+#ifdef ANALYZER_HAVE_IO_URING
+    if (uring_setup()) {
+        ctx->readahead_backend = READAHEAD_URING;
+        analyzer_log("Read-ahead: io_uring (%d buffers)\n", PREFETCH_SLOTS);
+        return;
+    }
+#endif
+    if (start_prefetch_threads()) {
+        ctx->readahead_backend = READAHEAD_THREADS;
+        analyzer_log("Read-ahead: thread pool (%d threads, %d buffers)\n", ctx->prefetch_thread_count, PREFETCH_SLOTS);
+    }
+}
+
+static void shutdown_readahead() {
+    if (ctx->readahead_backend == READAHEAD_OFF) return;
+#ifdef ANALYZER_HAVE_IO_URING
+    if (ctx->readahead_backend == READAHEAD_URING) {
+        while (ctx->uring.in_flight > 0) uring_reap(1);
+        uring_teardown();
+    }
+#endif
+    if (ctx->readahead_backend == READAHEAD_THREADS) stop_prefetch_threads();
+
+    // Nie abgeholte Puffer (falsch vorhergesagte Includes) freigeben
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        free(ctx->prefetch_slots[i].data);
+        ctx->prefetch_slots[i].data = NULL;
+        ctx->prefetch_slots[i].state = PREFETCH_FREE;
+    }
+    ctx->prefetch_bytes = 0;
+    ctx->readahead_backend = READAHEAD_OFF;
+}
+
+static int find_prefetch_slot(const char* filepath) {
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (ctx->prefetch_slots[i].state != PREFETCH_FREE && strcmp(ctx->prefetch_slots[i].path, filepath) == 0) return i;
+    }
+    return -1;
+}
+
+static void release_prefetch_slot(PrefetchSlot* slot) {
+    ctx->prefetch_bytes -= slot->size;
+    slot->data = NULL;
+    slot->size = 0;
+    slot->state = PREFETCH_FREE;
+}
+
+static int find_file_index(const char* filepath);
+
+// Freien Slot suchen; fertige Puffer für bereits analysierte Dateien werden nie mehr abgeholt
+// und dürfen wiederverwendet werden (nur unter prefetch_lock bzw. im io_uring-Betrieb)
+static int acquire_prefetch_slot() {
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (ctx->prefetch_slots[i].state == PREFETCH_FREE) return i;
+    }
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        PrefetchSlot* slot = &ctx->prefetch_slots[i];
+        if ((slot->state == PREFETCH_DONE || slot->state == PREFETCH_FAILED) && find_file_index(slot->path) >= 0) {
+            free(slot->data);
+            release_prefetch_slot(slot);
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Lesen einer Datei im Hintergrund anstoßen (Größe aus dem Verzeichnis-Snapshot);
+// bereits analysierte Dateien werden nie mehr gelesen
+static void prefetch_file(const char* filepath) {
+    if (ctx->readahead_backend == READAHEAD_OFF || find_file_index(filepath) >= 0) return;
+    if (reusable_parse_cache_entry(filepath) >= 0) return;
+
+    int entry = snapshot_find_path(filepath);
+    if (entry < 0 || ctx->tree_entries[entry].is_directory) return;
+    long size = ctx->tree_entries[entry].size;
+
+#ifdef ANALYZER_HAVE_IO_URING
+    if (ctx->readahead_backend == READAHEAD_URING) uring_reap(0);
+#endif
+    if (ctx->readahead_backend == READAHEAD_THREADS) prefetch_lock();
+
+    int slot_index = -1;
+    if (find_prefetch_slot(filepath) < 0 && ctx->prefetch_bytes + size <= PREFETCH_MAX_BYTES) {
+        slot_index = acquire_prefetch_slot();
+    }
+    if (slot_index >= 0) {
+        PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+        strcpy(slot->path, filepath);
+        slot->size = size;
+        slot->done = 0;
+        slot->fd = -1;
+        slot->sequence = ctx->prefetch_sequence++;
+        ctx->prefetch_bytes += size;
+        ctx->prefetch_requests++;
+
+        if (ctx->readahead_backend == READAHEAD_THREADS) {
+            slot->data = NULL;
+            slot->state = PREFETCH_QUEUED;
+            prefetch_broadcast();
+        }
+#ifdef ANALYZER_HAVE_IO_URING
+        if (ctx->readahead_backend == READAHEAD_URING) {
+            slot->data = (char*)malloc(size + 1);
+            if (!slot->data) {
+                release_prefetch_slot(slot);
+            } else {
+                slot->state = PREFETCH_OPENING;
+                uring_submit(slot_index);
             }
         }
+#endif
+    }
 
-        // Static variables
-        if (match_static_var(line, name)) {
-            CodeElement* elem = &analysis->static_vars[analysis->static_var_count];
-            strcpy(elem->name, name);
-            elem->line = line_num;
-            strcpy(elem->type, "static");
-            if (in_function) {
-                strcpy(elem->function_context, current_function);
+    if (ctx->readahead_backend == READAHEAD_THREADS) prefetch_unlock();
+}
+
+// Vorab gelesenen Inhalt übernehmen (wartet, falls das Lesen noch läuft) oder NULL
+static char* take_prefetched(const char* filepath, long* size_out) {
+    if (ctx->readahead_backend == READAHEAD_OFF) return NULL;
+
+    char* data = NULL;
+    if (ctx->readahead_backend == READAHEAD_THREADS) {
+        prefetch_lock();
+        int slot_index = find_prefetch_slot(filepath);
+        if (slot_index >= 0) {
+            PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+            while (slot->state == PREFETCH_QUEUED || slot->state == PREFETCH_READING) prefetch_wait();
+            data = slot->data;
+            *size_out = slot->size;
+            release_prefetch_slot(slot);
+        }
+        prefetch_unlock();
+    }
+#ifdef ANALYZER_HAVE_IO_URING
+    if (ctx->readahead_backend == READAHEAD_URING) {
+        int slot_index = find_prefetch_slot(filepath);
+        if (slot_index >= 0) {
+            PrefetchSlot* slot = &ctx->prefetch_slots[slot_index];
+            while (slot->state == PREFETCH_OPENING || slot->state == PREFETCH_READING) uring_reap(1);
+            if (slot->state == PREFETCH_DONE) {
+                data = slot->data;
+                *size_out = slot->size;
+            } else {
+                free(slot->data);
             }
+            release_prefetch_slot(slot);
+        }
+    }
+#endif
+    if (data) ctx->prefetch_hits++;
+    return data;
+}
+
+// Include-Zeilen einer frisch gelesenen Datei vorab auflösen und deren Inhalt anfordern.
+// Die Auflösung kennt nur die bisher gefundenen PRAGMA_PATHs - ein Fehltreffer kostet nur
+// einen Puffer, das eigentliche Parsen löst jedes Include erneut auf.
+static void prefetch_includes(const char* content, long size, const char* current_dir) {
+    if (ctx->readahead_backend == READAHEAD_OFF) return;
+
+    const char* cursor = content;
+    const char* end = content + size;
+    char line[MAX_LINE_LEN];
+    while (next_content_line(&cursor, end, line, MAX_LINE_LEN)) {
+        trim_whitespace(line);
+        if (starts_with(line, "//") || starts_with(line, "/*") || !strstr(line, "#include")) continue;
+        IncludeElement include_elem;
+        memset(&include_elem, 0, sizeof(IncludeElement));
+        if (match_include_enhanced(line, &include_elem) != 1) continue;
+
+        char found_dir[MAX_PATH_LEN];
+        char* include_path = find_include_file_enhanced(include_elem.name, current_dir, found_dir);
+        if (include_path) prefetch_file(include_path);
+    }
+}
+
+// Inhalt aus dem Read-Ahead übernehmen, sonst synchron lesen
+static char* read_file_content(const char* filepath, long* size_out) {
+    if (ctx->history_commit[0]) return read_history_file(filepath, size_out);
+    char* content = take_prefetched(filepath, size_out);
+    if (content) return content;
+    return read_file_from_disk(filepath, size_out);
+}
+
+static int find_content_original(unsigned long long hash, long size) {
+    char key[48];
+    sprintf(key, "%016llx:%ld", hash, size);
+    int original = hash_index_find(&ctx->content_index, key);
+    if (original >= 0 && !ctx->files[original].parse_complete) return -1;
+    return original;
+}
+
+static void register_content(unsigned long long hash, long size, int file_index) {
+    char key[48];
+    sprintf(key, "%016llx:%ld", hash, size);
+    if (hash_index_find(&ctx->content_index, key) < 0) {
+        hash_index_put(&ctx->content_index, key, file_index);
+    }
+}
+
+static void add_global_pragma_path(const PragmaPath* pp, const char* filename) {
+    if (ctx->global_pragma_path_count < MAX_PRAGMA_PATHS * MAX_FILES) {
+        if (ctx->global_pragma_path_count == ctx->global_pragma_path_capacity) {
+            int capacity = ctx->global_pragma_path_capacity ? ctx->global_pragma_path_capacity * 2 : 64;
+            PragmaPath* grown = (PragmaPath*)realloc(ctx->global_pragma_paths, sizeof(PragmaPath) * capacity);
+            if (!grown) return;
+            ctx->global_pragma_paths = grown;
+            ctx->global_pragma_path_capacity = capacity;
+        }
+        ctx->global_pragma_paths[ctx->global_pragma_path_count] = *pp;
+        ctx->global_pragma_path_count++;
+        analyzer_log("Found PRAGMA_PATH: \"%s\" in %s:%d%s\n",
+                     pp->path, filename, pp->line,
+                     pp->has_backslash ? " [BACKSLASH]" : "");
+    }
+}
+
+static int analyze_file_with_includes(const char* filepath, int depth);
+
+// Include relativ zu current_dir auflösen und der Datei folgen
+static void resolve_and_follow_include(IncludeElement* include_elem, const char* current_dir,
+                                const char* filename, int depth) {
+    char found_dir[MAX_PATH_LEN];
+    char* include_path = find_include_file_enhanced(include_elem->name, current_dir, found_dir);
+
+    include_elem->target_index = -1;
+    include_elem->found_via_pragma = 0;
+
+    if (include_path) {
+        strcpy(include_elem->resolved_path, include_path);
+        strcpy(include_elem->found_in_directory, found_dir);
+
+        char normalized_found[MAX_PATH_LEN];
+        strcpy(normalized_found, found_dir);
+        normalize_path_separators(normalized_found);
+
+        char normalized_base[MAX_PATH_LEN];
+        strcpy(normalized_base, ctx->base_path);
+        normalize_path_separators(normalized_base);
+
+        char normalized_current[MAX_PATH_LEN];
+        strcpy(normalized_current, current_dir);
+        normalize_path_separators(normalized_current);
+
+        if (strcmp(normalized_found, normalized_base) != 0 &&
+            strcmp(normalized_found, normalized_current) != 0) {
+            include_elem->found_via_pragma = 1;
+        }
+
+        add_directory_usage(found_dir);
+        include_elem->target_index = analyze_file_with_includes(include_path, depth + 1);
+    } else {
+        analyzer_log("Warning: Include file not found: %s (in %s:%d)\n",
+                     include_elem->name, filename, include_elem->line);
+        strcpy(include_elem->resolved_path, "NOT FOUND");
+        strcpy(include_elem->found_in_directory, "");
+    }
+}
+
+// Funktions-/Action-Namen zählen, Überladungen merken
+static void register_function_element(FileAnalysis* analysis, CodeElement* elem) {
+    int count = find_or_add_function_name(elem->name);
+    if (count > 1) {
+        elem->is_duplicate = 1;
+        elem->duplicate_count = count;
+        if (analysis->overload_count < MAX_ITEMS_PER_FILE) {
+            analysis->function_overloads[analysis->overload_count] = *elem;
+            analysis->overload_count++;
+        }
+    }
+}
+
+static void register_static_element(FileAnalysis* analysis, CodeElement* elem) {
+    int count = find_or_add_static_var(elem->name, elem->function_context[0] ? elem->function_context : NULL);
+    if (count > 1) {
+        elem->is_duplicate = 1;
+        elem->duplicate_count = count;
+        if (analysis->static_duplicate_count < MAX_ITEMS_PER_FILE) {
+            analysis->static_duplicates[analysis->static_duplicate_count] = *elem;
+            analysis->static_duplicate_count++;
+        }
+    }
+}
+
+// v1.4: Makro-Tabelle - jede #define mit Datei und Zeile. Definitionen werden schon beim Parsen
+// registriert, damit eine Verwendung wie beim Compiler auf die bis dahin gültige Definition
+// zeigt (eine Kompilierung, Dateien in Include-Reihenfolge).
+
+static int add_macro_definition(int file_index, const char* name, int body_id, int has_parameters, int line) {
+    if (ctx->macro_def_count == ctx->macro_def_capacity) {
+        ctx->macro_def_capacity = ctx->macro_def_capacity ? ctx->macro_def_capacity * 2 : 256;
+        ctx->macro_defs = (MacroDefinition*)realloc(ctx->macro_defs, sizeof(MacroDefinition) * ctx->macro_def_capacity);
+    }
+    ctx->macro_defs[ctx->macro_def_count].name_id = intern_string(name);
+    ctx->macro_defs[ctx->macro_def_count].body_id = body_id;
+    ctx->macro_defs[ctx->macro_def_count].has_parameters = has_parameters;
+    ctx->macro_defs[ctx->macro_def_count].file_index = file_index;
+    ctx->macro_defs[ctx->macro_def_count].line = line;
+    hash_index_put(&ctx->macro_index, name, ctx->macro_def_count);
+    return ctx->macro_def_count++;
+}
+
+static void add_macro_element(FileAnalysis* analysis, const char* name, const char* body, int has_parameters, int line,
+                       int definition) {
+    if (analysis->macro_count >= MAX_ITEMS_PER_FILE) return;
+    MacroElement* elem = &analysis->macros[analysis->macro_count++];
+    strcpy(elem->name, name);
+    strncpy(elem->body, body, MAX_NAME_LEN - 1);
+    elem->body[MAX_NAME_LEN - 1] = '\0';
+    elem->has_parameters = has_parameters;
+    elem->line = line;
+    elem->definition = definition;
+}
+
+typedef struct {
+    MacroUse* uses;
+    int count;
+    int capacity;
+} MacroUseCollector;
+
+static void add_macro_use(MacroUseCollector* collector, int definition, int line, int count) {
+    for (int i = collector->count - 1; i >= 0; i--) {
+        if (collector->uses[i].definition == definition) {
+            collector->uses[i].count += count;
+            return;
+        }
+    }
+    if (collector->count == collector->capacity) {
+        collector->capacity = collector->capacity ? collector->capacity * 2 : 32;
+        collector->uses = (MacroUse*)realloc(collector->uses, sizeof(MacroUse) * collector->capacity);
+    }
+    MacroUse* use = &collector->uses[collector->count++];
+    use->file_index = -1;
+    use->definition = definition;
+    use->line = line;
+    use->count = count;
+}
+
+// Bezeichner einer Zeile gegen die bisher definierten Makros auflösen
+static void collect_macro_uses(MacroUseCollector* collector, const char* text, int line) {
+    if (ctx->macro_def_count == 0) return;
+    char name[MAX_NAME_LEN];
+    int is_member;
+    const char* p = text;
+    while ((p = next_identifier(text, p, name, &is_member)) != NULL) {
+        if (is_member) continue;
+        int definition = hash_index_find(&ctx->macro_index, name);
+        if (definition >= 0) add_macro_use(collector, definition, line, 1);
+    }
+}
+
+static void store_macro_uses(int file_index, const MacroUseCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->macro_use_first = ctx->macro_use_count;
+    for (int i = 0; i < collector->count; i++) {
+        if (ctx->macro_use_count == ctx->macro_use_capacity) {
+            ctx->macro_use_capacity = ctx->macro_use_capacity ? ctx->macro_use_capacity * 2 : 1024;
+            ctx->macro_uses = (MacroUse*)realloc(ctx->macro_uses, sizeof(MacroUse) * ctx->macro_use_capacity);
+        }
+        ctx->macro_uses[ctx->macro_use_count] = collector->uses[i];
+        ctx->macro_uses[ctx->macro_use_count].file_index = file_index;
+        ctx->macro_use_count++;
+    }
+    analysis->macro_use_total = ctx->macro_use_count - analysis->macro_use_first;
+}
+
+// Identischer Inhalt: Verwendungen des Originals über den Namen neu auflösen
+// (die Kopie sieht die zu ihrem Zeitpunkt gültigen Definitionen)
+static void copy_macro_uses(int target, int source) {
+    MacroUseCollector collector;
+    memset(&collector, 0, sizeof(MacroUseCollector));
+    const FileAnalysis* original = &ctx->files[source];
+    for (int i = 0; i < original->macro_use_total; i++) {
+        const MacroUse* use = &ctx->macro_uses[original->macro_use_first + i];
+        int definition = hash_index_find(&ctx->macro_index, interned_string(ctx->macro_defs[use->definition].name_id));
+        add_macro_use(&collector, definition >= 0 ? definition : use->definition, use->line, use->count);
+    }
+    store_macro_uses(target, &collector);
+    free(collector.uses);
+}
+
+// Wiederverwendung eines identischen Inhalts: Code-Elemente kopieren, dann in Zeilenreihenfolge
+// PRAGMA_PATHs registrieren, Includes vom eigenen Verzeichnis aus auflösen und Namen zählen -
+// genau in der Reihenfolge, in der das Parsen es tun würde.
+enum { REPLAY_PRAGMA, REPLAY_INCLUDE, REPLAY_VOID, REPLAY_FUNCTION, REPLAY_ACTION, REPLAY_STATIC, REPLAY_MACRO };
+
+typedef struct {
+    int line;
+    int kind;
+    int index;
+} ReplayEvent;
+
+static int compare_replay_events(const void* a, const void* b) {
+    const ReplayEvent* x = (const ReplayEvent*)a;
+    const ReplayEvent* y = (const ReplayEvent*)b;
+    if (x->line != y->line) return x->line - y->line;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    return x->index - y->index;
+}
+
+static void add_replay_events(ReplayEvent* events, int* count, int kind, const CodeElement* elems, int elem_count) {
+    for (int i = 0; i < elem_count; i++) {
+        events[*count].line = elems[i].line;
+        events[*count].kind = kind;
+        events[*count].index = i;
+        (*count)++;
+    }
+}
+
+// Elemente liegen bereits in target; macro_body_ids: interner Body je Makro-Element
+static void replay_file_events(int target, const char* current_dir, int depth, const int* macro_body_ids) {
+    FileAnalysis* analysis = &ctx->files[target];
+    int event_capacity = analysis->pragma_path_count + analysis->include_count +
+                         analysis->void_function_count + analysis->function_count +
+                         analysis->action_count + analysis->static_var_count + analysis->macro_count;
+    ReplayEvent* events = (ReplayEvent*)malloc(sizeof(ReplayEvent) * (event_capacity + 1));
+    int event_count = 0;
+    for (int i = 0; i < analysis->pragma_path_count; i++) {
+        events[event_count].line = analysis->pragma_paths[i].line;
+        events[event_count].kind = REPLAY_PRAGMA;
+        events[event_count].index = i;
+        event_count++;
+    }
+    for (int i = 0; i < analysis->include_count; i++) {
+        events[event_count].line = analysis->includes[i].line;
+        events[event_count].kind = REPLAY_INCLUDE;
+        events[event_count].index = i;
+        event_count++;
+    }
+    add_replay_events(events, &event_count, REPLAY_VOID, analysis->void_functions, analysis->void_function_count);
+    add_replay_events(events, &event_count, REPLAY_FUNCTION, analysis->functions, analysis->function_count);
+    add_replay_events(events, &event_count, REPLAY_ACTION, analysis->actions, analysis->action_count);
+    add_replay_events(events, &event_count, REPLAY_STATIC, analysis->static_vars, analysis->static_var_count);
+    for (int i = 0; i < analysis->macro_count; i++) {
+        events[event_count].line = analysis->macros[i].line;
+        events[event_count].kind = REPLAY_MACRO;
+        events[event_count].index = i;
+        event_count++;
+    }
+    qsort(events, event_count, sizeof(ReplayEvent), compare_replay_events);
+
+    for (int e = 0; e < event_count; e++) {
+        int i = events[e].index;
+        switch (events[e].kind) {
+        case REPLAY_PRAGMA:
+            strcpy(analysis->pragma_paths[i].source_file, analysis->filepath);
+            add_global_pragma_path(&analysis->pragma_paths[i], analysis->filename);
+            break;
+        case REPLAY_INCLUDE:
+            resolve_and_follow_include(&analysis->includes[i], current_dir, analysis->filename, depth);
+            break;
+        case REPLAY_VOID:
+            analysis->void_functions[i].is_duplicate = 0;
+            register_function_element(analysis, &analysis->void_functions[i]);
+            break;
+        case REPLAY_FUNCTION:
+            analysis->functions[i].is_duplicate = 0;
+            register_function_element(analysis, &analysis->functions[i]);
+            break;
+        case REPLAY_ACTION:
+            analysis->actions[i].is_duplicate = 0;
+            register_function_element(analysis, &analysis->actions[i]);
+            break;
+        case REPLAY_STATIC:
+            analysis->static_vars[i].is_duplicate = 0;
+            register_static_element(analysis, &analysis->static_vars[i]);
+            break;
+        case REPLAY_MACRO:
+            analysis->macros[i].definition =
+                add_macro_definition(target, analysis->macros[i].name, macro_body_ids[i], analysis->macros[i].has_parameters,
+                                     analysis->macros[i].line);
+            break;
+        }
+    }
+    free(events);
+}
+
+static void replay_file_analysis(int target, int source, const char* current_dir, int depth) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const FileAnalysis* original = &ctx->files[source];
+
+    *analysis->elements = *original->elements;
+    analysis->pragma_path_count = original->pragma_path_count;
+    analysis->include_count = original->include_count;
+    analysis->void_function_count = original->void_function_count;
+    analysis->function_count = original->function_count;
+    analysis->action_count = original->action_count;
+    analysis->struct_count = original->struct_count;
+    analysis->typedef_struct_count = original->typedef_struct_count;
+    analysis->static_var_count = original->static_var_count;
+    analysis->macro_count = original->macro_count;
+    analysis->line_count = original->line_count;
+
+    int macro_body_ids[MAX_ITEMS_PER_FILE];
+    for (int i = 0; i < analysis->macro_count; i++) {
+        macro_body_ids[i] = ctx->macro_defs[original->macros[i].definition].body_id;
+    }
+    replay_file_events(target, current_dir, depth, macro_body_ids);
+}
+
+// v1.4: Element-Tabellen anlegen / freigeben
+static int allocate_file_elements(FileAnalysis* analysis) {
+    FileElementStorage* storage = (FileElementStorage*)calloc(1, sizeof(FileElementStorage));
+    if (!storage) return 0;
+
+    analysis->elements = storage;
+    analysis->includes = storage->includes;
+    analysis->void_functions = storage->void_functions;
+    analysis->functions = storage->functions;
+    analysis->actions = storage->actions;
+    analysis->structs = storage->structs;
+    analysis->typedef_structs = storage->typedef_structs;
+    analysis->static_vars = storage->static_vars;
+    analysis->function_overloads = storage->function_overloads;
+    analysis->static_duplicates = storage->static_duplicates;
+    analysis->macros = storage->macros;
+    analysis->pragma_paths = storage->pragma_paths;
+    return 1;
+}
+
+static void release_file_elements(FileAnalysis* analysis) {
+    free(analysis->elements);
+    analysis->elements = NULL;
+    analysis->includes = NULL;
+    analysis->void_functions = NULL;
+    analysis->functions = NULL;
+    analysis->actions = NULL;
+    analysis->structs = NULL;
+    analysis->typedef_structs = NULL;
+    analysis->static_vars = NULL;
+    analysis->function_overloads = NULL;
+    analysis->static_duplicates = NULL;
+    analysis->macros = NULL;
+    analysis->pragma_paths = NULL;
+}
+
+// Skelett aus den Element-Tabellen ableiten - alles, was nach dem Parsen noch gebraucht wird
+static void build_file_skeleton(FileAnalysis* analysis) {
+    analysis->include_targets = (int*)malloc(sizeof(int) * (analysis->include_count + 1));
+    analysis->include_lines = (int*)malloc(sizeof(int) * (analysis->include_count + 1));
+    analysis->include_usage = (unsigned char*)malloc(analysis->include_count + 1);
+    analysis->backslash_include_count = 0;
+    analysis->pragma_include_count = 0;
+    for (int j = 0; j < analysis->include_count; j++) {
+        analysis->include_targets[j] = analysis->includes[j].target_index;
+        analysis->include_lines[j] = analysis->includes[j].line;
+        analysis->include_usage[j] = (unsigned char)analysis->includes[j].usage;
+        if (analysis->includes[j].has_backslash) analysis->backslash_include_count++;
+        if (analysis->includes[j].found_via_pragma) analysis->pragma_include_count++;
+    }
+
+    analysis->pragma_backslash_count = 0;
+    for (int j = 0; j < analysis->pragma_path_count; j++) {
+        if (analysis->pragma_paths[j].has_backslash) analysis->pragma_backslash_count++;
+    }
+
+    analysis->global_static_ids = (int*)malloc(sizeof(int) * (analysis->static_var_count + 1));
+    analysis->global_static_count = 0;
+    for (int j = 0; j < analysis->static_var_count; j++) {
+        if (analysis->static_vars[j].function_context[0] != '\0') continue;
+        analysis->global_static_ids[analysis->global_static_count++] = intern_string(analysis->static_vars[j].name);
+    }
+
+    analysis->type_name_ids = (int*)malloc(sizeof(int) * (analysis->struct_count + analysis->typedef_struct_count + 1));
+    analysis->type_name_count = 0;
+    for (int j = 0; j < analysis->struct_count; j++) {
+        analysis->type_name_ids[analysis->type_name_count++] = intern_string(analysis->structs[j].name);
+    }
+    for (int j = 0; j < analysis->typedef_struct_count; j++) {
+        analysis->type_name_ids[analysis->type_name_count++] = intern_string(analysis->typedef_structs[j].name);
+    }
+
+    analysis->macro_name_ids = (int*)malloc(sizeof(int) * (analysis->macro_count + 1));
+    for (int j = 0; j < analysis->macro_count; j++) {
+        analysis->macro_name_ids[j] = intern_string(analysis->macros[j].name);
+    }
+}
+
+// v1.4: Symbol-Tabelle - alle Funktions-/Action-Definitionen mit Datei und Zeile
+enum { SYMBOL_VOID, SYMBOL_FUNCTION, SYMBOL_ACTION };
+
+static void add_symbol(int name_id, int kind, int file_index, const CodeElement* elem) {
+    if (ctx->symbol_count == ctx->symbol_capacity) {
+        ctx->symbol_capacity = ctx->symbol_capacity ? ctx->symbol_capacity * 2 : 1024;
+        ctx->symbols = (SymbolDefinition*)realloc(ctx->symbols, sizeof(SymbolDefinition) * ctx->symbol_capacity);
+    }
+    ctx->symbols[ctx->symbol_count].name_id = name_id;
+    ctx->symbols[ctx->symbol_count].kind = kind;
+    ctx->symbols[ctx->symbol_count].file_index = file_index;
+    ctx->symbols[ctx->symbol_count].line = elem->line;
+    ctx->symbols[ctx->symbol_count].is_prototype = elem->is_prototype;
+    ctx->symbol_count++;
+}
+
+static void register_file_symbols(int file_index) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->first_symbol = ctx->symbol_count;
+    for (int j = 0; j < analysis->void_function_count; j++) {
+        add_symbol(intern_string(analysis->void_functions[j].name), SYMBOL_VOID, file_index,
+                   &analysis->void_functions[j]);
+    }
+    for (int j = 0; j < analysis->function_count; j++) {
+        add_symbol(intern_string(analysis->functions[j].name), SYMBOL_FUNCTION, file_index,
+                   &analysis->functions[j]);
+    }
+    for (int j = 0; j < analysis->action_count; j++) {
+        add_symbol(intern_string(analysis->actions[j].name), SYMBOL_ACTION, file_index,
+                   &analysis->actions[j]);
+    }
+    analysis->symbol_total = ctx->symbol_count - analysis->first_symbol;
+}
+// v1.4: Referenzen aus Funktionsrümpfen (Aufrufe und Funktionszeiger wie ent_create(..., player_action))
+// Jeder Bezeichner eines Rumpfs wird pro Funktion einmal gemerkt; aufgelöst wird erst, wenn alle
+// Definitionen bekannt sind (build_call_graph).
+
+// Sammelt die Referenzen einer Datei während des Parsens
+typedef struct {
+    CallReference* refs;
+    int count;
+    int capacity;
+    int caller_line;
+    int serial;
+} CallCollector;
+
+static void begin_function_body(CallCollector* collector, int line) {
+    collector->caller_line = line;
+    collector->serial = ++ctx->reference_serial;
+}
+
+static void add_body_reference(CallCollector* collector, const char* name, int line) {
+    int name_id = intern_string(name);
+    if (name_id >= ctx->reference_mark_capacity) {
+        int capacity = ctx->reference_mark_capacity ? ctx->reference_mark_capacity : 1024;
+        while (capacity <= name_id) capacity *= 2;
+        ctx->reference_mark_serial = (int*)realloc(ctx->reference_mark_serial, sizeof(int) * capacity);
+        ctx->reference_mark_slot = (int*)realloc(ctx->reference_mark_slot, sizeof(int) * capacity);
+        memset(ctx->reference_mark_serial + ctx->reference_mark_capacity, 0,
+               sizeof(int) * (capacity - ctx->reference_mark_capacity));
+        ctx->reference_mark_capacity = capacity;
+    }
+
+    if (ctx->reference_mark_serial[name_id] == collector->serial) {
+        collector->refs[ctx->reference_mark_slot[name_id]].count++;
+        return;
+    }
+
+    if (collector->count == collector->capacity) {
+        collector->capacity = collector->capacity ? collector->capacity * 2 : 64;
+        collector->refs = (CallReference*)realloc(collector->refs, sizeof(CallReference) * collector->capacity);
+    }
+    ctx->reference_mark_serial[name_id] = collector->serial;
+    ctx->reference_mark_slot[name_id] = collector->count;
+    CallReference* ref = &collector->refs[collector->count++];
+    ref->caller = collector->caller_line;
+    ref->name_id = name_id;
+    ref->line = line;
+    ref->count = 1;
+}
+
+// Bezeichner einer Rumpfzeile sammeln; Member-Zugriffe (my.skill1, ptr->x) zählen nicht
+static void collect_body_references(CallCollector* collector, const char* text, int line) {
+    char name[MAX_NAME_LEN];
+    int is_member;
+    const char* p = text;
+    while ((p = next_identifier(text, p, name, &is_member)) != NULL) {
+        if (!is_member) add_body_reference(collector, name, line);
+    }
+}
+
+// Referenzen einer fertig geparsten Datei übernehmen: Definitionszeile -> Symbol-Index
+static void store_call_references(int file_index, const CallCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->call_ref_first = ctx->call_ref_count;
+
+    int cached_line = -1, cached_symbol = -1;
+    for (int i = 0; i < collector->count; i++) {
+        const CallReference* ref = &collector->refs[i];
+        if (ref->caller != cached_line) {
+            cached_line = ref->caller;
+            cached_symbol = -1;
+            for (int s = analysis->first_symbol; s < analysis->first_symbol + analysis->symbol_total; s++) {
+                if (ctx->symbols[s].line == cached_line && !ctx->symbols[s].is_prototype) {
+                    cached_symbol = s;
+                    break;
+                }
+            }
+        }
+        if (cached_symbol < 0) continue;
+
+        if (ctx->call_ref_count == ctx->call_ref_capacity) {
+            ctx->call_ref_capacity = ctx->call_ref_capacity ? ctx->call_ref_capacity * 2 : 4096;
+            ctx->call_refs = (CallReference*)realloc(ctx->call_refs, sizeof(CallReference) * ctx->call_ref_capacity);
+        }
+        ctx->call_refs[ctx->call_ref_count] = *ref;
+        ctx->call_refs[ctx->call_ref_count].caller = cached_symbol;
+        ctx->call_ref_count++;
+    }
+    analysis->call_ref_total = ctx->call_ref_count - analysis->call_ref_first;
+}
+
+// Identischer Inhalt: Referenzen des Originals auf die Symbole der Kopie umschreiben
+static void copy_call_references(int target, int source) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const FileAnalysis* original = &ctx->files[source];
+    analysis->call_ref_first = ctx->call_ref_count;
+    for (int i = 0; i < original->call_ref_total; i++) {
+        if (ctx->call_ref_count == ctx->call_ref_capacity) {
+            ctx->call_ref_capacity = ctx->call_ref_capacity ? ctx->call_ref_capacity * 2 : 4096;
+            ctx->call_refs = (CallReference*)realloc(ctx->call_refs, sizeof(CallReference) * ctx->call_ref_capacity);
+        }
+        ctx->call_refs[ctx->call_ref_count] = ctx->call_refs[original->call_ref_first + i];
+        ctx->call_refs[ctx->call_ref_count].caller += analysis->first_symbol - original->first_symbol;
+        ctx->call_ref_count++;
+    }
+    analysis->call_ref_total = ctx->call_ref_count - analysis->call_ref_first;
+}
+
+static void get_relative_file_path(const char* full_path, char* out);
+static void collect_file_declarations(int file_index);
+static void write_file_section(FILE* file, FileAnalysis* analysis);
+
+// v1.4: Ungenutzte Includes
+// Pro Header wird einmal ein Aho-Corasick-Automat über alle Symbole aufgebaut, die der Header
+// und seine transitiven Includes deklarieren (Funktionen, Actions, Structs, Typedefs, globale
+// Statics, Makros). Ein Durchlauf über den Text des Includers genügt dann pro Include-Zeile.
+// Werden nur Makros gefunden, ist das Include "nur für Makros" da (Kandidat für Split-Header).
+#define AUTOMATON_NODE_BUDGET 1000000
+enum { INCLUDE_USAGE_UNKNOWN, INCLUDE_USAGE_USED, INCLUDE_USAGE_UNUSED, INCLUDE_USAGE_MACRO_ONLY, INCLUDE_USAGE_POINTER_ONLY };
+
+static int automaton_add_node(SymbolAutomaton* automaton, char c) {
+    if (automaton->node_count == automaton->node_capacity) {
+        automaton->node_capacity = automaton->node_capacity ? automaton->node_capacity * 2 : 256;
+        automaton->nodes = (AutomatonNode*)realloc(automaton->nodes, sizeof(AutomatonNode) * automaton->node_capacity);
+    }
+    AutomatonNode* node = &automaton->nodes[automaton->node_count];
+    node->first_child = -1;
+    node->next_sibling = -1;
+    node->fail = 0;
+    node->output = -1;
+    node->length = 0;
+    node->is_macro = 0;
+    node->is_type = 0;
+    node->c = c;
+    return automaton->node_count++;
+}
+
+static int automaton_child(const SymbolAutomaton* automaton, int node, char c) {
+    for (int k = automaton->nodes[node].first_child; k >= 0; k = automaton->nodes[k].next_sibling) {
+        if (automaton->nodes[k].c == c) return k;
+    }
+    return -1;
+}
+
+static void automaton_add_pattern(SymbolAutomaton* automaton, const char* pattern, int is_macro, int is_type) {
+    int node = 0;
+    for (const char* p = pattern; *p; p++) {
+        int child = automaton_child(automaton, node, *p);
+        if (child < 0) {
+            child = automaton_add_node(automaton, *p);
+            automaton->nodes[child].next_sibling = automaton->nodes[node].first_child;
+            automaton->nodes[node].first_child = child;
+        }
+        node = child;
+    }
+    if (node == 0) return;
+    if (automaton->nodes[node].length == 0) {
+        automaton->nodes[node].length = (int)strlen(pattern);
+        automaton->nodes[node].is_macro = (char)is_macro;
+        automaton->nodes[node].is_type = (char)is_type;
+        automaton->pattern_count++;
+        if (is_type) automaton->type_pattern_count++;
+    } else {
+        if (!is_macro) automaton->nodes[node].is_macro = 0;
+        if (!is_type) automaton->nodes[node].is_type = 0;
+    }
+}
+
+// Fail- und Output-Links per Breitensuche
+static void automaton_build_links(SymbolAutomaton* automaton) {
+    int* queue = (int*)malloc(sizeof(int) * (automaton->node_count + 1));
+    int head = 0, tail = 0;
+    for (int k = automaton->nodes[0].first_child; k >= 0; k = automaton->nodes[k].next_sibling) {
+        queue[tail++] = k;
+    }
+    while (head < tail) {
+        int node = queue[head++];
+        for (int k = automaton->nodes[node].first_child; k >= 0; k = automaton->nodes[k].next_sibling) {
+            char c = automaton->nodes[k].c;
+            int fail = automaton->nodes[node].fail;
+            while (fail != 0 && automaton_child(automaton, fail, c) < 0) fail = automaton->nodes[fail].fail;
+            int target = automaton_child(automaton, fail, c);
+            if (target < 0) target = 0;
+            automaton->nodes[k].fail = target;
+            automaton->nodes[k].output = automaton->nodes[target].length ? target : automaton->nodes[target].output;
+            queue[tail++] = k;
+        }
+    }
+    free(queue);
+}
+
+static void free_automaton(SymbolAutomaton* automaton) {
+    free(automaton->nodes);
+    free(automaton);
+}
+
+// Fortschritt eines Durchlaufs über den Text (automaton_next_word)
+typedef struct {
+    long position;
+    int node;
+    int line_start;
+} AutomatonScan;
+
+// Nächstes Muster als ganzes Wort ab scan->position: Knoten des Musters oder -1 am Textende.
+// Das Wort endet bei scan->position - 1. #include-Zeilen, Kommentare und String-Literale zählen nicht.
+static int automaton_next_word(const SymbolAutomaton* automaton, const char* text, long size, AutomatonScan* scan) {
+    int node = scan->node;
+    int line_start = scan->line_start;
+    for (long i = scan->position; i < size; i++) {
+        if (line_start) {
+            line_start = 0;
+            long k = i;
+            while (k < size && (text[k] == ' ' || text[k] == '\t')) k++;
+            if (size - k >= 8 && strncmp(text + k, "#include", 8) == 0) {
+                while (i < size && text[i] != '\n') i++;
+                node = 0;
+                line_start = 1;
+                continue;
+            }
+            // "#define NAME": eine eigene Definition ist keine Verwendung, nur der Body zählt
+            if (size - k >= 8 && strncmp(text + k, "#define", 7) == 0 && (text[k + 7] == ' ' || text[k + 7] == '\t')) {
+                k += 7;
+                while (k < size && (text[k] == ' ' || text[k] == '\t')) k++;
+                while (k < size && is_identifier_char(text[k])) k++;
+                i = k - 1;
+                node = 0;
+                continue;
+            }
+        }
+        char c = text[i];
+        if (c == '\n') line_start = 1;
+
+        if (c == '/' && i + 1 < size && text[i + 1] == '/') {
+            while (i + 1 < size && text[i + 1] != '\n') i++;
+            node = 0;
+            continue;
+        }
+        if (c == '/' && i + 1 < size && text[i + 1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(text[i] == '*' && text[i + 1] == '/')) i++;
+            i++;
+            node = 0;
+            continue;
+        }
+        if (c == '"') {
+            i++;
+            while (i < size && text[i] != '"' && text[i] != '\n') {
+                if (text[i] == '\\') i++;
+                i++;
+            }
+            node = 0;
+            continue;
+        }
+
+        int child;
+        while ((child = automaton_child(automaton, node, c)) < 0 && node != 0) node = automaton->nodes[node].fail;
+        node = child >= 0 ? child : 0;
+
+        // Muster sind Bezeichner: höchstens eines endet hier als ganzes Wort
+        int match = automaton->nodes[node].length ? node : automaton->nodes[node].output;
+        for (; match >= 0; match = automaton->nodes[match].output) {
+            long start = i - automaton->nodes[match].length + 1;
+            if ((start == 0 || !is_identifier_char(text[start - 1])) &&
+                (i + 1 >= size || !is_identifier_char(text[i + 1]))) {
+                scan->position = i + 1;
+                scan->node = node;
+                scan->line_start = line_start;
+                return match;
+            }
+        }
+    }
+    scan->position = size;
+    return -1;
+}
+
+// Kommt irgendein Muster als ganzes Wort im Text vor? 2: ein Symbol, 1: nur Makros, 0: nichts.
+static int automaton_finds_word(const SymbolAutomaton* automaton, const char* text, long size) {
+    AutomatonScan scan = { 0, 0, 1 };
+    int found_macro = 0;
+    int match;
+    while ((match = automaton_next_word(automaton, text, size, &scan)) >= 0) {
+        if (!automaton->nodes[match].is_macro) return 2;
+        found_macro = 1;
+    }
+    return found_macro;
+}
+
+// Automat für einen Header samt transitiver Includes; NULL, solange ein Teil davon noch
+// geparst wird (Zyklus) - dann bleibt das Include ungeprüft
+static SymbolAutomaton* get_header_automaton(int header) {
+    if (ctx->header_automata[header]) return ctx->header_automata[header];
+
+    int* stack = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int* reached = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int stack_size = 0, reached_count = 0;
+    ctx->closure_visit_serial++;
+    ctx->closure_visit_stamp[header] = ctx->closure_visit_serial;
+    stack[stack_size++] = header;
+    while (stack_size > 0) {
+        int f = stack[--stack_size];
+        if (!ctx->files[f].parse_complete) {
+            free(stack);
+            free(reached);
+            return NULL;
+        }
+        reached[reached_count++] = f;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target < 0 || ctx->closure_visit_stamp[target] == ctx->closure_visit_serial) continue;
+            ctx->closure_visit_stamp[target] = ctx->closure_visit_serial;
+            stack[stack_size++] = target;
+        }
+    }
+
+    SymbolAutomaton* automaton = (SymbolAutomaton*)calloc(1, sizeof(SymbolAutomaton));
+    automaton_add_node(automaton, '\0');
+    for (int r = 0; r < reached_count; r++) {
+        FileAnalysis* analysis = &ctx->files[reached[r]];
+        for (int s = analysis->first_symbol; s < analysis->first_symbol + analysis->symbol_total; s++) {
+            automaton_add_pattern(automaton, interned_string(ctx->symbols[s].name_id), 0, 0);
+        }
+        for (int k = 0; k < analysis->type_name_count; k++) {
+            automaton_add_pattern(automaton, interned_string(analysis->type_name_ids[k]), 0, 1);
+        }
+        for (int k = 0; k < analysis->global_static_count; k++) {
+            automaton_add_pattern(automaton, interned_string(analysis->global_static_ids[k]), 0, 0);
+        }
+        for (int k = 0; k < analysis->macro_count; k++) {
+            automaton_add_pattern(automaton, interned_string(analysis->macro_name_ids[k]), 1, 0);
+        }
+    }
+    automaton_build_links(automaton);
+    free(stack);
+    free(reached);
+
+    // Cache begrenzen: bei Überschreitung alle Automaten verwerfen
+    if (ctx->automaton_nodes_cached + automaton->node_count > AUTOMATON_NODE_BUDGET) {
+        for (int i = 0; i < MAX_FILES; i++) {
+            if (!ctx->header_automata[i]) continue;
+            free_automaton(ctx->header_automata[i]);
+            ctx->header_automata[i] = NULL;
+        }
+        ctx->automaton_nodes_cached = 0;
+    }
+    ctx->header_automata[header] = automaton;
+    ctx->automaton_nodes_cached += automaton->node_count;
+    return automaton;
+}
+
+static int is_header_file(int file_index) {
+    const char* ext = strrchr(ctx->files[file_index].filename, '.');
+    return ext && (strcmp(ext, ".h") == 0 || strcmp(ext, ".H") == 0);
+}
+
+// v1.4: Include-Guard - erste Direktive "#pragma once" oder "#ifndef X" direkt gefolgt von "#define X"
+static int detect_include_guard(const char* content, long size) {
+    const char* cursor = content;
+    const char* end = content + size;
+    char line[MAX_LINE_LEN];
+    char guard[MAX_NAME_LEN] = "";
+    int in_comment = 0;
+    while (next_content_line(&cursor, end, line, sizeof(line))) {
+        trim_whitespace(line);
+        const char* text = line + strspn(line, " \t");
+        if (in_comment) {
+            if (strstr(text, "*/")) in_comment = 0;
+            continue;
+        }
+        if (!text[0] || starts_with(text, "//")) continue;
+        if (starts_with(text, "/*")) {
+            if (!strstr(text + 2, "*/")) in_comment = 1;
+            continue;
+        }
+        if (text[0] != '#') return 0;
+
+        if (guard[0]) {
+            char macro_name[MAX_NAME_LEN];
+            char body[MAX_LINE_LEN];
+            return match_define(text, macro_name, body, NULL) && strcmp(macro_name, guard) == 0;
+        }
+        const char* p = text + 1;
+        while (*p == ' ' || *p == '\t') p++;
+        if (starts_with(p, "pragma") && strstr(p, "once")) return 1;
+        if (strncmp(p, "ifndef", 6) != 0 || (p[6] != ' ' && p[6] != '\t')) return 0;
+        p += 6;
+        while (*p == ' ' || *p == '\t') p++;
+        int len = 0;
+        while (is_identifier_char(*p) && len < MAX_NAME_LEN - 1) guard[len++] = *p++;
+        guard[len] = '\0';
+        if (!len) return 0;
+    }
+    return 0;
+}
+
+// v1.4: Vorwärtsdeklarationen
+// Ein benutztes Include ist durch Vorwärtsdeklarationen ersetzbar, wenn aus dem Header (und seinen
+// Includes) nur Struct- und Typedef-Namen vorkommen und jeder davon nur als Zeiger: direkt gefolgt
+// von '*' oder '&', oder als "struct NAME" ohne Rumpf. Zugriffe "name->", "name." oder "name[" auf eine so
+// deklarierte Variable brauchen die Definition. Heuristik ohne Typprüfung - im Zweifel bleibt das Include.
+#define FORWARD_TYPES_PER_INCLUDE 16
+#define FORWARD_POINTER_NAMES 64
+
+static void add_forward_declaration(int include_slot, int name_id) {
+    if (ctx->forward_decl_count == ctx->forward_decl_capacity) {
+        ctx->forward_decl_capacity = ctx->forward_decl_capacity ? ctx->forward_decl_capacity * 2 : 256;
+        ctx->forward_decls = (ForwardDeclaration*)realloc(ctx->forward_decls,
+                                                          sizeof(ForwardDeclaration) * ctx->forward_decl_capacity);
+    }
+    ctx->forward_decls[ctx->forward_decl_count].include_slot = include_slot;
+    ctx->forward_decls[ctx->forward_decl_count].name_id = name_id;
+    ctx->forward_decl_count++;
+}
+
+static long skip_blanks(const char* text, long size, long i) {
+    while (i < size && (text[i] == ' ' || text[i] == '\t')) i++;
+    return i;
+}
+
+// Steht direkt vor Position end (Leerzeichen übersprungen) das Schlüsselwort keyword? Liefert dessen Anfang oder -1
+static long keyword_before(const char* text, long end, const char* keyword) {
+    while (end > 0 && (text[end - 1] == ' ' || text[end - 1] == '\t')) end--;
+    long len = (long)strlen(keyword);
+    if (end < len || strncmp(text + end - len, keyword, len) != 0) return -1;
+    if (end > len && is_identifier_char(text[end - len - 1])) return -1;
+    return end - len;
+}
+
+// Kommt name als ganzes Wort vor '->', '.' (Referenz) oder '[' vor?
+static int text_has_member_access(const char* text, long size, const char* name) {
+    long len = (long)strlen(name);
+    for (long i = 0; i + len <= size; i++) {
+        if (text[i] != name[0] || memcmp(text + i, name, len) != 0) continue;
+        if ((i > 0 && is_identifier_char(text[i - 1])) || (i + len < size && is_identifier_char(text[i + len]))) continue;
+        long k = skip_blanks(text, size, i + len);
+        if (k < size && (text[k] == '[' || text[k] == '.' || (text[k] == '-' && k + 1 < size && text[k + 1] == '>'))) return 1;
+    }
+    return 0;
+}
+
+// Anzahl verschiedener Typen (Namen in type_ids), wenn der Text aus dem Automaten nur Typen über
+// Zeiger verwendet, sonst -1
+static int find_pointer_only_types(const SymbolAutomaton* automaton, const char* text, long size, int* type_ids, int max_types) {
+    char pointer_names[FORWARD_POINTER_NAMES][MAX_NAME_LEN];
+    int pointer_count = 0;
+    int type_count = 0;
+    AutomatonScan scan = { 0, 0, 1 };
+    int match;
+    while ((match = automaton_next_word(automaton, text, size, &scan)) >= 0) {
+        if (!automaton->nodes[match].is_type) return -1;
+        long end = scan.position;
+        long start = end - automaton->nodes[match].length;
+
+        long k = skip_blanks(text, size, end);
+        long struct_keyword = keyword_before(text, start, "struct");
+        if (k < size && (text[k] == '*' || text[k] == '&')) {
+            // Deklarierten Namen merken ("Foo* a", "Foo** list", "Foo* get_foo(")
+            while (k < size && (text[k] == '*' || text[k] == '&' || text[k] == ' ' || text[k] == '\t')) k++;
+            int len = 0;
+            while (k + len < size && is_identifier_char(text[k + len]) && len < MAX_NAME_LEN - 1) len++;
+            int known = 0;
+            for (int p = 0; p < pointer_count && !known; p++) {
+                known = (int)strlen(pointer_names[p]) == len && memcmp(pointer_names[p], text + k, len) == 0;
+            }
+            if (len > 0 && !known) {
+                if (pointer_count == FORWARD_POINTER_NAMES) return -1;
+                memcpy(pointer_names[pointer_count], text + k, len);
+                pointer_names[pointer_count++][len] = '\0';
+            }
+        } else if (struct_keyword >= 0 && k < size && text[k] == ';') {
+            // "struct Foo;" ist selbst eine Vorwärtsdeklaration
+        } else if (struct_keyword >= 0 && keyword_before(text, struct_keyword, "typedef") >= 0) {
+            // "typedef struct Foo Foo;" - der Typedef-Name gehört dazu
+            long name_end = k;
+            while (name_end < size && is_identifier_char(text[name_end])) name_end++;
+            long after = skip_blanks(text, size, name_end);
+            if (name_end == k || after >= size || text[after] != ';') return -1;
+            scan.position = name_end;
+            scan.node = 0;
+        } else {
+            return -1;
+        }
+
+        char name[MAX_NAME_LEN];
+        int len = (int)(end - start) < MAX_NAME_LEN - 1 ? (int)(end - start) : MAX_NAME_LEN - 1;
+        memcpy(name, text + start, len);
+        name[len] = '\0';
+        int name_id = intern_string(name);
+        int known = 0;
+        for (int t = 0; t < type_count && !known; t++) known = type_ids[t] == name_id;
+        if (known) continue;
+        if (type_count == max_types) return -1;
+        type_ids[type_count++] = name_id;
+    }
+
+    for (int p = 0; p < pointer_count; p++) {
+        if (text_has_member_access(text, size, pointer_names[p])) return -1;
+    }
+    return type_count > 0 ? type_count : -1;
+}
+
+// Nur Header-Includes werden geprüft - inkludierte .c Dateien sind Teil der Kompilierung.
+// Sammel-Header ohne eigene Deklarationen existieren nur, um weiterzureichen.
+static void check_include_usage(int file_index, const char* content, long size) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    int declares_nothing = analysis->void_function_count + analysis->function_count + analysis->action_count +
+                           analysis->struct_count + analysis->typedef_struct_count + analysis->static_var_count +
+                           analysis->macro_count == 0;
+    int is_umbrella = is_header_file(file_index) && declares_nothing;
+
+    analysis->forward_decl_first = ctx->forward_decl_count;
+    for (int j = 0; j < analysis->include_count; j++) {
+        IncludeElement* include_elem = &analysis->includes[j];
+        int target = include_elem->target_index;
+        include_elem->usage = INCLUDE_USAGE_UNKNOWN;
+        if (is_umbrella || target < 0 || target == file_index || !is_header_file(target)) continue;
+
+        SymbolAutomaton* automaton = get_header_automaton(target);
+        if (!automaton || automaton->pattern_count == 0) continue;
+        int found = automaton_finds_word(automaton, content, size);
+        include_elem->usage = found == 2 ? INCLUDE_USAGE_USED
+                            : found == 1 ? INCLUDE_USAGE_MACRO_ONLY
+                                         : INCLUDE_USAGE_UNUSED;
+        if (found != 2 || automaton->type_pattern_count == 0) continue;
+
+        int type_ids[FORWARD_TYPES_PER_INCLUDE];
+        int type_count = find_pointer_only_types(automaton, content, size, type_ids, FORWARD_TYPES_PER_INCLUDE);
+        if (type_count <= 0) continue;
+        include_elem->usage = INCLUDE_USAGE_POINTER_ONLY;
+        for (int t = 0; t < type_count; t++) add_forward_declaration(j, type_ids[t]);
+    }
+    analysis->forward_decl_total = ctx->forward_decl_count - analysis->forward_decl_first;
+}
+
+// Abschluss einer Datei: Skelett, Symbole, Rumpf-Referenzen und Deklarationen übernehmen;
+// im Streaming-Modus Sektion schreiben und Element-Tabellen freigeben
+static void finish_file_analysis(int file_index, const CallCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->parse_complete = 1;
+    build_file_skeleton(analysis);
+    register_file_symbols(file_index);
+    if (collector) store_call_references(file_index, collector);
+    collect_file_declarations(file_index);
+
+    if (ctx->stream_report) {
+        write_file_section(ctx->stream_report, analysis);
+        fflush(ctx->stream_report);
+        release_file_elements(analysis);
+    }
+}
+
+// v1.4: Struct-Layout und statischer Speicher
+// Beim Parsen werden die Member jedes Struct-Rumpfs und die Deklarationen statischer Variablen
+// gesammelt (Typ, Name, Zeiger, Array-Dimensionen). resolve_struct_layouts berechnet danach Größe,
+// Offsets und Padding nach den Lite-C-Regeln: var, int, long, float und fixed 4 Bytes, double 8,
+// Zeiger 4 (32 Bit), natürliche Ausrichtung. Eingebettete Structs werden über den Namen aufgelöst,
+// Array-Dimensionen als Zahl oder als Makro mit numerischem Body.
+#define LITEC_POINTER_SIZE 4
+#define LITEC_MAX_ALIGN 8
+#define CACHE_LINE_SIZE 64
+
+enum { LAYOUT_OPEN, LAYOUT_ACTIVE, LAYOUT_DONE };
+
+typedef struct {
+    const char* name;
+    int size;
+    int align;
+} PrimitiveType;
+
+static const PrimitiveType litec_primitive_types[] = {
+    { "char", 1, 1 }, { "short", 2, 2 }, { "int", 4, 4 }, { "long", 4, 4 }, { "long long", 8, 8 },
+    { "float", 4, 4 }, { "double", 8, 8 }, { "var", 4, 4 }, { "fixed", 4, 4 }, { "BOOL", 4, 4 },
+    { "BYTE", 1, 1 }, { "WORD", 2, 2 }, { "DWORD", 4, 4 },
+    { "VECTOR", 12, 4 }, { "ANGLE", 12, 4 }, { "COLOR", 12, 4 },
+    { NULL, 0, 0 }
+};
+
+// Sammelt Struct-Rümpfe und statische Variablen einer Datei während des Parsens
+typedef struct {
+    StructLayout* layouts;
+    int layout_count;
+    int layout_capacity;
+    DataMember* members;            // Members aller Layouts nacheinander
+    int member_count;
+    int member_capacity;
+    DataMember* statics;
+    int static_count;
+    int static_capacity;
+    int open_layout;                // Layout, dessen Rumpf gerade gelesen wird, oder -1
+    int open_typedef;
+    int depth;                      // Klammertiefe im Rumpf
+    int nested_body;                // eingebetteter Rumpf ("struct { ... } inner;") vor dem nächsten ';'
+    int pending_line;               // "typedef struct X" ohne '{': Rumpf beginnt in der nächsten Zeile
+    int pending_typedef;
+    char pending_tag[MAX_NAME_LEN];
+    char declaration[MAX_LINE_LEN];
+    int declaration_line;
+} LayoutCollector;
+
+static void init_layout_collector(LayoutCollector* collector) {
+    memset(collector, 0, sizeof(LayoutCollector));
+    collector->open_layout = -1;
+}
+
+static void free_layout_collector(LayoutCollector* collector) {
+    free(collector->layouts);
+    free(collector->members);
+    free(collector->statics);
+}
+
+static void append_data_member(DataMember** list, int* count, int* capacity, const DataMember* member) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *list = (DataMember*)realloc(*list, sizeof(DataMember) * *capacity);
+    }
+    (*list)[(*count)++] = *member;
+}
+
+static void append_struct_layout(StructLayout** list, int* count, int* capacity, const StructLayout* layout) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 32;
+        *list = (StructLayout*)realloc(*list, sizeof(StructLayout) * *capacity);
+    }
+    (*list)[(*count)++] = *layout;
+}
+
+static int is_type_qualifier(const char* word) {
+    return strcmp(word, "const") == 0 || strcmp(word, "volatile") == 0 || strcmp(word, "static") == 0 ||
+           strcmp(word, "extern") == 0 || strcmp(word, "register") == 0 || strcmp(word, "struct") == 0 ||
+           strcmp(word, "signed") == 0 || strcmp(word, "unsigned") == 0;
+}
+
+// Eine Deklaration ohne ';' ("var x, *y, z[4][MAX]" oder "void* (*callback)(ENTITY*)") in Members
+// zerlegen; alle Deklaratoren teilen den Basistyp. Liefert die Anzahl Members.
+static int parse_data_declaration(const char* text, int line, DataMember* out, int max) {
+    char name[MAX_NAME_LEN];
+    DataMember member;
+    memset(&member, 0, sizeof(DataMember));
+    member.line = line;
+    member.dims_id = -1;
+
+    // Funktionszeiger: "(*name)" oder Lite-C "function name(var)" - immer Zeigergröße
+    const char* paren = strchr(text, '(');
+    if (paren) {
+        const char* star = strstr(text, "(*");
+        const char* p = star ? star + 2 : paren;
+        if (!star) {
+            while (p > text && (p[-1] == ' ' || p[-1] == '\t')) p--;
+            while (p > text && is_identifier_char(p[-1])) p--;
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        int len = 0;
+        while (is_identifier_char(p[len]) && len < MAX_NAME_LEN - 1) len++;
+        if (len == 0 || max < 1) return 0;
+        memcpy(name, p, len);
+        name[len] = '\0';
+        member.type_id = intern_string("function");
+        member.name_id = intern_string(name);
+        member.is_pointer = 1;
+        out[0] = member;
+        return 1;
+    }
+
+    char base_type[MAX_NAME_LEN] = "";
+    char words[8][MAX_NAME_LEN];
+    char dims[MAX_NAME_LEN];
+    int word_count = 0, stars = 0, has_dims = 0, has_sign = 0, count = 0, first = 1;
+    dims[0] = '\0';
+    for (const char* p = text; ; p++) {
+        if (is_identifier_start(*p)) {
+            int len = 0;
+            while (is_identifier_char(p[len])) len++;
+            if (word_count < 8 && len < MAX_NAME_LEN) {
+                memcpy(words[word_count], p, len);
+                words[word_count][len] = '\0';
+                word_count++;
+            }
+            p += len - 1;
+        } else if (*p == '*' || *p == '&') {
+            stars++;
+        } else if (*p == '[') {
+            const char* close = strchr(p, ']');
+            if (!close) break;
+            char term[MAX_NAME_LEN];
+            int len = (int)(close - p - 1);
+            if (len >= MAX_NAME_LEN) len = MAX_NAME_LEN - 1;
+            memcpy(term, p + 1, len);
+            term[len] = '\0';
+            trim_whitespace(term);
+            const char* start = term + strspn(term, " \t");
+            if (strlen(dims) + strlen(start) + 3 < sizeof(dims)) {
+                if (has_dims) strcat(dims, "][");
+                strcat(dims, start);
+            }
+            has_dims = 1;
+            p = close;
+        } else if (*p == ',' || *p == '\0') {
+            if (word_count > 0) {
+                // Erster Deklarator: die Wörter vor dem Namen bilden den Basistyp
+                if (first) {
+                    for (int w = 0; w < word_count - 1; w++) {
+                        if (strcmp(words[w], "signed") == 0 || strcmp(words[w], "unsigned") == 0) has_sign = 1;
+                        if (is_type_qualifier(words[w])) continue;
+                        if (strcmp(words[w], "int") == 0 && base_type[0]) continue;   // "long int", "short int"
+                        if (base_type[0] && strlen(base_type) + strlen(words[w]) + 2 < sizeof(base_type)) strcat(base_type, " ");
+                        if (strlen(base_type) + strlen(words[w]) + 1 < sizeof(base_type)) strcat(base_type, words[w]);
+                    }
+                    if (!base_type[0] && has_sign) strcpy(base_type, "int");
+                    first = 0;
+                }
+                if (base_type[0] && count < max) {
+                    member.type_id = intern_string(base_type);
+                    member.name_id = intern_string(words[word_count - 1]);
+                    member.is_pointer = stars > 0;
+                    member.dims_id = has_dims ? intern_string(dims) : -1;
+                    out[count++] = member;
+                }
+            }
+            if (*p == '\0') break;
+            word_count = 0;
+            stars = 0;
+            has_dims = 0;
+            dims[0] = '\0';
+        }
+    }
+    return count;
+}
+
+static void finish_member_declaration(LayoutCollector* collector) {
+    DataMember members[16];
+    int count = 0;
+    if (collector->nested_body) {
+        // Eingebetteter Rumpf: nur der Name ist bekannt, die Größe nicht
+        char name[MAX_NAME_LEN];
+        int is_member;
+        if (next_identifier(collector->declaration, collector->declaration, name, &is_member)) {
+            memset(&members[0], 0, sizeof(DataMember));
+            members[0].type_id = intern_string("struct");
+            members[0].name_id = intern_string(name);
+            members[0].dims_id = -1;
+            members[0].line = collector->declaration_line;
+            count = 1;
+        }
+        collector->nested_body = 0;
+    } else {
+        count = parse_data_declaration(collector->declaration, collector->declaration_line, members, 16);
+    }
+    for (int i = 0; i < count; i++) {
+        append_data_member(&collector->members, &collector->member_count, &collector->member_capacity, &members[i]);
+        collector->layouts[collector->open_layout].member_count++;
+    }
+    collector->declaration[0] = '\0';
+}
+
+static void open_struct_layout(LayoutCollector* collector, const char* tag, int is_typedef, int line) {
+    StructLayout layout;
+    memset(&layout, 0, sizeof(StructLayout));
+    layout.name_id = -1;
+    layout.tag_id = tag[0] ? intern_string(tag) : -1;
+    layout.line = line;
+    layout.member_first = collector->member_count;
+    append_struct_layout(&collector->layouts, &collector->layout_count, &collector->layout_capacity, &layout);
+    collector->open_layout = collector->layout_count - 1;
+    collector->open_typedef = is_typedef;
+    collector->depth = 0;
+    collector->nested_body = 0;
+    collector->declaration[0] = '\0';
+}
+
+// Rumpf geschlossen; after zeigt hinter '}' ("} NAME;" bei typedef)
+static void close_struct_layout(LayoutCollector* collector, const char* after) {
+    StructLayout* layout = &collector->layouts[collector->open_layout];
+    char alias[MAX_NAME_LEN];
+    int len = 0;
+    while (*after == ' ' || *after == '\t') after++;
+    while (is_identifier_char(after[len]) && len < MAX_NAME_LEN - 1) len++;
+    memcpy(alias, after, len);
+    alias[len] = '\0';
+
+    if (collector->open_typedef && alias[0]) layout->name_id = intern_string(alias);
+    else layout->name_id = layout->tag_id;
+
+    // "struct { ... } instance;" ohne Namen ist eine Variable, kein Typ
+    if (layout->name_id < 0) {
+        collector->member_count = layout->member_first;
+        collector->layout_count--;
+    }
+    collector->open_layout = -1;
+}
+
+// Eine Quelltextzeile (ohne führenden Kommentar) auf Struct-Rümpfe untersuchen
+static void collect_struct_line(LayoutCollector* collector, const char* line, int line_num) {
+    char text[MAX_LINE_LEN];
+    snprintf(text, sizeof(text), "%s", line);
+    char* comment = strstr(text, "//");
+    if (comment) *comment = '\0';
+    comment = strstr(text, "/*");
+    if (comment) *comment = '\0';
+    const char* p = text + strspn(text, " \t");
+
+    if (collector->open_layout < 0) {
+        if (collector->pending_line && *p == '{') {
+            open_struct_layout(collector, collector->pending_tag, collector->pending_typedef, collector->pending_line);
+            collector->pending_line = 0;
+        } else {
+            collector->pending_line = 0;
+            int is_typedef = starts_with(p, "typedef struct") && !is_identifier_char(p[14]);
+            if (!is_typedef && !(starts_with(p, "struct") && !is_identifier_char(p[6]))) return;
+            if (strchr(p, '(')) return;
+
+            const char* q = p + (is_typedef ? 14 : 6);
+            while (*q == ' ' || *q == '\t') q++;
+            char tag[MAX_NAME_LEN];
+            int len = 0;
+            while (is_identifier_char(q[len]) && len < MAX_NAME_LEN - 1) len++;
+            memcpy(tag, q, len);
+            tag[len] = '\0';
+
+            const char* brace = strchr(p, '{');
+            if (!brace) {
+                if (!strchr(p, ';')) {
+                    collector->pending_line = line_num;
+                    collector->pending_typedef = is_typedef;
+                    strcpy(collector->pending_tag, tag);
+                }
+                return;
+            }
+            open_struct_layout(collector, tag, is_typedef, line_num);
+            p = brace;
+        }
+    } else if (*p == '#') {
+        return;
+    }
+
+    for (; *p; p++) {
+        if (*p == '{') {
+            collector->depth++;
+        } else if (*p == '}') {
+            collector->depth--;
+            if (collector->depth == 0) {
+                close_struct_layout(collector, p + 1);
+                return;
+            }
+            if (collector->depth == 1) {
+                collector->nested_body = 1;
+                collector->declaration[0] = '\0';
+            }
+        } else if (collector->depth == 1) {
+            if (*p == ';') {
+                finish_member_declaration(collector);
+            } else {
+                size_t len = strlen(collector->declaration);
+                if (len == 0 && (*p == ' ' || *p == '\t')) continue;
+                if (len == 0) collector->declaration_line = line_num;
+                if (len < sizeof(collector->declaration) - 2) {
+                    collector->declaration[len] = *p;
+                    collector->declaration[len + 1] = '\0';
+                }
+            }
+        }
+    }
+    // Deklarationen können über mehrere Zeilen gehen
+    size_t len = strlen(collector->declaration);
+    if (len > 0 && len < sizeof(collector->declaration) - 2) strcat(collector->declaration, " ");
+}
+
+// Statische Variable (Zeile, die match_static_var erkannt hat); statische Funktionen zählen nicht
+static void collect_static_storage(LayoutCollector* collector, const char* line, int line_num) {
+    if (strchr(line, '(') && !strstr(line, "(*")) return;
+    char text[MAX_LINE_LEN];
+    snprintf(text, sizeof(text), "%s", line);
+    text[strcspn(text, "=;{")] = '\0';
+
+    DataMember members[16];
+    int count = parse_data_declaration(text, line_num, members, 16);
+    for (int i = 0; i < count; i++) {
+        append_data_member(&collector->statics, &collector->static_count, &collector->static_capacity, &members[i]);
+    }
+}
+
+static void store_struct_layouts(int file_index, const LayoutCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->struct_layout_first = ctx->struct_layout_count;
+    for (int i = 0; i < collector->layout_count; i++) {
+        StructLayout layout = collector->layouts[i];
+        if (layout.name_id < 0) continue;                 // Rumpf bis zum Dateiende nicht geschlossen
+        layout.file_index = file_index;
+        layout.member_first = ctx->data_member_count;
+        for (int m = 0; m < layout.member_count; m++) {
+            append_data_member(&ctx->data_members, &ctx->data_member_count, &ctx->data_member_capacity,
+                               &collector->members[collector->layouts[i].member_first + m]);
+        }
+        append_struct_layout(&ctx->struct_layouts, &ctx->struct_layout_count, &ctx->struct_layout_capacity, &layout);
+    }
+    analysis->struct_layout_total = ctx->struct_layout_count - analysis->struct_layout_first;
+
+    analysis->static_storage_first = ctx->data_member_count;
+    for (int i = 0; i < collector->static_count; i++) {
+        append_data_member(&ctx->data_members, &ctx->data_member_count, &ctx->data_member_capacity,
+                           &collector->statics[i]);
+    }
+    analysis->static_storage_total = ctx->data_member_count - analysis->static_storage_first;
+}
+
+// Identischer Inhalt: Layouts und statische Variablen des Originals übernehmen
+static void copy_struct_layouts(int target, int source) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const FileAnalysis* original = &ctx->files[source];
+    analysis->struct_layout_first = ctx->struct_layout_count;
+    for (int i = 0; i < original->struct_layout_total; i++) {
+        StructLayout layout = ctx->struct_layouts[original->struct_layout_first + i];
+        int member_first = layout.member_first;
+        layout.file_index = target;
+        layout.member_first = ctx->data_member_count;
+        for (int m = 0; m < layout.member_count; m++) {
+            DataMember member = ctx->data_members[member_first + m];
+            append_data_member(&ctx->data_members, &ctx->data_member_count, &ctx->data_member_capacity, &member);
+        }
+        append_struct_layout(&ctx->struct_layouts, &ctx->struct_layout_count, &ctx->struct_layout_capacity, &layout);
+    }
+    analysis->struct_layout_total = ctx->struct_layout_count - analysis->struct_layout_first;
+
+    analysis->static_storage_first = ctx->data_member_count;
+    for (int i = 0; i < original->static_storage_total; i++) {
+        DataMember member = ctx->data_members[original->static_storage_first + i];
+        append_data_member(&ctx->data_members, &ctx->data_member_count, &ctx->data_member_capacity, &member);
+    }
+    analysis->static_storage_total = ctx->data_member_count - analysis->static_storage_first;
+}
+
+static int primitive_type_size(const char* type, int* align) {
+    for (int i = 0; litec_primitive_types[i].name; i++) {
+        if (strcmp(litec_primitive_types[i].name, type) == 0) {
+            *align = litec_primitive_types[i].align;
+            return litec_primitive_types[i].size;
+        }
+    }
+    return 0;
+}
+
+// Array-Dimension als Zahl oder als Makro mit numerischem Body; 0, wenn unbekannt
+static long resolve_array_dimension(const char* term) {
+    char* end;
+    long value = strtol(term, &end, 0);
+    if (end != term && *end == '\0') return value;
+    int definition = hash_index_find(&ctx->macro_index, term);
+    if (definition < 0 || ctx->macro_defs[definition].has_parameters) return 0;
+    const char* body = interned_string(ctx->macro_defs[definition].body_id);
+    while (*body == '(' || *body == ' ') body++;
+    value = strtol(body, &end, 0);
+    while (*end == ')' || *end == ' ') end++;
+    return end != body && *end == '\0' ? value : 0;
+}
+
+static long array_element_count(int dims_id, int* known) {
+    if (dims_id < 0) return 1;
+    const char* dims = interned_string(dims_id);
+    if (!dims[0]) {
+        *known = 0;
+        return 1;
+    }
+    long count = 1;
+    while (*dims) {
+        char term[MAX_NAME_LEN];
+        int len = (int)strcspn(dims, "]");
+        if (len >= MAX_NAME_LEN) len = MAX_NAME_LEN - 1;
+        memcpy(term, dims, len);
+        term[len] = '\0';
+        long value = resolve_array_dimension(term);
+        if (value <= 0) {
+            *known = 0;
+            value = 1;
+        }
+        count *= value;
+        dims += len;
+        if (*dims == ']') dims++;
+        if (*dims == '[') dims++;
+    }
+    return count;
+}
+
+static int compute_struct_layout(int index);
+
+static void size_data_member(DataMember* member) {
+    int known = 1;
+    long count = array_element_count(member->dims_id, &known);
+    long element_size = LITEC_POINTER_SIZE;
+    int align = LITEC_POINTER_SIZE;
+    if (!member->is_pointer) {
+        const char* type = interned_string(member->type_id);
+        int primitive = primitive_type_size(type, &align);
+        int layout = primitive ? -1 : hash_index_find(&ctx->struct_layout_index, type);
+        if (primitive) {
+            element_size = primitive;
+        } else if (layout >= 0 && compute_struct_layout(layout)) {
+            element_size = ctx->struct_layouts[layout].size;
+            align = ctx->struct_layouts[layout].align;
+        } else {
+            align = LITEC_POINTER_SIZE;
+            known = 0;
+        }
+    }
+    if (align > LITEC_MAX_ALIGN) align = LITEC_MAX_ALIGN;
+    member->size = element_size * count;
+    member->align = align;
+    member->size_known = known;
+}
+
+// Offsets, Größe und Padding eines Structs; 0 bei Rekursion (Struct enthält sich selbst)
+static int compute_struct_layout(int index) {
+    StructLayout* layout = &ctx->struct_layouts[index];
+    if (layout->state == LAYOUT_DONE) return 1;
+    if (layout->state == LAYOUT_ACTIVE) return 0;
+    layout->state = LAYOUT_ACTIVE;
+
+    long offset = 0, used = 0;
+    int align = 1;
+    for (int m = layout->member_first; m < layout->member_first + layout->member_count; m++) {
+        DataMember* member = &ctx->data_members[m];
+        size_data_member(member);
+        if (!member->size_known) layout->unknown_members++;
+        offset = (offset + member->align - 1) / member->align * member->align;
+        member->offset = offset;
+        offset += member->size;
+        used += member->size;
+        if (member->align > align) align = member->align;
+    }
+    layout->align = align;
+    layout->size = (offset + align - 1) / align * align;
+    layout->padding = layout->size - used;
+    layout->state = LAYOUT_DONE;
+    return 1;
+}
+
+static void resolve_struct_layouts() {
+    for (int i = 0; i < ctx->struct_layout_count; i++) {
+        const StructLayout* layout = &ctx->struct_layouts[i];
+        const char* name = interned_string(layout->name_id);
+        if (hash_index_find(&ctx->struct_layout_index, name) < 0) hash_index_put(&ctx->struct_layout_index, name, i);
+        if (layout->tag_id >= 0 && hash_index_find(&ctx->struct_layout_index, interned_string(layout->tag_id)) < 0) {
+            hash_index_put(&ctx->struct_layout_index, interned_string(layout->tag_id), i);
+        }
+    }
+    for (int i = 0; i < ctx->struct_layout_count; i++) compute_struct_layout(i);
+
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        for (int v = analysis->static_storage_first; v < analysis->static_storage_first + analysis->static_storage_total; v++) {
+            size_data_member(&ctx->data_members[v]);
+        }
+    }
+}
+
+// v1.4: Per-Frame-Schleifen
+// Lite-C-Actions laufen typischerweise als "while (...) { ...; wait(1); }" - der Rumpf wird einmal
+// pro Frame und Entity ausgeführt. Beim Parsen werden die Schleifen jeder Funktion (while, for,
+// do) mit ihrer Verschachtelung und die Aufrufe darin gesammelt; eine Schleife mit wait() im
+// Rumpf ist eine Frame-Schleife. Die Kosten werden nach dem Aufbau des Aufrufgraphen berechnet:
+// teure Engine-Funktionen direkt, eigene Funktionen mit allem, was sie (transitiv) aufrufen.
+#define HOT_LOOP_MAX_NESTING 32
+#define HOT_LOOP_NEST_FACTOR 4      // angenommene Iterationen einer inneren Schleife ohne wait()
+#define HOT_LOOP_COST_CAP 1000000000L
+#define HOT_LOOPS_SHOWN 50
+
+typedef struct {
+    const char* name;
+    int cost;                       // heuristische Kosteneinheiten pro Aufruf
+} EngineCallCost;
+
+static const EngineCallCost engine_call_costs[] = {
+    { "c_trace", 20 }, { "c_scan", 20 }, { "c_move", 10 }, { "c_rotate", 8 }, { "c_intersect", 10 },
+    { "c_content", 5 }, { "path_scan", 20 }, { "ent_create", 30 }, { "ent_remove", 10 }, { "ent_morph", 15 },
+    { "ent_animate", 3 }, { "ent_playsound", 5 }, { "snd_play", 5 }, { "media_play", 20 }, { "effect", 10 },
+    { "ptr_remove", 10 }, { "bmap_create", 30 }, { "pan_create", 30 }, { "txt_create", 20 },
+    { "sys_malloc", 5 }, { "malloc", 5 }, { "str_create", 5 }, { "str_cpy", 2 }, { "str_cat", 2 },
+    { "str_remove", 3 }, { "str_for_num", 2 }, { "str_cmpi", 1 }, { "file_open_read", 50 },
+    { "file_open_write", 50 }, { "file_open_append", 50 }, { "file_close", 10 }, { "file_str_read", 5 },
+    { "file_var_read", 3 }, { "vec_for_vertex", 3 }, { "draw_text", 2 }, { "draw_line", 1 },
+    { "vec_set", 1 }, { "vec_add", 1 }, { "vec_sub", 1 }, { "vec_scale", 1 }, { "vec_dist", 1 },
+    { "vec_length", 1 }, { "vec_normalize", 1 }, { "vec_to_angle", 1 }, { "vec_rotate", 1 }, { "random", 1 },
+    { NULL, 0 }
+};
+
+typedef struct {
+    int parent;                     // umschließende Schleife oder -1
+    int line;
+    int body_depth;                 // Klammertiefe des Rumpfs, -1 solange Kopf/Bedingung gelesen werden
+    int condition_parens;           // Klammertiefe vor der Bedingung
+    int in_condition;
+    int statement;                  // Rumpf ohne Klammern: endet beim nächsten ';'
+    int is_do;
+    int has_wait;
+    int function_name_id;
+} SourceLoop;
+
+// Sammelt die Schleifen einer Datei während des Parsens
+typedef struct {
+    SourceLoop* loops;
+    int loop_count;
+    int loop_capacity;
+    LoopCall* calls;
+    int call_count;
+    int call_capacity;
+    int stack[HOT_LOOP_MAX_NESTING];    // offene Schleifen, innerste oben
+    int stack_depth;
+    int brace_depth;
+    int paren_depth;
+    int do_while_tail;              // nach dem Rumpf einer do-Schleife: das folgende while ist kein Kopf
+    int function_name_id;
+} HotLoopCollector;
+
+static void begin_hot_loop_function(HotLoopCollector* collector, const char* function_name) {
+    collector->stack_depth = 0;
+    collector->brace_depth = 0;
+    collector->paren_depth = 0;
+    collector->do_while_tail = 0;
+    collector->function_name_id = intern_string(function_name);
+}
+
+static void append_loop_call(LoopCall** list, int* count, int* capacity, const LoopCall* call) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *list = (LoopCall*)realloc(*list, sizeof(LoopCall) * *capacity);
+    }
+    (*list)[(*count)++] = *call;
+}
+
+static void begin_source_loop(HotLoopCollector* collector, int line, int is_do) {
+    if (collector->stack_depth == HOT_LOOP_MAX_NESTING) return;
+    if (collector->loop_count == collector->loop_capacity) {
+        collector->loop_capacity = collector->loop_capacity ? collector->loop_capacity * 2 : 32;
+        collector->loops = (SourceLoop*)realloc(collector->loops, sizeof(SourceLoop) * collector->loop_capacity);
+    }
+    SourceLoop* loop = &collector->loops[collector->loop_count];
+    memset(loop, 0, sizeof(SourceLoop));
+    loop->parent = collector->stack_depth > 0 ? collector->stack[collector->stack_depth - 1] : -1;
+    loop->line = line;
+    loop->body_depth = -1;
+    loop->condition_parens = collector->paren_depth;
+    loop->in_condition = !is_do;
+    loop->is_do = is_do;
+    loop->function_name_id = collector->function_name_id;
+    collector->stack[collector->stack_depth++] = collector->loop_count++;
+}
+
+// Schleife oben auf dem Stapel, deren Kopf fertig ist und deren Rumpf noch nicht begonnen hat
+static SourceLoop* pending_source_loop(HotLoopCollector* collector) {
+    if (collector->stack_depth == 0) return NULL;
+    SourceLoop* loop = &collector->loops[collector->stack[collector->stack_depth - 1]];
+    return loop->body_depth < 0 && !loop->in_condition ? loop : NULL;
+}
+
+// Einzelanweisungs-Schleifen auf dieser Klammertiefe enden (';' oder Ende eines Blocks)
+static void close_statement_loops(HotLoopCollector* collector) {
+    while (collector->stack_depth > 0) {
+        SourceLoop* loop = &collector->loops[collector->stack[collector->stack_depth - 1]];
+        if (!loop->statement || loop->body_depth != collector->brace_depth) break;
+        collector->stack_depth--;
+    }
+}
+
+static int is_control_keyword(const char* word) {
+    return strcmp(word, "if") == 0 || strcmp(word, "switch") == 0 || strcmp(word, "return") == 0 ||
+           strcmp(word, "sizeof") == 0 || strcmp(word, "else") == 0;
+}
+
+// Eine Zeile eines Funktionsrumpfs (ab '{' bei der Kopfzeile)
+static void collect_hot_loop_line(HotLoopCollector* collector, const char* text, int line) {
+    char word[MAX_NAME_LEN];
+    for (const char* p = text; *p; ) {
+        if (*p == '"' || *p == '\'') {
+            char quote = *p++;
+            while (*p && *p != quote) {
+                if (*p == '\\' && p[1]) p++;
+                p++;
+            }
+            if (*p) p++;
+            continue;
+        }
+        if (p[0] == '/' && (p[1] == '/' || p[1] == '*')) break;
+
+        // Erstes Zeichen nach einem fertigen Schleifenkopf ohne '{': Rumpf ist eine Anweisung
+        SourceLoop* pending = pending_source_loop(collector);
+        if (pending && *p != '{' && *p != ' ' && *p != '\t') {
+            pending->body_depth = collector->brace_depth;
+            pending->statement = 1;
+        }
+
+        if (is_identifier_start(*p) && (p == text || !is_identifier_char(p[-1]))) {
+            int len = 0;
+            while (is_identifier_char(p[len])) {
+                if (len < MAX_NAME_LEN - 1) word[len] = p[len];
+                len++;
+            }
+            word[len < MAX_NAME_LEN ? len : MAX_NAME_LEN - 1] = '\0';
+            const char* next = p + len;
+            while (*next == ' ' || *next == '\t') next++;
+            int is_member = p > text && (p[-1] == '.' || (p[-1] == '>' && p - 1 > text && p[-2] == '-'));
+
+            if (strcmp(word, "while") == 0 && collector->do_while_tail) {
+                collector->do_while_tail = 0;
+            } else if (strcmp(word, "while") == 0 || strcmp(word, "for") == 0) {
+                begin_source_loop(collector, line, 0);
+            } else if (strcmp(word, "do") == 0) {
+                begin_source_loop(collector, line, 1);
+            } else if (*next == '(' && !is_member && !is_control_keyword(word)) {
+                if (strcmp(word, "wait") == 0) {
+                    for (int s = 0; s < collector->stack_depth; s++) {
+                        SourceLoop* loop = &collector->loops[collector->stack[s]];
+                        if (loop->body_depth >= 0) loop->has_wait = 1;
+                    }
+                } else if (collector->stack_depth > 0) {
+                    LoopCall call;
+                    memset(&call, 0, sizeof(LoopCall));
+                    call.loop = collector->stack[collector->stack_depth - 1];
+                    call.name_id = intern_string(word);
+                    call.line = line;
+                    call.count = 1;
+                    append_loop_call(&collector->calls, &collector->call_count, &collector->call_capacity, &call);
+                }
+            }
+            p += len;
+            continue;
+        }
+
+        if (*p == '(') {
+            collector->paren_depth++;
+        } else if (*p == ')') {
+            if (collector->paren_depth > 0) collector->paren_depth--;
+            if (collector->stack_depth > 0) {
+                SourceLoop* loop = &collector->loops[collector->stack[collector->stack_depth - 1]];
+                if (loop->in_condition && collector->paren_depth == loop->condition_parens) loop->in_condition = 0;
+            }
+        } else if (*p == '{') {
+            collector->brace_depth++;
+            pending = pending_source_loop(collector);
+            if (pending) pending->body_depth = collector->brace_depth;
+        } else if (*p == '}') {
+            while (collector->stack_depth > 0) {
+                SourceLoop* loop = &collector->loops[collector->stack[collector->stack_depth - 1]];
+                if (loop->statement || loop->body_depth != collector->brace_depth) break;
+                collector->stack_depth--;
+                if (loop->is_do) collector->do_while_tail = 1;
+            }
+            if (collector->brace_depth > 0) collector->brace_depth--;
+            close_statement_loops(collector);
+        } else if (*p == ';' && collector->paren_depth == 0) {
+            collector->do_while_tail = 0;
+            close_statement_loops(collector);
+        }
+        p++;
+    }
+}
+
+// Aufrufe ihrer Frame-Schleife zuordnen (innerste umschließende Schleife mit wait()) und übernehmen
+static void store_frame_loops(int file_index, const HotLoopCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->frame_loop_first = ctx->frame_loop_count;
+    for (int l = 0; l < collector->loop_count; l++) {
+        const SourceLoop* loop = &collector->loops[l];
+        if (!loop->has_wait) continue;
+        if (ctx->frame_loop_count == ctx->frame_loop_capacity) {
+            ctx->frame_loop_capacity = ctx->frame_loop_capacity ? ctx->frame_loop_capacity * 2 : 64;
+            ctx->frame_loops = (FrameLoop*)realloc(ctx->frame_loops, sizeof(FrameLoop) * ctx->frame_loop_capacity);
+        }
+        int frame = ctx->frame_loop_count++;
+        FrameLoop* frame_loop = &ctx->frame_loops[frame];
+        memset(frame_loop, 0, sizeof(FrameLoop));
+        frame_loop->file_index = file_index;
+        frame_loop->function_name_id = loop->function_name_id;
+        frame_loop->line = loop->line;
+        frame_loop->call_first = ctx->loop_call_count;
+
+        for (int c = 0; c < collector->call_count; c++) {
+            LoopCall call = collector->calls[c];
+            int owner = call.loop;
+            while (owner >= 0 && !collector->loops[owner].has_wait) {
+                call.nesting++;
+                owner = collector->loops[owner].parent;
+            }
+            if (owner != l) continue;
+
+            int merged = 0;
+            for (int k = frame_loop->call_first; k < ctx->loop_call_count; k++) {
+                LoopCall* existing = &ctx->loop_calls[k];
+                if (existing->name_id == call.name_id && existing->nesting == call.nesting) {
+                    existing->count += call.count;
+                    merged = 1;
+                    break;
+                }
+            }
+            if (merged) continue;
+            call.loop = frame;
+            append_loop_call(&ctx->loop_calls, &ctx->loop_call_count, &ctx->loop_call_capacity, &call);
+        }
+        frame_loop->call_count = ctx->loop_call_count - frame_loop->call_first;
+    }
+    analysis->frame_loop_total = ctx->frame_loop_count - analysis->frame_loop_first;
+}
+
+// Identischer Inhalt: Frame-Schleifen des Originals übernehmen
+static void copy_frame_loops(int target, int source) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const FileAnalysis* original = &ctx->files[source];
+    analysis->frame_loop_first = ctx->frame_loop_count;
+    for (int i = 0; i < original->frame_loop_total; i++) {
+        if (ctx->frame_loop_count == ctx->frame_loop_capacity) {
+            ctx->frame_loop_capacity = ctx->frame_loop_capacity ? ctx->frame_loop_capacity * 2 : 64;
+            ctx->frame_loops = (FrameLoop*)realloc(ctx->frame_loops, sizeof(FrameLoop) * ctx->frame_loop_capacity);
+        }
+        int frame = ctx->frame_loop_count++;
+        FrameLoop frame_loop = ctx->frame_loops[original->frame_loop_first + i];
+        int call_first = frame_loop.call_first;
+        frame_loop.file_index = target;
+        frame_loop.call_first = ctx->loop_call_count;
+        for (int c = 0; c < frame_loop.call_count; c++) {
+            LoopCall call = ctx->loop_calls[call_first + c];
+            call.loop = frame;
+            append_loop_call(&ctx->loop_calls, &ctx->loop_call_count, &ctx->loop_call_capacity, &call);
+        }
+        ctx->frame_loops[frame] = frame_loop;
+    }
+    analysis->frame_loop_total = ctx->frame_loop_count - analysis->frame_loop_first;
+}
+
+static long add_hot_loop_cost(long a, long b) {
+    return a + b > HOT_LOOP_COST_CAP ? HOT_LOOP_COST_CAP : a + b;
+}
+
+static long scale_hot_loop_cost(long cost, long factor) {
+    if (cost == 0) return 0;
+    return factor > HOT_LOOP_COST_CAP / cost ? HOT_LOOP_COST_CAP : cost * factor;
+}
+
+// Kosten einer eigenen Funktion: Engine-Aufrufe im Rumpf plus aufgerufene Funktionen (Rekursion zählt nicht)
+static long function_call_cost(int symbol, const long* name_cost, long* memo, unsigned char* state) {
+    if (state[symbol] == 2) return memo[symbol];
+    if (state[symbol] == 1) return 0;
+    state[symbol] = 1;
+    long cost = 0;
+    for (int e = ctx->call_graph.first_edge[symbol]; e < ctx->call_graph.first_edge[symbol + 1]; e++) {
+        long callee = function_call_cost(ctx->call_graph.edge_target[e], name_cost, memo, state);
+        cost = add_hot_loop_cost(cost, scale_hot_loop_cost(callee, ctx->call_graph.edge_weight[e]));
+    }
+    memo[symbol] = add_hot_loop_cost(memo[symbol], cost);
+    state[symbol] = 2;
+    return memo[symbol];
+}
+
+static void compute_hot_loop_costs() {
+    if (ctx->frame_loop_count == 0) return;
+    long* name_cost = (long*)calloc(ctx->string_pool_count + 1, sizeof(long));
+    for (int i = 0; engine_call_costs[i].name; i++) {
+        int name_id = hash_index_find(&ctx->string_pool_index, engine_call_costs[i].name);
+        if (name_id >= 0) name_cost[name_id] = engine_call_costs[i].cost;
+    }
+
+    // Eigene Kosten je Funktion aus den Rumpf-Referenzen, dann transitiv über den Aufrufgraphen
+    long* memo = (long*)calloc(ctx->symbol_count + 1, sizeof(long));
+    unsigned char* state = (unsigned char*)calloc(ctx->symbol_count + 1, 1);
+    for (int r = 0; r < ctx->call_ref_count; r++) {
+        const CallReference* ref = &ctx->call_refs[r];
+        memo[ref->caller] = add_hot_loop_cost(memo[ref->caller], scale_hot_loop_cost(name_cost[ref->name_id], ref->count));
+    }
+
+    for (int l = 0; l < ctx->frame_loop_count; l++) {
+        FrameLoop* loop = &ctx->frame_loops[l];
+        loop->cost = 0;
+        for (int c = loop->call_first; c < loop->call_first + loop->call_count; c++) {
+            LoopCall* call = &ctx->loop_calls[c];
+            long unit = name_cost[call->name_id];
+            if (unit == 0) {
+                for (int s = ctx->symbol_name_first[call->name_id]; s >= 0; s = ctx->symbol_name_next[s]) {
+                    if (!ctx->symbols[s].is_prototype) unit = add_hot_loop_cost(unit, function_call_cost(s, name_cost, memo, state));
+                }
+            }
+            long factor = call->count;
+            for (int n = 0; n < call->nesting; n++) factor = scale_hot_loop_cost(factor, HOT_LOOP_NEST_FACTOR);
+            call->cost = scale_hot_loop_cost(unit, factor);
+            loop->cost = add_hot_loop_cost(loop->cost, call->cost);
+        }
+    }
+    free(name_cost);
+    free(memo);
+    free(state);
+}
+
+// v1.4: Asset-Referenzen
+// Dateinamen mit Asset-Endung in String-Literalen (ent_create("hero.mdl", ...), level_load("map.wmb"),
+// BMAP* hud = "hud.tga"; ...) und PRAGMA_BIND-Einträge werden beim Parsen gesammelt. Globale
+// Definitionen mit Namen ("BMAP* name = ..." oder "#define NAME ...") gehören zu diesem Namen und
+// werden von jeder Funktion erreicht, die ihn verwendet. Aufgelöst wird nach dem Parsen aller
+// Dateien (PRAGMA_PATH kann später folgen), die Footprints nach dem Aufrufgraphen.
+static const char* asset_extensions[] = {
+    "mdl", "wmb", "hmp", "wed", "bmp", "tga", "pcx", "dds", "png", "jpg", "jpeg",
+    "wav", "ogg", "mp3", "mid", "avi", "mpg", "wmv", "fx", "fxo", "wrs", "ttf", NULL
+};
+
+typedef struct {
+    AssetReference* refs;
+    int count;
+    int capacity;
+} AssetCollector;
+
+static int has_asset_extension(const char* name) {
+    const char* dot = strrchr(name, '.');
+    if (!dot || strchr(dot, '/')) return 0;
+    for (int i = 0; asset_extensions[i]; i++) {
+        size_t length = strlen(asset_extensions[i]);
+        if (strlen(dot + 1) == length && _strnicmp(dot + 1, asset_extensions[i], length) == 0) return 1;
+    }
+    return 0;
+}
+
+static void add_asset_reference(AssetCollector* collector, const char* name, int line, int caller_line, int owner_id, int is_bind) {
+    if (collector->count == collector->capacity) {
+        collector->capacity = collector->capacity ? collector->capacity * 2 : 16;
+        collector->refs = (AssetReference*)realloc(collector->refs, sizeof(AssetReference) * collector->capacity);
+    }
+    AssetReference* ref = &collector->refs[collector->count++];
+    ref->caller = caller_line;
+    ref->owner_id = owner_id;
+    ref->name_id = intern_string(name);
+    ref->line = line;
+    ref->is_bind = is_bind;
+    ref->asset = -1;
+}
+
+// "#define PRAGMA_BIND "datei"" - wird beim Publizieren mitkopiert
+static int match_pragma_bind(const char* line, char* name) {
+    const char* start = strstr(line, "#define PRAGMA_BIND");
+    if (!start) return 0;
+    start = strchr(start + 19, '"');
+    if (!start) return 0;
+    const char* end = strchr(start + 1, '"');
+    if (!end || end - start - 1 >= MAX_PATH_LEN) return 0;
+    memcpy(name, start + 1, end - start - 1);
+    name[end - start - 1] = '\0';
+    normalize_path_separators(name);
+    return name[0] != '\0';
+}
+
+// Name einer globalen Definition "TYP* name = "..."" / "#define NAME "..."", sonst -1
+static int global_asset_owner(const char* line) {
+    char first[MAX_NAME_LEN], second[MAX_NAME_LEN];
+    const char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (strncmp(p, "#define", 7) == 0) {
+        p += 7;
+        if (sscanf(p, " %127[A-Za-z0-9_] \"", first) == 1) return intern_string(first);
+        return -1;
+    }
+    int length = 0;
+    if (sscanf(p, "%127[A-Za-z0-9_] %*[*] %127[A-Za-z0-9_] =%n", first, second, &length) == 2 ||
+        sscanf(p, "%127[A-Za-z0-9_] %127[A-Za-z0-9_] =%n", first, second, &length) == 2) {
+        if (length > 0) return intern_string(second);
+    }
+    return -1;
+}
+
+// String-Literale einer Zeile; caller_line 0 außerhalb von Funktionen
+static void collect_asset_literals(AssetCollector* collector, const char* text, int line, int caller_line) {
+    int owner_id = -2;              // erst bestimmen, wenn ein Literal passt
+    for (const char* p = text; *p; p++) {
+        if (p[0] == '/' && p[1] == '/') return;
+        if (*p == '\'') {
+            for (p++; *p && *p != '\''; p++) {
+                if (*p == '\\' && p[1]) p++;
+            }
+            if (!*p) return;
+            continue;
+        }
+        if (*p != '"') continue;
+
+        char name[MAX_PATH_LEN];
+        int length = 0;
+        for (p++; *p && *p != '"'; p++) {
+            if (*p == '\\' && p[1]) p++;
+            if (length < MAX_PATH_LEN - 1) name[length++] = *p;
+        }
+        name[length] = '\0';
+        if (length > 0 && has_asset_extension(name)) {
+            normalize_path_separators(name);
+            if (owner_id == -2) owner_id = caller_line ? -1 : global_asset_owner(text);
+            add_asset_reference(collector, name, line, caller_line, owner_id, 0);
+        }
+        if (!*p) return;
+    }
+}
+
+// Definitionszeile -> Symbol-Index wie bei den Aufruf-Referenzen
+static void store_asset_references(int file_index, const AssetCollector* collector) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    analysis->asset_ref_first = ctx->asset_ref_count;
+    for (int i = 0; i < collector->count; i++) {
+        if (ctx->asset_ref_count == ctx->asset_ref_capacity) {
+            ctx->asset_ref_capacity = ctx->asset_ref_capacity ? ctx->asset_ref_capacity * 2 : 256;
+            ctx->asset_refs = (AssetReference*)realloc(ctx->asset_refs, sizeof(AssetReference) * ctx->asset_ref_capacity);
+        }
+        AssetReference ref = collector->refs[i];
+        int caller_line = ref.caller;
+        ref.caller = -1;
+        for (int s = analysis->first_symbol; caller_line > 0 && s < analysis->first_symbol + analysis->symbol_total; s++) {
+            if (ctx->symbols[s].line == caller_line && !ctx->symbols[s].is_prototype) {
+                ref.caller = s;
+                break;
+            }
+        }
+        if (caller_line > 0 && ref.caller < 0) continue;
+        ref.file_index = file_index;
+        ctx->asset_refs[ctx->asset_ref_count++] = ref;
+    }
+    analysis->asset_ref_total = ctx->asset_ref_count - analysis->asset_ref_first;
+}
+
+static void copy_asset_references(int target, int source) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const FileAnalysis* original = &ctx->files[source];
+    analysis->asset_ref_first = ctx->asset_ref_count;
+    for (int i = 0; i < original->asset_ref_total; i++) {
+        if (ctx->asset_ref_count == ctx->asset_ref_capacity) {
+            ctx->asset_ref_capacity = ctx->asset_ref_capacity ? ctx->asset_ref_capacity * 2 : 256;
+            ctx->asset_refs = (AssetReference*)realloc(ctx->asset_refs, sizeof(AssetReference) * ctx->asset_ref_capacity);
+        }
+        AssetReference ref = ctx->asset_refs[original->asset_ref_first + i];
+        if (ref.caller >= 0) ref.caller += analysis->first_symbol - original->first_symbol;
+        ref.file_index = target;
+        ctx->asset_refs[ctx->asset_ref_count++] = ref;
+    }
+    analysis->asset_ref_total = ctx->asset_ref_count - analysis->asset_ref_first;
+}
+
+// Asset-Datei suchen: Arbeitsordner (Projekt-Root), PRAGMA_PATH-Verzeichnisse, Ordner der Quelldatei.
+// Im Projekt über den Snapshot, sonst (z.B. nicht versionierte Assets mit --git-index) auf der Platte.
+static int probe_asset_candidate(const char* candidate, char* found_path, long* size) {
+    int entry = snapshot_find_path(candidate);
+    if (entry >= 0) {
+        if (ctx->tree_entries[entry].is_directory) return 0;
+        strcpy(found_path, ctx->tree_entries[entry].path);
+        *size = ctx->tree_entries[entry].size;
+        return 1;
+    }
+    if (entry == SNAPSHOT_NOT_FOUND && !ctx->use_git_index) return 0;
+    char native_path[MAX_PATH_LEN];
+    strcpy(native_path, candidate);
+    to_native_separators(native_path);
+    long long mtime;
+    if (!get_file_stat(native_path, size, &mtime)) return 0;
+    strcpy(found_path, native_path);
+    return 1;
+}
+
+// Abgeschnittene Kandidaten könnten eine andere Datei treffen: zu lange Pfade gelten als nicht gefunden
+static int candidate_fits(int length) {
+    return length >= 0 && length < MAX_PATH_LEN;
+}
+
+static int resolve_asset_file(const char* name, const char* current_dir) {
+    char candidate[MAX_PATH_LEN], found_path[MAX_PATH_LEN], key[MAX_PATH_LEN + 2];
+    long size = -1;
+    int found = 0;
+    int length = snprintf(candidate, sizeof(candidate), "%s/%s", ctx->base_path, name);
+    found = candidate_fits(length) && probe_asset_candidate(candidate, found_path, &size);
+    for (int i = 0; !found && i < ctx->global_pragma_path_count; i++) {
+        length = snprintf(candidate, sizeof(candidate), "%s/%s/%s", ctx->base_path, ctx->global_pragma_paths[i].path, name);
+        found = candidate_fits(length) && probe_asset_candidate(candidate, found_path, &size);
+    }
+    if (!found) {
+        length = snprintf(candidate, sizeof(candidate), "%s/%s", current_dir, name);
+        found = candidate_fits(length) && probe_asset_candidate(candidate, found_path, &size);
+    }
+
+    // Schlüssel: relativer Pfad, fehlende Assets mit '?' vor dem Namen
+    if (found) get_relative_file_path(found_path, key);
+    else snprintf(key, sizeof(key), "?%s", name);
+    int asset = hash_index_find(&ctx->asset_index, key);
+    if (asset >= 0) return asset;
+
+    ctx->asset_files = (AssetFile*)realloc(ctx->asset_files, sizeof(AssetFile) * (ctx->asset_file_count + 1));
+    asset = ctx->asset_file_count++;
+    ctx->asset_files[asset].path_id = intern_string(found ? key : name);
+    ctx->asset_files[asset].size = found ? size : -1;
+    hash_index_put(&ctx->asset_index, key, asset);
+    return asset;
+}
+
+static void resolve_asset_references() {
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        char current_dir[MAX_PATH_LEN];
+        strcpy(current_dir, analysis->filepath);
+        normalize_path_separators(current_dir);
+        char* last_slash = strrchr(current_dir, '/');
+        if (last_slash) *last_slash = '\0';
+        for (int r = analysis->asset_ref_first; r < analysis->asset_ref_first + analysis->asset_ref_total; r++) {
+            ctx->asset_refs[r].asset = resolve_asset_file(interned_string(ctx->asset_refs[r].name_id), current_dir);
+        }
+    }
+}
+
+static int compare_asset_footprints(const void* a, const void* b) {
+    const AssetFootprint* x = (const AssetFootprint*)a;
+    const AssetFootprint* y = (const AssetFootprint*)b;
+    if (x->bytes != y->bytes) return x->bytes < y->bytes ? 1 : -1;
+    return x->symbol - y->symbol;
+}
+
+// Größte Assets eines Footprints merken (absteigend)
+static void note_largest_asset(AssetFootprint* footprint, int asset) {
+    long size = ctx->asset_files[asset].size;
+    for (int k = 0; k < ASSET_LARGEST_SHOWN; k++) {
+        int current = footprint->largest[k];
+        if (current >= 0 && ctx->asset_files[current].size >= size) continue;
+        for (int m = ASSET_LARGEST_SHOWN - 1; m > k; m--) footprint->largest[m] = footprint->largest[m - 1];
+        footprint->largest[k] = asset;
+        return;
+    }
+}
+
+// Footprint je Action und main(): alle verschiedenen Assets, die über Aufrufe, Funktionszeiger
+// und verwendete globale Asset-Definitionen erreichbar sind
+static void compute_asset_footprints() {
+    free(ctx->asset_footprints);
+    ctx->asset_footprints = NULL;
+    ctx->asset_footprint_count = 0;
+    ctx->global_asset_count = 0;
+    ctx->global_asset_bytes = 0;
+    if (ctx->asset_ref_count == 0) return;
+
+    // Eigene Literale je Symbol und globale Definitionen je Name als verkettete Listen
+    int* symbol_first = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    int* owner_first = (int*)malloc(sizeof(int) * (ctx->string_pool_count + 1));
+    int* next_ref = (int*)malloc(sizeof(int) * (ctx->asset_ref_count + 1));
+    for (int s = 0; s < ctx->symbol_count; s++) symbol_first[s] = -1;
+    for (int i = 0; i < ctx->string_pool_count; i++) owner_first[i] = -1;
+    int* asset_stamp = (int*)calloc(ctx->asset_file_count + 1, sizeof(int));
+    int* symbol_stamp = (int*)calloc(ctx->symbol_count + 1, sizeof(int));
+    int* queue = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    int* owner_use_first = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    int* next_owner_use = (int*)malloc(sizeof(int) * (ctx->call_ref_count + 1));
+    int serial = 1;
+
+    for (int r = ctx->asset_ref_count - 1; r >= 0; r--) {
+        const AssetReference* ref = &ctx->asset_refs[r];
+        if (ref->asset < 0) continue;
+        if (ref->caller >= 0) {
+            next_ref[r] = symbol_first[ref->caller];
+            symbol_first[ref->caller] = r;
+        } else if (ref->owner_id >= 0) {
+            next_ref[r] = owner_first[ref->owner_id];
+            owner_first[ref->owner_id] = r;
+        } else if (asset_stamp[ref->asset] != serial) {
+            // PRAGMA_BIND und unbenannte globale Literale: immer geladen bzw. mitgeliefert
+            asset_stamp[ref->asset] = serial;
+            ctx->global_asset_count++;
+            if (ctx->asset_files[ref->asset].size > 0) ctx->global_asset_bytes += ctx->asset_files[ref->asset].size;
+        }
+    }
+    // Rumpf-Referenzen auf benannte globale Asset-Definitionen je Symbol
+    for (int s = 0; s < ctx->symbol_count; s++) owner_use_first[s] = -1;
+    for (int c = ctx->call_ref_count - 1; c >= 0; c--) {
+        const CallReference* call = &ctx->call_refs[c];
+        if (call->caller < 0 || owner_first[call->name_id] < 0) continue;
+        next_owner_use[c] = owner_use_first[call->caller];
+        owner_use_first[call->caller] = c;
+    }
+
+    for (int root = 0; root < ctx->symbol_count; root++) {
+        const SymbolDefinition* symbol = &ctx->symbols[root];
+        if (symbol->is_prototype) continue;
+        if (symbol->kind != SYMBOL_ACTION && strcmp(interned_string(symbol->name_id), "main") != 0) continue;
+        const FileAnalysis* file = &ctx->files[symbol->file_index];
+        if ((!file->is_used && ctx->use_include_tracking) || file->duplicate_of >= 0) continue;
+
+        AssetFootprint footprint;
+        memset(&footprint, 0, sizeof(footprint));
+        footprint.symbol = root;
+        for (int k = 0; k < ASSET_LARGEST_SHOWN; k++) footprint.largest[k] = -1;
+        serial++;
+        int head = 0, tail = 0;
+        queue[tail++] = root;
+        symbol_stamp[root] = serial;
+        while (head < tail) {
+            int s = queue[head++];
+            for (int r = symbol_first[s]; r >= 0; r = next_ref[r]) {
+                if (asset_stamp[ctx->asset_refs[r].asset] == serial) continue;
+                asset_stamp[ctx->asset_refs[r].asset] = serial;
+                footprint.asset_count++;
+                if (ctx->asset_files[ctx->asset_refs[r].asset].size > 0) {
+                    footprint.bytes += ctx->asset_files[ctx->asset_refs[r].asset].size;
+                }
+                note_largest_asset(&footprint, ctx->asset_refs[r].asset);
+            }
+            for (int c = owner_use_first[s]; c >= 0; c = next_owner_use[c]) {
+                for (int r = owner_first[ctx->call_refs[c].name_id]; r >= 0; r = next_ref[r]) {
+                    if (asset_stamp[ctx->asset_refs[r].asset] == serial) continue;
+                    asset_stamp[ctx->asset_refs[r].asset] = serial;
+                    footprint.asset_count++;
+                    if (ctx->asset_files[ctx->asset_refs[r].asset].size > 0) {
+                        footprint.bytes += ctx->asset_files[ctx->asset_refs[r].asset].size;
+                    }
+                    note_largest_asset(&footprint, ctx->asset_refs[r].asset);
+                }
+            }
+            for (int e = ctx->call_graph.first_edge[s]; e < ctx->call_graph.first_edge[s + 1]; e++) {
+                int target = ctx->call_graph.edge_target[e];
+                if (symbol_stamp[target] == serial) continue;
+                symbol_stamp[target] = serial;
+                queue[tail++] = target;
+            }
+        }
+
+        if (footprint.asset_count == 0) continue;
+        ctx->asset_footprints = (AssetFootprint*)realloc(ctx->asset_footprints,
+                                                         sizeof(AssetFootprint) * (ctx->asset_footprint_count + 1));
+        ctx->asset_footprints[ctx->asset_footprint_count++] = footprint;
+    }
+    if (ctx->asset_footprint_count > 1) {
+        qsort(ctx->asset_footprints, ctx->asset_footprint_count, sizeof(AssetFootprint), compare_asset_footprints);
+    }
+
+    free(symbol_first);
+    free(owner_first);
+    free(next_ref);
+    free(asset_stamp);
+    free(symbol_stamp);
+    free(queue);
+    free(owner_use_first);
+    free(next_owner_use);
+}
+
+// v1.4: Parse-Cache
+// Speichert je Datei die Parse-Ergebnisse (Elemente, Rumpf-Referenzen, Makro-Verwendungen,
+// Include-Nutzung) als Textzeilen. Eine Datei wird wiederverwendet, wenn sie unverändert ist
+// (Blob-ID aus dem Git-Index oder Inhalts-Hash) und keine Datei ihrer Include-Hülle sich
+// geändert hat; mit changed_since zählen zusätzlich alle Dateien aus "git diff" als geändert.
+// Wiederverwendete Dateien werden wie identische Kopien abgespielt (replay_file_events).
+//   F <pfad> <blob|-> <bytes> <hash> <zeilen> <guard>
+//   I <zeile> <nutzung> <backslash> <typ> <name> <ziel>     E <art> <zeile> <prototyp> <kontext> <name>
+//   M <zeile> <name> <body>    P <zeile> <backslash> <pfad>    C <definition> <zeile> <anzahl> <name>
+//   U <zeile> <anzahl> <makro>    S <zeile> <name> <tag>, danach je Member D <zeile> <zeiger> <typ> <name> <dims|->
+//   V <zeile> <zeiger> <typ> <name> <dims|-> (statische Variable)
+//   W <zeile> <funktion> (Frame-Schleife), danach je Aufruf X <zeile> <verschachtelung> <anzahl> <name>
+//   A <definition|0> <zeile> <bind> <besitzer|-> <datei> (Asset-Referenz)
+//   T <include> <typ> (nur über Zeiger verwendeter Typ, include: Index der I-Zeile)
+#define PARSE_CACHE_VERSION 6
+
+static const char* parse_cache_element_kinds = "vfastx";
+
+// Zerlegt eine Cache-Zeile an Tabulatoren (in place)
+static int split_cache_fields(char* line, char** fields, int max) {
+    int count = 0;
+    fields[count++] = line;
+    for (char* p = line; *p && count < max; p++) {
+        if (*p == '\t') {
+            *p = '\0';
+            fields[count++] = p + 1;
+        }
+    }
+    return count;
+}
+
+// Nächste nicht leere Zeile eines Eintrags (die Anzahl steht in record_lines)
+static const char* next_cache_line(const char* line) {
+    line += strlen(line) + 1;
+    while (!*line) line++;
+    return line;
+}
+
+static void append_cache_field(TextBuffer* buffer, const char* text) {
+    char clean[MAX_LINE_LEN + MAX_PATH_LEN];
+    int len = 0;
+    for (; *text && len < (int)sizeof(clean) - 1; text++) {
+        clean[len++] = (*text == '\t' || *text == '\n' || *text == '\r') ? ' ' : *text;
+    }
+    clean[len] = '\0';
+    buffer_append(buffer, "\t%s", clean);
+}
+
+static void load_parse_cache() {
+    long size = 0;
+    char* text = NULL;
+    if (ctx->keep_parse_cache && ctx->memory_parse_cache) {
+        // Verlauf/Server: Cache des vorigen Laufs aus dem Speicher übernehmen
+        text = ctx->memory_parse_cache;
+        size = ctx->memory_parse_cache_size;
+        ctx->memory_parse_cache = NULL;
+    } else if (ctx->history_commit[0] || !ctx->parse_cache_file[0]) {
+        return;
+    } else {
+        text = read_file_from_disk(ctx->parse_cache_file, &size);
+        if (!text) {
+            analyzer_log("Parse cache %s not found - parsing all files\n", ctx->parse_cache_file);
+            return;
+        }
+    }
+    int version = 0;
+    if (sscanf(text, "ANALYZER PARSE CACHE %d", &version) != 1 || version != PARSE_CACHE_VERSION) {
+        analyzer_log("Warning: Ignoring parse cache %s (unknown format)\n", ctx->parse_cache_file);
+        free(text);
+        return;
+    }
+
+    ctx->parse_cache_text = text;
+    for (long i = 0; i < size; i++) {
+        if (text[i] == '\n' || text[i] == '\r') text[i] = '\0';
+    }
+    int current = -1;
+    char* end = text + size;
+    for (char* line = text + strlen(text) + 1; line < end; ) {
+        char* next = line + strlen(line) + 1;
+        if (line[0] == 'F' && line[1] == '\t') {
+            char* fields[8];
+            current = -1;
+            if (split_cache_fields(line, fields, 8) == 7) {
+                if (ctx->parse_cache_count == ctx->parse_cache_capacity) {
+                    ctx->parse_cache_capacity = ctx->parse_cache_capacity ? ctx->parse_cache_capacity * 2 : 256;
+                    ctx->parse_cache = (ParseCacheEntry*)realloc(ctx->parse_cache,
+                                                                 sizeof(ParseCacheEntry) * ctx->parse_cache_capacity);
+                }
+                current = ctx->parse_cache_count++;
+                ParseCacheEntry* entry = &ctx->parse_cache[current];
+                memset(entry, 0, sizeof(ParseCacheEntry));
+                entry->path = fields[1];
+                if (strcmp(fields[2], "-") != 0) snprintf(entry->blob, sizeof(entry->blob), "%s", fields[2]);
+                entry->file_size = strtol(fields[3], NULL, 10);
+                entry->content_hash = strtoull(fields[4], NULL, 16);
+                entry->line_count = atoi(fields[5]);
+                entry->has_include_guard = atoi(fields[6]);
+                hash_index_put(&ctx->parse_cache_index, entry->path, current);
+            }
+        } else if (line[0] && current >= 0) {
+            if (!ctx->parse_cache[current].record) ctx->parse_cache[current].record = line;
+            ctx->parse_cache[current].record_lines++;
+        }
+        line = next;
+    }
+}
+
+// Dateien, die sich seit revision geändert haben (Arbeitsverzeichnis gegen revision), mit Pfaden
+// relativ zu base_path. 0, wenn git nicht aufgerufen werden konnte.
+static int collect_changed_files(const char* revision, HashIndex* changed) {
+    if (!is_safe_revision(revision)) return 0;
+
+    char command[MAX_PATH_LEN + MAX_NAME_LEN + 96];
+    snprintf(command, sizeof(command), "git -C \"%s\" -c core.quotepath=off diff --name-only --relative %s --",
+             ctx->base_path, revision);
+    FILE* pipe = _popen(command, "r");
+    if (!pipe) return 0;
+    char line[MAX_PATH_LEN];
+    while (fgets(line, sizeof(line), pipe)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0]) hash_index_put(changed, line, 1);
+    }
+    return _pclose(pipe) == 0;
+}
+
+static int parse_cache_entry_unchanged(const ParseCacheEntry* entry) {
+    char path[MAX_PATH_LEN];
+    if (snprintf(path, sizeof(path), "%s/%s", ctx->base_path, entry->path) >= (int)sizeof(path)) return 0;
+    int tree_entry = snapshot_find_path(path);
+    if (tree_entry < 0 || ctx->tree_entries[tree_entry].is_directory) return 0;
+    const TreeEntry* file = &ctx->tree_entries[tree_entry];
+
+    // Mit Git-Index: gleiche Blob-ID und die Datei entspricht dem Index - ohne sie zu lesen
+    long size = 0;
+    long long mtime = 0;
+    if (entry->blob[0] && file->blob[0]) {
+        if (strcmp(entry->blob, file->blob) != 0) return 0;
+        if (ctx->history_commit[0]) return 1;   // Verlauf: der Blob ist der Inhalt
+        if (get_file_stat(file->path, &size, &mtime) && size == file->size && mtime == file->mtime) return 1;
+    }
+    if (ctx->history_commit[0]) return 0;
+    char* content = read_file_from_disk(file->path, &size);
+    int same = content && size == entry->file_size && hash_content(content, size) == entry->content_hash;
+    free(content);
+    return same;
+}
+
+// Cache laden und festlegen, welche Einträge wiederverwendet werden dürfen
+static void prepare_parse_cache() {
+    ctx->parse_cache_hits = 0;
+    if (!ctx->parse_cache_file[0] && !ctx->keep_parse_cache) return;
+    load_parse_cache();
+    if (ctx->parse_cache_count == 0) return;
+
+    HashIndex changed;
+    memset(&changed, 0, sizeof(HashIndex));
+    int changes_known = 1;
+    if (ctx->reanalyze_file[0]) {
+        // Server: der Client meldet die geänderte Datei, die übrigen werden nicht gelesen
+        hash_index_put(&changed, ctx->reanalyze_file, 1);
+    } else if (ctx->changed_since[0] && !ctx->history_commit[0]) {
+        changes_known = collect_changed_files(ctx->changed_since, &changed);
+        if (changes_known) analyzer_log("Changed since %s: %d files\n", ctx->changed_since, changed.count);
+        else analyzer_log("Warning: Could not list changes since %s - parsing all files\n", ctx->changed_since);
+    }
+    for (int e = 0; e < ctx->parse_cache_count; e++) {
+        ParseCacheEntry* entry = &ctx->parse_cache[e];
+        entry->reusable = changes_known && hash_index_find(&changed, entry->path) < 0 &&
+                          (ctx->reanalyze_file[0] || parse_cache_entry_unchanged(entry));
+    }
+    hash_index_free(&changed);
+
+    // Wer eine geänderte Datei (transitiv) inkludiert, wird ebenfalls neu geparst:
+    // Makro-Verwendungen und Include-Nutzung hängen vom Inhalt der Includes ab
+    int* edges = NULL;
+    int edge_count = 0, edge_capacity = 0;
+    char buffer[MAX_LINE_LEN * 3];
+    char* fields[8];
+    for (int e = 0; e < ctx->parse_cache_count; e++) {
+        const char* line = ctx->parse_cache[e].record;
+        for (int n = 0; n < ctx->parse_cache[e].record_lines; n++) {
+            if (n > 0) line = next_cache_line(line);
+            if (line[0] != 'I') continue;
+            snprintf(buffer, sizeof(buffer), "%s", line);
+            if (split_cache_fields(buffer, fields, 8) != 7) continue;
+            int target = hash_index_find(&ctx->parse_cache_index, fields[6]);
+            if (target < 0 || target == e) continue;
+            if (edge_count + 2 > edge_capacity) {
+                edge_capacity = edge_capacity ? edge_capacity * 2 : 1024;
+                edges = (int*)realloc(edges, sizeof(int) * edge_capacity);
+            }
+            edges[edge_count++] = target;
+            edges[edge_count++] = e;
+        }
+    }
+    for (int changes = 1; changes; ) {
+        changes = 0;
+        for (int k = 0; k < edge_count; k += 2) {
+            if (!ctx->parse_cache[edges[k]].reusable && ctx->parse_cache[edges[k + 1]].reusable) {
+                ctx->parse_cache[edges[k + 1]].reusable = 0;
+                changes = 1;
+            }
+        }
+    }
+    free(edges);
+
+    int reusable = 0;
+    for (int e = 0; e < ctx->parse_cache_count; e++) reusable += ctx->parse_cache[e].reusable;
+    analyzer_log("Parse cache: %d of %d cached files unchanged\n", reusable, ctx->parse_cache_count);
+}
+
+static int reusable_parse_cache_entry(const char* filepath) {
+    if (ctx->parse_cache_count == 0) return -1;
+    char path[MAX_PATH_LEN];
+    get_relative_file_path(filepath, path);
+    int entry = hash_index_find(&ctx->parse_cache_index, path);
+    return entry >= 0 && ctx->parse_cache[entry].reusable ? entry : -1;
+}
+
+// T-Zeilen gelten nur, solange das Include weiterhin nur über Zeiger verwendet wird
+static void restore_forward_declarations(FileAnalysis* analysis, const ParseCacheEntry* entry) {
+    char buffer[MAX_LINE_LEN * 3];
+    char* fields[4];
+    analysis->forward_decl_first = ctx->forward_decl_count;
+    const char* line = entry->record;
+    for (int n = 0; n < entry->record_lines; n++) {
+        if (n > 0) line = next_cache_line(line);
+        if (line[0] != 'T') continue;
+        snprintf(buffer, sizeof(buffer), "%s", line);
+        if (split_cache_fields(buffer, fields, 4) != 3) continue;
+        int slot = atoi(fields[1]);
+        if (slot < 0 || slot >= analysis->include_count || analysis->includes[slot].usage != INCLUDE_USAGE_POINTER_ONLY) continue;
+        add_forward_declaration(slot, intern_string(fields[2]));
+    }
+    analysis->forward_decl_total = ctx->forward_decl_count - analysis->forward_decl_first;
+}
+
+// Elemente, Referenzen und Makro-Verwendungen aus dem Cache übernehmen und in Zeilenreihenfolge
+// registrieren - wie bei einer identischen Kopie
+static void restore_cached_parse(int target, int cache_index, const char* current_dir, int depth) {
+    FileAnalysis* analysis = &ctx->files[target];
+    const ParseCacheEntry* entry = &ctx->parse_cache[cache_index];
+    analysis->line_count = entry->line_count;
+
+    CodeElement* element_lists[6] = { analysis->void_functions, analysis->functions, analysis->actions,
+                                      analysis->structs, analysis->typedef_structs, analysis->static_vars };
+    int* element_counts[6] = { &analysis->void_function_count, &analysis->function_count, &analysis->action_count,
+                               &analysis->struct_count, &analysis->typedef_struct_count, &analysis->static_var_count };
+    const char* element_types[6] = { "void", "function", "action", "struct", "typedef_struct", "static" };
+    int macro_body_ids[MAX_ITEMS_PER_FILE];
+    unsigned char cached_usage[MAX_ITEMS_PER_FILE];
+    unsigned int cached_target[MAX_ITEMS_PER_FILE];
+    CallCollector calls;
+    memset(&calls, 0, sizeof(CallCollector));
+    CallCollector macro_refs;       // name_id = Makroname
+    memset(&macro_refs, 0, sizeof(CallCollector));
+    LayoutCollector layouts;
+    init_layout_collector(&layouts);
+    HotLoopCollector hot_loops;     // Frame-Schleifen mit bereits zugeordneten Aufrufen
+    memset(&hot_loops, 0, sizeof(HotLoopCollector));
+    AssetCollector assets;
+    memset(&assets, 0, sizeof(AssetCollector));
+
+    char buffer[MAX_LINE_LEN * 3];
+    char* fields[8];
+    const char* line = entry->record;
+    for (int n = 0; n < entry->record_lines; n++) {
+        if (n > 0) line = next_cache_line(line);
+        snprintf(buffer, sizeof(buffer), "%s", line);
+        int field_count = split_cache_fields(buffer, fields, 8);
+
+        if (buffer[0] == 'I' && field_count == 7 && analysis->include_count < MAX_ITEMS_PER_FILE) {
+            int k = analysis->include_count++;
+            IncludeElement* include_elem = &analysis->includes[k];
+            memset(include_elem, 0, sizeof(IncludeElement));
+            include_elem->target_index = -1;
+            include_elem->line = atoi(fields[1]);
+            cached_usage[k] = (unsigned char)atoi(fields[2]);
+            include_elem->has_backslash = atoi(fields[3]);
+            snprintf(include_elem->type, sizeof(include_elem->type), "%s", fields[4]);
+            snprintf(include_elem->name, sizeof(include_elem->name), "%s", fields[5]);
+            cached_target[k] = hash_string(fields[6]);
+        } else if (buffer[0] == 'E' && field_count == 6) {
+            const char* kind = strchr(parse_cache_element_kinds, fields[1][0]);
+            if (!kind || !fields[1][0]) continue;
+            int list = (int)(kind - parse_cache_element_kinds);
+            if (*element_counts[list] >= MAX_ITEMS_PER_FILE) continue;
+            CodeElement* elem = &element_lists[list][(*element_counts[list])++];
+            memset(elem, 0, sizeof(CodeElement));
+            elem->line = atoi(fields[2]);
+            elem->is_prototype = atoi(fields[3]);
+            strcpy(elem->type, element_types[list]);
+            snprintf(elem->function_context, sizeof(elem->function_context), "%s", fields[4]);
+            snprintf(elem->name, sizeof(elem->name), "%s", fields[5]);
+        } else if (buffer[0] == 'M' && field_count == 5 && analysis->macro_count < MAX_ITEMS_PER_FILE) {
+            macro_body_ids[analysis->macro_count] = intern_string(fields[4]);
+            add_macro_element(analysis, fields[3], fields[4], atoi(fields[2]), atoi(fields[1]), -1);
+        } else if (buffer[0] == 'P' && field_count == 4 && analysis->pragma_path_count < MAX_PRAGMA_PATHS) {
+            PragmaPath* pp = &analysis->pragma_paths[analysis->pragma_path_count++];
+            memset(pp, 0, sizeof(PragmaPath));
+            pp->line = atoi(fields[1]);
+            pp->has_backslash = atoi(fields[2]);
+            snprintf(pp->path, sizeof(pp->path), "%s", fields[3]);
+        } else if ((buffer[0] == 'C' && field_count == 5) || (buffer[0] == 'U' && field_count == 4)) {
+            CallCollector* refs = buffer[0] == 'C' ? &calls : &macro_refs;
+            if (refs->count == refs->capacity) {
+                refs->capacity = refs->capacity ? refs->capacity * 2 : 64;
+                refs->refs = (CallReference*)realloc(refs->refs, sizeof(CallReference) * refs->capacity);
+            }
+            CallReference* ref = &refs->refs[refs->count++];
+            int offset = buffer[0] == 'C' ? 1 : 0;
+            ref->caller = offset ? atoi(fields[1]) : 0;
+            ref->line = atoi(fields[1 + offset]);
+            ref->count = atoi(fields[2 + offset]);
+            ref->name_id = intern_string(fields[3 + offset]);
+        } else if (buffer[0] == 'S' && field_count == 4) {
+            open_struct_layout(&layouts, fields[3], 0, atoi(fields[1]));
+            layouts.layouts[layouts.open_layout].name_id = intern_string(fields[2]);
+        } else if ((buffer[0] == 'D' && field_count == 6 && layouts.open_layout >= 0) || (buffer[0] == 'V' && field_count == 6)) {
+            DataMember member;
+            memset(&member, 0, sizeof(DataMember));
+            member.line = atoi(fields[1]);
+            member.is_pointer = atoi(fields[2]);
+            member.type_id = intern_string(fields[3]);
+            member.name_id = intern_string(fields[4]);
+            member.dims_id = strcmp(fields[5], "-") == 0 ? -1 : intern_string(fields[5]);
+            if (buffer[0] == 'V') {
+                append_data_member(&layouts.statics, &layouts.static_count, &layouts.static_capacity, &member);
+            } else {
+                append_data_member(&layouts.members, &layouts.member_count, &layouts.member_capacity, &member);
+                layouts.layouts[layouts.open_layout].member_count++;
+            }
+        } else if (buffer[0] == 'W' && field_count == 3) {
+            hot_loops.function_name_id = intern_string(fields[2]);
+            begin_source_loop(&hot_loops, atoi(fields[1]), 0);
+            hot_loops.loops[hot_loops.loop_count - 1].has_wait = 1;
+            hot_loops.stack_depth = 0;
+        } else if (buffer[0] == 'X' && field_count == 5 && hot_loops.loop_count > 0) {
+            LoopCall call;
+            memset(&call, 0, sizeof(LoopCall));
+            call.loop = hot_loops.loop_count - 1;
+            call.line = atoi(fields[1]);
+            call.nesting = atoi(fields[2]);
+            call.count = atoi(fields[3]);
+            call.name_id = intern_string(fields[4]);
+            append_loop_call(&hot_loops.calls, &hot_loops.call_count, &hot_loops.call_capacity, &call);
+        } else if (buffer[0] == 'A' && field_count == 6) {
+            int owner_id = strcmp(fields[4], "-") == 0 ? -1 : intern_string(fields[4]);
+            add_asset_reference(&assets, fields[5], atoi(fields[2]), atoi(fields[1]), owner_id, atoi(fields[3]));
+        }
+    }
+
+    replay_file_events(target, current_dir, depth, macro_body_ids);
+
+    // Nutzung nur übernehmen, wenn das Include noch dieselbe Datei trifft
+    char path[MAX_PATH_LEN];
+    for (int k = 0; k < analysis->include_count; k++) {
+        int include_target = analysis->includes[k].target_index;
+        if (include_target >= 0) get_relative_file_path(ctx->files[include_target].filepath, path);
+        else path[0] = '\0';
+        analysis->includes[k].usage = hash_string(path) == cached_target[k] ? cached_usage[k] : INCLUDE_USAGE_UNKNOWN;
+    }
+    restore_forward_declarations(analysis, entry);
+
+    finish_file_analysis(target, &calls);
+    MacroUseCollector macro_collector;
+    memset(&macro_collector, 0, sizeof(MacroUseCollector));
+    for (int i = 0; i < macro_refs.count; i++) {
+        int definition = hash_index_find(&ctx->macro_index, interned_string(macro_refs.refs[i].name_id));
+        if (definition >= 0) add_macro_use(&macro_collector, definition, macro_refs.refs[i].line, macro_refs.refs[i].count);
+    }
+    store_macro_uses(target, &macro_collector);
+    store_struct_layouts(target, &layouts);
+    store_frame_loops(target, &hot_loops);
+    store_asset_references(target, &assets);
+    free(calls.refs);
+    free(macro_refs.refs);
+    free(macro_collector.uses);
+    free_layout_collector(&layouts);
+    free(hot_loops.loops);
+    free(hot_loops.calls);
+    free(assets.refs);
+}
+
+static void append_cache_member(TextBuffer* buffer, char kind, const DataMember* member) {
+    buffer_append(buffer, "%c\t%d\t%d", kind, member->line, member->is_pointer);
+    append_cache_field(buffer, interned_string(member->type_id));
+    append_cache_field(buffer, interned_string(member->name_id));
+    append_cache_field(buffer, member->dims_id >= 0 ? interned_string(member->dims_id) : "-");
+    buffer_append(buffer, "\n");
+}
+
+static void append_cache_elements(TextBuffer* buffer, char kind, const CodeElement* elems, int count) {
+    for (int i = 0; i < count; i++) {
+        buffer_append(buffer, "E\t%c\t%d\t%d", kind, elems[i].line, elems[i].is_prototype);
+        append_cache_field(buffer, elems[i].function_context);
+        append_cache_field(buffer, elems[i].name);
+        buffer_append(buffer, "\n");
+    }
+}
+
+// Nach dem Parsen, vor den globalen Auswertungen (die Referenzen zeigen noch auf Symbole)
+static void save_parse_cache() {
+    if (ctx->streaming_mode) {
+        analyzer_log("Parse cache not written: file details are freed in streaming mode\n");
+        return;
+    }
+    TextBuffer buffer;
+    memset(&buffer, 0, sizeof(TextBuffer));
+    buffer_append(&buffer, "ANALYZER PARSE CACHE %d\n", PARSE_CACHE_VERSION);
+
+    char path[MAX_PATH_LEN];
+    for (int i = 0; i < ctx->file_count; i++) {
+        const FileAnalysis* analysis = &ctx->files[i];
+        if (!analysis->parse_complete || !analysis->elements) continue;
+
+        // Blob-ID nur, wenn die Datei auf der Platte dem Index entspricht
+        const char* blob = "-";
+        int tree_entry = snapshot_find_path(analysis->filepath);
+        long size = 0;
+        long long mtime = 0;
+        if (tree_entry >= 0 && ctx->tree_entries[tree_entry].blob[0] &&
+            (ctx->history_commit[0] || (get_file_stat(analysis->filepath, &size, &mtime) &&
+                                        size == ctx->tree_entries[tree_entry].size &&
+                                        mtime == ctx->tree_entries[tree_entry].mtime))) {
+            blob = ctx->tree_entries[tree_entry].blob;
+        }
+        get_relative_file_path(analysis->filepath, path);
+        buffer_append(&buffer, "F");
+        append_cache_field(&buffer, path);
+        buffer_append(&buffer, "\t%s\t%ld\t%016llx\t%d\t%d\n", blob, analysis->file_size, analysis->content_hash,
+                      analysis->line_count, analysis->has_include_guard);
+
+        for (int k = 0; k < analysis->include_count; k++) {
+            const IncludeElement* include_elem = &analysis->includes[k];
+            buffer_append(&buffer, "I\t%d\t%d\t%d", include_elem->line, include_elem->usage, include_elem->has_backslash);
+            append_cache_field(&buffer, include_elem->type);
+            append_cache_field(&buffer, include_elem->name);
+            if (include_elem->target_index >= 0) get_relative_file_path(ctx->files[include_elem->target_index].filepath, path);
+            else path[0] = '\0';
+            append_cache_field(&buffer, path);
+            buffer_append(&buffer, "\n");
+        }
+        for (int k = analysis->forward_decl_first; k < analysis->forward_decl_first + analysis->forward_decl_total; k++) {
+            buffer_append(&buffer, "T\t%d", ctx->forward_decls[k].include_slot);
+            append_cache_field(&buffer, interned_string(ctx->forward_decls[k].name_id));
+            buffer_append(&buffer, "\n");
+        }
+        append_cache_elements(&buffer, 'v', analysis->void_functions, analysis->void_function_count);
+        append_cache_elements(&buffer, 'f', analysis->functions, analysis->function_count);
+        append_cache_elements(&buffer, 'a', analysis->actions, analysis->action_count);
+        append_cache_elements(&buffer, 's', analysis->structs, analysis->struct_count);
+        append_cache_elements(&buffer, 't', analysis->typedef_structs, analysis->typedef_struct_count);
+        append_cache_elements(&buffer, 'x', analysis->static_vars, analysis->static_var_count);
+        for (int k = 0; k < analysis->macro_count; k++) {
+            buffer_append(&buffer, "M\t%d\t%d", analysis->macros[k].line, analysis->macros[k].has_parameters);
+            append_cache_field(&buffer, analysis->macros[k].name);
+            append_cache_field(&buffer, interned_string(ctx->macro_defs[analysis->macros[k].definition].body_id));
+            buffer_append(&buffer, "\n");
+        }
+        for (int k = 0; k < analysis->pragma_path_count; k++) {
+            buffer_append(&buffer, "P\t%d\t%d", analysis->pragma_paths[k].line, analysis->pragma_paths[k].has_backslash);
+            append_cache_field(&buffer, analysis->pragma_paths[k].path);
+            buffer_append(&buffer, "\n");
+        }
+        for (int r = analysis->call_ref_first; r < analysis->call_ref_first + analysis->call_ref_total; r++) {
+            const CallReference* ref = &ctx->call_refs[r];
+            buffer_append(&buffer, "C\t%d\t%d\t%d", ctx->symbols[ref->caller].line, ref->line, ref->count);
+            append_cache_field(&buffer, interned_string(ref->name_id));
+            buffer_append(&buffer, "\n");
+        }
+        for (int u = analysis->macro_use_first; u < analysis->macro_use_first + analysis->macro_use_total; u++) {
+            const MacroUse* use = &ctx->macro_uses[u];
+            buffer_append(&buffer, "U\t%d\t%d", use->line, use->count);
+            append_cache_field(&buffer, interned_string(ctx->macro_defs[use->definition].name_id));
+            buffer_append(&buffer, "\n");
+        }
+        for (int l = analysis->struct_layout_first; l < analysis->struct_layout_first + analysis->struct_layout_total; l++) {
+            const StructLayout* layout = &ctx->struct_layouts[l];
+            buffer_append(&buffer, "S\t%d", layout->line);
+            append_cache_field(&buffer, interned_string(layout->name_id));
+            append_cache_field(&buffer, layout->tag_id >= 0 ? interned_string(layout->tag_id) : "");
+            buffer_append(&buffer, "\n");
+            for (int m = layout->member_first; m < layout->member_first + layout->member_count; m++) {
+                append_cache_member(&buffer, 'D', &ctx->data_members[m]);
+            }
+        }
+        for (int v = analysis->static_storage_first; v < analysis->static_storage_first + analysis->static_storage_total; v++) {
+            append_cache_member(&buffer, 'V', &ctx->data_members[v]);
+        }
+        for (int l = analysis->frame_loop_first; l < analysis->frame_loop_first + analysis->frame_loop_total; l++) {
+            const FrameLoop* loop = &ctx->frame_loops[l];
+            buffer_append(&buffer, "W\t%d", loop->line);
+            append_cache_field(&buffer, interned_string(loop->function_name_id));
+            buffer_append(&buffer, "\n");
+            for (int c = loop->call_first; c < loop->call_first + loop->call_count; c++) {
+                const LoopCall* call = &ctx->loop_calls[c];
+                buffer_append(&buffer, "X\t%d\t%d\t%d", call->line, call->nesting, call->count);
+                append_cache_field(&buffer, interned_string(call->name_id));
+                buffer_append(&buffer, "\n");
+            }
+        }
+        for (int r = analysis->asset_ref_first; r < analysis->asset_ref_first + analysis->asset_ref_total; r++) {
+            const AssetReference* ref = &ctx->asset_refs[r];
+            buffer_append(&buffer, "A\t%d\t%d\t%d", ref->caller >= 0 ? ctx->symbols[ref->caller].line : 0,
+                          ref->line, ref->is_bind);
+            append_cache_field(&buffer, ref->owner_id >= 0 ? interned_string(ref->owner_id) : "-");
+            append_cache_field(&buffer, interned_string(ref->name_id));
+            buffer_append(&buffer, "\n");
+        }
+    }
+
+    if (ctx->keep_parse_cache) {
+        // Verlauf/Server: für den nächsten Lauf im Speicher behalten
+        free(ctx->memory_parse_cache);
+        ctx->memory_parse_cache = buffer.data;
+        ctx->memory_parse_cache_size = (long)buffer.length;
+        return;
+    }
+    if (write_if_changed(ctx->parse_cache_file, &buffer) < 0) {
+        analyzer_log("Error: Could not write parse cache %s\n", ctx->parse_cache_file);
+    }
+    buffer_free(&buffer);
+}
+
+// Hauptanalyse-Funktion - liefert den Index in files[] oder -1
+static int analyze_file_with_includes(const char* filepath, int depth) {
+    if (depth > 10) {
+        analyzer_log("Warning: Include depth limit reached for %s\n", filepath);
+        return -1;
+    }
+
+    int existing_index = find_file_index(filepath);
+    if (existing_index >= 0) {
+        ctx->files[existing_index].is_used = 1;
+        ctx->files[existing_index].multiple_include_count++;
+        // Datei liegt noch auf dem Include-Stack: Zyklus geschlossen - alle Dateien
+        // oberhalb davon gehören ebenfalls zum Zyklus
+        if (check_circular_include(filepath)) {
+            for (int i = ctx->stack_depth - 1; i >= 0; i--) {
+                int stack_file = find_file_index(ctx->include_stack[i].filepath);
+                if (stack_file >= 0) ctx->files[stack_file].is_circular_include = 1;
+                if (stack_file == existing_index) break;
+            }
+        }
+        return existing_index;
+    }
+
+    if (ctx->file_count >= MAX_FILES) return -1;
+
+    int is_circular = check_circular_include(filepath);
+    int included_from = ctx->stack_depth > 0 ? find_file_index(ctx->include_stack[ctx->stack_depth - 1].filepath) : -1;
+
+    if (ctx->stack_depth < 50) {
+        strcpy(ctx->include_stack[ctx->stack_depth].filepath, filepath);
+        ctx->include_stack[ctx->stack_depth].depth = depth;
+        ctx->stack_depth++;
+    }
+
+    // Unveränderte Datei aus dem Parse-Cache: wird weder gelesen noch geparst
+    int cache_entry = reusable_parse_cache_entry(filepath);
+    long content_size = 0;
+    char* content = cache_entry >= 0 ? NULL : read_file_content(filepath, &content_size);
+    if (!content && cache_entry < 0) {
+        analyzer_log("Warning: Could not read file: %s\n", filepath);
+        if (ctx->stack_depth > 0) ctx->stack_depth--;
+        return -1;
+    }
+
+    FileAnalysis* analysis = &ctx->files[ctx->file_count];
+    memset(analysis, 0, sizeof(FileAnalysis));
+    if (!allocate_file_elements(analysis)) {
+        analyzer_log("Warning: Out of memory for %s\n", filepath);
+        free(content);
+        if (ctx->stack_depth > 0) ctx->stack_depth--;
+        return -1;
+    }
+
+    const char* filename = strrchr(filepath, '\\');
+    if (!filename) filename = strrchr(filepath, '/');
+    if (filename) filename++;
+    else filename = filepath;
+    strcpy(analysis->filename, filename);
+    strcpy(analysis->filepath, filepath);
+    // filepath zeigt meist in den Puffer von find_include_file_enhanced, den jedes verschachtelte
+    // Include überschreibt - ab hier nur noch die Kopie verwenden
+    filepath = analysis->filepath;
+    filename = analysis->filename;
+    strcpy(analysis->relative_dir, get_relative_path(filepath, ctx->base_path));
+    analysis->is_used = 1;
+    analysis->include_depth = depth;
+    analysis->is_performance_problem = (depth > 10) ? 1 : 0;
+    analysis->is_circular_include = is_circular;
+    analysis->multiple_include_count = 1;
+    analysis->duplicate_of = -1;
+    analysis->included_from = included_from;
+    if (cache_entry >= 0) {
+        analysis->file_size = ctx->parse_cache[cache_entry].file_size;
+        analysis->content_hash = ctx->parse_cache[cache_entry].content_hash;
+        analysis->has_include_guard = ctx->parse_cache[cache_entry].has_include_guard;
+    } else {
+        analysis->file_size = content_size;
+        analysis->content_hash = hash_content(content, content_size);
+        analysis->has_include_guard = detect_include_guard(content, content_size);
+    }
+
+    char current_dir[MAX_PATH_LEN];
+    strcpy(current_dir, filepath);
+    char* last_slash = strrchr(current_dir, '\\');
+    if (!last_slash) last_slash = strrchr(current_dir, '/');
+    if (last_slash) *last_slash = '\0';
+
+    analyzer_log("Analyzing: %s (depth %d) -> %s%s\n", filename, depth, analysis->relative_dir,
+                 is_circular ? " [CIRCULAR]" : "");
+
+    if (cache_entry >= 0) {
+        int current_file_index = ctx->file_count++;
+        analyzer_log("  Unchanged - reusing cached parse result\n");
+        ctx->parse_cache_hits++;
+        int original = find_content_original(analysis->content_hash, analysis->file_size);
+        if (original >= 0) analysis->duplicate_of = original;
+        else register_content(analysis->content_hash, analysis->file_size, current_file_index);
+        restore_cached_parse(current_file_index, cache_entry, current_dir, depth);
+        if (ctx->stack_depth > 0) ctx->stack_depth--;
+        return current_file_index;
+    }
+
+    // Includes dieser Datei schon anfordern, während sie noch geparst wird
+    prefetch_includes(content, content_size, current_dir);
+
+    int current_file_index = ctx->file_count++;
+
+    // Identischer Inhalt wurde bereits geparst: Ergebnis übernehmen
+    // (im Streaming-Modus nur, solange die Elemente des Originals noch im Speicher sind)
+    int original = find_content_original(analysis->content_hash, content_size);
+    if (original >= 0) analysis->duplicate_of = original;
+    if (original >= 0 && ctx->files[original].elements) {
+        analyzer_log("  Identical to %s - reusing parse result\n", ctx->files[original].filepath);
+        replay_file_analysis(current_file_index, original, current_dir, depth);
+        check_include_usage(current_file_index, content, content_size);
+        free(content);
+        finish_file_analysis(current_file_index, NULL);
+        copy_call_references(current_file_index, original);
+        copy_macro_uses(current_file_index, original);
+        copy_struct_layouts(current_file_index, original);
+        copy_frame_loops(current_file_index, original);
+        copy_asset_references(current_file_index, original);
+        if (ctx->stack_depth > 0) ctx->stack_depth--;
+        return current_file_index;
+    }
+    if (original < 0) register_content(analysis->content_hash, content_size, current_file_index);
+
+    char line[MAX_LINE_LEN];
+    int line_num = 0;
+    char current_function[MAX_NAME_LEN] = "";
+    int brace_level = 0;
+    int in_function = 0;
+    CallCollector collector;
+    memset(&collector, 0, sizeof(CallCollector));
+    MacroUseCollector macro_collector;
+    memset(&macro_collector, 0, sizeof(MacroUseCollector));
+    LayoutCollector layouts;
+    init_layout_collector(&layouts);
+    HotLoopCollector hot_loops;
+    memset(&hot_loops, 0, sizeof(HotLoopCollector));
+    AssetCollector assets;
+    memset(&assets, 0, sizeof(AssetCollector));
+    const char* cursor = content;
+    const char* content_end = content + content_size;
+
+    while (next_content_line(&cursor, content_end, line, sizeof(line))) {
+        line_num++;
+        trim_whitespace(line);
+
+        if (starts_with(line, "//") || starts_with(line, "/*")) continue;
+
+        // PRAGMA_PATH Erkennung
+        char pragma_path_value[MAX_PATH_LEN];
+        int pragma_has_backslash = 0;
+        if (match_pragma_path(line, pragma_path_value, &pragma_has_backslash)) {
+            if (analysis->pragma_path_count < MAX_PRAGMA_PATHS) {
+                PragmaPath* pp = &analysis->pragma_paths[analysis->pragma_path_count];
+                strcpy(pp->path, pragma_path_value);
+                strcpy(pp->source_file, filepath);
+                pp->line = line_num;
+                pp->has_backslash = pragma_has_backslash;
+                analysis->pragma_path_count++;
+                add_global_pragma_path(pp, filename);
+            }
+        }
+
+        // Include-Verarbeitung
+        IncludeElement include_elem;
+        memset(&include_elem, 0, sizeof(IncludeElement));
+        include_elem.target_index = -1;
+        int include_result = match_include_enhanced(line, &include_elem);
+
+        if (include_result == 1) {
+            include_elem.line = line_num;
+            resolve_and_follow_include(&include_elem, current_dir, filename, depth);
+
+            if (analysis->include_count < MAX_ITEMS_PER_FILE) {
+                analysis->includes[analysis->include_count] = include_elem;
+                analysis->include_count++;
+            }
+        } else if (include_result == 2) {
+            analyzer_log("Skipping system include: <%s> in %s:%d\n", include_elem.name, filename, line_num);
+        }
+
+        // Makros: Verwendungen der bisher definierten Makros merken, dann die Definition registrieren
+        char macro_name[MAX_NAME_LEN];
+        char macro_body[MAX_LINE_LEN];
+        int has_parameters;
+        if (match_define(line, macro_name, macro_body, &has_parameters)) {
+            collect_macro_uses(&macro_collector, macro_body, line_num);
+            int definition = add_macro_definition(current_file_index, macro_name, intern_string(macro_body),
+                                                  has_parameters, line_num);
+            add_macro_element(analysis, macro_name, macro_body, has_parameters, line_num, definition);
+        } else if (include_result == 0 && !strstr(line, "#undef")) {
+            collect_macro_uses(&macro_collector, line, line_num);
+        }
+
+        // Funktionsblock-Tracking (Prototypen öffnen keinen Rumpf)
+        char temp_name[MAX_NAME_LEN];
+        int prototype = is_prototype_line(line);
+        int declaration_line = 0;
+        if ((match_function_declaration(line, "void", temp_name) ||
+             match_function_declaration(line, "function", temp_name) ||
+             match_function_declaration(line, "action", temp_name)) && !prototype) {
+            strcpy(current_function, temp_name);
+            in_function = 1;
+            brace_level = 0;
+            declaration_line = 1;
+            begin_function_body(&collector, line_num);
+            begin_hot_loop_function(&hot_loops, temp_name);
+        }
+
+        for (int i = 0; line[i]; i++) {
+            if (line[i] == '{') brace_level++;
+            if (line[i] == '}') brace_level--;
+        }
+
+        // Bezeichner im Rumpf für den Aufrufgraphen (in der Kopfzeile erst ab '{')
+        if (in_function) {
+            const char* body = declaration_line ? strchr(line, '{') : line;
+            if (body) {
+                collect_body_references(&collector, body, line_num);
+                collect_hot_loop_line(&hot_loops, body, line_num);
+                collect_asset_literals(&assets, body, line_num, collector.caller_line);
+            }
+        }
+
+        // v1.4: Asset-Referenzen außerhalb von Funktionen (PRAGMA_BIND, globale Definitionen)
+        char bind_name[MAX_PATH_LEN];
+        if (match_pragma_bind(line, bind_name)) {
+            add_asset_reference(&assets, bind_name, line_num, 0, -1, 1);
+        } else if (!in_function) {
+            collect_asset_literals(&assets, line, line_num, 0);
+        }
+
+        if (in_function && brace_level <= 0 && strchr(line, '}')) {
+            in_function = 0;
+            current_function[0] = '\0';
+        }
+
+        char name[MAX_NAME_LEN];
+
+        // Void functions
+        if (match_function_declaration(line, "void", name) &&
+            analysis->void_function_count < MAX_ITEMS_PER_FILE) {
+            CodeElement* elem = &analysis->void_functions[analysis->void_function_count];
+            strcpy(elem->name, name);
+            elem->line = line_num;
+            strcpy(elem->type, "void");
+            elem->is_prototype = prototype;
+            register_function_element(analysis, elem);
+            analysis->void_function_count++;
+        }
+
+        // Functions
+        if (match_function_declaration(line, "function", name) &&
+            analysis->function_count < MAX_ITEMS_PER_FILE) {
+            CodeElement* elem = &analysis->functions[analysis->function_count];
+            strcpy(elem->name, name);
+            elem->line = line_num;
+            strcpy(elem->type, "function");
+            elem->is_prototype = prototype;
+            register_function_element(analysis, elem);
+            analysis->function_count++;
+        }
+
+        // Actions
+        if (match_function_declaration(line, "action", name) &&
+            analysis->action_count < MAX_ITEMS_PER_FILE) {
+            CodeElement* elem = &analysis->actions[analysis->action_count];
+            strcpy(elem->name, name);
+            elem->line = line_num;
+            strcpy(elem->type, "action");
+            elem->is_prototype = prototype;
+            register_function_element(analysis, elem);
+            analysis->action_count++;
+        }
+
+        // v1.4: Struct-Rümpfe für die Layout-Berechnung
+        collect_struct_line(&layouts, line, line_num);
+
+        // Structs
+        if (match_struct(line, name) && analysis->struct_count < MAX_ITEMS_PER_FILE) {
+            CodeElement* elem = &analysis->structs[analysis->struct_count];
+            strcpy(elem->name, name);
+            elem->line = line_num;
+            strcpy(elem->type, "struct");
+            analysis->struct_count++;
+        }
+
+        // Typedef structs
+        int typedef_result = match_typedef_struct(line, name);
+        if (typedef_result > 0) {
+            int found = 0;
+            for (int k = 0; k < analysis->typedef_struct_count; k++) {
+                if (strcmp(analysis->typedef_structs[k].name, name) == 0) {
+                    found = 1;
+                    break;
+                }
+            }
+            if (!found && analysis->typedef_struct_count < MAX_ITEMS_PER_FILE) {
+                CodeElement* elem = &analysis->typedef_structs[analysis->typedef_struct_count];
+                strcpy(elem->name, name);
+                elem->line = line_num;
+                strcpy(elem->type, "typedef_struct");
+                analysis->typedef_struct_count++;
+            }
+        }
+
+        // Static variables
+        if (match_static_var(line, name) && analysis->static_var_count < MAX_ITEMS_PER_FILE) {
+            CodeElement* elem = &analysis->static_vars[analysis->static_var_count];
+            strcpy(elem->name, name);
+            elem->line = line_num;
+            strcpy(elem->type, "static");
+            if (in_function) {
+                strcpy(elem->function_context, current_function);
+            }
+            register_static_element(analysis, elem);
+            analysis->static_var_count++;
+            collect_static_storage(&layouts, line, line_num);
+        }
+    }
+
+    check_include_usage(current_file_index, content, content_size);
+    free(content);
+    analysis->line_count = line_num;
+    finish_file_analysis(current_file_index, &collector);
+    store_macro_uses(current_file_index, &macro_collector);
+    store_struct_layouts(current_file_index, &layouts);
+    store_frame_loops(current_file_index, &hot_loops);
+    store_asset_references(current_file_index, &assets);
+    free(collector.refs);
+    free(macro_collector.uses);
+    free_layout_collector(&layouts);
+    free(hot_loops.loops);
+    free(hot_loops.calls);
+    free(assets.refs);
+
+    if (ctx->stack_depth > 0) {
+        ctx->stack_depth--;
+    }
+    return current_file_index;
+}
+
+// Scan-Funktion für All-Files-Modus - durchläuft den Verzeichnis-Snapshot statt der Platte
+static int is_source_entry(int entry) {
+    if (ctx->tree_entries[entry].is_directory) return 0;
+    const char* ext = strrchr(ctx->tree_entries[entry].name, '.');
+    return ext && (strcmp(ext, ".c") == 0 || strcmp(ext, ".h") == 0);
+}
+
+static void scan_all_files() {
+    int next_prefetch = 0;
+    for (int i = 0; i < ctx->tree_entry_count; i++) {
+        if (!is_source_entry(i)) continue;
+
+        // Die nächsten Einträge des Snapshots vorab lesen (Fenster = halber Puffer-Pool)
+        if (next_prefetch <= i) next_prefetch = i + 1;
+        while (next_prefetch < ctx->tree_entry_count && next_prefetch <= i + PREFETCH_SLOTS / 2) {
+            if (is_source_entry(next_prefetch)) prefetch_file(ctx->tree_entries[next_prefetch].path);
+            next_prefetch++;
+        }
+
+        analyze_file_with_includes(ctx->tree_entries[i].path, 0);
+    }
+}
+
+// v1.4: Gerichteter Graph in CSR-Form (Datei- und Verzeichnis-Graph)
+// Kanten sind typisiert: Include-Zeile oder reine Makro-Abhängigkeit
+typedef struct {
+    int source;
+    int target;
+    int weight;
+    int type;
+} DepEdge;
+
+static int compare_dep_edges(const void* a, const void* b) {
+    const DepEdge* x = (const DepEdge*)a;
+    const DepEdge* y = (const DepEdge*)b;
+    if (x->source != y->source) return x->source - y->source;
+    if (x->target != y->target) return x->target - y->target;
+    return x->type - y->type;
+}
+
+// Baut den Graphen aus einer Kantenliste; Mehrfachkanten gleichen Typs werden zu einer Kante
+// mit Summengewicht
+static void build_dep_graph(DepGraph* graph, int node_count, DepEdge* edges, int edge_count) {
+    qsort(edges, edge_count, sizeof(DepEdge), compare_dep_edges);
+
+    graph->node_count = node_count;
+    graph->edge_count = 0;
+    graph->first_edge = (int*)calloc(node_count + 1, sizeof(int));
+    graph->edge_target = (int*)malloc(sizeof(int) * (edge_count + 1));
+    graph->edge_weight = (int*)malloc(sizeof(int) * (edge_count + 1));
+    graph->edge_type = (unsigned char*)malloc(edge_count + 1);
+
+    for (int i = 0; i < edge_count; i++) {
+        int e = graph->edge_count;
+        if (e > 0 && i > 0 && edges[i - 1].source == edges[i].source &&
+            edges[i - 1].target == edges[i].target && edges[i - 1].type == edges[i].type) {
+            graph->edge_weight[e - 1] += edges[i].weight;
+            continue;
+        }
+        graph->edge_target[e] = edges[i].target;
+        graph->edge_weight[e] = edges[i].weight;
+        graph->edge_type[e] = (unsigned char)edges[i].type;
+        graph->first_edge[edges[i].source + 1]++;
+        graph->edge_count++;
+    }
+    for (int n = 0; n < node_count; n++) {
+        graph->first_edge[n + 1] += graph->first_edge[n];
+    }
+}
+
+static void free_dep_graph(DepGraph* graph) {
+    free(graph->first_edge);
+    free(graph->edge_target);
+    free(graph->edge_weight);
+    free(graph->edge_type);
+    memset(graph, 0, sizeof(DepGraph));
+}
+
+// Tarjan SCC - component[n] erhält die Komponentennummer, Rückgabe: Anzahl Komponenten.
+// Komponenten werden in umgekehrter topologischer Reihenfolge nummeriert (Senken zuerst).
+typedef struct {
+    const DepGraph* graph;
+    int* component;
+    int* index;
+    int* lowlink;
+    int* on_stack;
+    int* stack;
+    int stack_size;
+    int next_index;
+    int component_count;
+} SccState;
+
+static void scc_visit(SccState* state, int node) {
+    state->index[node] = state->lowlink[node] = state->next_index++;
+    state->stack[state->stack_size++] = node;
+    state->on_stack[node] = 1;
+
+    const DepGraph* graph = state->graph;
+    for (int e = graph->first_edge[node]; e < graph->first_edge[node + 1]; e++) {
+        int target = graph->edge_target[e];
+        if (state->index[target] < 0) {
+            scc_visit(state, target);
+            if (state->lowlink[target] < state->lowlink[node]) state->lowlink[node] = state->lowlink[target];
+        } else if (state->on_stack[target] && state->index[target] < state->lowlink[node]) {
+            state->lowlink[node] = state->index[target];
+        }
+    }
+
+    if (state->lowlink[node] == state->index[node]) {
+        int member;
+        do {
+            member = state->stack[--state->stack_size];
+            state->on_stack[member] = 0;
+            state->component[member] = state->component_count;
+        } while (member != node);
+        state->component_count++;
+    }
+}
+
+static int compute_scc(const DepGraph* graph, int* component) {
+    int n = graph->node_count;
+    SccState state;
+    state.graph = graph;
+    state.component = component;
+    state.index = (int*)malloc(sizeof(int) * (n + 1));
+    state.lowlink = (int*)malloc(sizeof(int) * (n + 1));
+    state.on_stack = (int*)calloc(n + 1, sizeof(int));
+    state.stack = (int*)malloc(sizeof(int) * (n + 1));
+    state.stack_size = 0;
+    state.next_index = 0;
+    state.component_count = 0;
+
+    for (int i = 0; i < n; i++) state.index[i] = -1;
+    for (int i = 0; i < n; i++) {
+        if (state.index[i] < 0) scc_visit(&state, i);
+    }
+
+    free(state.index);
+    free(state.lowlink);
+    free(state.on_stack);
+    free(state.stack);
+    return state.component_count;
+}
+
+// Include-Kanten aller Dateien anhängen (Platz: Summe der include_count)
+static int append_include_edges(DepEdge* edges) {
+    int edge_count = 0;
+    for (int i = 0; i < ctx->file_count; i++) {
+        for (int j = 0; j < ctx->files[i].include_count; j++) {
+            if (ctx->files[i].include_targets[j] < 0) continue;
+            edges[edge_count].source = i;
+            edges[edge_count].target = ctx->files[i].include_targets[j];
+            edges[edge_count].weight = 1;
+            edges[edge_count].type = EDGE_INCLUDE;
+            edge_count++;
+        }
+    }
+    return edge_count;
+}
+
+// Datei-Graph aus den aufgelösten Includes (Gewicht = Anzahl Include-Zeilen)
+static void build_file_include_graph(DepGraph* graph) {
+    int edge_count = 0;
+    for (int i = 0; i < ctx->file_count; i++) edge_count += ctx->files[i].include_count;
+
+    DepEdge* edges = (DepEdge*)malloc(sizeof(DepEdge) * (edge_count + 1));
+    edge_count = append_include_edges(edges);
+    build_dep_graph(graph, ctx->file_count, edges, edge_count);
+    free(edges);
+}
+
+// Zirkuläre Includes aus den starken Zusammenhangskomponenten ableiten:
+// jede Datei in einer Komponente mit mehr als einer Datei (oder mit Selbst-Include)
+static void mark_circular_includes() {
+    DepGraph graph;
+    build_file_include_graph(&graph);
+
+    int* component = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int* component_size = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    compute_scc(&graph, component);
+    for (int i = 0; i < ctx->file_count; i++) component_size[component[i]]++;
+
+    for (int i = 0; i < ctx->file_count; i++) {
+        int self_include = 0;
+        for (int e = graph.first_edge[i]; e < graph.first_edge[i + 1]; e++) {
+            if (graph.edge_target[e] == i) self_include = 1;
+        }
+        ctx->files[i].is_circular_include = component_size[component[i]] > 1 || self_include;
+    }
+
+    free(ctx->file_component);
+    ctx->file_component = component;
+    free(component_size);
+    free_dep_graph(&graph);
+}
+
+// Kürzester Zyklus durch eine zirkuläre Datei (Breitensuche innerhalb ihrer Komponente).
+// path erhält die Dateien ab file_index ohne die Wiederholung am Ende; Rückgabe: Länge, 0 ohne Zyklus.
+static int find_shortest_cycle(int file_index, int* path) {
+    if (!ctx->files[file_index].is_circular_include) return 0;
+    int component = ctx->file_component[file_index];
+    int* parent = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int* queue = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    for (int f = 0; f < ctx->file_count; f++) parent[f] = -2;
+    int head = 0, tail = 0, last = -1;
+    queue[tail++] = file_index;
+    while (head < tail && last < 0) {
+        int f = queue[head++];
+        for (int k = 0; k < ctx->files[f].include_count && last < 0; k++) {
+            int t = ctx->files[f].include_targets[k];
+            if (t < 0 || ctx->file_component[t] != component) continue;
+            if (t == file_index) last = f;
+            else if (parent[t] == -2) {
+                parent[t] = f;
+                queue[tail++] = t;
+            }
+        }
+    }
+    int length = 0;
+    if (last >= 0) {
+        for (int f = last; f != file_index; f = parent[f]) queue[length++] = f;
+        path[0] = file_index;
+        for (int k = 0; k < length; k++) path[k + 1] = queue[length - 1 - k];
+        length++;
+    }
+    free(parent);
+    free(queue);
+    return length;
+}
+
+// v1.4: Transitive Include-Hüllen
+// Bit t in Zeile f ist gesetzt, wenn Datei f (direkt oder indirekt) Datei t inkludiert.
+#define CLOSURE_ROW(f) (ctx->include_closure + (size_t)(f) * ctx->closure_stride)
+#define BITSET_TEST(set, i) ((set)[(i) >> 3] & (1 << ((i) & 7)))
+#define BITSET_SET(set, i) ((set)[(i) >> 3] |= (unsigned char)(1 << ((i) & 7)))
+
+static void build_include_closures() {
+    free(ctx->include_closure);
+    ctx->closure_stride = (ctx->file_count + 7) / 8;
+    ctx->include_closure = (unsigned char*)calloc((size_t)ctx->file_count * ctx->closure_stride + 1, 1);
+    int* queue = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    if (!ctx->include_closure || !queue) {
+        analyzer_log("Error: Out of memory while computing include closures\n");
+        free(queue);
+        return;
+    }
+
+    for (int f = 0; f < ctx->file_count; f++) {
+        unsigned char* row = CLOSURE_ROW(f);
+        int head = 0, tail = 0;
+        queue[tail++] = f;
+        while (head < tail) {
+            FileAnalysis* current = &ctx->files[queue[head++]];
+            for (int j = 0; j < current->include_count; j++) {
+                int target = current->include_targets[j];
+                if (target < 0 || BITSET_TEST(row, target)) continue;
+                BITSET_SET(row, target);
+                queue[tail++] = target;
+            }
+        }
+    }
+    free(queue);
+}
+
+// Geschätzte präprozessierte Zeilen: eigene Zeilen + jede erreichbare Datei einmal
+// (Lite-C inkludiert jede Datei nur einmal pro Kompilierung)
+static long get_closure_lines(int file_index) {
+    long total = ctx->files[file_index].line_count;
+    unsigned char* row = CLOSURE_ROW(file_index);
+    for (int t = 0; t < ctx->file_count; t++) {
+        if (t != file_index && BITSET_TEST(row, t)) total += ctx->files[t].line_count;
+    }
+    return total;
+}
+
+// Dateipfad relativ zum Projekt-Root, mit '/' als Trenner
+static void get_relative_file_path(const char* full_path, char* out) {
+    const char* rel_start = strstr(full_path, ctx->base_path);
+    if (rel_start) {
+        rel_start += strlen(ctx->base_path);
+        if (*rel_start == '\\' || *rel_start == '/') rel_start++;
+        strcpy(out, rel_start);
+    } else {
+        strcpy(out, full_path);
+    }
+    normalize_path_separators(out);
+}
+
+static int is_translation_unit(int file_index, const int* included_by_count);
+
+// v1.4: Zyklen-Auflösung
+// Je starker Zusammenhangskomponente eine kleine Menge Include-Kanten, nach deren Entfernen der
+// Include-Graph azyklisch ist (Feedback-Arc-Set). Heuristik von Eades/Lin/Smyth mit Kantengewichten:
+// Senken ans Ende, Quellen an den Anfang, sonst die Datei mit dem größten Überschuss (ausgehendes
+// minus eingehendes Gewicht) an den Anfang. Kanten gegen diese Reihenfolge bilden die Menge; danach
+// wird jede Kante (schwere zuerst) wieder aufgenommen, die keinen Zyklus mehr schließt.
+typedef struct {
+    int source;                     // lokale Knoten der Komponente
+    int target;
+    int file_index;
+    int include_slot;
+    long weight;
+    int removed;
+} CycleEdge;
+
+// Kantengewicht: Zeilen des Ziels plus allem, was es außerhalb der Komponente hereinholt
+// (die volle Hülle ist für alle Dateien einer Komponente gleich)
+static long cycle_edge_weight(int target, int component, unsigned char* scratch) {
+    memset(scratch, 0, ctx->closure_stride);
+    BITSET_SET(scratch, target);
+    for (int k = 0; k < ctx->files[target].include_count; k++) {
+        int t = ctx->files[target].include_targets[k];
+        if (t < 0 || ctx->file_component[t] == component) continue;
+        BITSET_SET(scratch, t);
+        unsigned char* row = CLOSURE_ROW(t);
+        for (int b = 0; b < ctx->closure_stride; b++) scratch[b] |= row[b];
+    }
+    long lines = 0;
+    for (int x = 0; x < ctx->file_count; x++) {
+        if (BITSET_TEST(scratch, x)) lines += ctx->files[x].line_count;
+    }
+    return lines;
+}
+
+// Reihenfolge nach Eades/Lin/Smyth, position[v] erhält den Platz von Knoten v.
+// edges ist nach source sortiert (out_first), in_edges enthält die Kanten je Ziel (in_first).
+static void order_cycle_nodes(const CycleEdge* edges, const int* out_first, const int* in_first, const int* in_edges,
+                       int node_count, int* position) {
+    int* out_count = (int*)calloc(node_count + 1, sizeof(int));
+    int* in_count = (int*)calloc(node_count + 1, sizeof(int));
+    long* out_weight = (long*)calloc(node_count + 1, sizeof(long));
+    long* in_weight = (long*)calloc(node_count + 1, sizeof(long));
+    unsigned char* placed = (unsigned char*)calloc(node_count + 1, 1);
+    int* stack = (int*)malloc(sizeof(int) * (3 * node_count + 1));   // jeder Knoten höchstens dreimal
+
+    for (int e = 0; e < out_first[node_count]; e++) {
+        if (edges[e].source == edges[e].target) continue;
+        out_count[edges[e].source]++;
+        out_weight[edges[e].source] += edges[e].weight;
+        in_count[edges[e].target]++;
+        in_weight[edges[e].target] += edges[e].weight;
+    }
+    int size = 0;
+    for (int v = 0; v < node_count; v++) {
+        if (out_count[v] == 0 || in_count[v] == 0) stack[size++] = v;
+    }
+
+    int left = 0, right = node_count - 1;
+    while (left <= right) {
+        int v = -1, at_end = 0;
+        while (size > 0 && v < 0) {
+            int c = stack[--size];
+            if (placed[c]) continue;
+            if (out_count[c] == 0) {
+                v = c;
+                at_end = 1;
+            } else if (in_count[c] == 0) {
+                v = c;
+            }
+        }
+        if (v < 0) {
+            for (int c = 0; c < node_count; c++) {
+                if (placed[c]) continue;
+                if (v < 0 || out_weight[c] - in_weight[c] > out_weight[v] - in_weight[v]) v = c;
+            }
+        }
+        position[v] = at_end ? right-- : left++;
+        placed[v] = 1;
+
+        for (int e = out_first[v]; e < out_first[v + 1]; e++) {
+            int t = edges[e].target;
+            if (placed[t]) continue;
+            in_weight[t] -= edges[e].weight;
+            if (--in_count[t] == 0) stack[size++] = t;
+        }
+        for (int k = in_first[v]; k < in_first[v + 1]; k++) {
+            int s = edges[in_edges[k]].source;
+            if (placed[s]) continue;
+            out_weight[s] -= edges[in_edges[k]].weight;
+            if (--out_count[s] == 0) stack[size++] = s;
+        }
+    }
+
+    free(out_count);
+    free(in_count);
+    free(out_weight);
+    free(in_weight);
+    free(placed);
+    free(stack);
+}
+
+// Erreicht from den Knoten to über nicht entfernte Kanten?
+static int cycle_path_exists(const CycleEdge* edges, const int* out_first, int node_count, int from, int to,
+                      int* stack, unsigned char* seen) {
+    memset(seen, 0, node_count);
+    int size = 0;
+    stack[size++] = from;
+    seen[from] = 1;
+    while (size > 0) {
+        int v = stack[--size];
+        if (v == to) return 1;
+        for (int e = out_first[v]; e < out_first[v + 1]; e++) {
+            if (edges[e].removed || seen[edges[e].target]) continue;
+            seen[edges[e].target] = 1;
+            stack[size++] = edges[e].target;
+        }
+    }
+    return 0;
+}
+
+static int compare_cycle_edges_by_weight(const void* a, const void* b) {
+    const CycleEdge* x = *(const CycleEdge* const*)a;
+    const CycleEdge* y = *(const CycleEdge* const*)b;
+    if (x->weight != y->weight) return x->weight < y->weight ? 1 : -1;
+    if (x->file_index != y->file_index) return x->file_index - y->file_index;
+    return x->include_slot - y->include_slot;
+}
+
+static int compare_cycle_components(const void* a, const void* b) {
+    const CycleComponent* x = (const CycleComponent*)a;
+    const CycleComponent* y = (const CycleComponent*)b;
+    if (x->file_count != y->file_count) return y->file_count - x->file_count;
+    return x->component - y->component;
+}
+
+// Präprozessierte Zeilen von start, wenn die markierten Include-Zeilen fehlen
+static long closure_lines_without(int start, const unsigned char* cut, const int* slot_first, int* queue) {
+    ctx->closure_visit_serial++;
+    ctx->closure_visit_stamp[start] = ctx->closure_visit_serial;
+    long total = 0;
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    while (head < tail) {
+        int f = queue[head++];
+        total += ctx->files[f].line_count;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target < 0 || cut[slot_first[f] + j]) continue;
+            if (ctx->closure_visit_stamp[target] == ctx->closure_visit_serial) continue;
+            ctx->closure_visit_stamp[target] = ctx->closure_visit_serial;
+            queue[tail++] = target;
+        }
+    }
+    return total;
+}
+
+// Feedback-Arc-Set für eine Komponente; hängt die Kanten an ctx->cycle_breaks an
+static void break_include_cycle(int component, const int* files, int node_count, int* local, unsigned char* scratch) {
+    if (node_count <= 0) return;
+    int edge_count = 0;
+    for (int v = 0; v < node_count; v++) {
+        local[files[v]] = v;
+        const FileAnalysis* analysis = &ctx->files[files[v]];
+        for (int j = 0; j < analysis->include_count; j++) {
+            int t = analysis->include_targets[j];
+            if (t >= 0 && ctx->file_component[t] == component) edge_count++;
+        }
+    }
+
+    long* node_weight = (long*)malloc(sizeof(long) * (node_count + 1));
+    for (int v = 0; v < node_count; v++) node_weight[v] = cycle_edge_weight(files[v], component, scratch);
+
+    // Kanten nach Quelle (Reihenfolge der Knoten), dazu die eingehenden Kanten je Ziel
+    CycleEdge* edges = (CycleEdge*)malloc(sizeof(CycleEdge) * (edge_count + 1));
+    int* out_first = (int*)calloc(node_count + 1, sizeof(int));
+    int* in_first = (int*)calloc(node_count + 2, sizeof(int));
+    int* in_edges = (int*)malloc(sizeof(int) * (edge_count + 1));
+    int e = 0;
+    for (int v = 0; v < node_count; v++) {
+        out_first[v] = e;
+        const FileAnalysis* analysis = &ctx->files[files[v]];
+        for (int j = 0; j < analysis->include_count; j++) {
+            int t = analysis->include_targets[j];
+            if (t < 0 || ctx->file_component[t] != component) continue;
+            edges[e].source = v;
+            edges[e].target = local[t];
+            edges[e].file_index = files[v];
+            edges[e].include_slot = j;
+            edges[e].weight = node_weight[local[t]];
+            edges[e].removed = 0;
+            in_first[local[t] + 2]++;
+            e++;
+        }
+    }
+    out_first[node_count] = e;
+    for (int v = 0; v < node_count; v++) in_first[v + 2] += in_first[v + 1];
+    for (int k = 0; k < edge_count; k++) in_edges[in_first[edges[k].target + 1]++] = k;
+
+    int* position = (int*)malloc(sizeof(int) * (node_count + 1));
+    order_cycle_nodes(edges, out_first, in_first, in_edges, node_count, position);
+
+    CycleEdge** candidates = (CycleEdge**)malloc(sizeof(CycleEdge*) * (edge_count + 1));
+    int candidate_count = 0;
+    for (int k = 0; k < edge_count; k++) {
+        if (position[edges[k].source] < position[edges[k].target]) continue;
+        edges[k].removed = 1;
+        candidates[candidate_count++] = &edges[k];
+    }
+
+    // Überflüssige Kanten zurücknehmen: u -> v schließt keinen Zyklus, wenn v u nicht erreicht
+    int* stack = (int*)malloc(sizeof(int) * (node_count + 1));
+    unsigned char* seen = (unsigned char*)malloc(node_count + 1);
+    qsort(candidates, candidate_count, sizeof(CycleEdge*), compare_cycle_edges_by_weight);
+    for (int k = 0; k < candidate_count; k++) {
+        CycleEdge* edge = candidates[k];
+        if (edge->source == edge->target) continue;
+        if (!cycle_path_exists(edges, out_first, node_count, edge->target, edge->source, stack, seen)) edge->removed = 0;
+    }
+
+    for (int k = 0; k < edge_count; k++) {
+        if (!edges[k].removed) continue;
+        ctx->cycle_breaks = (CycleBreak*)realloc(ctx->cycle_breaks, sizeof(CycleBreak) * (ctx->cycle_break_count + 1));
+        CycleBreak* cycle_break = &ctx->cycle_breaks[ctx->cycle_break_count++];
+        cycle_break->file_index = edges[k].file_index;
+        cycle_break->include_slot = edges[k].include_slot;
+        cycle_break->weight = edges[k].weight;
+    }
+
+    for (int v = 0; v < node_count; v++) local[files[v]] = -1;
+    free(node_weight);
+    free(edges);
+    free(out_first);
+    free(in_first);
+    free(in_edges);
+    free(position);
+    free(candidates);
+    free(stack);
+    free(seen);
+}
+
+static void compute_cycle_breaks() {
+    free(ctx->cycle_components);
+    free(ctx->cycle_breaks);
+    ctx->cycle_components = NULL;
+    ctx->cycle_breaks = NULL;
+    ctx->cycle_component_count = 0;
+    ctx->cycle_break_count = 0;
+    ctx->cycle_unit_count = 0;
+    ctx->cycle_unit_lines_saved = 0;
+    if (!ctx->include_closure || !ctx->file_component) return;
+
+    int n = ctx->file_count;
+    int* member_first = (int*)calloc(n + 2, sizeof(int));
+    int* members = (int*)malloc(sizeof(int) * (n + 1));
+    for (int f = 0; f < n; f++) member_first[ctx->file_component[f] + 2]++;
+    for (int c = 0; c < n; c++) member_first[c + 2] += member_first[c + 1];
+    for (int f = 0; f < n; f++) members[member_first[ctx->file_component[f] + 1]++] = f;
+
+    int* slot_first = (int*)malloc(sizeof(int) * (n + 1));
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    int slot_count = 0;
+    for (int f = 0; f < n; f++) {
+        slot_first[f] = slot_count;
+        slot_count += ctx->files[f].include_count;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target >= 0 && target != f) included_by_count[target]++;
+        }
+    }
+    unsigned char* cut = (unsigned char*)calloc(slot_count + 1, 1);
+    int* local = (int*)malloc(sizeof(int) * (n + 1));
+    for (int f = 0; f < n; f++) local[f] = -1;
+    unsigned char* scratch = (unsigned char*)malloc(ctx->closure_stride + 1);
+    int* queue = (int*)malloc(sizeof(int) * (n + 1));
+
+    for (int c = 0; c < n; c++) {
+        int node_count = member_first[c + 1] - member_first[c];
+        if (node_count == 0 || !ctx->files[members[member_first[c]]].is_circular_include) continue;
+
+        CycleComponent component;
+        memset(&component, 0, sizeof(component));
+        component.component = c;
+        component.file_count = node_count;
+        component.break_first = ctx->cycle_break_count;
+        break_include_cycle(c, members + member_first[c], node_count, local, scratch);
+        component.break_count = ctx->cycle_break_count - component.break_first;
+
+        // Zeilen vorher/nachher: Dateien des Zyklus und Translation Units, die ihn erreichen
+        for (int k = component.break_first; k < ctx->cycle_break_count; k++) {
+            cut[slot_first[ctx->cycle_breaks[k].file_index] + ctx->cycle_breaks[k].include_slot] = 1;
+        }
+        int first_member = members[member_first[c]];
+        for (int f = 0; f < n; f++) {
+            int in_cycle = ctx->file_component[f] == c;
+            if (!in_cycle && !(is_translation_unit(f, included_by_count) && BITSET_TEST(CLOSURE_ROW(f), first_member))) continue;
+            long before = get_closure_lines(f);
+            long after = closure_lines_without(f, cut, slot_first, queue);
+            if (in_cycle) {
+                component.cycle_lines_before += before;
+                component.cycle_lines_after += after;
+            } else {
+                component.unit_count++;
+                component.unit_lines_before += before;
+                component.unit_lines_after += after;
+            }
+        }
+        for (int k = component.break_first; k < ctx->cycle_break_count; k++) {
+            cut[slot_first[ctx->cycle_breaks[k].file_index] + ctx->cycle_breaks[k].include_slot] = 0;
+        }
+
+        ctx->cycle_components = (CycleComponent*)realloc(ctx->cycle_components,
+                                                         sizeof(CycleComponent) * (ctx->cycle_component_count + 1));
+        ctx->cycle_components[ctx->cycle_component_count++] = component;
+    }
+
+    // Gesamtersparnis: alle Zyklen gleichzeitig auflösen, jede Translation Unit einmal zählen
+    for (int k = 0; k < ctx->cycle_break_count; k++) {
+        cut[slot_first[ctx->cycle_breaks[k].file_index] + ctx->cycle_breaks[k].include_slot] = 1;
+    }
+    for (int f = 0; ctx->cycle_break_count > 0 && f < n; f++) {
+        if (!is_translation_unit(f, included_by_count)) continue;
+        long saved = get_closure_lines(f) - closure_lines_without(f, cut, slot_first, queue);
+        if (saved <= 0) continue;
+        ctx->cycle_unit_count++;
+        ctx->cycle_unit_lines_saved += saved;
+    }
+    if (ctx->cycle_component_count > 1) {
+        qsort(ctx->cycle_components, ctx->cycle_component_count, sizeof(CycleComponent), compare_cycle_components);
+    }
+
+    free(member_first);
+    free(members);
+    free(slot_first);
+    free(included_by_count);
+    free(cut);
+    free(local);
+    free(scratch);
+    free(queue);
+}
+
+// v1.4: Build-Ebenen und kritischer Pfad
+// Zyklen werden zu ihrer Komponente zusammengefasst (file_component). Tarjan nummeriert Senken
+// zuerst, jede Kante zwischen Komponenten zeigt also auf eine kleinere Nummer - aufsteigende
+// Nummern sind eine topologische Reihenfolge. Ebene 0: Dateien ohne Includes, sonst 1 + höchste
+// Ebene eines Includes. Kritischer Pfad: Kette mit den meisten eigenen Zeilen von einer
+// Translation Unit bis zu einem Blatt-Header (ein Zyklus zählt mit allen seinen Dateien).
+static void compute_build_levels() {
+    free(ctx->file_level);
+    free(ctx->critical_path);
+    ctx->file_level = NULL;
+    ctx->critical_path = NULL;
+    ctx->critical_path_length = 0;
+    ctx->critical_path_lines = 0;
+    ctx->build_level_count = 0;
+    if (!ctx->file_component || ctx->file_count == 0) return;
+
+    int n = ctx->file_count;
+    int component_count = 0;
+    for (int f = 0; f < n; f++) {
+        if (ctx->file_component[f] >= component_count) component_count = ctx->file_component[f] + 1;
+    }
+    int* member_first = (int*)calloc(component_count + 2, sizeof(int));
+    int* members = (int*)malloc(sizeof(int) * (n + 1));
+    for (int f = 0; f < n; f++) member_first[ctx->file_component[f] + 2]++;
+    for (int c = 0; c < component_count; c++) member_first[c + 2] += member_first[c + 1];
+    for (int f = 0; f < n; f++) members[member_first[ctx->file_component[f] + 1]++] = f;
+
+    int* level = (int*)calloc(component_count + 1, sizeof(int));
+    long* chain_lines = (long*)calloc(component_count + 1, sizeof(long));
+    int* next_from = (int*)malloc(sizeof(int) * (component_count + 1));   // Include-Kante zur
+    int* next_to = (int*)malloc(sizeof(int) * (component_count + 1));     // schwersten Fortsetzung
+    for (int c = 0; c < component_count; c++) {
+        long own_lines = 0, best = 0;
+        next_from[c] = -1;
+        for (int m = member_first[c]; m < member_first[c + 1]; m++) {
+            const FileAnalysis* analysis = &ctx->files[members[m]];
+            own_lines += analysis->line_count;
+            for (int j = 0; j < analysis->include_count; j++) {
+                int t = analysis->include_targets[j];
+                if (t < 0 || ctx->file_component[t] == c) continue;
+                int target = ctx->file_component[t];
+                if (level[target] + 1 > level[c]) level[c] = level[target] + 1;
+                if (next_from[c] < 0 || chain_lines[target] > best) {
+                    best = chain_lines[target];
+                    next_from[c] = members[m];
+                    next_to[c] = t;
+                }
+            }
+        }
+        chain_lines[c] = own_lines + best;
+    }
+
+    ctx->file_level = (int*)malloc(sizeof(int) * (n + 1));
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    for (int f = 0; f < n; f++) {
+        ctx->file_level[f] = level[ctx->file_component[f]];
+        if (ctx->file_level[f] >= ctx->build_level_count) ctx->build_level_count = ctx->file_level[f] + 1;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target >= 0 && target != f) included_by_count[target]++;
+        }
+    }
+
+    // Start: Translation Unit mit der schwersten Kette, ohne TU die schwerste Datei überhaupt
+    int start = -1;
+    for (int pass = 0; pass < 2 && start < 0; pass++) {
+        for (int f = 0; f < n; f++) {
+            if (pass == 0 && !is_translation_unit(f, included_by_count)) continue;
+            if (start < 0 || chain_lines[ctx->file_component[f]] > chain_lines[ctx->file_component[start]]) start = f;
+        }
+    }
+
+    // Pfad als Dateifolge; ein Zyklus steht mit allen Dateien darauf (Eintrittsdatei zuerst,
+    // Austrittsdatei zuletzt), damit die Zeilen der Schritte die Summe ergeben
+    ctx->critical_path = (int*)malloc(sizeof(int) * (n + 1));
+    ctx->critical_path_lines = chain_lines[ctx->file_component[start]];
+    for (int f = start; f >= 0; ) {
+        int c = ctx->file_component[f];
+        int exit_file = next_from[c] >= 0 ? next_from[c] : f;
+        ctx->critical_path[ctx->critical_path_length++] = f;
+        for (int m = member_first[c]; m < member_first[c + 1]; m++) {
+            if (members[m] != f && members[m] != exit_file) ctx->critical_path[ctx->critical_path_length++] = members[m];
+        }
+        if (exit_file != f) ctx->critical_path[ctx->critical_path_length++] = exit_file;
+        f = next_from[c] >= 0 ? next_to[c] : -1;
+    }
+
+    free(member_first);
+    free(members);
+    free(level);
+    free(chain_lines);
+    free(next_from);
+    free(next_to);
+    free(included_by_count);
+}
+
+// v1.4: Aufrufgraph über alle Dateien (Knoten = Symbole, Gewicht = Anzahl Verwendungen)
+// Eine Referenz zeigt auf jede Definition des Namens (Überladungen sind ohne Typen nicht
+// unterscheidbar); Prototypen und Selbstaufrufe zählen nicht.
+
+// Wird nie referenziert und ist kein Einstiegspunkt (main, Actions)
+static int is_dead_function(int symbol) {
+    if (ctx->symbols[symbol].is_prototype || ctx->symbols[symbol].kind == SYMBOL_ACTION) return 0;
+    if (strcmp(interned_string(ctx->symbols[symbol].name_id), "main") == 0) return 0;
+    if (!ctx->files[ctx->symbols[symbol].file_index].is_used && ctx->use_include_tracking) return 0;
+    return ctx->symbol_incoming[symbol] == 0;
+}
+
+// Ist der Name in Datei f selbst oder in einer von f erreichbaren Datei deklariert/definiert?
+static int symbol_visible_from(int f, int name_id) {
+    for (int s = ctx->symbol_name_first[name_id]; s >= 0; s = ctx->symbol_name_next[s]) {
+        int defining_file = ctx->symbols[s].file_index;
+        if (defining_file == f || (ctx->include_closure && BITSET_TEST(CLOSURE_ROW(f), defining_file))) return 1;
+    }
+    return 0;
+}
+
+static void build_call_graph() {
+    free(ctx->symbol_name_first);
+    free(ctx->symbol_name_next);
+    ctx->symbol_name_first = (int*)malloc(sizeof(int) * (ctx->string_pool_count + 1));
+    ctx->symbol_name_next = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    int* first_definition = (int*)malloc(sizeof(int) * (ctx->string_pool_count + 1));
+    int* next_definition = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    for (int i = 0; i < ctx->string_pool_count; i++) first_definition[i] = ctx->symbol_name_first[i] = -1;
+    for (int s = ctx->symbol_count - 1; s >= 0; s--) {
+        ctx->symbol_name_next[s] = ctx->symbol_name_first[ctx->symbols[s].name_id];
+        ctx->symbol_name_first[ctx->symbols[s].name_id] = s;
+        if (ctx->symbols[s].is_prototype) continue;
+        next_definition[s] = first_definition[ctx->symbols[s].name_id];
+        first_definition[ctx->symbols[s].name_id] = s;
+    }
+
+    int edge_capacity = ctx->call_ref_count + 16;
+    DepEdge* edges = (DepEdge*)malloc(sizeof(DepEdge) * edge_capacity);
+    int edge_count = 0;
+    ctx->resolved_call_refs = 0;
+    for (int i = 0; i < ctx->call_ref_count; i++) {
+        const CallReference* ref = &ctx->call_refs[i];
+        int resolved = 0;
+        for (int d = first_definition[ref->name_id]; d >= 0; d = next_definition[d]) {
+            if (d == ref->caller) continue;
+            if (edge_count == edge_capacity) {
+                edge_capacity *= 2;
+                edges = (DepEdge*)realloc(edges, sizeof(DepEdge) * edge_capacity);
+            }
+            edges[edge_count].source = ref->caller;
+            edges[edge_count].target = d;
+            edges[edge_count].weight = ref->count;
+            edges[edge_count].type = EDGE_CALL;
+            edge_count++;
+            resolved = 1;
+        }
+        ctx->resolved_call_refs += resolved;
+    }
+
+    if (ctx->call_graph_built) free_dep_graph(&ctx->call_graph);
+    build_dep_graph(&ctx->call_graph, ctx->symbol_count, edges, edge_count);
+    ctx->call_graph_built = 1;
+
+    free(ctx->symbol_incoming);
+    ctx->symbol_incoming = (int*)calloc(ctx->symbol_count + 1, sizeof(int));
+    for (int e = 0; e < ctx->call_graph.edge_count; e++) ctx->symbol_incoming[ctx->call_graph.edge_target[e]]++;
+
+    ctx->dead_function_count = 0;
+    for (int s = 0; s < ctx->symbol_count; s++) {
+        if (is_dead_function(s)) ctx->dead_function_count++;
+    }
+
+    free(edges);
+    free(first_definition);
+    free(next_definition);
+}
+
+// v1.4: Datei-Abhängigkeitsgraph mit typisierten Kanten: Include-Zeilen (EDGE_INCLUDE) und
+// reine Makro-Abhängigkeiten (EDGE_MACRO: f verwendet Makros aus g, ruft aber keine Funktion
+// aus g auf; Gewicht = Anzahl verschiedener Makros). Benötigt den Aufrufgraphen.
+
+static void build_file_dependency_graph() {
+    int edge_count = ctx->macro_use_count;
+    for (int i = 0; i < ctx->file_count; i++) edge_count += ctx->files[i].include_count;
+    DepEdge* edges = (DepEdge*)malloc(sizeof(DepEdge) * (edge_count + 1));
+    edge_count = append_include_edges(edges);
+
+    int* called_stamp = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    for (int f = 0; f < ctx->file_count; f++) {
+        for (int s = ctx->files[f].first_symbol; s < ctx->files[f].first_symbol + ctx->files[f].symbol_total; s++) {
+            for (int e = ctx->call_graph.first_edge[s]; e < ctx->call_graph.first_edge[s + 1]; e++) {
+                called_stamp[ctx->symbols[ctx->call_graph.edge_target[e]].file_index] = f + 1;
+            }
+        }
+        for (int u = ctx->files[f].macro_use_first; u < ctx->files[f].macro_use_first + ctx->files[f].macro_use_total; u++) {
+            int defining_file = ctx->macro_defs[ctx->macro_uses[u].definition].file_index;
+            if (defining_file == f || called_stamp[defining_file] == f + 1) continue;
+            edges[edge_count].source = f;
+            edges[edge_count].target = defining_file;
+            edges[edge_count].weight = 1;
+            edges[edge_count].type = EDGE_MACRO;
+            edge_count++;
+        }
+    }
+
+    if (ctx->file_dependency_graph_built) free_dep_graph(&ctx->file_dependency_graph);
+    build_dep_graph(&ctx->file_dependency_graph, ctx->file_count, edges, edge_count);
+    ctx->file_dependency_graph_built = 1;
+
+    ctx->macro_edge_count = 0;
+    for (int e = 0; e < ctx->file_dependency_graph.edge_count; e++) {
+        if (ctx->file_dependency_graph.edge_type[e] == EDGE_MACRO) ctx->macro_edge_count++;
+    }
+    free(called_stamp);
+    free(edges);
+}
+
+// v1.4: Unity-Build Planung
+// Eine Translation Unit ist eine .c Datei, die von keiner anderen Datei inkludiert wird.
+static int is_translation_unit(int file_index, const int* included_by_count) {
+    const char* ext = strrchr(ctx->files[file_index].filename, '.');
+    return ext && strcmp(ext, ".c") == 0 && included_by_count[file_index] == 0;
+}
+
+// Globale statische Variablen, die laut find_or_add_static_var mehrfach im Projekt vorkommen
+static int has_colliding_statics(int file_index) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    for (int j = 0; j < analysis->global_static_count; j++) {
+        if (get_static_var_count(interned_string(analysis->global_static_ids[j]), NULL) > 1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int files_share_static_name(int a, int b) {
+    for (int i = 0; i < ctx->files[a].global_static_count; i++) {
+        for (int j = 0; j < ctx->files[b].global_static_count; j++) {
+            if (ctx->files[a].global_static_ids[i] == ctx->files[b].global_static_ids[j]) return 1;
+        }
+    }
+    return 0;
+}
+
+// Würde die TU zusammen mit dem Batch zwei Definitionen derselben statischen Variable sehen?
+static int unity_static_conflict(const UnityBatch* batch, int tu, const int* colliding) {
+    unsigned char* row = CLOSURE_ROW(tu);
+    for (int a = 0; a < ctx->file_count; a++) {
+        if (!colliding[a] || BITSET_TEST(batch->contained, a)) continue;
+        if (a != tu && !BITSET_TEST(row, a)) continue;
+        for (int b = 0; b < ctx->file_count; b++) {
+            if (colliding[b] && BITSET_TEST(batch->contained, b) && files_share_static_name(a, b)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void add_tu_to_batch(UnityBatch* batch, int tu, long tu_lines) {
+    unsigned char* row = CLOSURE_ROW(tu);
+    batch->members[batch->member_count++] = tu;
+    batch->separate_lines += tu_lines;
+    for (int t = 0; t < ctx->file_count; t++) {
+        if ((t == tu || BITSET_TEST(row, t)) && !BITSET_TEST(batch->contained, t)) {
+            BITSET_SET(batch->contained, t);
+            batch->total_lines += ctx->files[t].line_count;
+        }
+    }
+}
+
+static int compare_tu_cost_desc(const void* a, const void* b) {
+    const long* x = (const long*)a;
+    const long* y = (const long*)b;
+    if (x[1] != y[1]) return x[1] < y[1] ? 1 : -1;
+    return (int)(x[0] - y[0]);
+}
+
+static void plan_unity_batches() {
+    if (!ctx->include_closure) return;
+
+    int* included_by_count = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    int* colliding = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    long* order = (long*)malloc(sizeof(long) * 2 * (ctx->file_count + 1));
+    for (int i = 0; i < ctx->file_count; i++) {
+        for (int j = 0; j < ctx->files[i].include_count; j++) {
+            int target = ctx->files[i].include_targets[j];
+            if (target >= 0 && target != i) included_by_count[target]++;
+        }
+        colliding[i] = has_colliding_statics(i);
+    }
+
+    // TUs nach präprozessierten Kosten absteigend (große zuerst, damit Batches um sie wachsen)
+    ctx->unity_tu_count = 0;
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (!ctx->files[i].is_used && ctx->use_include_tracking) continue;
+        if (!is_translation_unit(i, included_by_count)) continue;
+        order[ctx->unity_tu_count * 2] = i;
+        order[ctx->unity_tu_count * 2 + 1] = get_closure_lines(i);
+        ctx->unity_tu_count++;
+    }
+    qsort(order, ctx->unity_tu_count, sizeof(long) * 2, compare_tu_cost_desc);
+
+    ctx->unity_batches = (UnityBatch*)calloc(ctx->unity_tu_count + 1, sizeof(UnityBatch));
+    ctx->unity_batch_count = 0;
+
+    for (int k = 0; k < ctx->unity_tu_count; k++) {
+        int tu = (int)order[k * 2];
+        long tu_lines = order[k * 2 + 1];
+        unsigned char* row = CLOSURE_ROW(tu);
+
+        // Anteil der Header-Zeilen der TU, die der Batch bereits enthält
+        long header_lines = tu_lines - ctx->files[tu].line_count;
+        int best = -1;
+        double best_ratio = -1.0;
+        for (int b = 0; b < ctx->unity_batch_count; b++) {
+            UnityBatch* batch = &ctx->unity_batches[b];
+            long shared = 0, added = 0;
+            for (int t = 0; t < ctx->file_count; t++) {
+                if (t != tu && !BITSET_TEST(row, t)) continue;
+                if (BITSET_TEST(batch->contained, t)) {
+                    if (t != tu) shared += ctx->files[t].line_count;
+                } else {
+                    added += ctx->files[t].line_count;
+                }
+            }
+            if (batch->total_lines + added > ctx->unity_line_budget) continue;
+
+            double ratio = header_lines > 0 ? (double)shared / header_lines : 1.0;
+            if (ratio < UNITY_MIN_SHARED_RATIO || ratio <= best_ratio) continue;
+            if (unity_static_conflict(batch, tu, colliding)) continue;
+            best = b;
+            best_ratio = ratio;
+        }
+
+        if (best < 0) {
+            best = ctx->unity_batch_count++;
+            ctx->unity_batches[best].members = (int*)malloc(sizeof(int) * ctx->unity_tu_count);
+            ctx->unity_batches[best].contained = (unsigned char*)calloc(ctx->closure_stride + 1, 1);
+        }
+        add_tu_to_batch(&ctx->unity_batches[best], tu, tu_lines);
+    }
+
+    free(included_by_count);
+    free(colliding);
+    free(order);
+}
+
+static void write_unity_batch_files(const char* output_dir) {
+    _mkdir(output_dir);
+
+    for (int b = 0; b < ctx->unity_batch_count; b++) {
+        UnityBatch* batch = &ctx->unity_batches[b];
+        char batch_path[MAX_PATH_LEN];
+        int path_len = snprintf(batch_path, sizeof(batch_path), "%s" PATH_SEP "unity_%03d.c", output_dir, b + 1);
+        if (path_len < 0 || path_len >= (int)sizeof(batch_path)) {
+            analyzer_log("Warning: Unity batch path too long, skipping batch %d\n", b + 1);
+            continue;
+        }
+
+        TextBuffer buffer;
+        memset(&buffer, 0, sizeof(TextBuffer));
+        buffer_append(&buffer, "// Auto-generated unity build batch %d of %d\n", b + 1, ctx->unity_batch_count);
+        buffer_append(&buffer, "// Estimated preprocessed lines: %ld (separately: %ld)\n\n",
+                      batch->total_lines, batch->separate_lines);
+        for (int m = 0; m < batch->member_count; m++) {
+            char relative_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[batch->members[m]].filepath, relative_path);
+            buffer_append(&buffer, "#include \"%s\"\n", relative_path);
+        }
+        if (write_if_changed(batch_path, &buffer) < 0) {
+            analyzer_log("Error: Could not create unity batch file: %s\n", batch_path);
+        }
+        buffer_free(&buffer);
+    }
+    analyzer_log("Unity build batches written: %d files in %s\n", ctx->unity_batch_count, output_dir);
+}
+
+static void write_unity_build_section(FILE* file) {
+    long separate_total = 0, unity_total = 0;
+    for (int b = 0; b < ctx->unity_batch_count; b++) {
+        separate_total += ctx->unity_batches[b].separate_lines;
+        unity_total += ctx->unity_batches[b].total_lines;
+    }
+
+    fprintf(file, "=== UNITY BUILD PLAN ===\n");
+    fprintf(file, "Translation Units: %d\n", ctx->unity_tu_count);
+    fprintf(file, "Batches: %d (budget %ld preprocessed lines)\n", ctx->unity_batch_count, ctx->unity_line_budget);
+    for (int b = 0; b < ctx->unity_batch_count; b++) {
+        UnityBatch* batch = &ctx->unity_batches[b];
+        fprintf(file, "\nunity_%03d.c: %d units, %ld lines (separately: %ld)%s\n",
+                b + 1, batch->member_count, batch->total_lines, batch->separate_lines,
+                batch->total_lines > ctx->unity_line_budget ? " [OVER BUDGET: single unit]" : "");
+        for (int m = 0; m < batch->member_count; m++) {
+            fprintf(file, "  %s\n", ctx->files[batch->members[m]].filename);
+        }
+    }
+    fprintf(file, "\nEstimated preprocessed lines (separate): %ld\n", separate_total);
+    fprintf(file, "Estimated preprocessed lines (unity): %ld\n", unity_total);
+    fprintf(file, "Estimated preprocessing saved: %ld lines (%.1f%%)\n\n",
+            separate_total - unity_total,
+            separate_total > 0 ? 100.0 * (separate_total - unity_total) / separate_total : 0.0);
+}
+
+// v1.4: Depfiles - pro Translation Unit eine .d-Datei (Make/Ninja) mit allen transitiv
+// inkludierten Dateien, dazu ein JSON-Manifest. Die Pfade sind die aufgelösten Pfade der Analyse
+// (Quellpfad wie angegeben, '/' als Trenner), also auch über PRAGMA_PATH gefundene Includes.
+// Dateien werden nur bei geändertem Inhalt neu geschrieben.
+#define DEPFILE_MANIFEST "dependencies.json"
+
+// Pfad für Makefiles: Leerzeichen und '#' mit '\', '$' als "$$"
+static void buffer_append_make_path(TextBuffer* buffer, const char* path) {
+    for (const char* c = path; *c; c++) {
+        if (*c == ' ' || *c == '#') buffer_append(buffer, "\\%c", *c);
+        else if (*c == '$') buffer_append(buffer, "$$");
+        else buffer_append(buffer, "%c", *c);
+    }
+}
+
+static void buffer_append_json_string(TextBuffer* buffer, const char* str) {
+    buffer_append(buffer, "\"");
+    for (const unsigned char* c = (const unsigned char*)str; *c; c++) {
+        if (*c == '"' || *c == '\\') buffer_append(buffer, "\\%c", *c);
+        else if (*c < 0x20) buffer_append(buffer, "\\u%04x", *c);
+        else buffer_append(buffer, "%c", *c);
+    }
+    buffer_append(buffer, "\"");
+}
+
+// Legt alle Verzeichnisse oberhalb der Datei an
+static void make_parent_directories(const char* file_path) {
+    char directory[MAX_PATH_LEN];
+    strcpy(directory, file_path);
+    for (char* c = directory + 1; *c; c++) {
+        if (*c != '/' && *c != '\\') continue;
+        char separator = *c;
+        *c = '\0';
+        _mkdir(directory);
+        *c = separator;
+    }
+}
+
+static int compare_files_by_path(const void* a, const void* b) {
+    return strcmp(ctx->files[*(const int*)a].filepath, ctx->files[*(const int*)b].filepath);
+}
+
+// Rückgabe: Anzahl neu geschriebener Dateien, -1 wenn keine Include-Hüllen vorliegen
+static int write_depfiles(const char* output_dir) {
+    if (!ctx->include_closure) return -1;
+    _mkdir(output_dir);
+
+    int n = ctx->file_count;
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    for (int f = 0; f < n; f++) {
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target >= 0 && target != f) included_by_count[target]++;
+        }
+    }
+    int* units = (int*)malloc(sizeof(int) * (n + 1));
+    int* dependencies = (int*)malloc(sizeof(int) * (n + 1));
+    int unit_count = 0;
+    for (int f = 0; f < n; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        if (is_translation_unit(f, included_by_count)) units[unit_count++] = f;
+    }
+    qsort(units, unit_count, sizeof(int), compare_files_by_path);
+
+    TextBuffer manifest;
+    memset(&manifest, 0, sizeof(TextBuffer));
+    char root[MAX_PATH_LEN];
+    strcpy(root, ctx->base_path);
+    normalize_path_separators(root);
+    buffer_append(&manifest, "{\n  \"version\": 1,\n  \"source_root\": ");
+    buffer_append_json_string(&manifest, root);
+    buffer_append(&manifest, ",\n  \"translation_units\": [");
+
+    int written = 0, listed = 0;
+    for (int u = 0; u < unit_count; u++) {
+        int unit = units[u];
+        int dependency_count = 0;
+        unsigned char* row = CLOSURE_ROW(unit);
+        for (int t = 0; t < n; t++) {
+            if (t != unit && BITSET_TEST(row, t)) dependencies[dependency_count++] = t;
+        }
+        qsort(dependencies, dependency_count, sizeof(int), compare_files_by_path);
+
+        char relative_path[MAX_PATH_LEN], source[MAX_PATH_LEN], target[MAX_PATH_LEN], depfile_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[unit].filepath, relative_path);
+        strcpy(source, ctx->files[unit].filepath);
+        normalize_path_separators(source);
+        strcpy(target, source);
+        char* extension = strrchr(target, '.');
+        if (extension) strcpy(extension, ".o");
+        int path_len = snprintf(depfile_path, sizeof(depfile_path), "%s" PATH_SEP "%s.d", output_dir, relative_path);
+        if (path_len < 0 || path_len >= (int)sizeof(depfile_path)) {
+            analyzer_log("Warning: Depfile path too long, skipping %s\n", relative_path);
+            continue;
+        }
+
+        // "ziel.o: quelle.c header...", dazu leere Regeln je Header (wie gcc -MP), damit
+        // gelöschte Header den Build nicht abbrechen
+        TextBuffer depfile;
+        memset(&depfile, 0, sizeof(TextBuffer));
+        buffer_append_make_path(&depfile, target);
+        buffer_append(&depfile, ": ");
+        buffer_append_make_path(&depfile, source);
+        for (int d = 0; d < dependency_count; d++) {
+            char path[MAX_PATH_LEN];
+            strcpy(path, ctx->files[dependencies[d]].filepath);
+            normalize_path_separators(path);
+            buffer_append(&depfile, " \\\n  ");
+            buffer_append_make_path(&depfile, path);
+        }
+        buffer_append(&depfile, "\n");
+        for (int d = 0; d < dependency_count; d++) {
+            char path[MAX_PATH_LEN];
+            strcpy(path, ctx->files[dependencies[d]].filepath);
+            normalize_path_separators(path);
+            buffer_append(&depfile, "\n");
+            buffer_append_make_path(&depfile, path);
+            buffer_append(&depfile, ":\n");
+        }
+        make_parent_directories(depfile_path);
+        int result = write_if_changed(depfile_path, &depfile);
+        if (result < 0) analyzer_log("Error: Could not write depfile %s\n", depfile_path);
+        else written += result;
+        buffer_free(&depfile);
+
+        // Im Manifest relativ zum Ausgabeverzeichnis: das Ende von depfile_path
+        buffer_append(&manifest, "%s\n    {\"file\": ", listed++ > 0 ? "," : "");
+        buffer_append_json_string(&manifest, source);
+        buffer_append(&manifest, ", \"depfile\": ");
+        buffer_append_json_string(&manifest, depfile_path + strlen(output_dir) + strlen(PATH_SEP));
+        buffer_append(&manifest, ", \"includes\": [");
+        for (int d = 0; d < dependency_count; d++) {
+            char path[MAX_PATH_LEN];
+            strcpy(path, ctx->files[dependencies[d]].filepath);
+            normalize_path_separators(path);
+            buffer_append(&manifest, "%s", d > 0 ? ", " : "");
+            buffer_append_json_string(&manifest, path);
+        }
+        buffer_append(&manifest, "]}");
+    }
+    buffer_append(&manifest, "%s]\n}\n", listed > 0 ? "\n  " : "");
+
+    char manifest_path[MAX_PATH_LEN];
+    int path_len = snprintf(manifest_path, sizeof(manifest_path), "%s" PATH_SEP DEPFILE_MANIFEST, output_dir);
+    if (path_len < 0 || path_len >= (int)sizeof(manifest_path)) {
+        analyzer_log("Error: Depfile directory path too long, %s not written\n", DEPFILE_MANIFEST);
+    } else {
+        int result = write_if_changed(manifest_path, &manifest);
+        if (result < 0) analyzer_log("Error: Could not write %s\n", manifest_path);
+        else written += result;
+    }
+    buffer_free(&manifest);
+
+    analyzer_log("Depfiles: %d translation units, %d files rewritten in %s\n", unit_count, written, output_dir);
+    free(included_by_count);
+    free(units);
+    free(dependencies);
+    return written;
+}
+
+// v1.4: Verzeichnis-Aggregation
+// Ein Durchlauf nach dem Parsen: Summen pro Verzeichnis, gewichteter Verzeichnis-Include-Graph,
+// Zyklen (SCCs) und Kopplung zwischen Modulen.
+
+// Verzeichnis relativ zum Projekt-Root ("." für das Root selbst)
+static void get_relative_directory(const char* full_path, char* out) {
+    get_relative_file_path(full_path, out);
+    char* last_slash = strrchr(out, '/');
+    if (last_slash) *last_slash = '\0';
+    else strcpy(out, ".");
+}
+
+static int find_or_add_directory_stats(const char* directory) {
+    for (int i = 0; i < ctx->directory_stats_count; i++) {
+        if (strcmp(ctx->directory_stats[i].directory, directory) == 0) return i;
+    }
+    DirectoryStats* stats = &ctx->directory_stats[ctx->directory_stats_count];
+    memset(stats, 0, sizeof(DirectoryStats));
+    strcpy(stats->directory, directory);
+    strcpy(stats->native_directory, directory);
+    to_native_separators(stats->native_directory);
+    return ctx->directory_stats_count++;
+}
+
+static void aggregate_directory_stats() {
+    ctx->directory_stats_count = 0;
+    free(ctx->file_directory);
+    ctx->file_directory = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+
+    int edge_count = 0;
+    for (int i = 0; i < ctx->file_count; i++) {
+        char directory[MAX_PATH_LEN];
+        get_relative_directory(ctx->files[i].filepath, directory);
+        ctx->file_directory[i] = find_or_add_directory_stats(directory);
+        edge_count += ctx->files[i].include_count;
+
+        FileAnalysis* analysis = &ctx->files[i];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+
+        DirectoryStats* stats = &ctx->directory_stats[ctx->file_directory[i]];
+        stats->file_count++;
+        stats->total_functions += analysis->void_function_count + analysis->function_count +
+                                  analysis->action_count;
+        stats->total_structs += analysis->struct_count + analysis->typedef_struct_count;
+        stats->total_includes += analysis->include_count;
+        stats->total_static_vars += analysis->static_var_count;
+        stats->total_overloads += analysis->overload_count;
+        stats->total_duplicates += analysis->static_duplicate_count;
+    }
+
+    // Verzeichnis-Graph: jede aufgelöste Include-Zeile zwischen zwei Verzeichnissen zählt als Gewicht 1
+    DepEdge* edges = (DepEdge*)malloc(sizeof(DepEdge) * (edge_count + 1));
+    edge_count = 0;
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (!ctx->files[i].is_used && ctx->use_include_tracking) continue;
+        for (int j = 0; j < ctx->files[i].include_count; j++) {
+            int target = ctx->files[i].include_targets[j];
+            if (target < 0) continue;
+            if (ctx->file_directory[i] == ctx->file_directory[target]) {
+                ctx->directory_stats[ctx->file_directory[i]].internal_includes++;
+                continue;
+            }
+            edges[edge_count].source = ctx->file_directory[i];
+            edges[edge_count].target = ctx->file_directory[target];
+            edges[edge_count].weight = 1;
+            edges[edge_count].type = EDGE_INCLUDE;
+            edge_count++;
+        }
+    }
+    free_dep_graph(&ctx->directory_graph);
+    build_dep_graph(&ctx->directory_graph, ctx->directory_stats_count, edges, edge_count);
+    free(edges);
+
+    for (int d = 0; d < ctx->directory_stats_count; d++) {
+        for (int e = ctx->directory_graph.first_edge[d]; e < ctx->directory_graph.first_edge[d + 1]; e++) {
+            int target = ctx->directory_graph.edge_target[e];
+            ctx->directory_stats[d].efferent_coupling++;
+            ctx->directory_stats[d].external_includes += ctx->directory_graph.edge_weight[e];
+            ctx->directory_stats[target].afferent_coupling++;
+        }
+    }
+
+    free(ctx->directory_component);
+    ctx->directory_component = (int*)malloc(sizeof(int) * (ctx->directory_stats_count + 1));
+    ctx->directory_component_count = compute_scc(&ctx->directory_graph, ctx->directory_component);
+}
+
+static int compare_directory_edges_by_weight(const void* a, const void* b) {
+    const DepEdge* x = (const DepEdge*)a;
+    const DepEdge* y = (const DepEdge*)b;
+    if (x->weight != y->weight) return y->weight - x->weight;
+    return compare_dep_edges(a, b);
+}
+
+static void write_directory_section(FILE* file) {
+    fprintf(file, "=== DIRECTORY STATISTICS ===\n");
+    fprintf(file, "%-40s %6s %6s %6s %6s %6s %6s %6s\n",
+            "Directory", "Files", "Funcs", "Structs", "Incl", "Static", "Overl", "Dupl");
+    for (int d = 0; d < ctx->directory_stats_count; d++) {
+        DirectoryStats* stats = &ctx->directory_stats[d];
+        if (stats->file_count == 0) continue;
+        fprintf(file, "%-40s %6d %6d %6d %6d %6d %6d %6d\n",
+                stats->directory, stats->file_count, stats->total_functions, stats->total_structs,
+                stats->total_includes, stats->total_static_vars, stats->total_overloads,
+                stats->total_duplicates);
+    }
+    fprintf(file, "\n");
+
+    // Kopplung: Ca = eingehende Module, Ce = ausgehende Module, I = Ce / (Ca + Ce)
+    fprintf(file, "=== DIRECTORY COUPLING ===\n");
+    fprintf(file, "%-40s %6s %6s %6s %8s %8s\n", "Directory", "Ca", "Ce", "I", "Internal", "External");
+    for (int d = 0; d < ctx->directory_stats_count; d++) {
+        DirectoryStats* stats = &ctx->directory_stats[d];
+        if (stats->file_count == 0) continue;
+        int coupling = stats->afferent_coupling + stats->efferent_coupling;
+        fprintf(file, "%-40s %6d %6d %6.2f %8d %8d\n",
+                stats->directory, stats->afferent_coupling, stats->efferent_coupling,
+                coupling > 0 ? (double)stats->efferent_coupling / coupling : 0.0,
+                stats->internal_includes, stats->external_includes);
+    }
+    fprintf(file, "\n");
+
+    if (ctx->directory_graph.edge_count > 0) {
+        DepEdge* edges = (DepEdge*)malloc(sizeof(DepEdge) * ctx->directory_graph.edge_count);
+        int edge_count = 0;
+        for (int d = 0; d < ctx->directory_stats_count; d++) {
+            for (int e = ctx->directory_graph.first_edge[d]; e < ctx->directory_graph.first_edge[d + 1]; e++) {
+                edges[edge_count].source = d;
+                edges[edge_count].target = ctx->directory_graph.edge_target[e];
+                edges[edge_count].weight = ctx->directory_graph.edge_weight[e];
+                edges[edge_count].type = EDGE_INCLUDE;
+                edge_count++;
+            }
+        }
+        qsort(edges, edge_count, sizeof(DepEdge), compare_directory_edges_by_weight);
+
+        fprintf(file, "=== DIRECTORY DEPENDENCIES ===\n");
+        for (int e = 0; e < edge_count; e++) {
+            int cyclic = ctx->directory_component[edges[e].source] == ctx->directory_component[edges[e].target];
+            fprintf(file, "%5d  %s -> %s%s\n", edges[e].weight,
+                    ctx->directory_stats[edges[e].source].directory,
+                    ctx->directory_stats[edges[e].target].directory,
+                    cyclic ? " [CYCLE]" : "");
+        }
+        fprintf(file, "\n");
+        free(edges);
+    }
+
+    // Zyklen: Komponenten mit mehr als einem Verzeichnis werden zu einem Modul zusammengefasst
+    int cycle_count = 0;
+    for (int c = 0; c < ctx->directory_component_count; c++) {
+        int members = 0, internal_weight = 0;
+        for (int d = 0; d < ctx->directory_stats_count; d++) {
+            if (ctx->directory_component[d] != c) continue;
+            members++;
+            for (int e = ctx->directory_graph.first_edge[d]; e < ctx->directory_graph.first_edge[d + 1]; e++) {
+                if (ctx->directory_component[ctx->directory_graph.edge_target[e]] == c) {
+                    internal_weight += ctx->directory_graph.edge_weight[e];
+                }
+            }
+        }
+        if (members < 2) continue;
+
+        if (cycle_count == 0) fprintf(file, "=== DIRECTORY CYCLES ===\n");
+        cycle_count++;
+        fprintf(file, "Cycle %d: %d directories, %d includes inside the cycle\n",
+                cycle_count, members, internal_weight);
+        for (int d = 0; d < ctx->directory_stats_count; d++) {
+            if (ctx->directory_component[d] == c) fprintf(file, "  %s\n", ctx->directory_stats[d].directory);
+        }
+    }
+    if (cycle_count > 0) fprintf(file, "\n");
+}
+
+// v1.4: Byte-identische Dateien (gleicher Inhalts-Hash) in verschiedenen Verzeichnissen
+static void write_duplicate_content_section(FILE* file) {
+    int copy_count = 0;
+    long wasted_bytes = 0;
+
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (ctx->files[i].duplicate_of >= 0) continue;
+        if (!ctx->files[i].is_used && ctx->use_include_tracking) continue;
+
+        int copies = 0;
+        for (int j = i + 1; j < ctx->file_count; j++) {
+            if (ctx->files[j].duplicate_of == i && (ctx->files[j].is_used || !ctx->use_include_tracking)) copies++;
+        }
+        if (copies == 0) continue;
+
+        if (copy_count == 0) fprintf(file, "=== DUPLICATE FILE CONTENT ===\n");
+        copy_count += copies;
+        wasted_bytes += ctx->files[i].file_size * copies;
+
+        char relative_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[i].filepath, relative_path);
+        fprintf(file, "%d identical copies of %s (%ld bytes each, %ld bytes wasted):\n",
+                copies + 1, ctx->files[i].filename, ctx->files[i].file_size, ctx->files[i].file_size * copies);
+        fprintf(file, "  %s\n", relative_path);
+        for (int j = i + 1; j < ctx->file_count; j++) {
+            if (ctx->files[j].duplicate_of != i || (!ctx->files[j].is_used && ctx->use_include_tracking)) continue;
+            get_relative_file_path(ctx->files[j].filepath, relative_path);
+            fprintf(file, "  %s\n", relative_path);
+        }
+    }
+
+    if (copy_count > 0) {
+        fprintf(file, "Redundant copies: %d, wasted bytes: %ld\n\n", copy_count, wasted_bytes);
+    }
+}
+
+static const char* symbol_kind_name(int kind) {
+    switch (kind) {
+    case SYMBOL_VOID: return "void";
+    case SYMBOL_FUNCTION: return "function";
+    case SYMBOL_ACTION: return "action";
+    }
+    return "symbol";
+}
+
+static int compare_symbols_by_name(const void* a, const void* b) {
+    const SymbolDefinition* x = &ctx->symbols[*(const int*)a];
+    const SymbolDefinition* y = &ctx->symbols[*(const int*)b];
+    int cmp = strcmp(interned_string(x->name_id), interned_string(y->name_id));
+    if (cmp != 0) return cmp;
+    if (x->file_index != y->file_index) return x->file_index - y->file_index;
+    return x->line - y->line;
+}
+
+// Gleichnamige Funktionen/Actions (auch Prototyp + Definition) aus der Symbol-Tabelle
+static void write_overload_section(FILE* file) {
+    int* order = (int*)malloc(sizeof(int) * (ctx->symbol_count + 1));
+    for (int i = 0; i < ctx->symbol_count; i++) order[i] = i;
+    qsort(order, ctx->symbol_count, sizeof(int), compare_symbols_by_name);
+
+    int group_count = 0;
+    for (int start = 0; start < ctx->symbol_count;) {
+        int end = start + 1;
+        while (end < ctx->symbol_count && ctx->symbols[order[end]].name_id == ctx->symbols[order[start]].name_id) end++;
+
+        if (end - start > 1) {
+            if (group_count == 0) fprintf(file, "=== FUNCTION OVERLOADS ===\n");
+            group_count++;
+            fprintf(file, "%s: %d occurrences\n", interned_string(ctx->symbols[order[start]].name_id), end - start);
+            for (int k = start; k < end; k++) {
+                SymbolDefinition* symbol = &ctx->symbols[order[k]];
+                char relative_path[MAX_PATH_LEN];
+                get_relative_file_path(ctx->files[symbol->file_index].filepath, relative_path);
+                fprintf(file, "  %s:%d (%s)\n", relative_path, symbol->line, symbol_kind_name(symbol->kind));
+            }
+        }
+        start = end;
+    }
+    if (group_count > 0) fprintf(file, "\n");
+    free(order);
+}
+
+// Präprozessierte Zeilen, die nur über Include j von Datei f hereinkommen
+static long unused_include_savings(int f, int j) {
+    if (!ctx->include_closure) return 0;
+    unsigned char* other = (unsigned char*)calloc(ctx->closure_stride, 1);
+    for (int k = 0; k < ctx->files[f].include_count; k++) {
+        int target = ctx->files[f].include_targets[k];
+        if (k == j || target < 0) continue;
+        BITSET_SET(other, target);
+        unsigned char* row = CLOSURE_ROW(target);
+        for (int b = 0; b < ctx->closure_stride; b++) other[b] |= row[b];
+    }
+
+    int removed = ctx->files[f].include_targets[j];
+    long saved = 0;
+    for (int x = 0; x < ctx->file_count; x++) {
+        if (x == f || BITSET_TEST(other, x)) continue;
+        if (x == removed || BITSET_TEST(CLOSURE_ROW(removed), x)) saved += ctx->files[x].line_count;
+    }
+    free(other);
+    return saved;
+}
+
+static int count_unused_includes() {
+    int count = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            if (ctx->files[f].include_usage[j] == INCLUDE_USAGE_UNUSED) count++;
+        }
+    }
+    return count;
+}
+
+static void write_unused_include_section(FILE* file) {
+    if (count_unused_includes() == 0) return;
+
+    fprintf(file, "=== UNUSED INCLUDES ===\n");
+    fprintf(file, "(no symbol of the header or of its includes appears in the including file;\n");
+    fprintf(file, " headers included later in the same compilation may still rely on it)\n");
+    int removable = 0;
+    long total_saved = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            if (ctx->files[f].include_usage[j] != INCLUDE_USAGE_UNUSED) continue;
+            char relative_path[MAX_PATH_LEN];
+            char target_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[f].filepath, relative_path);
+            get_relative_file_path(ctx->files[ctx->files[f].include_targets[j]].filepath, target_path);
+            long saved = unused_include_savings(f, j);
+            fprintf(file, "%s:%d -> %s (saves %ld preprocessed lines)\n",
+                    relative_path, ctx->files[f].include_lines[j], target_path, saved);
+            removable++;
+            total_saved += saved;
+        }
+    }
+    fprintf(file, "Removable include lines: %d, preprocessed lines saved: %ld\n\n", removable, total_saved);
+}
+
+// v1.4: Vorwärtsdeklarationen statt Includes. Kosten je Empfehlung: Zeilen, die nur über dieses
+// Include in die Datei kommen, und Zeilen aller Translation Units, die die Datei erreichen, ohne die
+// Include-Zeile (closure_lines_without); "entkoppelt": Units, die den Header danach nicht mehr erreichen.
+typedef struct {
+    int file_index;
+    int include_slot;
+    int decl_first;                 // Bereich in forward_decls[]
+    int decl_count;
+    long file_lines;
+    long unit_lines;
+    int unit_count;
+    int decoupled_units;
+} ForwardSuggestion;
+
+static void append_type_forward_declaration(TextBuffer* buffer, int name_id);
+static long closure_lines_without(int start, const unsigned char* cut, const int* slot_first, int* queue);
+
+static int compare_forward_suggestions(const void* a, const void* b) {
+    const ForwardSuggestion* x = (const ForwardSuggestion*)a;
+    const ForwardSuggestion* y = (const ForwardSuggestion*)b;
+    if (x->unit_lines != y->unit_lines) return x->unit_lines < y->unit_lines ? 1 : -1;
+    if (x->file_index != y->file_index) return x->file_index - y->file_index;
+    return x->include_slot - y->include_slot;
+}
+
+static void write_forward_declaration_section(FILE* file) {
+    if (ctx->forward_decl_count == 0 || !ctx->include_closure) return;
+
+    int n = ctx->file_count;
+    int* slot_first = (int*)malloc(sizeof(int) * (n + 1));
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    int slot_count = 0;
+    for (int f = 0; f < n; f++) {
+        slot_first[f] = slot_count;
+        slot_count += ctx->files[f].include_count;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target >= 0 && target != f) included_by_count[target]++;
+        }
+    }
+    unsigned char* cut = (unsigned char*)calloc(slot_count + 1, 1);
+    int* queue = (int*)malloc(sizeof(int) * (n + 1));
+    ForwardSuggestion* suggestions = (ForwardSuggestion*)malloc(sizeof(ForwardSuggestion) * ctx->forward_decl_count);
+    int suggestion_count = 0;
+
+    for (int f = 0; f < n; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+        int end = analysis->forward_decl_first + analysis->forward_decl_total;
+        for (int k = analysis->forward_decl_first; k < end; ) {
+            ForwardSuggestion suggestion;
+            memset(&suggestion, 0, sizeof(suggestion));
+            suggestion.file_index = f;
+            suggestion.include_slot = ctx->forward_decls[k].include_slot;
+            suggestion.decl_first = k;
+            while (k < end && ctx->forward_decls[k].include_slot == suggestion.include_slot) k++;
+            suggestion.decl_count = k - suggestion.decl_first;
+            int target = analysis->include_targets[suggestion.include_slot];
+            if (target < 0) continue;
+
+            suggestion.file_lines = unused_include_savings(f, suggestion.include_slot);
+            cut[slot_first[f] + suggestion.include_slot] = 1;
+            for (int t = 0; t < n; t++) {
+                if (!is_translation_unit(t, included_by_count) || (t != f && !BITSET_TEST(CLOSURE_ROW(t), f))) continue;
+                long saved = get_closure_lines(t) - closure_lines_without(t, cut, slot_first, queue);
+                if (saved <= 0) continue;
+                suggestion.unit_count++;
+                suggestion.unit_lines += saved;
+                if (ctx->closure_visit_stamp[target] != ctx->closure_visit_serial) suggestion.decoupled_units++;
+            }
+            cut[slot_first[f] + suggestion.include_slot] = 0;
+            suggestions[suggestion_count++] = suggestion;
+        }
+    }
+    qsort(suggestions, suggestion_count, sizeof(ForwardSuggestion), compare_forward_suggestions);
+
+    if (suggestion_count > 0) {
+        fprintf(file, "=== FORWARD DECLARATIONS ===\n");
+        fprintf(file, "(the including file uses these structs of the header only through pointers - the include line\n");
+        fprintf(file, " can be replaced by the declarations shown; headers included later may still rely on it)\n");
+    }
+    long total_unit_lines = 0;
+    for (int i = 0; i < suggestion_count; i++) {
+        const ForwardSuggestion* suggestion = &suggestions[i];
+        const FileAnalysis* analysis = &ctx->files[suggestion->file_index];
+        int target = analysis->include_targets[suggestion->include_slot];
+        char relative_path[MAX_PATH_LEN];
+        char target_path[MAX_PATH_LEN];
+        get_relative_file_path(analysis->filepath, relative_path);
+        get_relative_file_path(ctx->files[target].filepath, target_path);
+
+        TextBuffer declarations;
+        memset(&declarations, 0, sizeof(TextBuffer));
+        for (int k = suggestion->decl_first; k < suggestion->decl_first + suggestion->decl_count; k++) {
+            if (k > suggestion->decl_first) buffer_append(&declarations, " ");
+            append_type_forward_declaration(&declarations, ctx->forward_decls[k].name_id);
+        }
+        fprintf(file, "%s:%d -> %s: %s\n", relative_path, analysis->include_lines[suggestion->include_slot], target_path,
+                declarations.data);
+        fprintf(file, "  saves %ld preprocessed lines in the file", suggestion->file_lines);
+        if (suggestion->unit_count > 0) {
+            fprintf(file, ", %ld in %d translation unit(s)", suggestion->unit_lines, suggestion->unit_count);
+        } else {
+            fprintf(file, " (translation units still reach the header through other includes)");
+        }
+        if (suggestion->decoupled_units > 0) {
+            fprintf(file, "; %d of them no longer depend on %s", suggestion->decoupled_units, target_path);
+        }
+        fprintf(file, "\n");
+        buffer_free(&declarations);
+        total_unit_lines += suggestion->unit_lines;
+    }
+    if (suggestion_count > 0) {
+        fprintf(file, "Replaceable include lines: %d, preprocessed lines saved in translation units: %ld\n\n",
+                suggestion_count, total_unit_lines);
+    }
+
+    free(slot_first);
+    free(included_by_count);
+    free(cut);
+    free(queue);
+    free(suggestions);
+}
+
+static int include_line_of(int from, int to);
+
+static int compare_files_by_lines(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    if (ctx->files[x].line_count != ctx->files[y].line_count) return ctx->files[y].line_count - ctx->files[x].line_count;
+    return x - y;
+}
+
+// Build-Ebenen: Dateien und präprozessierte Zeilen je Ebene, dazu der kritische Pfad
+static void write_build_level_section(FILE* file) {
+    if (!ctx->file_level || ctx->build_level_count == 0) return;
+
+    int* level_files = (int*)calloc(ctx->build_level_count + 1, sizeof(int));
+    long* level_lines = (long*)calloc(ctx->build_level_count + 1, sizeof(long));
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        level_files[ctx->file_level[f]]++;
+        level_lines[ctx->file_level[f]] += get_closure_lines(f);
+    }
+
+    fprintf(file, "=== BUILD LEVELS ===\n");
+    fprintf(file, "(include cycles collapsed; level 0 = files without includes, every file only includes\n");
+    fprintf(file, " lower levels; preprocessed lines = sum of the transitive includes of all files on the level)\n");
+    fprintf(file, "Level  Files  Preprocessed lines\n");
+    for (int l = 0; l < ctx->build_level_count; l++) {
+        fprintf(file, "%5d  %5d  %ld\n", l, level_files[l], level_lines[l]);
+    }
+
+    int steps = 1;
+    for (int k = 1; k < ctx->critical_path_length; k++) {
+        if (ctx->file_component[ctx->critical_path[k]] != ctx->file_component[ctx->critical_path[k - 1]]) steps++;
+    }
+    fprintf(file, "Critical path: %ld lines in %d steps (longest chain of own lines from a translation unit\n",
+            ctx->critical_path_lines, steps);
+    fprintf(file, " down to a leaf header; each step has to be processed before the one above it)\n");
+    char from[MAX_PATH_LEN], to[MAX_PATH_LEN];
+    get_relative_file_path(ctx->files[ctx->critical_path[0]].filepath, from);
+    fprintf(file, "  %s [%d lines]\n", from, ctx->files[ctx->critical_path[0]].line_count);
+    for (int k = 1; k < ctx->critical_path_length; k++) {
+        int a = ctx->critical_path[k - 1], b = ctx->critical_path[k];
+        get_relative_file_path(ctx->files[a].filepath, from);
+        get_relative_file_path(ctx->files[b].filepath, to);
+        if (ctx->file_component[a] == ctx->file_component[b]) {
+            fprintf(file, "  %s ~> %s [%d lines] (same include cycle)\n", from, to, ctx->files[b].line_count);
+        } else {
+            fprintf(file, "  %s:%d -> %s [%d lines]\n", from, include_line_of(a, b), to, ctx->files[b].line_count);
+        }
+    }
+
+    // Split-Kandidaten: die größten Header auf dem Pfad
+    int* headers = (int*)malloc(sizeof(int) * (ctx->critical_path_length + 1));
+    for (int k = 1; k < ctx->critical_path_length; k++) headers[k - 1] = ctx->critical_path[k];
+    int header_count = ctx->critical_path_length - 1;
+    if (header_count > 1) qsort(headers, header_count, sizeof(int), compare_files_by_lines);
+    if (header_count > 0) {
+        fprintf(file, "Largest headers on the critical path:");
+        for (int k = 0; k < header_count && k < 3; k++) {
+            get_relative_file_path(ctx->files[headers[k]].filepath, to);
+            fprintf(file, "%s %s (%d lines)", k > 0 ? "," : "", to, ctx->files[headers[k]].line_count);
+        }
+        fprintf(file, "\n");
+    }
+    free(headers);
+    fprintf(file, "\n");
+
+    free(level_files);
+    free(level_lines);
+}
+
+// Aufrufgraph: Übersicht, Datei-zu-Datei Aufrufe und tote Funktionen
+static void write_call_graph_section(FILE* file) {
+    if (!ctx->call_graph_built) return;
+
+    int definitions = 0;
+    for (int s = 0; s < ctx->symbol_count; s++) {
+        if (!ctx->symbols[s].is_prototype) definitions++;
+    }
+    fprintf(file, "=== CALL GRAPH ===\n");
+    fprintf(file, "Function/action definitions: %d\n", definitions);
+    fprintf(file, "Body references: %d (resolved to project functions: %d)\n", ctx->call_ref_count, ctx->resolved_call_refs);
+    fprintf(file, "Call edges: %d\n\n", ctx->call_graph.edge_count);
+
+    // Welche Dateien liefern die Funktionen, die eine Datei tatsächlich verwendet?
+    // [NOT INCLUDED]: weder Definition noch Prototyp ist über die Includes dieser Datei
+    // erreichbar - der Aufruf funktioniert nur dank der Include-Reihenfolge anderer Dateien
+    int* calls_into = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    int* hidden = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    int* touched = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int header_written = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        int touched_count = 0;
+        for (int s = ctx->files[f].first_symbol; s < ctx->files[f].first_symbol + ctx->files[f].symbol_total; s++) {
+            for (int e = ctx->call_graph.first_edge[s]; e < ctx->call_graph.first_edge[s + 1]; e++) {
+                int target_file = ctx->symbols[ctx->call_graph.edge_target[e]].file_index;
+                if (target_file == f) continue;
+                if (calls_into[target_file] == 0) touched[touched_count++] = target_file;
+                calls_into[target_file] += ctx->call_graph.edge_weight[e];
+                if (!symbol_visible_from(f, ctx->symbols[ctx->call_graph.edge_target[e]].name_id)) hidden[target_file] = 1;
+            }
+        }
+        if (touched_count == 0) continue;
+
+        if (!header_written) {
+            fprintf(file, "=== FILE CALL DEPENDENCIES ===\n");
+            header_written = 1;
+        }
+        char relative_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[f].filepath, relative_path);
+        fprintf(file, "%s\n", relative_path);
+        for (int k = 0; k < touched_count; k++) {
+            int target_file = touched[k];
+            char target_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[target_file].filepath, target_path);
+            fprintf(file, "  -> %s (%d)%s\n", target_path, calls_into[target_file],
+                    hidden[target_file] ? " [NOT INCLUDED]" : "");
+            calls_into[target_file] = 0;
+            hidden[target_file] = 0;
+        }
+    }
+    if (header_written) fprintf(file, "\n");
+    free(calls_into);
+    free(hidden);
+    free(touched);
+
+    if (ctx->dead_function_count > 0) {
+        fprintf(file, "=== DEAD FUNCTIONS ===\n");
+        fprintf(file, "(never referenced from any function body; actions and main are entry points)\n");
+        for (int s = 0; s < ctx->symbol_count; s++) {
+            if (!is_dead_function(s)) continue;
+            char relative_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[ctx->symbols[s].file_index].filepath, relative_path);
+            fprintf(file, "%s:%d  %s %s()\n", relative_path, ctx->symbols[s].line,
+                    symbol_kind_name(ctx->symbols[s].kind), interned_string(ctx->symbols[s].name_id));
+        }
+        fprintf(file, "\n");
+    }
+}
+
+// v1.4: Makro-Abschnitte
+static int compare_macro_defs_by_name(const void* a, const void* b) {
+    const MacroDefinition* x = &ctx->macro_defs[*(const int*)a];
+    const MacroDefinition* y = &ctx->macro_defs[*(const int*)b];
+    int cmp = strcmp(interned_string(x->name_id), interned_string(y->name_id));
+    if (cmp != 0) return cmp;
+    if (x->file_index != y->file_index) return x->file_index - y->file_index;
+    return x->line - y->line;
+}
+
+// Makros mit mehreren, unterschiedlichen Definitionen; file != NULL schreibt den Abschnitt
+static int write_macro_conflicts(FILE* file) {
+    int* order = (int*)malloc(sizeof(int) * (ctx->macro_def_count + 1));
+    int order_count = 0;
+    for (int i = 0; i < ctx->macro_def_count; i++) {
+        if (!ctx->files[ctx->macro_defs[i].file_index].is_used && ctx->use_include_tracking) continue;
+        order[order_count++] = i;
+    }
+    qsort(order, order_count, sizeof(int), compare_macro_defs_by_name);
+
+    int conflict_count = 0;
+    for (int start = 0; start < order_count;) {
+        int end = start + 1;
+        int conflicting = 0;
+        while (end < order_count && ctx->macro_defs[order[end]].name_id == ctx->macro_defs[order[start]].name_id) {
+            if (ctx->macro_defs[order[end]].body_id != ctx->macro_defs[order[start]].body_id ||
+                ctx->macro_defs[order[end]].has_parameters != ctx->macro_defs[order[start]].has_parameters) conflicting = 1;
+            end++;
+        }
+
+        if (conflicting) {
+            conflict_count++;
+            if (file) {
+                if (conflict_count == 1) fprintf(file, "=== MACRO CONFLICTS ===\n");
+                fprintf(file, "%s: %d definitions\n", interned_string(ctx->macro_defs[order[start]].name_id), end - start);
+                for (int k = start; k < end; k++) {
+                    MacroDefinition* def = &ctx->macro_defs[order[k]];
+                    char relative_path[MAX_PATH_LEN];
+                    get_relative_file_path(ctx->files[def->file_index].filepath, relative_path);
+                    const char* body = interned_string(def->body_id);
+                    fprintf(file, "  %s:%d  #define %s%s%s\n", relative_path, def->line, interned_string(def->name_id),
+                            def->has_parameters || !body[0] ? "" : " ", body);
+                }
+            }
+        }
+        start = end;
+    }
+    if (file && conflict_count > 0) fprintf(file, "\n");
+    free(order);
+    return conflict_count;
+}
+
+static int count_macro_only_includes() {
+    int count = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            if (ctx->files[f].include_usage[j] == INCLUDE_USAGE_MACRO_ONLY) count++;
+        }
+    }
+    return count;
+}
+
+// Verschiedene Makros, die Datei f aus target (oder dessen Includes) verwendet
+static int collect_include_macros(int f, int target, int* name_ids, int max_names) {
+    int count = 0;
+    for (int u = ctx->files[f].macro_use_first; u < ctx->files[f].macro_use_first + ctx->files[f].macro_use_total; u++) {
+        const MacroDefinition* def = &ctx->macro_defs[ctx->macro_uses[u].definition];
+        int g = def->file_index;
+        if (g != target && !(ctx->include_closure && BITSET_TEST(CLOSURE_ROW(target), g))) continue;
+        int known = 0;
+        for (int k = 0; k < count && k < max_names && !known; k++) known = name_ids[k] == def->name_id;
+        if (known) continue;
+        if (count < max_names) name_ids[count] = def->name_id;
+        count++;
+    }
+    return count;
+}
+
+static void write_macro_name_list(FILE* file, const int* name_ids, int count, int max_names) {
+    for (int k = 0; k < count && k < max_names; k++) {
+        fprintf(file, "%s%s", k > 0 ? ", " : "", interned_string(name_ids[k]));
+    }
+    if (count > max_names) fprintf(file, ", ... (%d macros)", count);
+}
+
+#define MACRO_NAMES_SHOWN 5
+
+// Reine Makro-Abhängigkeiten und Includes, die nur wegen Makros da sind
+static void write_macro_dependency_section(FILE* file) {
+    int name_ids[MACRO_NAMES_SHOWN];
+
+    if (ctx->file_dependency_graph_built && ctx->macro_edge_count > 0) {
+        fprintf(file, "=== MACRO DEPENDENCIES ===\n");
+        fprintf(file, "(the file uses macros of the target but calls none of its functions;\n");
+        fprintf(file, " [NOT INCLUDED]: the target is not reachable through the file's own includes)\n");
+        for (int f = 0; f < ctx->file_count; f++) {
+            if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+            for (int e = ctx->file_dependency_graph.first_edge[f]; e < ctx->file_dependency_graph.first_edge[f + 1]; e++) {
+                if (ctx->file_dependency_graph.edge_type[e] != EDGE_MACRO) continue;
+                int target = ctx->file_dependency_graph.edge_target[e];
+                char relative_path[MAX_PATH_LEN];
+                char target_path[MAX_PATH_LEN];
+                get_relative_file_path(ctx->files[f].filepath, relative_path);
+                get_relative_file_path(ctx->files[target].filepath, target_path);
+
+                int count = 0;
+                for (int u = ctx->files[f].macro_use_first; u < ctx->files[f].macro_use_first + ctx->files[f].macro_use_total; u++) {
+                    const MacroDefinition* def = &ctx->macro_defs[ctx->macro_uses[u].definition];
+                    if (def->file_index != target) continue;
+                    if (count < MACRO_NAMES_SHOWN) name_ids[count] = def->name_id;
+                    count++;
+                }
+                fprintf(file, "%s -> %s (", relative_path, target_path);
+                write_macro_name_list(file, name_ids, count, MACRO_NAMES_SHOWN);
+                fprintf(file, ")%s\n",
+                        ctx->include_closure && !BITSET_TEST(CLOSURE_ROW(f), target) ? " [NOT INCLUDED]" : "");
+            }
+        }
+        fprintf(file, "Macro-only file dependencies: %d\n\n", ctx->macro_edge_count);
+    }
+
+    if (count_macro_only_includes() == 0) return;
+
+    // Pro Header: wie oft wird er nur für genau ein Makro inkludiert?
+    int* single_macro_includes = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    fprintf(file, "=== MACRO-ONLY INCLUDES ===\n");
+    fprintf(file, "(only macros of the header or of its includes appear in the including file)\n");
+    for (int f = 0; f < ctx->file_count; f++) {
+        if (!ctx->files[f].is_used && ctx->use_include_tracking) continue;
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            if (ctx->files[f].include_usage[j] != INCLUDE_USAGE_MACRO_ONLY) continue;
+            int target = ctx->files[f].include_targets[j];
+            char relative_path[MAX_PATH_LEN];
+            char target_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[f].filepath, relative_path);
+            get_relative_file_path(ctx->files[target].filepath, target_path);
+            int count = collect_include_macros(f, target, name_ids, MACRO_NAMES_SHOWN);
+            fprintf(file, "%s:%d -> %s: ", relative_path, ctx->files[f].include_lines[j], target_path);
+            if (count == 0) fprintf(file, "(used macros are redefined by the including file)");
+            write_macro_name_list(file, name_ids, count, MACRO_NAMES_SHOWN);
+            fprintf(file, "\n");
+            if (count == 1) single_macro_includes[target]++;
+        }
+    }
+
+    int header_written = 0;
+    for (int h = 0; h < ctx->file_count; h++) {
+        if (single_macro_includes[h] == 0) continue;
+        if (!header_written) {
+            fprintf(file, "Split-out candidates (headers included for a single macro):\n");
+            header_written = 1;
+        }
+        char header_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[h].filepath, header_path);
+        fprintf(file, "  %s: %d include(s), %ld preprocessed lines\n", header_path, single_macro_includes[h],
+                get_closure_lines(h));
+    }
+    fprintf(file, "\n");
+    free(single_macro_includes);
+}
+
+// v1.4: Struct-Layouts - Größe und Padding je Struct, Padding-Lücken, Felder über einer
+// Cache-Line-Grenze und Members unbekannter Größe
+static void write_struct_layout_section(FILE* file) {
+    int struct_count = 0;
+    long total_size = 0, total_padding = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+        if (analysis->duplicate_of >= 0) continue;
+        char relative_path[MAX_PATH_LEN];
+        get_relative_file_path(analysis->filepath, relative_path);
+
+        for (int l = analysis->struct_layout_first; l < analysis->struct_layout_first + analysis->struct_layout_total; l++) {
+            const StructLayout* layout = &ctx->struct_layouts[l];
+            if (struct_count == 0) {
+                fprintf(file, "=== STRUCT LAYOUT ===\n");
+                fprintf(file, "(Lite-C sizes: var/int/long/float/fixed 4, double 8, pointers %d; natural alignment; "
+                              "%d-byte cache lines)\n", LITEC_POINTER_SIZE, CACHE_LINE_SIZE);
+            }
+            struct_count++;
+            total_size += layout->size;
+            total_padding += layout->padding;
+            fprintf(file, "%s:%d  %s: %ld bytes, %ld padding, align %d%s\n", relative_path, layout->line,
+                    interned_string(layout->name_id), layout->size, layout->padding, layout->align,
+                    layout->unknown_members ? " [incomplete]" : "");
+
+            long end = 0;
+            for (int m = layout->member_first; m < layout->member_first + layout->member_count; m++) {
+                const DataMember* member = &ctx->data_members[m];
+                const char* member_name = interned_string(member->name_id);
+                if (member->offset > end) {
+                    fprintf(file, "  padding: %ld bytes before '%s' (offset %ld)\n", member->offset - end, member_name,
+                            member->offset);
+                }
+                end = member->offset + member->size;
+                if (member->size > 0 && member->size <= CACHE_LINE_SIZE &&
+                    member->offset / CACHE_LINE_SIZE != (end - 1) / CACHE_LINE_SIZE) {
+                    fprintf(file, "  crosses cache line: '%s' (offset %ld, %ld bytes)\n", member_name, member->offset,
+                            member->size);
+                }
+                if (!member->size_known) {
+                    fprintf(file, "  unknown size: '%s' (%s%s), counted as %ld bytes\n", member_name,
+                            interned_string(member->type_id), member->dims_id >= 0 ? " array" : "", member->size);
+                }
+            }
+            if (layout->size > end && layout->member_count > 0) {
+                fprintf(file, "  padding: %ld bytes at the end\n", layout->size - end);
+            }
+        }
+    }
+    if (struct_count > 0) {
+        fprintf(file, "Structs: %d, total size: %ld bytes, padding: %ld bytes\n\n", struct_count, total_size,
+                total_padding);
+    }
+}
+
+typedef struct {
+    int file_index;
+    long bytes;
+} StaticFootprint;
+
+static int compare_static_footprints(const void* a, const void* b) {
+    const StaticFootprint* x = (const StaticFootprint*)a;
+    const StaticFootprint* y = (const StaticFootprint*)b;
+    if (x->bytes != y->bytes) return x->bytes < y->bytes ? 1 : -1;
+    return x->file_index - y->file_index;
+}
+
+// Statischer Speicher je Datei, größte zuerst
+static void write_static_footprint_section(FILE* file) {
+    StaticFootprint* footprints = (StaticFootprint*)malloc(sizeof(StaticFootprint) * (ctx->file_count + 1));
+    int count = 0;
+    long total = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+        if (analysis->static_storage_total == 0) continue;
+        long bytes = 0;
+        for (int v = analysis->static_storage_first; v < analysis->static_storage_first + analysis->static_storage_total; v++) {
+            bytes += ctx->data_members[v].size;
+        }
+        footprints[count].file_index = f;
+        footprints[count].bytes = bytes;
+        count++;
+        total += bytes;
+    }
+    if (count > 0) {
+        qsort(footprints, count, sizeof(StaticFootprint), compare_static_footprints);
+        fprintf(file, "=== STATIC MEMORY FOOTPRINT ===\n");
+        for (int i = 0; i < count; i++) {
+            const FileAnalysis* analysis = &ctx->files[footprints[i].file_index];
+            const DataMember* largest = NULL;
+            int incomplete = 0;
+            for (int v = analysis->static_storage_first; v < analysis->static_storage_first + analysis->static_storage_total; v++) {
+                const DataMember* member = &ctx->data_members[v];
+                if (!largest || member->size > largest->size) largest = member;
+                if (!member->size_known) incomplete = 1;
+            }
+            char relative_path[MAX_PATH_LEN];
+            get_relative_file_path(analysis->filepath, relative_path);
+            fprintf(file, "%s: %ld bytes in %d static variables (largest: %s, %ld bytes)%s\n", relative_path,
+                    footprints[i].bytes, analysis->static_storage_total, interned_string(largest->name_id),
+                    largest->size, incomplete ? " [incomplete]" : "");
+        }
+        fprintf(file, "Total static memory: %ld bytes\n\n", total);
+    }
+    free(footprints);
+}
+
+static int compare_frame_loops_by_cost(const void* a, const void* b) {
+    const FrameLoop* x = &ctx->frame_loops[*(const int*)a];
+    const FrameLoop* y = &ctx->frame_loops[*(const int*)b];
+    if (x->cost != y->cost) return x->cost < y->cost ? 1 : -1;
+    return *(const int*)a - *(const int*)b;
+}
+
+static int compare_loop_calls_by_cost(const void* a, const void* b) {
+    const LoopCall* x = &ctx->loop_calls[*(const int*)a];
+    const LoopCall* y = &ctx->loop_calls[*(const int*)b];
+    if (x->cost != y->cost) return x->cost < y->cost ? 1 : -1;
+    return x->line - y->line;
+}
+
+// v1.4: Per-Frame-Schleifen nach geschätzten Kosten, mit allen Aufrufen im Rumpf
+static void write_hot_loop_section(FILE* file) {
+    int* order = (int*)malloc(sizeof(int) * (ctx->frame_loop_count + 1));
+    int count = 0, wait_only = 0;
+    for (int l = 0; l < ctx->frame_loop_count; l++) {
+        const FileAnalysis* analysis = &ctx->files[ctx->frame_loops[l].file_index];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+        if (analysis->duplicate_of >= 0) continue;
+        if (ctx->frame_loops[l].call_count == 0) wait_only++;       // "while (paused) wait(1);"
+        else order[count++] = l;
+    }
+    if (count == 0) {
+        free(order);
+        return;
+    }
+    qsort(order, count, sizeof(int), compare_frame_loops_by_cost);
+
+    fprintf(file, "=== PER-FRAME HOT LOOPS ===\n");
+    fprintf(file, "(loops with wait() run once per frame and entity; heuristic cost units, user functions include\n");
+    fprintf(file, " everything they call; calls in inner loops without wait() count x%d per level)\n", HOT_LOOP_NEST_FACTOR);
+    int shown = count < HOT_LOOPS_SHOWN ? count : HOT_LOOPS_SHOWN;
+    for (int i = 0; i < shown; i++) {
+        const FrameLoop* loop = &ctx->frame_loops[order[i]];
+        char relative_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[loop->file_index].filepath, relative_path);
+        fprintf(file, "%3d. %s:%d in %s: cost %ld, %d called functions\n", i + 1, relative_path, loop->line,
+                interned_string(loop->function_name_id), loop->cost, loop->call_count);
+
+        int* calls = (int*)malloc(sizeof(int) * (loop->call_count + 1));
+        for (int c = 0; c < loop->call_count; c++) calls[c] = loop->call_first + c;
+        qsort(calls, loop->call_count, sizeof(int), compare_loop_calls_by_cost);
+        for (int c = 0; c < loop->call_count; c++) {
+            const LoopCall* call = &ctx->loop_calls[calls[c]];
+            int is_user = call->name_id < ctx->string_pool_count && ctx->symbol_name_first &&
+                          ctx->symbol_name_first[call->name_id] >= 0;
+            fprintf(file, "     %s()%s line %d", interned_string(call->name_id), is_user ? " [project]" : "", call->line);
+            if (call->count > 1) fprintf(file, ", %d calls", call->count);
+            if (call->nesting > 0) fprintf(file, ", inner loop depth %d", call->nesting);
+            if (call->cost > 0) fprintf(file, ": %ld", call->cost);
+            fprintf(file, "\n");
+        }
+        free(calls);
+    }
+    if (count > shown) fprintf(file, "... %d more frame loops\n", count - shown);
+    fprintf(file, "Frame loops: %d (plus %d that only wait)\n\n", count, wait_only);
+    free(order);
+}
+
+// v1.4: Asset-Footprint je Action und main(), danach fehlende Dateien mit Fundstelle
+#define ASSET_ROOTS_SHOWN 30
+#define ASSET_MISSING_SHOWN 50
+
+static void write_asset_section(FILE* file) {
+    int* referenced = (int*)calloc(ctx->asset_file_count + 1, sizeof(int));
+    int asset_count = 0, found_count = 0, missing_count = 0;
+    long found_bytes = 0;
+    for (int r = 0; r < ctx->asset_ref_count; r++) {
+        const AssetReference* ref = &ctx->asset_refs[r];
+        if (ref->asset < 0 || referenced[ref->asset]) continue;
+        referenced[ref->asset] = 1;
+        asset_count++;
+        if (ctx->asset_files[ref->asset].size >= 0) {
+            found_count++;
+            found_bytes += ctx->asset_files[ref->asset].size;
+        } else {
+            missing_count++;
+        }
+    }
+    free(referenced);
+    if (asset_count == 0) return;
+
+    fprintf(file, "=== ASSET FOOTPRINT ===\n");
+    fprintf(file, "(file names in string literals and PRAGMA_BIND, resolved against the project root, the PRAGMA_PATH\n");
+    fprintf(file, " directories and the referencing file's directory; footprint = distinct assets reachable through calls)\n");
+    fprintf(file, "Referenced assets: %d, found: %d (%ld bytes), missing: %d\n", asset_count, found_count, found_bytes,
+            missing_count);
+    if (ctx->global_asset_count > 0) {
+        fprintf(file, "Always loaded (PRAGMA_BIND and unnamed globals): %d asset%s, %ld bytes\n", ctx->global_asset_count,
+                ctx->global_asset_count == 1 ? "" : "s", ctx->global_asset_bytes);
+    }
+
+    int shown = ctx->asset_footprint_count < ASSET_ROOTS_SHOWN ? ctx->asset_footprint_count : ASSET_ROOTS_SHOWN;
+    for (int i = 0; i < shown; i++) {
+        const AssetFootprint* footprint = &ctx->asset_footprints[i];
+        const SymbolDefinition* symbol = &ctx->symbols[footprint->symbol];
+        char relative_path[MAX_PATH_LEN];
+        get_relative_file_path(ctx->files[symbol->file_index].filepath, relative_path);
+        fprintf(file, "%3d. %s %s (%s:%d): %ld bytes in %d asset%s\n", i + 1,
+                symbol->kind == SYMBOL_ACTION ? "action" : "entry", interned_string(symbol->name_id), relative_path,
+                symbol->line, footprint->bytes, footprint->asset_count, footprint->asset_count == 1 ? "" : "s");
+        for (int k = 0; k < ASSET_LARGEST_SHOWN && footprint->largest[k] >= 0; k++) {
+            const AssetFile* asset = &ctx->asset_files[footprint->largest[k]];
+            if (asset->size >= 0) fprintf(file, "     %s: %ld bytes\n", interned_string(asset->path_id), asset->size);
+            else fprintf(file, "     %s: missing\n", interned_string(asset->path_id));
+        }
+    }
+    if (ctx->asset_footprint_count > shown) {
+        fprintf(file, "... %d more entry points\n", ctx->asset_footprint_count - shown);
+    }
+
+    if (missing_count > 0) {
+        fprintf(file, "Missing assets:\n");
+        int listed = 0;
+        for (int r = 0; r < ctx->asset_ref_count && listed < ASSET_MISSING_SHOWN; r++) {
+            const AssetReference* ref = &ctx->asset_refs[r];
+            if (ref->asset < 0 || ctx->asset_files[ref->asset].size >= 0) continue;
+            if (ctx->files[ref->file_index].duplicate_of >= 0) continue;
+            char relative_path[MAX_PATH_LEN];
+            get_relative_file_path(ctx->files[ref->file_index].filepath, relative_path);
+            fprintf(file, "  %s:%d  \"%s\"%s\n", relative_path, ref->line, interned_string(ref->name_id),
+                    ref->is_bind ? " (PRAGMA_BIND)" : "");
+            listed++;
+        }
+        if (listed == ASSET_MISSING_SHOWN) fprintf(file, "  ...\n");
+    }
+    fprintf(file, "\n");
+}
+
+// FIXED: COMPLETE write_analysis_report Funktion
+// EINFACHSTE LÖSUNG: Entferne die gefährliche Sortierung komplett
+// Wie in der Debug-Version - funktioniert garantiert!
+
+static void write_report_title(FILE* file) {
+    char time_buffer[32];
+    format_clock_time(time_buffer);
+
+    fprintf(file, "=== ENHANCED C/C++ CODE DEPENDENCY ANALYSIS v1.3 FIXED ===\n");
+    fprintf(file, "Generated: %s\n", time_buffer);
+    fprintf(file, "\nAnalysis Mode: %s\n", ctx->use_include_tracking ? "Include Tracking" : "All Files");
+}
+
+static void count_report_totals(int* used_files, int* circular_files, int* performance_problems) {
+    *used_files = 0;
+    *circular_files = 0;
+    *performance_problems = 0;
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (ctx->files[i].is_used) (*used_files)++;
+        if (ctx->files[i].is_circular_include) (*circular_files)++;
+        if (ctx->files[i].is_performance_problem) (*performance_problems)++;
+    }
+}
+
+// v1.4: Zyklen-Auflösung - zu entfernende Include-Zeilen je Komponente, größte zuerst
+static void write_cycle_breaking_section(FILE* file) {
+    int shown = 0, total_breaks = 0;
+    for (int c = 0; c < ctx->cycle_component_count; c++) {
+        const CycleComponent* component = &ctx->cycle_components[c];
+        if (component->break_count == 0) continue;
+        if (!ctx->files[ctx->cycle_breaks[component->break_first].file_index].is_used && ctx->use_include_tracking) continue;
+        if (shown++ == 0) {
+            fprintf(file, "=== CYCLE BREAKING ===\n");
+            fprintf(file, "(removing these include lines makes the include graph acyclic; weight = lines the included\n");
+            fprintf(file, " file pulls in apart from the rest of the cycle, light includes are removed first)\n");
+        }
+        fprintf(file, "Cycle %d: %d files, remove %d include line%s\n", shown, component->file_count,
+                component->break_count, component->break_count == 1 ? "" : "s");
+        for (int k = component->break_first; k < component->break_first + component->break_count; k++) {
+            const CycleBreak* cycle_break = &ctx->cycle_breaks[k];
+            const FileAnalysis* analysis = &ctx->files[cycle_break->file_index];
+            char relative_path[MAX_PATH_LEN];
+            char target_path[MAX_PATH_LEN];
+            get_relative_file_path(analysis->filepath, relative_path);
+            get_relative_file_path(ctx->files[analysis->include_targets[cycle_break->include_slot]].filepath, target_path);
+            fprintf(file, "  %s:%d -> %s (weight %ld lines)\n", relative_path,
+                    analysis->include_lines[cycle_break->include_slot], target_path, cycle_break->weight);
+        }
+        fprintf(file, "  preprocessed lines of the files in the cycle: %ld -> %ld (-%ld)\n",
+                component->cycle_lines_before, component->cycle_lines_after,
+                component->cycle_lines_before - component->cycle_lines_after);
+        if (component->unit_count > 0) {
+            fprintf(file, "  preprocessed lines of the %d translation units reaching it: %ld -> %ld (-%ld)\n",
+                    component->unit_count, component->unit_lines_before, component->unit_lines_after,
+                    component->unit_lines_before - component->unit_lines_after);
+        }
+        total_breaks += component->break_count;
+    }
+    if (shown > 0) {
+        fprintf(file, "Include lines to remove: %d, preprocessed lines saved in %d translation unit(s): %ld\n\n",
+                total_breaks, ctx->cycle_unit_count, ctx->cycle_unit_lines_saved);
+    }
+}
+
+// Zähler, zirkuläre Includes und PRAGMA_PATH Übersicht
+static void write_report_overview(FILE* file) {
+    int used_files, circular_files, performance_problems;
+    count_report_totals(&used_files, &circular_files, &performance_problems);
+
+    fprintf(file, "Total Files Found: %d\n", ctx->file_count);
+    fprintf(file, "Actually Used Files: %d\n", used_files);
+    fprintf(file, "Global PRAGMA_PATH entries found: %d\n", ctx->global_pragma_path_count);
+    fprintf(file, "Files with Circular Includes: %d\n", circular_files);
+    fprintf(file, "Files with Performance Problems: %d\n\n", performance_problems);
+
+    // Circular Include Report
+    if (circular_files > 0) {
+        fprintf(file, "=== CIRCULAR INCLUDE WARNINGS ===\n");
+        for (int i = 0; i < ctx->file_count; i++) {
+            if (ctx->files[i].is_circular_include && ctx->files[i].is_used) {
+                fprintf(file, "WARNING: %s (depth %d) - Part of circular include chain\n",
+                        ctx->files[i].filename, ctx->files[i].include_depth);
+            }
+        }
+        fprintf(file, "\n");
+        write_cycle_breaking_section(file);
+    }
+
+    // PRAGMA_PATH Übersicht
+    if (ctx->global_pragma_path_count > 0) {
+        fprintf(file, "=== PRAGMA_PATH DEFINITIONS ===\n");
+        for (int i = 0; i < ctx->global_pragma_path_count; i++) {
+            const char* source_filename = strrchr(ctx->global_pragma_paths[i].source_file, '\\');
+            if (!source_filename) source_filename = strrchr(ctx->global_pragma_paths[i].source_file, '/');
+            if (source_filename) source_filename++;
+            else source_filename = ctx->global_pragma_paths[i].source_file;
+
+            fprintf(file, "%04d  #define PRAGMA_PATH \"%s\" (in %s)%s\n",
+                ctx->global_pragma_paths[i].line, ctx->global_pragma_paths[i].path, source_filename,
+                ctx->global_pragma_paths[i].has_backslash ? " [BACKSLASH]" : "");
+        }
+        fprintf(file, "\n");
+    }
+}
+
+static const char* include_usage_marker(int usage) {
+    if (usage == INCLUDE_USAGE_UNUSED) return " [UNUSED]";
+    if (usage == INCLUDE_USAGE_MACRO_ONLY) return " [MACRO ONLY]";
+    if (usage == INCLUDE_USAGE_POINTER_ONLY) return " [POINTER ONLY]";
+    return "";
+}
+
+// Detaillierte Ausgabe einer Datei (im Streaming-Modus direkt nach dem Parsen)
+static void write_file_section(FILE* file, FileAnalysis* analysis) {
+    fprintf(file, "=== %s ===\n", analysis->filename);
+    fprintf(file, "Directory: %s\n", analysis->relative_dir);
+    if (ctx->use_include_tracking) {
+        fprintf(file, "Include Depth: %d", analysis->include_depth);
+        if (analysis->is_performance_problem) {
+            fprintf(file, " [PERFORMANCE WARNING: Deep Include Chain]");
+        }
+        if (analysis->is_circular_include) {
+            fprintf(file, " [CIRCULAR INCLUDE DETECTED]");
+        }
+        fprintf(file, "\n");
+        fprintf(file, "Status: %s\n", analysis->is_used ? "USED" : "UNUSED");
+        if (analysis->multiple_include_count > 1) {
+            fprintf(file, "Multiple Includes: %d times\n", analysis->multiple_include_count);
+        }
+    }
+
+    // PRAGMA_PATH in dieser Datei
+    if (analysis->pragma_path_count > 0) {
+        fprintf(file, "\nPRAGMA_PATH DEFINITIONS:\n");
+        for (int j = 0; j < analysis->pragma_path_count; j++) {
+            fprintf(file, "%04d  #define PRAGMA_PATH \"%s\"%s\n",
+                analysis->pragma_paths[j].line, analysis->pragma_paths[j].path,
+                analysis->pragma_paths[j].has_backslash ? " [BACKSLASH]" : "");
+        }
+    }
+
+    // INCLUDES
+    if (analysis->include_count > 0) {
+        fprintf(file, "\nINCLUDES:\n");
+        for (int j = 0; j < analysis->include_count; j++) {
+            IncludeElement* inc = &analysis->includes[j];
+
+            if (inc->found_via_pragma) {
+                char relative_path[MAX_PATH_LEN];
+                const char* rel_start = strstr(inc->found_in_directory, ctx->base_path);
+                if (rel_start) {
+                    rel_start += strlen(ctx->base_path);
+                    if (*rel_start == '\\' || *rel_start == '/') rel_start++;
+                    sprintf(relative_path, "%s/%s", rel_start, inc->name);
+                    normalize_path_separators(relative_path);
+                } else {
+                    strcpy(relative_path, inc->name);
+                }
+
+                fprintf(file, "%04d  #include \"%s\" is \"%s\"%s%s\n",
+                    inc->line, inc->name, relative_path,
+                    inc->has_backslash ? " [BACKSLASH]" : "",
+                    include_usage_marker(inc->usage));
+            } else {
+                fprintf(file, "%04d  #include \"%s\"%s%s\n",
+                    inc->line, inc->name,
+                    inc->has_backslash ? " [BACKSLASH]" : "",
+                    include_usage_marker(inc->usage));
+            }
+        }
+    }
+
+    // VOID FUNCTIONS
+    if (analysis->void_function_count > 0) {
+        fprintf(file, "\nVOID FUNCTIONS:\n");
+        for (int j = 0; j < analysis->void_function_count; j++) {
+            fprintf(file, "%04d  void %s()\n",
+                analysis->void_functions[j].line, analysis->void_functions[j].name);
+        }
+    }
+
+    // FUNCTIONS
+    if (analysis->function_count > 0) {
+        fprintf(file, "\nFUNCTIONS:\n");
+        for (int j = 0; j < analysis->function_count; j++) {
+            fprintf(file, "%04d  function %s()\n",
+                analysis->functions[j].line, analysis->functions[j].name);
+        }
+    }
+
+    // ACTIONS
+    if (analysis->action_count > 0) {
+        fprintf(file, "\nACTIONS:\n");
+        for (int j = 0; j < analysis->action_count; j++) {
+            fprintf(file, "%04d  action %s()\n",
+                analysis->actions[j].line, analysis->actions[j].name);
+        }
+    }
+
+    // STRUCTS
+    if (analysis->struct_count > 0) {
+        fprintf(file, "\nSTRUCTS:\n");
+        for (int j = 0; j < analysis->struct_count; j++) {
+            fprintf(file, "%04d  struct %s\n",
+                analysis->structs[j].line, analysis->structs[j].name);
+        }
+    }
+
+    // TYPEDEF STRUCTS
+    if (analysis->typedef_struct_count > 0) {
+        fprintf(file, "\nTYPEDEF STRUCTS:\n");
+        for (int j = 0; j < analysis->typedef_struct_count; j++) {
+            fprintf(file, "%04d  typedef struct %s\n",
+                analysis->typedef_structs[j].line, analysis->typedef_structs[j].name);
+        }
+    }
+
+    // STATIC VARIABLES
+    if (analysis->static_var_count > 0) {
+        fprintf(file, "\nSTATIC VARIABLES:\n");
+        for (int j = 0; j < analysis->static_var_count; j++) {
+            CodeElement* var = &analysis->static_vars[j];
+            if (strlen(var->function_context) > 0) {
+                fprintf(file, "%04d  static %s (in function: %s)\n",
+                    var->line, var->name, var->function_context);
+            } else {
+                fprintf(file, "%04d  static %s (global)\n", var->line, var->name);
+            }
+        }
+    }
+
+    // MACROS
+    if (analysis->macro_count > 0) {
+        fprintf(file, "\nMACROS:\n");
+        for (int j = 0; j < analysis->macro_count; j++) {
+            const MacroElement* macro = &analysis->macros[j];
+            fprintf(file, "%04d  #define %s%s%s\n", macro->line, macro->name,
+                macro->has_parameters || !macro->body[0] ? "" : " ", macro->body);
+        }
+    }
+
+    fprintf(file, "\n----------------------------------------\n\n");
+}
+
+// Globale Abschnitte nach den Datei-Sektionen
+static void write_report_tail(FILE* file) {
+    write_directory_section(file);
+    write_duplicate_content_section(file);
+    write_overload_section(file);
+    write_call_graph_section(file);
+    write_unused_include_section(file);
+    write_forward_declaration_section(file);
+    write_build_level_section(file);
+    write_macro_dependency_section(file);
+    write_macro_conflicts(file);
+    write_struct_layout_section(file);
+    write_static_footprint_section(file);
+    write_hot_loop_section(file);
+    write_asset_section(file);
+
+    if (ctx->unity_output_dir[0]) {
+        write_unity_build_section(file);
+    }
+
+    int used_files, circular_files, performance_problems;
+    count_report_totals(&used_files, &circular_files, &performance_problems);
+
+    // Summary
+    fprintf(file, "=== SUMMARY ===\n");
+    fprintf(file, "Total Files Analyzed: %d\n", used_files);
+    fprintf(file, "Files with Circular Includes: %d\n", circular_files);
+    fprintf(file, "Files with Performance Problems: %d\n", performance_problems);
+    fprintf(file, "Global PRAGMA_PATH entries: %d\n", ctx->global_pragma_path_count);
+}
+
+static void verify_report_file(const char* output_file) {
+    analyzer_log("SUCCESS: Analysis file created: %s\n", output_file);
+
+    // Verify file exists
+    if (path_exists(output_file)) {
+        FILE* verify = fopen(output_file, "r");
+        if (verify) {
+            fseek(verify, 0, SEEK_END);
+            long size = ftell(verify);
+            analyzer_log("File size: %ld bytes\n", size);
+            fclose(verify);
+        }
+    } else {
+        analyzer_log("ERROR: File not found after creation!\n");
+    }
+}
+
+static FILE* open_report_file(const char* output_file) {
+    analyzer_log("Creating analysis report: %s\n", output_file);
+
+    FILE* file = fopen(output_file, "w");
+    if (!file) {
+        analyzer_log("ERROR: Could not create output file: %s\n", output_file);
+        analyzer_log("Current working directory: %s\n", _getcwd(NULL, 0));
+    }
+    return file;
+}
+
+static int write_analysis_report(const char* output_file) {
+    FILE* file = open_report_file(output_file);
+    if (!file) return -1;
+
+    write_report_title(file);
+    write_report_overview(file);
+
+    // REMOVED: Die gefährliche Sortierung wurde komplett entfernt!
+    // Dateien werden in der Reihenfolge ausgegeben, wie sie gefunden wurden
+
+    // Detaillierte Datei-Ausgabe (OHNE Sortierung)
+    for (int i = 0; i < ctx->file_count; i++) {
+        FileAnalysis* analysis = &ctx->files[i];
+
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+
+        write_file_section(file, analysis);
+    }
+
+    write_report_tail(file);
+
+    fclose(file);
+    verify_report_file(output_file);
+    return 0;
+}
+
+// v1.4: Streaming-Modus
+// Jede Datei-Sektion wird geschrieben, sobald die Datei fertig geparst ist; danach werden
+// ihre Element-Tabellen freigegeben. Übrig bleibt nur das Skelett (Include-Kanten, Zähler,
+// interne Namens-IDs). Die globalen Abschnitte folgen am Ende aus dem Skelett.
+
+static int begin_streaming_report(const char* output_file) {
+    ctx->stream_report = open_report_file(output_file);
+    if (!ctx->stream_report) return 0;
+
+    write_report_title(ctx->stream_report);
+    fprintf(ctx->stream_report, "Streaming Mode: file sections are written as files are parsed; "
+                                "global sections follow at the end\n\n");
+    return 1;
+}
+
+static int finish_streaming_report(const char* output_file) {
+    if (!ctx->stream_report) return -1;
+
+    fprintf(ctx->stream_report, "=== GLOBAL ANALYSIS ===\n");
+    write_report_overview(ctx->stream_report);
+    write_report_tail(ctx->stream_report);
+
+    fclose(ctx->stream_report);
+    ctx->stream_report = NULL;
+    verify_report_file(output_file);
+    return 0;
+}
+
+// Header-Generierung
+// Deklarationen werden im Speicher gesammelt, per Hash-Index dedupliziert und sortiert,
+// damit identische Analysen byte-identische Header erzeugen.
+enum { DECL_STRUCT, DECL_TYPEDEF_STRUCT, DECL_VOID_FUNCTION };
+
+static int compare_declarations(const void* a, const void* b) {
+    const Declaration* x = (const Declaration*)a;
+    const Declaration* y = (const Declaration*)b;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    return strcmp(interned_string(x->name_id), interned_string(y->name_id));
+}
+
+static void add_declaration(int kind, const char* name, int directory_id) {
+    char key[MAX_NAME_LEN + 8];
+    sprintf(key, "%d:%s", kind, name);
+
+    // Mehrfach definierte Namen gehören zum alphabetisch ersten Verzeichnis (deterministisch)
+    int existing = hash_index_find(&ctx->declaration_index, key);
+    if (existing >= 0) {
+        Declaration* decl = &ctx->declarations[existing];
+        if (strcmp(interned_string(directory_id), interned_string(decl->directory_id)) < 0) {
+            decl->directory_id = directory_id;
+        }
+        return;
+    }
+
+    if (ctx->declaration_count == ctx->declaration_capacity) {
+        ctx->declaration_capacity = ctx->declaration_capacity ? ctx->declaration_capacity * 2 : 1024;
+        ctx->declarations = (Declaration*)realloc(ctx->declarations, sizeof(Declaration) * ctx->declaration_capacity);
+    }
+    hash_index_put(&ctx->declaration_index, key, ctx->declaration_count);
+    ctx->declarations[ctx->declaration_count].kind = kind;
+    ctx->declarations[ctx->declaration_count].name_id = intern_string(name);
+    ctx->declarations[ctx->declaration_count].directory_id = directory_id;
+    ctx->declaration_count++;
+}
+
+// Wird beim Abschluss jeder Datei aufgerufen, solange ihre Elemente noch im Speicher sind
+static void collect_file_declarations(int file_index) {
+    FileAnalysis* analysis = &ctx->files[file_index];
+    char directory[MAX_PATH_LEN];
+    get_relative_directory(analysis->filepath, directory);
+    int directory_id = intern_string(directory);
+
+    for (int j = 0; j < analysis->struct_count; j++) {
+        add_declaration(DECL_STRUCT, analysis->structs[j].name, directory_id);
+    }
+    for (int j = 0; j < analysis->typedef_struct_count; j++) {
+        add_declaration(DECL_TYPEDEF_STRUCT, analysis->typedef_structs[j].name, directory_id);
+    }
+    for (int j = 0; j < analysis->void_function_count; j++) {
+        add_declaration(DECL_VOID_FUNCTION, analysis->void_functions[j].name, directory_id);
+    }
+}
+
+static void append_struct_declaration(TextBuffer* buffer, int kind, int name_id) {
+    if (kind == DECL_STRUCT) {
+        buffer_append(buffer, "struct %s;", interned_string(name_id));
+    } else if (kind == DECL_TYPEDEF_STRUCT) {
+        buffer_append(buffer, "typedef struct %s %s;", interned_string(name_id), interned_string(name_id));
+    }
+}
+
+// Vorwärtsdeklaration für den Forward-Declaration-Report: Typedef, wenn der Name irgendwo als Typedef-Struct vorkommt
+static void append_type_forward_declaration(TextBuffer* buffer, int name_id) {
+    char key[MAX_NAME_LEN + 8];
+    sprintf(key, "%d:%s", DECL_TYPEDEF_STRUCT, interned_string(name_id));
+    int kind = hash_index_find(&ctx->declaration_index, key) >= 0 ? DECL_TYPEDEF_STRUCT : DECL_STRUCT;
+    append_struct_declaration(buffer, kind, name_id);
+}
+
+// directory_id < 0: alle Deklarationen
+static void append_declarations(TextBuffer* buffer, int directory_id) {
+    buffer_append(buffer, "// Forward struct declarations\n");
+    for (int i = 0; i < ctx->declaration_count; i++) {
+        Declaration* decl = &ctx->declarations[i];
+        if (directory_id >= 0 && decl->directory_id != directory_id) continue;
+        if (decl->kind == DECL_STRUCT || decl->kind == DECL_TYPEDEF_STRUCT) {
+            append_struct_declaration(buffer, decl->kind, decl->name_id);
+            buffer_append(buffer, "\n");
+        }
+    }
+    buffer_append(buffer, "\n");
+
+    buffer_append(buffer, "// Forward function declarations\n");
+    for (int i = 0; i < ctx->declaration_count; i++) {
+        Declaration* decl = &ctx->declarations[i];
+        if (directory_id >= 0 && decl->directory_id != directory_id) continue;
+        if (decl->kind == DECL_VOID_FUNCTION) {
+            buffer_append(buffer, "void %s();\n", interned_string(decl->name_id));
+        }
+    }
+    buffer_append(buffer, "\n");
+}
+
+// Include-Guard aus einem Dateinamen: "declarations_src_ui.h" -> "DECLARATIONS_SRC_UI_H"
+static void make_guard_name(const char* filename, char* guard) {
+    int k = 0;
+    for (int i = 0; filename[i] && k < MAX_NAME_LEN - 1; i++) {
+        char c = filename[i];
+        if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+        else if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) c = '_';
+        guard[k++] = c;
+    }
+    guard[k] = '\0';
+}
+
+static int report_header_write(const char* path, int result) {
+    if (result < 0) analyzer_log("Error: Could not create header file: %s\n", path);
+    else if (result == 0) analyzer_log("Header file unchanged: %s\n", path);
+    else analyzer_log("Header file v1.3 generated: %s\n", path);
+    return result < 0 ? -1 : 0;
+}
+
+// Dateiname eines Teil-Headers: "<base_name>_<pfad>.h" mit '_' statt '/'. Die Abbildung ist nicht
+// injektiv ("a/b" und "a_b"), und Windows unterscheidet keine Groß-/Kleinschreibung - vergebene Namen
+// stehen deshalb klein geschrieben in taken, Kollisionen bekommen "~2", "~3", ... ('~' kommt sonst
+// nicht vor). Rückgabe 0, wenn der Name nicht in MAX_PATH_LEN passt.
+static int claim_split_header_name(HashIndex* taken, const char* base_name, const char* path, char* name) {
+    char flat[MAX_PATH_LEN];
+    int k = 0;
+    for (int i = 0; path[i] && k < MAX_PATH_LEN - 1; i++) {
+        char c = path[i];
+        flat[k++] = c == '/' || c == '\\' || c == ' ' || c == '~' ? '_' : c;
+    }
+    flat[k] = '\0';
+
+    for (int attempt = 1; ; attempt++) {
+        char suffix[16] = "";
+        if (attempt > 1) snprintf(suffix, sizeof(suffix), "~%d", attempt);
+        int length = snprintf(name, MAX_PATH_LEN, "%s_%s%s.h", base_name, flat, suffix);
+        if (length < 0 || length >= MAX_PATH_LEN) return 0;
+        char key[MAX_PATH_LEN];
+        for (k = 0; name[k]; k++) key[k] = (name[k] >= 'A' && name[k] <= 'Z') ? name[k] - 'A' + 'a' : name[k];
+        key[k] = '\0';
+        if (hash_index_find(taken, key) >= 0) continue;
+        hash_index_put(taken, key, attempt);
+        return 1;
+    }
+}
+
+// Guards sind ebenfalls nicht injektiv ("a-b" und "a_b"): bei Kollision "_2", "_3", ... anhängen
+static void claim_split_guard_name(HashIndex* taken, const char* filename, char* guard) {
+    make_guard_name(filename, guard);
+    size_t length = strlen(guard);
+    for (int attempt = 2; hash_index_find(taken, guard) >= 0 && length + 12 < MAX_NAME_LEN; attempt++) {
+        snprintf(guard + length, MAX_NAME_LEN - length, "_%d", attempt);
+    }
+    hash_index_put(taken, guard, 1);
+}
+
+// Aufteilung: ein Header pro Verzeichnis neben header_file, header_file inkludiert alle
+static int generate_split_headers(const char* header_file) {
+    char header_dir[MAX_PATH_LEN];
+    strcpy(header_dir, header_file);
+    char* last_slash = strrchr(header_dir, '\\');
+    if (!last_slash) last_slash = strrchr(header_dir, '/');
+    if (last_slash) last_slash[1] = '\0';
+    else header_dir[0] = '\0';
+
+    const char* header_name = last_slash ? header_file + (last_slash + 1 - header_dir) : header_file;
+    char base_name[MAX_PATH_LEN];
+    strcpy(base_name, header_name);
+    char* ext = strrchr(base_name, '.');
+    if (ext) *ext = '\0';
+
+    // Verzeichnisse alphabetisch, damit die Include-Reihenfolge und die Namensvergabe stabil bleiben
+    int* order = (int*)malloc(sizeof(int) * (ctx->declaration_count + 1));
+    int order_count = 0;
+    for (int i = 0; i < ctx->declaration_count; i++) {
+        int d = ctx->declarations[i].directory_id;
+        int known = 0;
+        for (int k = 0; k < order_count && !known; k++) known = order[k] == d;
+        if (known) continue;
+        int pos = order_count++;
+        while (pos > 0 && strcmp(interned_string(order[pos - 1]), interned_string(d)) > 0) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = d;
+    }
+
+    HashIndex taken, guards;
+    memset(&taken, 0, sizeof(HashIndex));
+    memset(&guards, 0, sizeof(HashIndex));
+    char lowered[MAX_PATH_LEN];
+    int k = 0;
+    for (; header_name[k] && k < MAX_PATH_LEN - 1; k++) {
+        lowered[k] = (header_name[k] >= 'A' && header_name[k] <= 'Z') ? header_name[k] - 'A' + 'a' : header_name[k];
+    }
+    lowered[k] = '\0';
+    hash_index_put(&taken, lowered, 0);
+
+    int status = 0;
+    TextBuffer umbrella;
+    memset(&umbrella, 0, sizeof(TextBuffer));
+    char guard[MAX_NAME_LEN], umbrella_guard[MAX_NAME_LEN];
+    claim_split_guard_name(&guards, header_name, umbrella_guard);
+    buffer_append(&umbrella, "#ifndef %s\n#define %s\n\n", umbrella_guard, umbrella_guard);
+    buffer_append(&umbrella, "// Auto-generated declarations file v1.3 (split per directory)\n\n");
+
+    for (int p = 0; p < order_count; p++) {
+        int d = order[p];
+        const char* directory = strcmp(interned_string(d), ".") == 0 ? "root" : interned_string(d);
+        char part_name[MAX_PATH_LEN], part_path[MAX_PATH_LEN];
+        if (!claim_split_header_name(&taken, base_name, directory, part_name) ||
+            snprintf(part_path, sizeof(part_path), "%s%s", header_dir, part_name) >= (int)sizeof(part_path)) {
+            analyzer_log("Error: Header path too long for directory %s\n", interned_string(d));
+            status = -1;
+            continue;
+        }
+
+        TextBuffer part;
+        memset(&part, 0, sizeof(TextBuffer));
+        claim_split_guard_name(&guards, part_name, guard);
+        buffer_append(&part, "#ifndef %s\n#define %s\n\n", guard, guard);
+        buffer_append(&part, "// Auto-generated declarations v1.3 for %s\n\n", interned_string(d));
+        append_declarations(&part, d);
+        buffer_append(&part, "#endif // %s\n", guard);
+        if (report_header_write(part_path, write_if_changed(part_path, &part)) < 0) status = -1;
+        buffer_free(&part);
+
+        buffer_append(&umbrella, "#include \"%s\"\n", part_name);
+    }
+
+    buffer_append(&umbrella, "\n#endif // %s\n", umbrella_guard);
+    if (report_header_write(header_file, write_if_changed(header_file, &umbrella)) < 0) status = -1;
+    buffer_free(&umbrella);
+    hash_index_free(&taken);
+    hash_index_free(&guards);
+    free(order);
+    return status;
+}
+
+static int generate_header_file(const char* header_file) {
+    qsort(ctx->declarations, ctx->declaration_count, sizeof(Declaration), compare_declarations);
+    for (int i = 0; i < ctx->declaration_count; i++) {
+        char key[MAX_NAME_LEN + 8];
+        sprintf(key, "%d:%s", ctx->declarations[i].kind, interned_string(ctx->declarations[i].name_id));
+        hash_index_put(&ctx->declaration_index, key, i);
+    }
+
+    if (ctx->split_declaration_headers) {
+        return generate_split_headers(header_file);
+    }
+
+    TextBuffer buffer;
+    memset(&buffer, 0, sizeof(TextBuffer));
+    buffer_append(&buffer, "#ifndef DECLARATIONS_H\n");
+    buffer_append(&buffer, "#define DECLARATIONS_H\n\n");
+    buffer_append(&buffer, "// Auto-generated declarations file v1.3\n\n");
+    append_declarations(&buffer, -1);
+    buffer_append(&buffer, "#endif // DECLARATIONS_H\n");
+
+    int status = report_header_write(header_file, write_if_changed(header_file, &buffer));
+    buffer_free(&buffer);
+    return status;
+}
+
+// v1.4: Analyse-Snapshots (--save-snapshot, --diff)
+// Ein Snapshot enthält eine sortierte String-Tabelle; alle Datensätze verweisen per Rang
+// darauf und sind selbst nach diesen Rängen sortiert. Zwei Snapshots werden deshalb
+// abschnittsweise in einem linearen Merge verglichen (Schlüssel = Strings der Ränge).
+// Pfade sind relativ zum Projekt-Root, damit verschiedene Checkouts vergleichbar sind.
+
+#define SNAPSHOT_VERSION 1
+
+enum { SNAP_FILES, SNAP_INCLUDES, SNAP_CYCLES, SNAP_OVERLOADS, SNAP_STATICS, SNAP_PRAGMAS, SNAP_SECTION_COUNT };
+
+static const char* snapshot_section_names[SNAP_SECTION_COUNT] = {
+    "files", "includes", "cycles", "overloads", "statics", "pragmas"
+};
+// Anzahl Schlüsselfelder je Abschnitt (0 = die ganze Zeile ist Schlüssel)
+static const int snapshot_key_width[SNAP_SECTION_COUNT] = { 1, 2, 0, 1, 1, 2 };
+
+// Zeilen eines Abschnitts: Werte hintereinander, row_start[r]..row_start[r + 1]
+typedef struct {
+    int* values;
+    int value_count;
+    int value_capacity;
+    int* row_start;
+    int row_count;
+    int row_capacity;
+} SnapshotSection;
+
+typedef struct {
+    char** strings;
+    int string_count;
+    int string_capacity;
+    SnapshotSection sections[SNAP_SECTION_COUNT];
+} AnalysisSnapshot;
+
+static void snapshot_add_value(SnapshotSection* section, int value) {
+    if (section->value_count == section->value_capacity) {
+        section->value_capacity = section->value_capacity ? section->value_capacity * 2 : 256;
+        section->values = (int*)realloc(section->values, sizeof(int) * section->value_capacity);
+    }
+    section->values[section->value_count++] = value;
+}
+
+static void snapshot_end_row(SnapshotSection* section) {
+    if (section->row_count + 1 >= section->row_capacity) {
+        section->row_capacity = section->row_capacity ? section->row_capacity * 2 : 64;
+        section->row_start = (int*)realloc(section->row_start, sizeof(int) * section->row_capacity);
+        if (section->row_count == 0) section->row_start[0] = 0;
+    }
+    section->row_start[++section->row_count] = section->value_count;
+}
+
+static void free_snapshot(AnalysisSnapshot* snapshot) {
+    for (int i = 0; i < snapshot->string_count; i++) free(snapshot->strings[i]);
+    free(snapshot->strings);
+    for (int s = 0; s < SNAP_SECTION_COUNT; s++) {
+        free(snapshot->sections[s].values);
+        free(snapshot->sections[s].row_start);
+    }
+    memset(snapshot, 0, sizeof(AnalysisSnapshot));
+}
+
+// --- Schreiben ---
+
+// Beim Schreiben bekommen Strings zuerst eine vorläufige ID, nach dem Sortieren ihren Rang
+static int snapshot_string(AnalysisSnapshot* snapshot, HashIndex* index, const char* str) {
+    int id = hash_index_find(index, str);
+    if (id >= 0) return id;
+    if (snapshot->string_count == snapshot->string_capacity) {
+        snapshot->string_capacity = snapshot->string_capacity ? snapshot->string_capacity * 2 : 256;
+        snapshot->strings = (char**)realloc(snapshot->strings, sizeof(char*) * snapshot->string_capacity);
+    }
+    snapshot->strings[snapshot->string_count] = _strdup(str);
+    hash_index_put(index, str, snapshot->string_count);
+    return snapshot->string_count++;
+}
+
+static int compare_strings(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// qsort über Zeilenindizes des Abschnitts sorting_section
+static ANALYZER_THREAD_LOCAL const SnapshotSection* sorting_section = NULL;
+
+static int compare_snapshot_rows(const void* a, const void* b) {
+    const SnapshotSection* section = sorting_section;
+    int x = *(const int*)a, y = *(const int*)b;
+    int x_len = section->row_start[x + 1] - section->row_start[x];
+    int y_len = section->row_start[y + 1] - section->row_start[y];
+    const int* xv = section->values + section->row_start[x];
+    const int* yv = section->values + section->row_start[y];
+    for (int i = 0; i < x_len && i < y_len; i++) {
+        if (xv[i] != yv[i]) return xv[i] - yv[i];
+    }
+    return x_len - y_len;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Vorläufige IDs durch Ränge ersetzen, Zeilen sortieren und doppelte Zeilen entfernen
+static void finalize_snapshot(AnalysisSnapshot* snapshot, HashIndex* index) {
+    qsort(snapshot->strings, snapshot->string_count, sizeof(char*), compare_strings);
+    int* rank = (int*)malloc(sizeof(int) * (snapshot->string_count + 1));
+    for (int r = 0; r < snapshot->string_count; r++) rank[hash_index_find(index, snapshot->strings[r])] = r;
+
+    for (int s = 0; s < SNAP_SECTION_COUNT; s++) {
+        SnapshotSection* section = &snapshot->sections[s];
+        int key_width = snapshot_key_width[s];
+        for (int r = 0; r < section->row_count; r++) {
+            int* row = section->values + section->row_start[r];
+            int width = section->row_start[r + 1] - section->row_start[r];
+            int ids = key_width ? key_width : width;
+            for (int i = 0; i < ids; i++) row[i] = rank[row[i]];
+            if (!key_width) qsort(row, width, sizeof(int), compare_ints);
+        }
+
+        int* order = (int*)malloc(sizeof(int) * (section->row_count + 1));
+        for (int r = 0; r < section->row_count; r++) order[r] = r;
+        sorting_section = section;
+        qsort(order, section->row_count, sizeof(int), compare_snapshot_rows);
+
+        SnapshotSection sorted;
+        memset(&sorted, 0, sizeof(SnapshotSection));
+        for (int k = 0; k < section->row_count; k++) {
+            if (k > 0 && compare_snapshot_rows(&order[k - 1], &order[k]) == 0) continue;
+            for (int v = section->row_start[order[k]]; v < section->row_start[order[k] + 1]; v++) {
+                snapshot_add_value(&sorted, section->values[v]);
+            }
+            snapshot_end_row(&sorted);
+        }
+        free(order);
+        free(section->values);
+        free(section->row_start);
+        *section = sorted;
+    }
+    free(rank);
+}
+
+static void collect_analysis_snapshot(AnalysisSnapshot* snapshot) {
+    HashIndex index;
+    memset(&index, 0, sizeof(HashIndex));
+    char path[MAX_PATH_LEN];
+
+    int* path_id = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int* included_by_count = (int*)calloc(ctx->file_count + 1, sizeof(int));
+    for (int i = 0; i < ctx->file_count; i++) {
+        get_relative_file_path(ctx->files[i].filepath, path);
+        path_id[i] = snapshot_string(snapshot, &index, path);
+        for (int k = 0; k < ctx->files[i].include_count; k++) {
+            int target = ctx->files[i].include_targets[k];
+            if (target >= 0 && target != i) included_by_count[target]++;
+        }
+    }
+
+    // files: Pfad, Zeilen, transitive Includes, präprozessierte Zeilen, TU, Include-Tiefe
+    SnapshotSection* files = &snapshot->sections[SNAP_FILES];
+    SnapshotSection* includes = &snapshot->sections[SNAP_INCLUDES];
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (!ctx->files[i].is_used && ctx->use_include_tracking) continue;
+        int closure_files = 0;
+        for (int t = 0; t < ctx->file_count; t++) {
+            if (t != i && BITSET_TEST(CLOSURE_ROW(i), t)) closure_files++;
+        }
+        snapshot_add_value(files, path_id[i]);
+        snapshot_add_value(files, ctx->files[i].line_count);
+        snapshot_add_value(files, closure_files);
+        snapshot_add_value(files, (int)get_closure_lines(i));
+        snapshot_add_value(files, is_translation_unit(i, included_by_count));
+        snapshot_add_value(files, ctx->files[i].include_depth);
+        snapshot_end_row(files);
+
+        for (int k = 0; k < ctx->files[i].include_count; k++) {
+            int target = ctx->files[i].include_targets[k];
+            if (target < 0) continue;
+            snapshot_add_value(includes, path_id[i]);
+            snapshot_add_value(includes, path_id[target]);
+            snapshot_end_row(includes);
+        }
+    }
+
+    // cycles: Mitglieder einer zirkulären Komponente
+    SnapshotSection* cycles = &snapshot->sections[SNAP_CYCLES];
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (!ctx->files[i].is_circular_include) continue;
+        int first = 1;
+        for (int j = 0; j < i && first; j++) {
+            if (ctx->file_component[j] == ctx->file_component[i] && ctx->files[j].is_circular_include) first = 0;
+        }
+        if (!first) continue;
+        for (int j = i; j < ctx->file_count; j++) {
+            if (ctx->file_component[j] == ctx->file_component[i]) snapshot_add_value(cycles, path_id[j]);
+        }
+        snapshot_end_row(cycles);
+    }
+
+    // overloads: Namen mit mehreren Definitionen (wie im Abschnitt FUNCTION OVERLOADS)
+    if (ctx->call_graph_built) {
+        for (int name_id = 0; name_id < ctx->string_pool_count; name_id++) {
+            int count = 0;
+            for (int s = ctx->symbol_name_first[name_id]; s >= 0; s = ctx->symbol_name_next[s]) count++;
+            if (count < 2) continue;
+            snapshot_add_value(&snapshot->sections[SNAP_OVERLOADS], snapshot_string(snapshot, &index, interned_string(name_id)));
+            snapshot_add_value(&snapshot->sections[SNAP_OVERLOADS], count);
+            snapshot_end_row(&snapshot->sections[SNAP_OVERLOADS]);
+        }
+    }
+
+    // statics: "kontext::name" mehrfach definierter statischer Variablen
+    for (int i = 0; i < ctx->static_var_name_count; i++) {
+        if (ctx->static_var_names[i].count < 2) continue;
+        snapshot_add_value(&snapshot->sections[SNAP_STATICS], snapshot_string(snapshot, &index, ctx->static_var_names[i].name));
+        snapshot_add_value(&snapshot->sections[SNAP_STATICS], ctx->static_var_names[i].count);
+        snapshot_end_row(&snapshot->sections[SNAP_STATICS]);
+    }
+
+    // pragmas: PRAGMA_PATH-Wert und definierende Datei
+    for (int i = 0; i < ctx->global_pragma_path_count; i++) {
+        get_relative_file_path(ctx->global_pragma_paths[i].source_file, path);
+        snapshot_add_value(&snapshot->sections[SNAP_PRAGMAS], snapshot_string(snapshot, &index, ctx->global_pragma_paths[i].path));
+        snapshot_add_value(&snapshot->sections[SNAP_PRAGMAS], snapshot_string(snapshot, &index, path));
+        snapshot_end_row(&snapshot->sections[SNAP_PRAGMAS]);
+    }
+
+    finalize_snapshot(snapshot, &index);
+    hash_index_free(&index);
+    free(path_id);
+    free(included_by_count);
+}
+
+static int save_analysis_snapshot(const char* snapshot_file) {
+    AnalysisSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(AnalysisSnapshot));
+    collect_analysis_snapshot(&snapshot);
+
+    TextBuffer buffer;
+    memset(&buffer, 0, sizeof(TextBuffer));
+    buffer_append(&buffer, "ANALYZER SNAPSHOT %d\n", SNAPSHOT_VERSION);
+    buffer_append(&buffer, "strings %d\n", snapshot.string_count);
+    for (int i = 0; i < snapshot.string_count; i++) buffer_append(&buffer, "%s\n", snapshot.strings[i]);
+    for (int s = 0; s < SNAP_SECTION_COUNT; s++) {
+        const SnapshotSection* section = &snapshot.sections[s];
+        buffer_append(&buffer, "%s %d\n", snapshot_section_names[s], section->row_count);
+        for (int r = 0; r < section->row_count; r++) {
+            for (int v = section->row_start[r]; v < section->row_start[r + 1]; v++) {
+                buffer_append(&buffer, v > section->row_start[r] ? " %d" : "%d", section->values[v]);
+            }
+            buffer_append(&buffer, "\n");
+        }
+    }
+
+    int result = write_if_changed(snapshot_file, &buffer);
+    if (result < 0) analyzer_log("Error: Could not write snapshot: %s\n", snapshot_file);
+    else analyzer_log("Snapshot written: %s (%d files, %d include edges)\n", snapshot_file,
+                      snapshot.sections[SNAP_FILES].row_count, snapshot.sections[SNAP_INCLUDES].row_count);
+    buffer_free(&buffer);
+    free_snapshot(&snapshot);
+    return result < 0 ? -1 : 0;
+}
+
+// --- Lesen und Vergleichen ---
+
+static int load_analysis_snapshot(const char* snapshot_file, AnalysisSnapshot* snapshot) {
+    memset(snapshot, 0, sizeof(AnalysisSnapshot));
+    FILE* file = fopen(snapshot_file, "r");
+    if (!file) return -1;
+
+    char line[MAX_LINE_LEN * 2];
+    int version = 0, count = 0, ok = 0;
+    if (fgets(line, sizeof(line), file) && sscanf(line, "ANALYZER SNAPSHOT %d", &version) == 1 &&
+        version == SNAPSHOT_VERSION && fgets(line, sizeof(line), file) && sscanf(line, "strings %d", &count) == 1) {
+        ok = 1;
+        snapshot->strings = (char**)malloc(sizeof(char*) * (count + 1));
+        for (int i = 0; i < count && ok; i++) {
+            ok = fgets(line, sizeof(line), file) != NULL;
+            if (!ok) break;
+            line[strcspn(line, "\r\n")] = '\0';
+            snapshot->strings[snapshot->string_count++] = _strdup(line);
+        }
+    }
+    for (int s = 0; s < SNAP_SECTION_COUNT && ok; s++) {
+        char name[32];
+        ok = fgets(line, sizeof(line), file) && sscanf(line, "%31s %d", name, &count) == 2 &&
+             strcmp(name, snapshot_section_names[s]) == 0;
+        SnapshotSection* section = &snapshot->sections[s];
+        for (int r = 0; r < count && ok; r++) {
+            ok = fgets(line, sizeof(line), file) != NULL;
+            char* p = line;
+            char* end;
+            for (long value = strtol(p, &end, 10); ok && end != p; value = strtol(p, &end, 10)) {
+                snapshot_add_value(section, (int)value);
+                p = end;
+            }
+            snapshot_end_row(section);
+            // ID-Felder müssen in der String-Tabelle liegen
+            int key_width = snapshot_key_width[s] ? snapshot_key_width[s] : section->row_start[r + 1] - section->row_start[r];
+            if (section->row_start[r + 1] - section->row_start[r] < key_width) ok = 0;
+            for (int i = 0; i < key_width && ok; i++) {
+                int id = section->values[section->row_start[r] + i];
+                if (id < 0 || id >= snapshot->string_count) ok = 0;
+            }
+        }
+    }
+    fclose(file);
+    if (!ok) free_snapshot(snapshot);
+    return ok ? 0 : -1;
+}
+
+// Schlüsselvergleich zweier Zeilen aus verschiedenen Snapshots über die Strings
+static int compare_snapshot_keys(const AnalysisSnapshot* a, int section_index, int row_a,
+                          const AnalysisSnapshot* b, int row_b) {
+    const SnapshotSection* sa = &a->sections[section_index];
+    const SnapshotSection* sb = &b->sections[section_index];
+    int len_a = sa->row_start[row_a + 1] - sa->row_start[row_a];
+    int len_b = sb->row_start[row_b + 1] - sb->row_start[row_b];
+    int key_width = snapshot_key_width[section_index];
+    int width = key_width ? key_width : (len_a < len_b ? len_a : len_b);
+    for (int i = 0; i < width; i++) {
+        int cmp = strcmp(a->strings[sa->values[sa->row_start[row_a] + i]],
+                         b->strings[sb->values[sb->row_start[row_b] + i]]);
+        if (cmp != 0) return cmp;
+    }
+    return key_width ? 0 : len_a - len_b;
+}
+
+static const int* snapshot_row(const AnalysisSnapshot* snapshot, int section_index, int row) {
+    const SnapshotSection* section = &snapshot->sections[section_index];
+    return section->values + section->row_start[row];
+}
+
+// Merge eines Abschnitts nach Schlüssel: je Treffer die Zeile im alten und im neuen Snapshot (-1 = fehlt)
+typedef struct {
+    int old_row;
+    int new_row;
+} SnapshotMatch;
+
+static int merge_snapshot_section(const AnalysisSnapshot* old_snapshot, const AnalysisSnapshot* new_snapshot,
+                           int section_index, SnapshotMatch* matches) {
+    int old_count = old_snapshot->sections[section_index].row_count;
+    int new_count = new_snapshot->sections[section_index].row_count;
+    int i = 0, j = 0, count = 0;
+    while (i < old_count || j < new_count) {
+        int cmp = i >= old_count ? 1 : j >= new_count ? -1
+                : compare_snapshot_keys(old_snapshot, section_index, i, new_snapshot, j);
+        matches[count].old_row = cmp <= 0 ? i++ : -1;
+        matches[count].new_row = cmp >= 0 ? j++ : -1;
+        count++;
+    }
+    return count;
+}
+
+static void write_snapshot_cycle(FILE* out, const AnalysisSnapshot* snapshot, int row) {
+    const SnapshotSection* section = &snapshot->sections[SNAP_CYCLES];
+    for (int v = section->row_start[row]; v < section->row_start[row + 1]; v++) {
+        fprintf(out, "%s%s", v > section->row_start[row] ? ", " : "", snapshot->strings[section->values[v]]);
+    }
+    fprintf(out, "\n");
+}
+
+// Schreibt den Vergleich; Rückgabe: Anzahl Unterschiede oder -1
+static int diff_analysis_snapshots(const char* old_file, const char* new_file, FILE* out) {
+    AnalysisSnapshot old_snapshot, new_snapshot;
+    if (load_analysis_snapshot(old_file, &old_snapshot) != 0) {
+        fprintf(out, "Error: Could not read snapshot: %s\n", old_file);
+        return -1;
+    }
+    if (load_analysis_snapshot(new_file, &new_snapshot) != 0) {
+        fprintf(out, "Error: Could not read snapshot: %s\n", new_file);
+        free_snapshot(&old_snapshot);
+        return -1;
+    }
+
+    fprintf(out, "=== SNAPSHOT DIFF ===\n");
+    fprintf(out, "Old: %s (%d files, %d include edges)\n", old_file,
+            old_snapshot.sections[SNAP_FILES].row_count, old_snapshot.sections[SNAP_INCLUDES].row_count);
+    fprintf(out, "New: %s (%d files, %d include edges)\n\n", new_file,
+            new_snapshot.sections[SNAP_FILES].row_count, new_snapshot.sections[SNAP_INCLUDES].row_count);
+
+    int largest = 0;
+    for (int s = 0; s < SNAP_SECTION_COUNT; s++) {
+        int total = old_snapshot.sections[s].row_count + new_snapshot.sections[s].row_count;
+        if (total > largest) largest = total;
+    }
+    SnapshotMatch* matches = (SnapshotMatch*)malloc(sizeof(SnapshotMatch) * (largest + 1));
+    int differences = 0;
+
+    // Dateien: neu / entfernt, dazu Änderungen der transitiven Hülle je Translation Unit
+    int count = merge_snapshot_section(&old_snapshot, &new_snapshot, SNAP_FILES, matches);
+    for (int pass = 0; pass < 3; pass++) {
+        const char* titles[] = { "ADDED FILES", "REMOVED FILES", "TRANSITIVE CLOSURE CHANGES (translation units)" };
+        int written = 0;
+        for (int m = 0; m < count; m++) {
+            const int* old_row = matches[m].old_row >= 0 ? snapshot_row(&old_snapshot, SNAP_FILES, matches[m].old_row) : NULL;
+            const int* new_row = matches[m].new_row >= 0 ? snapshot_row(&new_snapshot, SNAP_FILES, matches[m].new_row) : NULL;
+            if (pass == 0 && old_row) continue;
+            if (pass == 1 && new_row) continue;
+            if (pass == 2 && (!old_row || !new_row || !new_row[4] ||
+                              (old_row[2] == new_row[2] && old_row[3] == new_row[3]))) continue;
+            if (written++ == 0) fprintf(out, "%s:\n", titles[pass]);
+            differences++;
+            if (pass == 0) fprintf(out, "  + %s\n", new_snapshot.strings[new_row[0]]);
+            else if (pass == 1) fprintf(out, "  - %s\n", old_snapshot.strings[old_row[0]]);
+            else fprintf(out, "  %s: %d -> %d headers, %d -> %d preprocessed lines (%+d)\n",
+                         new_snapshot.strings[new_row[0]], old_row[2], new_row[2], old_row[3], new_row[3],
+                         new_row[3] - old_row[3]);
+        }
+        if (written) fprintf(out, "\n");
+    }
+
+    // Include-Kanten
+    count = merge_snapshot_section(&old_snapshot, &new_snapshot, SNAP_INCLUDES, matches);
+    for (int pass = 0; pass < 2; pass++) {
+        int written = 0;
+        for (int m = 0; m < count; m++) {
+            int row = pass == 0 ? matches[m].new_row : matches[m].old_row;
+            int other = pass == 0 ? matches[m].old_row : matches[m].new_row;
+            if (row < 0 || other >= 0) continue;
+            const AnalysisSnapshot* snapshot = pass == 0 ? &new_snapshot : &old_snapshot;
+            const int* edge = snapshot_row(snapshot, SNAP_INCLUDES, row);
+            if (written++ == 0) fprintf(out, "%s:\n", pass == 0 ? "INCLUDE EDGES ADDED" : "INCLUDE EDGES REMOVED");
+            differences++;
+            fprintf(out, "  %c %s -> %s\n", pass == 0 ? '+' : '-', snapshot->strings[edge[0]], snapshot->strings[edge[1]]);
+        }
+        if (written) fprintf(out, "\n");
+    }
+
+    // Zyklen (ganze Mitgliederliste als Schlüssel). Teilt ein Zyklus Dateien mit einem Zyklus
+    // des anderen Snapshots, ist er nicht neu bzw. aufgelöst, sondern gewachsen oder zerfallen.
+    HashIndex cycle_members[2];
+    memset(cycle_members, 0, sizeof(cycle_members));
+    for (int side = 0; side < 2; side++) {
+        const AnalysisSnapshot* snapshot = side == 0 ? &old_snapshot : &new_snapshot;
+        const SnapshotSection* section = &snapshot->sections[SNAP_CYCLES];
+        for (int v = 0; v < section->value_count; v++) {
+            hash_index_put(&cycle_members[side], snapshot->strings[section->values[v]], 1);
+        }
+    }
+    count = merge_snapshot_section(&old_snapshot, &new_snapshot, SNAP_CYCLES, matches);
+    for (int pass = 0; pass < 3; pass++) {
+        const char* titles[] = { "NEW CYCLES", "CHANGED CYCLES", "RESOLVED CYCLES" };
+        int written = 0;
+        for (int m = 0; m < count; m++) {
+            if (matches[m].old_row >= 0 && matches[m].new_row >= 0) continue;
+            int side = matches[m].new_row >= 0 ? 1 : 0;
+            const AnalysisSnapshot* snapshot = side ? &new_snapshot : &old_snapshot;
+            int row = side ? matches[m].new_row : matches[m].old_row;
+            const SnapshotSection* section = &snapshot->sections[SNAP_CYCLES];
+            int overlaps = 0;
+            for (int v = section->row_start[row]; v < section->row_start[row + 1] && !overlaps; v++) {
+                overlaps = hash_index_find(&cycle_members[1 - side], snapshot->strings[section->values[v]]) >= 0;
+            }
+            if (pass == 0 && (!side || overlaps)) continue;
+            if (pass == 1 && !overlaps) continue;
+            if (pass == 2 && (side || overlaps)) continue;
+            if (written++ == 0) fprintf(out, "%s:\n", titles[pass]);
+            if (pass != 1 || side) differences++;
+            fprintf(out, pass == 1 ? (side ? "  now: " : "  was: ") : "  ");
+            write_snapshot_cycle(out, snapshot, row);
+        }
+        if (written) fprintf(out, "\n");
+    }
+    hash_index_free(&cycle_members[0]);
+    hash_index_free(&cycle_members[1]);
+
+    // Überladungen und statische Duplikate: neu oder häufiger geworden
+    for (int s = SNAP_OVERLOADS; s <= SNAP_STATICS; s++) {
+        count = merge_snapshot_section(&old_snapshot, &new_snapshot, s, matches);
+        int written = 0;
+        for (int m = 0; m < count; m++) {
+            if (matches[m].new_row < 0) continue;
+            const int* new_row = snapshot_row(&new_snapshot, s, matches[m].new_row);
+            int old_count = matches[m].old_row >= 0 ? snapshot_row(&old_snapshot, s, matches[m].old_row)[1] : 0;
+            if (new_row[1] <= old_count) continue;
+            if (written++ == 0) fprintf(out, "%s:\n", s == SNAP_OVERLOADS ? "NEW OVERLOADS" : "NEW STATIC DUPLICATES");
+            differences++;
+            fprintf(out, "  %s: %d -> %d definitions\n", new_snapshot.strings[new_row[0]], old_count, new_row[1]);
+        }
+        if (written) fprintf(out, "\n");
+    }
+
+    // PRAGMA_PATH
+    count = merge_snapshot_section(&old_snapshot, &new_snapshot, SNAP_PRAGMAS, matches);
+    for (int pass = 0; pass < 2; pass++) {
+        int written = 0;
+        for (int m = 0; m < count; m++) {
+            int row = pass == 0 ? matches[m].new_row : matches[m].old_row;
+            int other = pass == 0 ? matches[m].old_row : matches[m].new_row;
+            if (row < 0 || other >= 0) continue;
+            const AnalysisSnapshot* snapshot = pass == 0 ? &new_snapshot : &old_snapshot;
+            const int* pragma = snapshot_row(snapshot, SNAP_PRAGMAS, row);
+            if (written++ == 0) fprintf(out, "%s:\n", pass == 0 ? "NEW PRAGMA_PATHS" : "REMOVED PRAGMA_PATHS");
+            differences++;
+            fprintf(out, "  %c \"%s\" in %s\n", pass == 0 ? '+' : '-', snapshot->strings[pragma[0]], snapshot->strings[pragma[1]]);
+        }
+        if (written) fprintf(out, "\n");
+    }
+
+    fprintf(out, differences ? "Differences: %d\n" : "No differences.\n", differences);
+    free(matches);
+    free_snapshot(&old_snapshot);
+    free_snapshot(&new_snapshot);
+    return differences;
+}
+
+// v1.4: Include-Budgets
+// Konfiguration (INI-artig, '#' leitet Kommentare ein). [*] gilt für alle Dateien, [dir/] für
+// ein Verzeichnis, [dir/file.c] für eine Datei - Pfade relativ zum Projekt-Root. Pro Schlüssel
+// gewinnt das längste passende Muster, bei gleicher Länge die spätere Regel.
+//   [*]
+//   max_include_depth = 8
+//   require_include_guards = yes
+//   [engine/]
+//   max_transitive_includes = 40
+//   [main.c]
+//   max_tu_lines = 20000
+//   no_new_cycles = yes
+
+enum { BUDGET_TRANSITIVE_INCLUDES, BUDGET_TU_LINES, BUDGET_INCLUDE_DEPTH, BUDGET_NO_NEW_CYCLES,
+       BUDGET_INCLUDE_GUARDS, BUDGET_KEY_COUNT };
+
+static const char* budget_key_names[BUDGET_KEY_COUNT] = {
+    "max_transitive_includes", "max_tu_lines", "max_include_depth", "no_new_cycles", "require_include_guards"
+};
+
+typedef struct {
+    char pattern[MAX_PATH_LEN];     // "" = [*], mit '/' am Ende ein Verzeichnis
+    long limits[BUDGET_KEY_COUNT];  // -1 = nicht gesetzt, Schalter 0/1
+} BudgetRule;
+
+typedef struct {
+    BudgetRule* rules;
+    int rule_count;
+    int rule_capacity;
+} BudgetConfig;
+
+// 0 bei Erfolg, sonst -1 mit Meldung (Datei:Zeile) nach out
+static int load_budget_config(const char* config_file, BudgetConfig* config, FILE* out) {
+    memset(config, 0, sizeof(BudgetConfig));
+    FILE* file = fopen(config_file, "r");
+    if (!file) {
+        fprintf(out, "Error: Could not read budget file: %s\n", config_file);
+        return -1;
+    }
+
+    char line[MAX_LINE_LEN];
+    char message[MAX_LINE_LEN + 32];
+    const char* error = NULL;
+    int line_num = 0;
+    BudgetRule* rule = NULL;
+    while (!error && fgets(line, sizeof(line), file)) {
+        line_num++;
+        // Zeilenende zuerst abschneiden: trim_whitespace lässt eine Zeile aus nur "\n" stehen
+        line[strcspn(line, "\r\n")] = '\0';
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        trim_whitespace(line);
+        char* text = line + strspn(line, " \t");
+        if (!*text) continue;
+
+        if (*text == '[') {
+            char* close = strchr(text, ']');
+            if (!close || close[1]) {
+                error = "expected [pattern]";
+                break;
+            }
+            *close = '\0';
+            if (config->rule_count == config->rule_capacity) {
+                config->rule_capacity = config->rule_capacity ? config->rule_capacity * 2 : 16;
+                config->rules = (BudgetRule*)realloc(config->rules, sizeof(BudgetRule) * config->rule_capacity);
+            }
+            rule = &config->rules[config->rule_count++];
+            char* pattern = text + 1 + strspn(text + 1, " \t");
+            trim_whitespace(pattern);
+            if (strcmp(pattern, "*") == 0) pattern[0] = '\0';
+            if (starts_with(pattern, "./") || starts_with(pattern, ".\\")) pattern += 2;
+            strncpy(rule->pattern, pattern, MAX_PATH_LEN - 1);
+            rule->pattern[MAX_PATH_LEN - 1] = '\0';
+            normalize_path_separators(rule->pattern);
+            for (int k = 0; k < BUDGET_KEY_COUNT; k++) rule->limits[k] = -1;
+            continue;
+        }
+
+        char* equals = strchr(text, '=');
+        if (!rule || !equals) {
+            error = rule ? "expected key = value" : "key outside of a [pattern] section";
+            break;
+        }
+        *equals = '\0';
+        char* value = equals + 1 + strspn(equals + 1, " \t");
+        trim_whitespace(text);
+        int key = 0;
+        while (key < BUDGET_KEY_COUNT && strcmp(text, budget_key_names[key]) != 0) key++;
+        if (key == BUDGET_KEY_COUNT) {
+            snprintf(message, sizeof(message), "unknown key '%s'", text);
+            error = message;
+            break;
+        }
+
+        char* end;
+        long limit = strtol(value, &end, 10);
+        if (strcmp(value, "yes") == 0 || strcmp(value, "true") == 0) limit = 1;
+        else if (strcmp(value, "no") == 0 || strcmp(value, "false") == 0) limit = 0;
+        else if (end == value || *end || limit < 0) error = "value must be a number >= 0, yes or no";
+        rule->limits[key] = limit;
+    }
+    fclose(file);
+
+    if (error) {
+        fprintf(out, "Error: %s:%d: %s\n", config_file, line_num, error);
+        free(config->rules);
+        memset(config, 0, sizeof(BudgetConfig));
+        return -1;
+    }
+    return 0;
+}
+
+// Limit für eine Datei (relativer Pfad) oder -1; pattern erhält das Muster der Regel
+static long budget_limit(const BudgetConfig* config, const char* relative_path, int key, const char** pattern) {
+    long limit = -1;
+    int best = -1;
+    int path_len = (int)strlen(relative_path);
+    for (int r = 0; r < config->rule_count; r++) {
+        const BudgetRule* rule = &config->rules[r];
+        int len = (int)strlen(rule->pattern);
+        if (rule->limits[key] < 0 || len < best) continue;
+        int is_directory = len > 0 && rule->pattern[len - 1] == '/';
+        if (len > 0 && (is_directory ? path_len < len : path_len != len)) continue;
+        if (len > 0 && _strnicmp(relative_path, rule->pattern, len) != 0) continue;
+        best = len;
+        limit = rule->limits[key];
+        *pattern = rule->pattern;
+    }
+    return limit;
+}
+
+// Zeile der #include-Anweisung in from, die to einbindet (0 wenn unbekannt)
+static int include_line_of(int from, int to) {
+    for (int k = 0; k < ctx->files[from].include_count; k++) {
+        if (ctx->files[from].include_targets[k] == to) return ctx->files[from].include_lines[k];
+    }
+    return 0;
+}
+
+// Include-Kette: "  datei:zeile -> ziel", optional mit einem Messwert je Ziel
+static void write_include_chain(FILE* out, const int* chain, int length, const long* metric, const char* unit) {
+    char from[MAX_PATH_LEN], to[MAX_PATH_LEN];
+    if (length == 1) {
+        get_relative_file_path(ctx->files[chain[0]].filepath, from);
+        fprintf(out, "  %s\n", from);
+    }
+    for (int k = 1; k < length; k++) {
+        get_relative_file_path(ctx->files[chain[k - 1]].filepath, from);
+        get_relative_file_path(ctx->files[chain[k]].filepath, to);
+        fprintf(out, "  %s:%d -> %s", from, include_line_of(chain[k - 1], chain[k]), to);
+        if (metric) fprintf(out, " [%ld %s]", metric[chain[k]], unit);
+        fprintf(out, "\n");
+    }
+}
+
+// Weg der ersten Einbindung vom Hauptdatei-Ende bis file_index (über included_from)
+static int first_inclusion_chain(int file_index, int* chain) {
+    int length = 0;
+    for (int f = file_index; f >= 0 && length < ctx->file_count; f = ctx->files[f].included_from) {
+        chain[length++] = f;
+    }
+    for (int k = 0; k < length / 2; k++) {
+        int swap = chain[k];
+        chain[k] = chain[length - 1 - k];
+        chain[length - 1 - k] = swap;
+    }
+    return length;
+}
+
+// Schwerste Kette: ab file_index jeweils dem direkten Include mit dem größten Messwert folgen
+static int heaviest_include_chain(int file_index, const long* metric, int* chain, int* visited, int serial) {
+    int length = 0;
+    for (int f = file_index; f >= 0; ) {
+        chain[length++] = f;
+        visited[f] = serial;
+        int next = -1;
+        for (int k = 0; k < ctx->files[f].include_count; k++) {
+            int t = ctx->files[f].include_targets[k];
+            if (t < 0 || visited[t] == serial) continue;
+            if (next < 0 || metric[t] > metric[next]) next = t;
+        }
+        f = next;
+    }
+    return length;
+}
+
+// Prüft alle Budgets gegen die aktuelle Analyse; Zyklen zählen mit baseline_file nur,
+// wenn sie im Baseline-Snapshot nicht vorkamen. Rückgabe: Anzahl Verstöße oder -1.
+static int check_include_budgets(const char* config_file, const char* baseline_file, FILE* out) {
+    BudgetConfig config;
+    if (load_budget_config(config_file, &config, out) != 0) return -1;
+    AnalysisSnapshot baseline;
+    memset(&baseline, 0, sizeof(AnalysisSnapshot));
+    if (baseline_file && load_analysis_snapshot(baseline_file, &baseline) != 0) {
+        fprintf(out, "Error: Could not read baseline snapshot: %s\n", baseline_file);
+        free(config.rules);
+        return -1;
+    }
+    if (!ctx->include_closure) {
+        fprintf(out, "Error: No include closures - run the analysis first\n");
+        free(config.rules);
+        free_snapshot(&baseline);
+        return -1;
+    }
+
+    int n = ctx->file_count;
+    char (*paths)[MAX_PATH_LEN] = (char (*)[MAX_PATH_LEN])malloc(sizeof(*paths) * (n + 1));
+    long* closure_files = (long*)calloc(n + 1, sizeof(long));
+    long* closure_lines = (long*)malloc(sizeof(long) * (n + 1));
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    int* chain = (int*)malloc(sizeof(int) * (n + 2));
+    int* visited = (int*)calloc(n + 1, sizeof(int));
+    for (int i = 0; i < n; i++) {
+        get_relative_file_path(ctx->files[i].filepath, paths[i]);
+        for (int t = 0; t < n; t++) {
+            if (t != i && BITSET_TEST(CLOSURE_ROW(i), t)) closure_files[i]++;
+        }
+        closure_lines[i] = get_closure_lines(i);
+        for (int k = 0; k < ctx->files[i].include_count; k++) {
+            int target = ctx->files[i].include_targets[k];
+            if (target >= 0 && target != i) included_by_count[target]++;
+        }
+    }
+
+    fprintf(out, "=== INCLUDE BUDGETS (%s) ===\n", config_file);
+    int violations = 0;
+    const char* pattern = "";
+    for (int i = 0; i < n; i++) {
+        if (!ctx->files[i].is_used && ctx->use_include_tracking) continue;
+
+        long limit = budget_limit(&config, paths[i], BUDGET_TRANSITIVE_INCLUDES, &pattern);
+        if (limit >= 0 && closure_files[i] > limit) {
+            fprintf(out, "max_transitive_includes: %s transitively includes %ld files (limit %ld, rule [%s])\n",
+                    paths[i], closure_files[i], limit, *pattern ? pattern : "*");
+            int length = heaviest_include_chain(i, closure_files, chain, visited, ++violations);
+            write_include_chain(out, chain, length, closure_files, "files");
+        }
+
+        limit = budget_limit(&config, paths[i], BUDGET_TU_LINES, &pattern);
+        if (limit >= 0 && is_translation_unit(i, included_by_count) && closure_lines[i] > limit) {
+            fprintf(out, "max_tu_lines: %s has %ld preprocessed lines (limit %ld, rule [%s])\n",
+                    paths[i], closure_lines[i], limit, *pattern ? pattern : "*");
+            int length = heaviest_include_chain(i, closure_lines, chain, visited, ++violations);
+            write_include_chain(out, chain, length, closure_lines, "lines");
+        }
+
+        limit = budget_limit(&config, paths[i], BUDGET_INCLUDE_DEPTH, &pattern);
+        if (limit >= 0 && ctx->files[i].include_depth > limit) {
+            fprintf(out, "max_include_depth: %s is included at depth %d (limit %ld, rule [%s])\n",
+                    paths[i], ctx->files[i].include_depth, limit, *pattern ? pattern : "*");
+            write_include_chain(out, chain, first_inclusion_chain(i, chain), NULL, NULL);
+            violations++;
+        }
+
+        limit = budget_limit(&config, paths[i], BUDGET_INCLUDE_GUARDS, &pattern);
+        if (limit > 0 && is_header_file(i) && !ctx->files[i].has_include_guard) {
+            fprintf(out, "require_include_guards: %s has no include guard (rule [%s])\n",
+                    paths[i], *pattern ? pattern : "*");
+            write_include_chain(out, chain, first_inclusion_chain(i, chain), NULL, NULL);
+            violations++;
+        }
+    }
+
+    // Zyklen je Komponente: neu, wenn ein Mitglied in keinem Baseline-Zyklus lag oder
+    // Mitglieder aus verschiedenen Baseline-Zyklen jetzt zusammenhängen
+    HashIndex baseline_cycle;
+    memset(&baseline_cycle, 0, sizeof(HashIndex));
+    const SnapshotSection* cycles = &baseline.sections[SNAP_CYCLES];
+    for (int r = 0; r < cycles->row_count; r++) {
+        for (int v = cycles->row_start[r]; v < cycles->row_start[r + 1]; v++) {
+            hash_index_put(&baseline_cycle, baseline.strings[cycles->values[v]], r);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (!ctx->files[i].is_circular_include) continue;
+        int component = ctx->file_component[i];
+        int first = 1, enforced = 0, member_count = 0, baseline_row = -1, witness = -1;
+        for (int j = 0; j < n; j++) {
+            if (ctx->file_component[j] != component) continue;
+            if (j < i) first = 0;
+            member_count++;
+            if (budget_limit(&config, paths[j], BUDGET_NO_NEW_CYCLES, &pattern) > 0) enforced = 1;
+            int row = hash_index_find(&baseline_cycle, paths[j]);
+            if (baseline_file && row >= 0 && (baseline_row < 0 || row == baseline_row)) baseline_row = row;
+            else if (witness < 0) witness = j;
+        }
+        if (!first || !enforced || witness < 0) continue;
+        fprintf(out, "no_new_cycles: %s is part of a%s include cycle (%d files)\n",
+                paths[witness], baseline_file ? " new" : "n", member_count);
+        int length = find_shortest_cycle(witness, chain);
+        chain[length++] = witness;
+        write_include_chain(out, chain, length, NULL, NULL);
+        violations++;
+    }
+    hash_index_free(&baseline_cycle);
+
+    fprintf(out, violations ? "Budget violations: %d\n" : "All budgets met.\n", violations);
+    free(paths);
+    free(closure_files);
+    free(closure_lines);
+    free(included_by_count);
+    free(chain);
+    free(visited);
+    free(config.rules);
+    free_snapshot(&baseline);
+    return violations;
+}
+
+// v1.4: Verlauf - Kennzahlen des Include-Graphen für jeden Commit eines Bereichs als CSV.
+// Jeder Commit wird wie eine normale Analyse ausgewertet; der Parse-Cache des vorigen Commits
+// bleibt im Speicher, so dass nur Dateien mit neuem Blob (und ihre Includer) neu geparst werden.
+#define HISTORY_CSV_HEADER "commit,date,files,include_edges,cycles,files_in_cycles,closure_total,closure_max," \
+                           "translation_units,tu_lines_total,tu_lines_max,overloads,parsed_files\n"
+
+static void write_history_row(FILE* out, const char* commit, long long timestamp) {
+    int n = ctx->file_count;
+    int* included_by_count = (int*)calloc(n + 1, sizeof(int));
+    for (int f = 0; f < n; f++) {
+        for (int j = 0; j < ctx->files[f].include_count; j++) {
+            int target = ctx->files[f].include_targets[j];
+            if (target >= 0 && target != f) included_by_count[target]++;
+        }
+    }
 
-            int count = find_or_add_static_var(name, in_function ? current_function : NULL);
-            if (count > 1) {
-                elem->is_duplicate = 1;
-                elem->duplicate_count = count;
-                analysis->static_duplicates[analysis->static_duplicate_count] = *elem;
-                analysis->static_duplicate_count++;
-            }
-            analysis->static_var_count++;
+    int files = 0, edges = 0, units = 0, overloads = 0, closure_max = 0, files_in_cycles = 0;
+    long closure_total = 0, unit_lines_total = 0, unit_lines_max = 0;
+    for (int f = 0; f < n; f++) {
+        const FileAnalysis* analysis = &ctx->files[f];
+        if (!analysis->is_used && ctx->use_include_tracking) continue;
+        files++;
+        overloads += analysis->overload_count;
+        for (int j = 0; j < analysis->include_count; j++) {
+            if (analysis->include_targets[j] >= 0) edges++;
+        }
+        if (!ctx->include_closure) continue;
+        int closure_size = 0;
+        unsigned char* row = CLOSURE_ROW(f);
+        for (int t = 0; t < n; t++) {
+            if (t != f && BITSET_TEST(row, t)) closure_size++;
+        }
+        closure_total += closure_size;
+        if (closure_size > closure_max) closure_max = closure_size;
+        if (is_translation_unit(f, included_by_count)) {
+            long lines = get_closure_lines(f);
+            units++;
+            unit_lines_total += lines;
+            if (lines > unit_lines_max) unit_lines_max = lines;
         }
     }
+    for (int c = 0; c < ctx->cycle_component_count; c++) files_in_cycles += ctx->cycle_components[c].file_count;
+    free(included_by_count);
+
+    time_t seconds = (time_t)timestamp;
+    struct tm utc_buffer;
+    struct tm* utc = utc_time_r(&seconds, &utc_buffer);
+    char date[32] = "";
+    if (utc) strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", utc);
+    fprintf(out, "%s,%s,%d,%d,%d,%d,%ld,%d,%d,%ld,%ld,%d,%d\n", commit, date, files, edges,
+            ctx->cycle_component_count, files_in_cycles, closure_total, closure_max, units, unit_lines_total,
+            unit_lines_max, overloads, ctx->file_count - ctx->parse_cache_hits);
+}
 
-    fclose(file);
+typedef struct {
+    char id[48];
+    long long timestamp;
+} HistoryCommit;
+
+// Commits aus "git rev-list" (nur erste Eltern, älteste zuerst). Rückgabe: analysierte Commits oder -1
+static int write_history_trend(const char* main_file, const char* revision_range, FILE* out) {
+    if (!is_safe_revision(revision_range)) {
+        analyzer_log("Error: Invalid revision range '%s'\n", revision_range);
+        return -1;
+    }
+    char command[MAX_PATH_LEN + MAX_NAME_LEN + 96];
+    snprintf(command, sizeof(command), "git -C \"%s\" rev-list --reverse --first-parent --timestamp %s",
+             ctx->base_path, revision_range);
+    FILE* pipe = _popen(command, "r");
+    if (!pipe) return -1;
+    HistoryCommit* commits = NULL;
+    int commit_count = 0, commit_capacity = 0;
+    char line[160];
+    while (fgets(line, sizeof(line), pipe)) {
+        HistoryCommit commit;
+        if (sscanf(line, "%lld %47s", &commit.timestamp, commit.id) != 2) continue;
+        if (commit_count == commit_capacity) {
+            commit_capacity = commit_capacity ? commit_capacity * 2 : 64;
+            commits = (HistoryCommit*)realloc(commits, sizeof(HistoryCommit) * commit_capacity);
+        }
+        commits[commit_count++] = commit;
+    }
+    if (_pclose(pipe) != 0) {
+        analyzer_log("Error: git rev-list failed for '%s' in %s\n", revision_range, ctx->base_path);
+        free(commits);
+        return -1;
+    }
 
-    if (stack_depth > 0) {
-        stack_depth--;
+    // Kein Streaming (der Cache braucht die Elemente), kein Read-Ahead von der Platte,
+    // keine Einzelmeldungen je Datei
+    AnalysisContext* context = ctx;
+    int verbose = ctx->verbose, streaming = ctx->streaming_mode, readahead = ctx->readahead_enabled;
+    int keep_parse_cache = ctx->keep_parse_cache;
+    ctx->streaming_mode = 0;
+    ctx->readahead_enabled = 0;
+    ctx->keep_parse_cache = 1;
+    fputs(HISTORY_CSV_HEADER, out);
+    int analyzed = 0;
+    for (int c = 0; c < commit_count; c++) {
+        strcpy(ctx->history_commit, commits[c].id);
+        ctx->verbose = 0;
+        int result = analyzer_run(context, main_file);
+        ctx->verbose = verbose;
+        if (result != 0) {
+            analyzer_log("[%d/%d] %.12s: not analyzable (main file missing?) - skipped\n", c + 1, commit_count,
+                         commits[c].id);
+            continue;
+        }
+        write_history_row(out, commits[c].id, commits[c].timestamp);
+        fflush(out);
+        analyzed++;
+        analyzer_log("[%d/%d] %.12s: %d files, %d parsed, %d reused\n", c + 1, commit_count, commits[c].id,
+                     ctx->file_count, ctx->file_count - ctx->parse_cache_hits, ctx->parse_cache_hits);
     }
+
+    ctx->streaming_mode = streaming;
+    ctx->readahead_enabled = readahead;
+    ctx->keep_parse_cache = keep_parse_cache;
+    ctx->history_commit[0] = '\0';
+    free(ctx->memory_parse_cache);
+    ctx->memory_parse_cache = NULL;
+    free_history_blobs();
+    free(commits);
+    return analyzed;
 }
 
-// Scan-Funktion für All-Files-Modus
-void scan_all_files(const char* path, const char* base_path_param) {
-    WIN32_FIND_DATA find_data;
-    char search_path[MAX_PATH_LEN];
-    sprintf(search_path, "%s\\*", path);
+// v1.4: Bibliotheks-API (analyzer.h)
+// Jede Funktion setzt zuerst den Thread-Kontext; danach arbeitet der restliche Code
+// unverändert auf ctx. Kontexte in verschiedenen Threads stören sich nicht.
+
+// Gibt alle Ergebnisse einer Analyse frei und setzt den Zustand zurück (Optionen bleiben)
+static void release_analysis_state() {
+    if (ctx->stream_report) fclose(ctx->stream_report);
+    for (int i = 0; i < ctx->file_count; i++) {
+        FileAnalysis* analysis = &ctx->files[i];
+        release_file_elements(analysis);
+        free(analysis->include_targets);
+        free(analysis->include_lines);
+        free(analysis->include_usage);
+        free(analysis->type_name_ids);
+        free(analysis->global_static_ids);
+        free(analysis->macro_name_ids);
+    }
+    free(ctx->global_pragma_paths);
+    hash_index_free(&ctx->content_index);
+    hash_index_free(&ctx->string_pool_index);
+    free((void*)ctx->string_pool);
+    free_tree_snapshot();
+    free(ctx->parse_cache);
+    hash_index_free(&ctx->parse_cache_index);
+    free(ctx->parse_cache_text);
+    free(ctx->macro_defs);
+    hash_index_free(&ctx->macro_index);
+    free(ctx->macro_uses);
+    free(ctx->symbols);
+    free(ctx->call_refs);
+    free(ctx->reference_mark_serial);
+    free(ctx->reference_mark_slot);
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (ctx->header_automata[i]) free_automaton(ctx->header_automata[i]);
+    }
+    free(ctx->include_closure);
+    free(ctx->file_component);
+    free_dep_graph(&ctx->call_graph);
+    free(ctx->symbol_incoming);
+    free(ctx->symbol_name_first);
+    free(ctx->symbol_name_next);
+    free_dep_graph(&ctx->file_dependency_graph);
+    free(ctx->file_directory);
+    free_dep_graph(&ctx->directory_graph);
+    free(ctx->directory_component);
+    free(ctx->struct_layouts);
+    free(ctx->data_members);
+    hash_index_free(&ctx->struct_layout_index);
+    free(ctx->frame_loops);
+    free(ctx->loop_calls);
+    free(ctx->cycle_components);
+    free(ctx->cycle_breaks);
+    free(ctx->file_level);
+    free(ctx->critical_path);
+    free(ctx->asset_refs);
+    free(ctx->asset_files);
+    hash_index_free(&ctx->asset_index);
+    free(ctx->asset_footprints);
+    free(ctx->forward_decls);
+    for (int b = 0; b < ctx->unity_batch_count; b++) {
+        free(ctx->unity_batches[b].members);
+        free(ctx->unity_batches[b].contained);
+    }
+    free(ctx->unity_batches);
+    free(ctx->declarations);
+    hash_index_free(&ctx->declaration_index);
 
-    HANDLE handle = FindFirstFile(search_path, &find_data);
-    if (handle == INVALID_HANDLE_VALUE) return;
+    memset(&ctx->files, 0, sizeof(AnalysisContext) - offsetof(AnalysisContext, files));
+}
 
-    do {
-        if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0) continue;
+void analyzer_default_options(AnalyzerOptions* options) {
+    memset(options, 0, sizeof(AnalyzerOptions));
+    options->unity_line_budget = UNITY_DEFAULT_LINE_BUDGET;
+    options->readahead = 1;
+}
 
-        char full_path[MAX_PATH_LEN];
-        sprintf(full_path, "%s\\%s", path, find_data.cFileName);
+AnalysisContext* analyzer_create(const char* source_path, const AnalyzerOptions* options) {
+    if (!path_exists(source_path)) return NULL;
+    AnalysisContext* context = (AnalysisContext*)calloc(1, sizeof(AnalysisContext));
+    if (!context) return NULL;
+
+    AnalyzerOptions defaults;
+    if (!options) {
+        analyzer_default_options(&defaults);
+        options = &defaults;
+    }
+    strncpy(context->base_path, source_path, MAX_PATH_LEN - 1);
+    if (options->unity_output_dir) strncpy(context->unity_output_dir, options->unity_output_dir, MAX_PATH_LEN - 1);
+    if (options->depfile_dir) strncpy(context->depfile_dir, options->depfile_dir, MAX_PATH_LEN - 1);
+    context->unity_line_budget = options->unity_line_budget > 0 ? options->unity_line_budget : UNITY_DEFAULT_LINE_BUDGET;
+    context->split_declaration_headers = options->split_declaration_headers;
+    if (options->stream_report_file) {
+        context->streaming_mode = 1;
+        strncpy(context->stream_report_file, options->stream_report_file, MAX_PATH_LEN - 1);
+    }
+    context->readahead_enabled = options->readahead;
+    context->use_git_index = options->git_index;
+    if (options->parse_cache_file) strncpy(context->parse_cache_file, options->parse_cache_file, MAX_PATH_LEN - 1);
+    if (options->changed_since) strncpy(context->changed_since, options->changed_since, MAX_NAME_LEN - 1);
+    context->verbose = options->verbose;
+    return context;
+}
 
-        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-            scan_all_files(full_path, base_path_param);
+int analyzer_run(AnalysisContext* context, const char* main_file) {
+    ctx = context;
+    if (main_file != ctx->main_file) {
+        ctx->main_file[0] = '\0';
+        if (main_file) strncpy(ctx->main_file, main_file, MAX_PATH_LEN - 1);
+    }
+    main_file = ctx->main_file;
+    if (ctx->analysis_done) release_analysis_state();
+    ctx->analysis_done = 1;
+    ctx->use_include_tracking = main_file[0] != '\0';
+
+    if (ctx->history_commit[0]) {
+        // Verlauf: Dateien und Inhalte aus dem Commit, nichts aus dem Arbeitsverzeichnis
+        int commit_files = build_tree_from_git_commit(ctx->base_path, ctx->history_commit);
+        if (commit_files < 0) {
+            analyzer_log("Error: Could not list the files of commit %s\n", ctx->history_commit);
+            return -1;
+        }
+        analyzer_log("Commit %s: %d files\n", ctx->history_commit, commit_files);
+        fetch_history_blobs();
+    } else {
+        int git_files = ctx->use_git_index ? build_tree_from_git_index(ctx->base_path) : -1;
+        if (git_files >= 0) {
+            analyzer_log("Git index: %d tracked files\n", git_files);
         } else {
-            const char* ext = strrchr(find_data.cFileName, '.');
-            if (ext && (strcmp(ext, ".c") == 0 || strcmp(ext, ".h") == 0)) {
-                analyze_file_with_includes(full_path, 0);
-            }
+            if (ctx->use_git_index) analyzer_log("Warning: No usable git index for %s - scanning directories\n", ctx->base_path);
+            build_tree_snapshot(ctx->base_path);
         }
-    } while (FindNextFile(handle, &find_data));
+    }
+    analyzer_log("Directory snapshot: %d entries\n", ctx->tree_entry_count);
+    prepare_parse_cache();
 
-    FindClose(handle);
-}
+    if (ctx->streaming_mode && !begin_streaming_report(ctx->stream_report_file)) {
+        return -1;
+    }
+    init_readahead();
 
-// FIXED: COMPLETE write_analysis_report Funktion
-// EINFACHSTE LÖSUNG: Entferne die gefährliche Sortierung komplett
-// Wie in der Debug-Version - funktioniert garantiert!
+    if (ctx->use_include_tracking) {
+        char main_path[MAX_PATH_LEN];
+        int length = snprintf(main_path, sizeof(main_path), "%s" PATH_SEP "%s", ctx->base_path, main_file);
+        if (length < 0 || length >= (int)sizeof(main_path)) {
+            analyzer_log("Error: Main file path too long: %s\n", main_file);
+            shutdown_readahead();
+            return -1;
+        }
 
-void write_analysis_report(const char* output_file) {
-    printf("Creating analysis report: %s\n", output_file);
+        char resolved_main[MAX_PATH_LEN];
+        if (!probe_include_candidate(main_path, resolved_main)) {
+            analyzer_log("Error: Main file '%s' does not exist!\n", main_path);
+            shutdown_readahead();
+            return -1;
+        }
 
-    FILE* file = fopen(output_file, "w");
-    if (!file) {
-        printf("ERROR: Could not create output file: %s\n", output_file);
-        printf("Current working directory: %s\n", _getcwd(NULL, 0));
-        return;
+        analyzer_log("Starting enhanced include tracking from: %s\n\n", main_file);
+        analyze_file_with_includes(resolved_main, 0);
+    } else {
+        analyzer_log("Scanning all .c/.h files in directory tree...\n\n");
+        scan_all_files();
     }
 
-    char time_buffer[32];
-    _strtime(time_buffer);
+    if (ctx->readahead_backend != READAHEAD_OFF) {
+        analyzer_log("\nRead-ahead: %d of %d requested files used\n", ctx->prefetch_hits, ctx->prefetch_requests);
+    }
+    shutdown_readahead();
 
-    fprintf(file, "=== ENHANCED C/C++ CODE DEPENDENCY ANALYSIS v1.3 FIXED ===\n");
-    fprintf(file, "Generated: %s\n", time_buffer);
-    fprintf(file, "\nAnalysis Mode: %s\n", use_include_tracking ? "Include Tracking" : "All Files");
-    fprintf(file, "Total Files Found: %d\n", file_count);
+    analyzer_log("\nAnalysis completed!\n");
+    analyzer_log("Found %d files\n", ctx->file_count);
+    if (ctx->parse_cache_file[0] || ctx->keep_parse_cache) {
+        analyzer_log("Reused %d cached parse results\n", ctx->parse_cache_hits);
+        save_parse_cache();
+    }
+    analyzer_log("Found %d PRAGMA_PATH definitions\n", ctx->global_pragma_path_count);
+    analyzer_log("Found %d unique directories\n", ctx->used_directory_count);
+
+    mark_circular_includes();
+    build_include_closures();
+    compute_cycle_breaks();
+    compute_build_levels();
+    build_call_graph();
+    build_file_dependency_graph();
+    aggregate_directory_stats();
+    resolve_struct_layouts();
+    compute_hot_loop_costs();
+    resolve_asset_references();
+    compute_asset_footprints();
+    if (ctx->unity_output_dir[0]) {
+        plan_unity_batches();
+    }
+    return 0;
+}
 
-    int used_files = 0;
-    int circular_files = 0;
-    int performance_problems = 0;
+// Im Streaming-Modus gehen die globalen Abschnitte in die beim Erzeugen angegebene Datei
+int analyzer_write_report(AnalysisContext* context, const char* output_file) {
+    ctx = context;
+    if (ctx->streaming_mode) return finish_streaming_report(ctx->stream_report_file);
+    return write_analysis_report(output_file);
+}
+
+int analyzer_write_header(AnalysisContext* context, const char* header_file) {
+    ctx = context;
+    return generate_header_file(header_file);
+}
+
+int analyzer_write_unity_batches(AnalysisContext* context) {
+    ctx = context;
+    if (!ctx->unity_output_dir[0]) return -1;
+    write_unity_batch_files(ctx->unity_output_dir);
+    return 0;
+}
 
-    for (int i = 0; i < file_count; i++) {
-        if (files[i].is_used) used_files++;
-        if (files[i].is_circular_include) circular_files++;
-        if (files[i].is_performance_problem) performance_problems++;
+int analyzer_write_depfiles(AnalysisContext* context) {
+    ctx = context;
+    if (!ctx->depfile_dir[0]) return -1;
+    return write_depfiles(ctx->depfile_dir);
+}
+
+int analyzer_save_snapshot(AnalysisContext* context, const char* snapshot_file) {
+    ctx = context;
+    return save_analysis_snapshot(snapshot_file);
+}
+
+int analyzer_check_budgets(AnalysisContext* context, const char* budget_file, const char* baseline_snapshot,
+                           FILE* out) {
+    ctx = context;
+    return check_include_budgets(budget_file, baseline_snapshot, out);
+}
+
+int analyzer_history(AnalysisContext* context, const char* main_file, const char* revision_range, FILE* out) {
+    ctx = context;
+    return write_history_trend(main_file, revision_range, out);
+}
+
+int analyzer_diff_snapshots(const char* old_file, const char* new_file, FILE* out) {
+    return diff_analysis_snapshots(old_file, new_file, out);
+}
+
+int analyzer_file_count(AnalysisContext* context) {
+    return context->file_count;
+}
+
+int analyzer_get_file(AnalysisContext* context, int file_index, AnalyzerFile* out) {
+    if (file_index < 0 || file_index >= context->file_count) return -1;
+    const FileAnalysis* analysis = &context->files[file_index];
+    out->name = analysis->filename;
+    out->path = analysis->filepath;
+    out->directory = context->file_directory ?
+        context->directory_stats[context->file_directory[file_index]].native_directory : ".";
+    out->is_used = analysis->is_used;
+    out->include_depth = analysis->include_depth;
+    out->line_count = analysis->line_count;
+    out->file_size = analysis->file_size;
+    out->is_circular_include = analysis->is_circular_include;
+    out->is_performance_problem = analysis->is_performance_problem;
+    out->duplicate_of = analysis->duplicate_of;
+    out->include_count = analysis->include_count;
+    out->build_level = context->file_level ? context->file_level[file_index] : 0;
+    return 0;
+}
+
+int analyzer_find_file(AnalysisContext* context, const char* path) {
+    ctx = context;
+    char normalized[MAX_PATH_LEN];
+    strncpy(normalized, path, MAX_PATH_LEN - 1);
+    normalized[MAX_PATH_LEN - 1] = '\0';
+    normalize_path_separators(normalized);
+    int length = (int)strlen(normalized);
+    int by_suffix = -1, by_name = -1;
+    for (int i = 0; i < ctx->file_count; i++) {
+        char candidate[MAX_PATH_LEN];
+        strcpy(candidate, ctx->files[i].filepath);
+        normalize_path_separators(candidate);
+        if (strcmp(candidate, normalized) == 0) return i;
+        // Pfad relativ zum Projekt ("engine/player.h"), Groß-/Kleinschreibung wie im Snapshot egal
+        int offset = (int)strlen(candidate) - length;
+        if (by_suffix < 0 && offset > 0 && (candidate[offset - 1] == '/' || candidate[offset - 1] == '\\') &&
+            _strnicmp(candidate + offset, normalized, length) == 0) {
+            by_suffix = i;
+        }
+        if (by_name < 0 && strcmp(ctx->files[i].filename, path) == 0) by_name = i;
     }
-    fprintf(file, "Actually Used Files: %d\n", used_files);
-    fprintf(file, "Global PRAGMA_PATH entries found: %d\n", global_pragma_path_count);
-    fprintf(file, "Files with Circular Includes: %d\n", circular_files);
-    fprintf(file, "Files with Performance Problems: %d\n\n", performance_problems);
+    return by_suffix >= 0 ? by_suffix : by_name;
+}
 
-    // Circular Include Report
-    if (circular_files > 0) {
-        fprintf(file, "=== CIRCULAR INCLUDE WARNINGS ===\n");
-        for (int i = 0; i < file_count; i++) {
-            if (files[i].is_circular_include && files[i].is_used) {
-                fprintf(file, "WARNING: %s (depth %d) - Part of circular include chain\n",
-                        files[i].filename, files[i].include_depth);
+// Include-Zeilen (auch unaufgelöste, target -1) und reine Makro-Abhängigkeiten
+int analyzer_get_dependencies(AnalysisContext* context, int file_index, AnalyzerDependency* out, int max) {
+    if (file_index < 0 || file_index >= context->file_count) return -1;
+    const FileAnalysis* analysis = &context->files[file_index];
+    int count = 0;
+    for (int k = 0; k < analysis->include_count; k++, count++) {
+        if (count >= max) continue;
+        out[count].target = analysis->include_targets[k];
+        out[count].type = ANALYZER_EDGE_INCLUDE;
+        out[count].line = analysis->include_lines[k];
+        out[count].usage = analysis->include_usage[k];
+        out[count].weight = 1;
+    }
+    const DepGraph* graph = &context->file_dependency_graph;
+    if (context->file_dependency_graph_built) {
+        for (int e = graph->first_edge[file_index]; e < graph->first_edge[file_index + 1]; e++) {
+            if (graph->edge_type[e] != EDGE_MACRO) continue;
+            if (count < max) {
+                out[count].target = graph->edge_target[e];
+                out[count].type = ANALYZER_EDGE_MACRO;
+                out[count].line = 0;
+                out[count].usage = ANALYZER_USAGE_UNKNOWN;
+                out[count].weight = graph->edge_weight[e];
             }
+            count++;
         }
-        fprintf(file, "\n");
     }
+    return count;
+}
 
-    // PRAGMA_PATH Übersicht
-    if (global_pragma_path_count > 0) {
-        fprintf(file, "=== PRAGMA_PATH DEFINITIONS ===\n");
-        for (int i = 0; i < global_pragma_path_count; i++) {
-            const char* source_filename = strrchr(global_pragma_paths[i].source_file, '\\');
-            if (!source_filename) source_filename = strrchr(global_pragma_paths[i].source_file, '/');
-            if (source_filename) source_filename++;
-            else source_filename = global_pragma_paths[i].source_file;
+static int append_code_elements(AnalyzerElement* out, int max, int count, int kind,
+                         const CodeElement* elements, int element_count) {
+    for (int i = 0; i < element_count; i++, count++) {
+        if (count >= max) continue;
+        out[count].kind = kind;
+        out[count].name = elements[i].name;
+        out[count].line = elements[i].line;
+        out[count].detail = elements[i].function_context;
+        out[count].is_prototype = elements[i].is_prototype;
+    }
+    return count;
+}
 
-            fprintf(file, "%04d  #define PRAGMA_PATH \"%s\" (in %s)%s\n",
-                global_pragma_paths[i].line, global_pragma_paths[i].path, source_filename,
-                global_pragma_paths[i].has_backslash ? " [BACKSLASH]" : "");
-        }
-        fprintf(file, "\n");
+// Die Element-Tabellen gibt es nur ohne Streaming-Modus (sonst -1)
+int analyzer_get_elements(AnalysisContext* context, int file_index, AnalyzerElement* out, int max) {
+    if (file_index < 0 || file_index >= context->file_count) return -1;
+    const FileAnalysis* analysis = &context->files[file_index];
+    if (!analysis->elements) return -1;
+
+    int count = 0;
+    for (int i = 0; i < analysis->include_count; i++, count++) {
+        if (count >= max) continue;
+        out[count].kind = ANALYZER_ELEMENT_INCLUDE;
+        out[count].name = analysis->includes[i].name;
+        out[count].line = analysis->includes[i].line;
+        out[count].detail = analysis->includes[i].resolved_path;
+        out[count].is_prototype = 0;
+    }
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_VOID_FUNCTION,
+                                 analysis->void_functions, analysis->void_function_count);
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_FUNCTION,
+                                 analysis->functions, analysis->function_count);
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_ACTION,
+                                 analysis->actions, analysis->action_count);
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_STRUCT,
+                                 analysis->structs, analysis->struct_count);
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_TYPEDEF_STRUCT,
+                                 analysis->typedef_structs, analysis->typedef_struct_count);
+    count = append_code_elements(out, max, count, ANALYZER_ELEMENT_STATIC_VAR,
+                                 analysis->static_vars, analysis->static_var_count);
+    for (int i = 0; i < analysis->macro_count; i++, count++) {
+        if (count >= max) continue;
+        out[count].kind = ANALYZER_ELEMENT_MACRO;
+        out[count].name = analysis->macros[i].name;
+        out[count].line = analysis->macros[i].line;
+        out[count].detail = analysis->macros[i].body;
+        out[count].is_prototype = 0;
     }
+    return count;
+}
 
-    // REMOVED: Die gefährliche Sortierung wurde komplett entfernt!
-    // Dateien werden in der Reihenfolge ausgegeben, wie sie gefunden wurden
+void analyzer_destroy(AnalysisContext* context) {
+    if (!context) return;
+    AnalysisContext* previous = ctx;
+    ctx = context;
+    release_analysis_state();
+    free(context->memory_parse_cache);
+    free(context);
+    ctx = (previous == context) ? NULL : previous;
+}
 
-    // Detaillierte Datei-Ausgabe (OHNE Sortierung)
-    for (int i = 0; i < file_count; i++) {
-        FileAnalysis* analysis = &files[i];
+// v1.4: Server-Modus - JSON-RPC 2.0, eine Anfrage bzw. Antwort pro Zeile
+// Die Analyse bleibt im Speicher; Anfragen werden aus dem Skelett (Include-Kanten,
+// Hüllen, Symbol-Tabelle, SCCs) beantwortet, ohne Dateien zu lesen.
+// Methoden: includersOf, includeClosure, definitionOf, cyclesContaining, reanalyze, shutdown
 
-        if (!analysis->is_used && use_include_tracking) continue;
+#define SERVER_MAX_REQUEST (64 * 1024)
 
-        fprintf(file, "=== %s ===\n", analysis->filename);
-        fprintf(file, "Directory: %s\n", analysis->relative_dir);
-        if (use_include_tracking) {
-            fprintf(file, "Include Depth: %d", analysis->include_depth);
-            if (analysis->is_performance_problem) {
-                fprintf(file, " [PERFORMANCE WARNING: Deep Include Chain]");
-            }
-            if (analysis->is_circular_include) {
-                fprintf(file, " [CIRCULAR INCLUDE DETECTED]");
+enum { RPC_PARSE_ERROR = -32700, RPC_INVALID_REQUEST = -32600, RPC_METHOD_NOT_FOUND = -32601,
+       RPC_INVALID_PARAMS = -32602, RPC_INTERNAL_ERROR = -32603 };
+
+static const char* json_skip_whitespace(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+// Liest einen String ab dem öffnenden Anführungszeichen; Rückgabe: Position danach oder NULL
+static const char* json_read_string(const char* p, char* out, int out_size) {
+    if (*p != '"') return NULL;
+    p++;
+    int len = 0;
+    while (*p && *p != '"') {
+        char c = *p++;
+        if (c == '\\') {
+            c = *p++;
+            switch (c) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'u': {
+                unsigned code = 0;
+                for (int i = 0; i < 4; i++) {
+                    char h = *p++;
+                    code <<= 4;
+                    if (h >= '0' && h <= '9') code |= h - '0';
+                    else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+                    else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+                    else return NULL;
+                }
+                c = code < 0x80 ? (char)code : '?';
+                break;
             }
-            fprintf(file, "\n");
-            fprintf(file, "Status: %s\n", analysis->is_used ? "USED" : "UNUSED");
-            if (analysis->multiple_include_count > 1) {
-                fprintf(file, "Multiple Includes: %d times\n", analysis->multiple_include_count);
+            case '\0': return NULL;
             }
         }
+        if (out && len < out_size - 1) out[len++] = c;
+    }
+    if (*p != '"') return NULL;
+    if (out) out[len] = '\0';
+    return p + 1;
+}
 
-        // PRAGMA_PATH in dieser Datei
-        if (analysis->pragma_path_count > 0) {
-            fprintf(file, "\nPRAGMA_PATH DEFINITIONS:\n");
-            for (int j = 0; j < analysis->pragma_path_count; j++) {
-                fprintf(file, "%04d  #define PRAGMA_PATH \"%s\"%s\n",
-                    analysis->pragma_paths[j].line, analysis->pragma_paths[j].path,
-                    analysis->pragma_paths[j].has_backslash ? " [BACKSLASH]" : "");
+// Überspringt einen beliebigen Wert; Rückgabe: Position danach oder NULL bei Syntaxfehler
+static const char* json_skip_value(const char* p) {
+    p = json_skip_whitespace(p);
+    if (*p == '"') return json_read_string(p, NULL, 0);
+    if (*p == '{' || *p == '[') {
+        char close = *p == '{' ? '}' : ']';
+        p = json_skip_whitespace(p + 1);
+        if (*p == close) return p + 1;
+        for (;;) {
+            if (close == '}') {
+                p = json_read_string(json_skip_whitespace(p), NULL, 0);
+                if (!p) return NULL;
+                p = json_skip_whitespace(p);
+                if (*p++ != ':') return NULL;
             }
+            p = json_skip_value(p);
+            if (!p) return NULL;
+            p = json_skip_whitespace(p);
+            if (*p == close) return p + 1;
+            if (*p++ != ',') return NULL;
         }
+    }
+    const char* start = p;
+    while (*p && (*p == '-' || *p == '+' || *p == '.' || (*p >= '0' && *p <= '9') ||
+                  (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))) {
+        p++;
+    }
+    return p > start ? p : NULL;
+}
 
-        // INCLUDES
-        if (analysis->include_count > 0) {
-            fprintf(file, "\nINCLUDES:\n");
-            for (int j = 0; j < analysis->include_count; j++) {
-                IncludeElement* inc = &analysis->includes[j];
+// Wert zu key im Objekt ab object (zeigt auf '{'), sonst NULL
+static const char* json_object_member(const char* object, const char* key) {
+    const char* p = json_skip_whitespace(object);
+    if (*p != '{') return NULL;
+    p = json_skip_whitespace(p + 1);
+    if (*p == '}') return NULL;
+    for (;;) {
+        char name[MAX_NAME_LEN];
+        p = json_read_string(json_skip_whitespace(p), name, sizeof(name));
+        if (!p) return NULL;
+        p = json_skip_whitespace(p);
+        if (*p++ != ':') return NULL;
+        p = json_skip_whitespace(p);
+        if (strcmp(name, key) == 0) return p;
+        p = json_skip_value(p);
+        if (!p) return NULL;
+        p = json_skip_whitespace(p);
+        if (*p++ != ',') return NULL;
+    }
+}
 
-                if (inc->found_via_pragma) {
-                    char relative_path[MAX_PATH_LEN];
-                    const char* rel_start = strstr(inc->found_in_directory, base_path);
-                    if (rel_start) {
-                        rel_start += strlen(base_path);
-                        if (*rel_start == '\\' || *rel_start == '/') rel_start++;
-                        sprintf(relative_path, "%s/%s", rel_start, inc->name);
-                        normalize_path_separators(relative_path);
-                    } else {
-                        strcpy(relative_path, inc->name);
-                    }
+static void json_write_string(FILE* out, const char* str) {
+    fputc('"', out);
+    for (const unsigned char* c = (const unsigned char*)str; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+        else if (*c == '\n') fputs("\\n", out);
+        else if (*c == '\t') fputs("\\t", out);
+        else if (*c < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
 
-                    fprintf(file, "%04d  #include \"%s\" is \"%s\"%s\n",
-                        inc->line, inc->name, relative_path,
-                        inc->has_backslash ? " [BACKSLASH]" : "");
-                } else {
-                    fprintf(file, "%04d  #include \"%s\"%s\n",
-                        inc->line, inc->name,
-                        inc->has_backslash ? " [BACKSLASH]" : "");
-                }
-            }
-        }
+// Erster String-Parameter: {"file": ...} / {"symbol": ...} / {"name": ...} oder ["..."]
+static int rpc_string_param(const char* params, char* out, int out_size) {
+    if (!params) return 0;
+    params = json_skip_whitespace(params);
+    if (*params == '[') return json_read_string(json_skip_whitespace(params + 1), out, out_size) != NULL;
+    const char* keys[] = { "file", "symbol", "name" };
+    for (int k = 0; k < 3; k++) {
+        const char* value = json_object_member(params, keys[k]);
+        if (value && json_read_string(value, out, out_size)) return 1;
+    }
+    return 0;
+}
 
-        // VOID FUNCTIONS
-        if (analysis->void_function_count > 0) {
-            fprintf(file, "\nVOID FUNCTIONS:\n");
-            for (int j = 0; j < analysis->void_function_count; j++) {
-                fprintf(file, "%04d  void %s()\n",
-                    analysis->void_functions[j].line, analysis->void_functions[j].name);
-            }
-        }
+static void rpc_begin_result(FILE* out, const char* id) {
+    fprintf(out, "{\"jsonrpc\":\"2.0\",\"id\":%s,\"result\":", id);
+}
 
-        // FUNCTIONS
-        if (analysis->function_count > 0) {
-            fprintf(file, "\nFUNCTIONS:\n");
-            for (int j = 0; j < analysis->function_count; j++) {
-                fprintf(file, "%04d  function %s()\n",
-                    analysis->functions[j].line, analysis->functions[j].name);
-            }
-        }
+static void rpc_error(FILE* out, const char* id, int code, const char* message) {
+    fprintf(out, "{\"jsonrpc\":\"2.0\",\"id\":%s,\"error\":{\"code\":%d,\"message\":", id, code);
+    json_write_string(out, message);
+    fputs("}}\n", out);
+}
 
-        // ACTIONS
-        if (analysis->action_count > 0) {
-            fprintf(file, "\nACTIONS:\n");
-            for (int j = 0; j < analysis->action_count; j++) {
-                fprintf(file, "%04d  action %s()\n",
-                    analysis->actions[j].line, analysis->actions[j].name);
-            }
-        }
+static void rpc_write_file_ref(FILE* out, int file_index) {
+    fputs("{\"file\":", out);
+    json_write_string(out, ctx->files[file_index].filepath);
+    fprintf(out, ",\"lines\":%d}", ctx->files[file_index].line_count);
+}
 
-        // STRUCTS
-        if (analysis->struct_count > 0) {
-            fprintf(file, "\nSTRUCTS:\n");
-            for (int j = 0; j < analysis->struct_count; j++) {
-                fprintf(file, "%04d  struct %s\n",
-                    analysis->structs[j].line, analysis->structs[j].name);
-            }
+static void rpc_includers_of(FILE* out, const char* id, int target) {
+    rpc_begin_result(out, id);
+    fputc('[', out);
+    int written = 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        for (int k = 0; k < ctx->files[f].include_count; k++) {
+            if (ctx->files[f].include_targets[k] != target) continue;
+            fputs(written++ ? ",{\"file\":" : "{\"file\":", out);
+            json_write_string(out, ctx->files[f].filepath);
+            fprintf(out, ",\"line\":%d}", ctx->files[f].include_lines[k]);
         }
+    }
+    fputs("]}\n", out);
+}
 
-        // TYPEDEF STRUCTS
-        if (analysis->typedef_struct_count > 0) {
-            fprintf(file, "\nTYPEDEF STRUCTS:\n");
-            for (int j = 0; j < analysis->typedef_struct_count; j++) {
-                fprintf(file, "%04d  typedef struct %s\n",
-                    analysis->typedef_structs[j].line, analysis->typedef_structs[j].name);
-            }
-        }
+static void rpc_include_closure(FILE* out, const char* id, int source) {
+    if (!ctx->include_closure) {
+        rpc_error(out, id, RPC_INTERNAL_ERROR, "No include closures");
+        return;
+    }
+    rpc_begin_result(out, id);
+    fputc('[', out);
+    const unsigned char* row = CLOSURE_ROW(source);
+    int written = 0;
+    for (int t = 0; t < ctx->file_count; t++) {
+        if (t == source || !BITSET_TEST(row, t)) continue;
+        if (written++) fputc(',', out);
+        rpc_write_file_ref(out, t);
+    }
+    fputs("]}\n", out);
+}
 
-        // STATIC VARIABLES
-        if (analysis->static_var_count > 0) {
-            fprintf(file, "\nSTATIC VARIABLES:\n");
-            for (int j = 0; j < analysis->static_var_count; j++) {
-                CodeElement* var = &analysis->static_vars[j];
-                if (strlen(var->function_context) > 0) {
-                    fprintf(file, "%04d  static %s (in function: %s)\n",
-                        var->line, var->name, var->function_context);
-                } else {
-                    fprintf(file, "%04d  static %s (global)\n", var->line, var->name);
+static void rpc_definition_of(FILE* out, const char* id, const char* name) {
+    rpc_begin_result(out, id);
+    fputc('[', out);
+    int written = 0;
+    int name_id = hash_index_find(&ctx->string_pool_index, name);
+    if (name_id >= 0 && ctx->call_graph_built) {
+        for (int s = ctx->symbol_name_first[name_id]; s >= 0; s = ctx->symbol_name_next[s]) {
+            const SymbolDefinition* symbol = &ctx->symbols[s];
+            fprintf(out, "%s{\"kind\":\"%s\",\"file\":", written++ ? "," : "", symbol_kind_name(symbol->kind));
+            json_write_string(out, ctx->files[symbol->file_index].filepath);
+            fprintf(out, ",\"line\":%d,\"prototype\":%s}", symbol->line, symbol->is_prototype ? "true" : "false");
+        }
+    }
+    if (name_id >= 0) {
+        for (int m = 0; m < ctx->macro_def_count; m++) {
+            if (ctx->macro_defs[m].name_id != name_id) continue;
+            fprintf(out, "%s{\"kind\":\"macro\",\"file\":", written++ ? "," : "");
+            json_write_string(out, ctx->files[ctx->macro_defs[m].file_index].filepath);
+            fprintf(out, ",\"line\":%d,\"body\":", ctx->macro_defs[m].line);
+            json_write_string(out, interned_string(ctx->macro_defs[m].body_id));
+            fputc('}', out);
+        }
+        // Structs: Zeile nur, solange die Element-Tabellen noch da sind (kein Streaming)
+        for (int f = 0; f < ctx->file_count; f++) {
+            const FileAnalysis* analysis = &ctx->files[f];
+            for (int t = 0; t < analysis->type_name_count; t++) {
+                if (analysis->type_name_ids[t] != name_id) continue;
+                int line = 0;
+                if (analysis->elements) {
+                    line = t < analysis->struct_count ? analysis->structs[t].line
+                                                      : analysis->typedef_structs[t - analysis->struct_count].line;
                 }
+                fprintf(out, "%s{\"kind\":\"%s\",\"file\":", written++ ? "," : "",
+                        t < analysis->struct_count ? "struct" : "typedef struct");
+                json_write_string(out, analysis->filepath);
+                fprintf(out, ",\"line\":%d}", line);
             }
         }
-
-        fprintf(file, "\n----------------------------------------\n\n");
     }
+    fputs("]}\n", out);
+}
 
-    // Summary
-    fprintf(file, "=== SUMMARY ===\n");
-    fprintf(file, "Total Files Analyzed: %d\n", used_files);
-    fprintf(file, "Files with Circular Includes: %d\n", circular_files);
-    fprintf(file, "Files with Performance Problems: %d\n", performance_problems);
-    fprintf(file, "Global PRAGMA_PATH entries: %d\n", global_pragma_path_count);
-
-    fclose(file);
-    printf("SUCCESS: Analysis file created: %s\n", output_file);
+// Alle Dateien der starken Zusammenhangskomponente und ein kürzester Zyklus durch die Datei
+static void rpc_cycles_containing(FILE* out, const char* id, int file_index) {
+    int component = ctx->file_component[file_index];
+    rpc_begin_result(out, id);
+    fprintf(out, "{\"circular\":%s,\"members\":[", ctx->files[file_index].is_circular_include ? "true" : "false");
+    int written = 0;
+    for (int f = 0; f < ctx->file_count && ctx->files[file_index].is_circular_include; f++) {
+        if (ctx->file_component[f] != component) continue;
+        if (written++) fputc(',', out);
+        json_write_string(out, ctx->files[f].filepath);
+    }
+    fputs("],\"cycle\":[", out);
 
-    // Verify file exists
-    if (GetFileAttributes(output_file) != INVALID_FILE_ATTRIBUTES) {
-        FILE* verify = fopen(output_file, "r");
-        if (verify) {
-            fseek(verify, 0, SEEK_END);
-            long size = ftell(verify);
-            printf("File size: %ld bytes\n", size);
-            fclose(verify);
-        }
-    } else {
-        printf("ERROR: File not found after creation!\n");
+    int* cycle = (int*)malloc(sizeof(int) * (ctx->file_count + 1));
+    int length = find_shortest_cycle(file_index, cycle);
+    for (int k = 0; k < length; k++) {
+        json_write_string(out, ctx->files[cycle[k]].filepath);
+        fputc(',', out);
     }
+    if (length) json_write_string(out, ctx->files[file_index].filepath);
+    free(cycle);
+    fputs("]}}\n", out);
 }
 
-// Header-Generierung
-void generate_header_file(const char* header_file) {
-    FILE* file = fopen(header_file, "w");
-    if (!file) {
-        printf("Error: Could not create header file: %s\n", header_file);
-        return;
+static double monotonic_milliseconds() {
+#ifdef _WIN32
+    return (double)GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+#endif
+}
+
+// Eine Anfragezeile beantworten. Rückgabe 1 bei shutdown.
+static int serve_request(const char* request, FILE* out) {
+    const char* p = json_skip_whitespace(request);
+    if (!*p) return 0;
+    const char* end = json_skip_value(p);
+    if (*p != '{' || !end || *json_skip_whitespace(end)) {
+        rpc_error(out, "null", RPC_PARSE_ERROR, "Parse error");
+        return 0;
     }
 
-    char time_buffer[32];
-    _strtime(time_buffer);
+    // id unverändert zurückgeben (Zahl, String oder null); ohne id: Notification
+    char id[MAX_NAME_LEN] = "null";
+    const char* id_value = json_object_member(p, "id");
+    if (id_value) {
+        const char* id_end = json_skip_value(id_value);
+        int len = id_end ? (int)(id_end - id_value) : 0;
+        if (len <= 0 || len >= MAX_NAME_LEN || *id_value == '{' || *id_value == '[') {
+            rpc_error(out, "null", RPC_INVALID_REQUEST, "Invalid request id");
+            return 0;
+        }
+        memcpy(id, id_value, len);
+        id[len] = '\0';
+    }
+    FILE* target = id_value ? out : NULL;
 
-    fprintf(file, "#ifndef DECLARATIONS_H\n");
-    fprintf(file, "#define DECLARATIONS_H\n\n");
-    fprintf(file, "// Auto-generated declarations file v1.3\n");
-    fprintf(file, "// Generated: %s\n\n", time_buffer);
+    char method[MAX_NAME_LEN];
+    const char* method_value = json_object_member(p, "method");
+    if (!method_value || !json_read_string(method_value, method, sizeof(method))) {
+        if (target) rpc_error(target, id, RPC_INVALID_REQUEST, "Missing method");
+        return 0;
+    }
+    const char* params = json_object_member(p, "params");
+    char argument[MAX_PATH_LEN];
+    int has_argument = rpc_string_param(params, argument, sizeof(argument));
 
-    fprintf(file, "// Forward struct declarations\n");
-    for (int i = 0; i < file_count; i++) {
-        if (!files[i].is_used && use_include_tracking) continue;
-        for (int j = 0; j < files[i].struct_count; j++) {
-            fprintf(file, "struct %s;\n", files[i].structs[j].name);
+    if (strcmp(method, "shutdown") == 0 || strcmp(method, "exit") == 0) {
+        if (target) fprintf(target, "{\"jsonrpc\":\"2.0\",\"id\":%s,\"result\":null}\n", id);
+        return 1;
+    }
+    if (strcmp(method, "reanalyze") == 0) {
+        // Neu geparst werden nur die genannte Datei und ihre Includer (Parse-Cache im Speicher);
+        // ohne Datei oder bei einer unbekannten werden alle Dateien mit dem Cache verglichen
+        double start = monotonic_milliseconds();
+        int file_index = has_argument ? analyzer_find_file(ctx, argument) : -1;
+        if (file_index >= 0) get_relative_file_path(ctx->files[file_index].filepath, ctx->reanalyze_file);
+        int status = analyzer_run(ctx, ctx->main_file);
+        ctx->reanalyze_file[0] = '\0';
+        if (!target) return 0;
+        if (status != 0) {
+            rpc_error(target, id, RPC_INVALID_PARAMS, "Reanalysis failed");
+            return 0;
         }
-        for (int j = 0; j < files[i].typedef_struct_count; j++) {
-            fprintf(file, "typedef struct %s %s;\n",
-                files[i].typedef_structs[j].name, files[i].typedef_structs[j].name);
+        rpc_begin_result(target, id);
+        fprintf(target, "{\"files\":%d,\"reused\":%d,\"milliseconds\":%.1f", ctx->file_count,
+                ctx->parse_cache_hits, monotonic_milliseconds() - start);
+        if (has_argument) {
+            file_index = analyzer_find_file(ctx, argument);
+            fputs(",\"file\":", target);
+            if (file_index >= 0) json_write_string(target, ctx->files[file_index].filepath);
+            else fputs("null", target);
         }
+        fputs("}}\n", target);
+        return 0;
     }
-    fprintf(file, "\n");
+    if (!target) return 0;
+
+    if (strcmp(method, "definitionOf") == 0) {
+        if (!has_argument) rpc_error(target, id, RPC_INVALID_PARAMS, "Expected params {\"symbol\": name}");
+        else rpc_definition_of(target, id, argument);
+        return 0;
+    }
+
+    int is_file_method = strcmp(method, "includersOf") == 0 || strcmp(method, "includeClosure") == 0 ||
+                         strcmp(method, "cyclesContaining") == 0;
+    if (!is_file_method) {
+        rpc_error(target, id, RPC_METHOD_NOT_FOUND, "Method not found");
+        return 0;
+    }
+    int file_index = has_argument ? analyzer_find_file(ctx, argument) : -1;
+    if (file_index < 0) {
+        rpc_error(target, id, RPC_INVALID_PARAMS, has_argument ? "Unknown file" : "Expected params {\"file\": path}");
+        return 0;
+    }
+    if (strcmp(method, "includersOf") == 0) rpc_includers_of(target, id, file_index);
+    else if (strcmp(method, "includeClosure") == 0) rpc_include_closure(target, id, file_index);
+    else rpc_cycles_containing(target, id, file_index);
+    return 0;
+}
 
-    fprintf(file, "// Forward function declarations\n");
-    for (int i = 0; i < file_count; i++) {
-        if (!files[i].is_used && use_include_tracking) continue;
-        for (int j = 0; j < files[i].void_function_count; j++) {
-            fprintf(file, "void %s();\n", files[i].void_functions[j].name);
+// Liest Anfragen zeilenweise bis EOF oder shutdown. Rückgabe 1 nach shutdown, sonst 0.
+int analyzer_serve(AnalysisContext* context, FILE* in, FILE* out) {
+    ctx = context;
+    ctx->keep_parse_cache = 1;
+    char* request = (char*)malloc(SERVER_MAX_REQUEST);
+    int stop = 0;
+    while (!stop && fgets(request, SERVER_MAX_REQUEST, in)) {
+        size_t len = strlen(request);
+        if (len == SERVER_MAX_REQUEST - 1 && request[len - 1] != '\n') {
+            // Überlange Zeile verwerfen
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {}
+            rpc_error(out, "null", RPC_INVALID_REQUEST, "Request too large");
+        } else {
+            stop = serve_request(request, out);
         }
+        fflush(out);
     }
-    fprintf(file, "\n");
+    free(request);
+    return stop;
+}
 
-    fprintf(file, "#endif // DECLARATIONS_H\n");
+// Lokaler Unix-Socket: Verbindungen nacheinander, bis ein Client shutdown sendet
+int analyzer_serve_unix_socket(AnalysisContext* context, const char* socket_path) {
+#ifdef _WIN32
+    (void)context;
+    (void)socket_path;
+    return -1;
+#else
+    struct sockaddr_un address;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) return -1;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    unlink(socket_path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 4) != 0) {
+        close(listener);
+        return -1;
+    }
 
-    fclose(file);
-    printf("Header file v1.3 generated: %s\n", header_file);
+    int stop = 0;
+    while (!stop) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) break;
+        FILE* in = fdopen(connection, "r");
+        FILE* out = in ? fdopen(dup(connection), "w") : NULL;
+        if (in && out) stop = analyzer_serve(context, in, out);
+        if (out) fclose(out);
+        if (in) fclose(in);
+        else close(connection);
+    }
+    close(listener);
+    unlink(socket_path);
+    return 0;
+#endif
+}
+
+#ifndef ANALYZER_LIBRARY
+// --server / --socket: Analyse einmal aufbauen und dann nur noch Anfragen beantworten.
+// Im stdio-Modus gehört stdout dem Protokoll, Statusmeldungen gehen nach stderr.
+static int run_server_mode(const char* source_path, const char* main_file, AnalyzerOptions* options,
+                    const char* socket_path) {
+    options->verbose = 0;
+    AnalysisContext* context = analyzer_create(source_path, options);
+    if (!context) {
+        fprintf(stderr, "Error: Path '%s' does not exist!\n", source_path);
+        return 1;
+    }
+    context->keep_parse_cache = 1;  // schon der erste reanalyze-Aufruf nutzt den Cache
+    if (analyzer_run(context, main_file) != 0) {
+        fprintf(stderr, "Error: Analysis failed (main file '%s' not found?)\n", main_file ? main_file : "");
+        analyzer_destroy(context);
+        return 1;
+    }
+    fprintf(stderr, "Server ready: %d files analyzed, listening on %s\n", analyzer_file_count(context),
+            socket_path ? socket_path : "stdin");
+
+    int status = 0;
+    if (!socket_path) {
+        analyzer_serve(context, stdin, stdout);
+    } else if (analyzer_serve_unix_socket(context, socket_path) != 0) {
+        fprintf(stderr, "Error: Could not listen on socket '%s'\n", socket_path);
+        status = 1;
+    }
+    analyzer_destroy(context);
+    return status;
+}
+
+// --history: Kennzahlen je Commit als CSV, kein Report
+static int run_history_mode(const char* source_path, const char* main_file, AnalyzerOptions* options,
+                     const char* revision_range, const char* csv_file) {
+    AnalysisContext* context = analyzer_create(source_path, options);
+    if (!context) {
+        printf("Error: Path '%s' does not exist!\n", source_path);
+        return 1;
+    }
+    FILE* out = fopen(csv_file, "w");
+    if (!out) {
+        printf("Error: Could not write %s\n", csv_file);
+        analyzer_destroy(context);
+        return 1;
+    }
+    int analyzed = analyzer_history(context, main_file, revision_range, out);
+    fclose(out);
+    analyzer_destroy(context);
+    if (analyzed < 0) {
+        printf("Error: Could not read the history of '%s' (git repository and revision range?)\n", revision_range);
+        return 1;
+    }
+    printf("History: %d commits written to %s\n", analyzed, csv_file);
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
+    // Optionen (--name wert) von den Positionsargumenten trennen
+    const char* positional[4] = { NULL, NULL, NULL, NULL };
+    int positional_count = 0;
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    options.verbose = 1;
+    int streaming = 0;
+    int server_mode = 0;
+    const char* socket_path = NULL;
+    const char* snapshot_file = NULL;
+    const char* diff_files[2] = { NULL, NULL };
+    const char* budget_file = NULL;
+    const char* baseline_file = NULL;
+    const char* history_range = NULL;
+    const char* history_file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--unity") == 0 && i + 1 < argc) {
+            options.unity_output_dir = argv[++i];
+        } else if (strcmp(argv[i], "--depfiles") == 0 && i + 1 < argc) {
+            options.depfile_dir = argv[++i];
+        } else if (strcmp(argv[i], "--unity-budget") == 0 && i + 1 < argc) {
+            options.unity_line_budget = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--split-headers") == 0) {
+            options.split_declaration_headers = 1;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            streaming = 1;
+        } else if (strcmp(argv[i], "--no-readahead") == 0) {
+            options.readahead = 0;
+        } else if (strcmp(argv[i], "--server") == 0) {
+            server_mode = 1;
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            server_mode = 1;
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--save-snapshot") == 0 && i + 1 < argc) {
+            snapshot_file = argv[++i];
+        } else if (strcmp(argv[i], "--git-index") == 0) {
+            options.git_index = 1;
+        } else if (strcmp(argv[i], "--parse-cache") == 0 && i + 1 < argc) {
+            options.parse_cache_file = argv[++i];
+        } else if (strcmp(argv[i], "--changed-since") == 0 && i + 1 < argc) {
+            options.changed_since = argv[++i];
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budget_file = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_file = argv[++i];
+        } else if (strcmp(argv[i], "--history") == 0 && i + 2 < argc) {
+            history_range = argv[++i];
+            history_file = argv[++i];
+        } else if (strcmp(argv[i], "--diff") == 0 && i + 2 < argc) {
+            diff_files[0] = argv[++i];
+            diff_files[1] = argv[++i];
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            printf("Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        } else if (positional_count < 4) {
+            positional[positional_count++] = argv[i];
+        }
+    }
+
+    // Snapshot-Vergleich braucht keine Analyse
+    if (diff_files[0]) {
+        return analyzer_diff_snapshots(diff_files[0], diff_files[1], stdout) < 0 ? 1 : 0;
+    }
+
+    if (baseline_file && !budget_file) {
+        printf("Error: --baseline requires --budget\n");
+        return 1;
+    }
+    if (options.changed_since && !options.parse_cache_file) {
+        printf("Error: --changed-since requires --parse-cache\n");
+        return 1;
+    }
+
+    if (positional_count < 1) {
         printf("Enhanced C/C++ Code Dependency Analyzer v1.3 FIXED\n");
         printf("FIXED: Complete Structure Analysis + All Detail Information\n");
-        printf("Usage: %s <source_path> [main_file] [output_file] [header_file]\n", argv[0]);
+        printf("Usage: %s <source_path> [main_file] [output_file] [header_file] [options]\n", argv[0]);
         printf("Examples:\n");
         printf("  %s .\\root main.c analysis.txt declarations.h    (Include tracking)\n", argv[0]);
         printf("  %s .\\root \"\" analysis.txt declarations.h        (All files)\n", argv[0]);
@@ -1080,16 +10160,40 @@ int main(int argc, char* argv[]) {
         printf("  + Performance problem detection\n");
         printf("  + PRAGMA_PATH support\n");
         printf("  + Cross-platform compatibility\n");
+        printf("\nOptions:\n");
+        printf("  --unity <dir>           Write unity build batches to <dir>\n");
+        printf("  --unity-budget <lines>  Max preprocessed lines per batch (default %d)\n",
+               UNITY_DEFAULT_LINE_BUDGET);
+        printf("  --depfiles <dir>        Write a .d depfile per translation unit and dependencies.json to <dir>\n");
+        printf("  --split-headers         Split the header file into one header per directory\n");
+        printf("  --stream                Write file sections while parsing (bounded memory)\n");
+        printf("  --no-readahead          Read files synchronously (no background I/O)\n");
+        printf("  --git-index             List files from the git index instead of walking directories\n");
+        printf("  --parse-cache <file>    Reuse parse results of unchanged files and update <file>\n");
+        printf("  --changed-since <rev>   With --parse-cache: re-parse files changed since <rev> and their includers\n");
+        printf("  --server                Answer JSON-RPC queries on stdin/stdout (no report)\n");
+        printf("  --socket <path>         Answer JSON-RPC queries on a Unix socket (no report)\n");
+        printf("  --save-snapshot <file>  Save the include graph and symbol summary for --diff\n");
+        printf("  --diff <old> <new>      Compare two snapshots (no analysis, no source path)\n");
+        printf("  --history <range> <csv> Include graph metrics for every commit in <range> as CSV (no report)\n");
+        printf("  --budget <file>         Check include budgets, exit code 2 on violations\n");
+        printf("  --baseline <snapshot>   With --budget: only cycles missing in <snapshot> are new\n");
         return 1;
     }
 
-    const char* source_path = argv[1];
-    const char* main_file = (argc > 2 && strlen(argv[2]) > 0) ? argv[2] : NULL;
-    const char* output_file = (argc > 3) ? argv[3] : "code_analysis.txt";
-    const char* header_file = (argc > 4) ? argv[4] : "declarations.h";
+    const char* source_path = positional[0];
+    const char* main_file = (positional_count > 1 && strlen(positional[1]) > 0) ? positional[1] : NULL;
+    const char* output_file = (positional_count > 2) ? positional[2] : "code_analysis.txt";
+    const char* header_file = (positional_count > 3) ? positional[3] : "declarations.h";
 
-    strcpy(base_path, source_path);
-    use_include_tracking = (main_file != NULL);
+    if (server_mode) {
+        return run_server_mode(source_path, main_file, &options, socket_path);
+    }
+    if (history_range) {
+        return run_history_mode(source_path, main_file, &options, history_range, history_file);
+    }
+    if (streaming) options.stream_report_file = output_file;
+    int use_include_tracking = (main_file != NULL);
 
     printf("=== Enhanced C/C++ Code Dependency Analyzer v1.3 FIXED ===\n");
     printf("Source Path: %s\n", source_path);
@@ -1100,34 +10204,28 @@ int main(int argc, char* argv[]) {
     printf("Output File: %s\n", output_file);
     printf("Header File: %s\n\n", header_file);
 
-    if (GetFileAttributes(source_path) == INVALID_FILE_ATTRIBUTES) {
+    if (!path_exists(source_path)) {
         printf("Error: Path '%s' does not exist!\n", source_path);
         return 1;
     }
 
-    if (use_include_tracking) {
-        char main_path[MAX_PATH_LEN];
-        sprintf(main_path, "%s\\%s", source_path, main_file);
-
-        if (GetFileAttributes(main_path) == INVALID_FILE_ATTRIBUTES) {
-            printf("Error: Main file '%s' does not exist!\n", main_path);
-            return 1;
-        }
-
-        printf("Starting enhanced include tracking from: %s\n\n", main_file);
-        analyze_file_with_includes(main_path, 0);
-    } else {
-        printf("Scanning all .c/.h files in directory tree...\n\n");
-        scan_all_files(source_path, source_path);
+    AnalysisContext* context = analyzer_create(source_path, &options);
+    if (!context || analyzer_run(context, main_file) != 0) {
+        analyzer_destroy(context);
+        return 1;
     }
 
-    printf("\nAnalysis completed!\n");
-    printf("Found %d files\n", file_count);
-    printf("Found %d PRAGMA_PATH definitions\n", global_pragma_path_count);
-    printf("Found %d unique directories\n", used_directory_count);
-
-    write_analysis_report(output_file);
-    generate_header_file(header_file);
+    analyzer_write_report(context, output_file);
+    analyzer_write_header(context, header_file);
+    if (options.unity_output_dir) {
+        analyzer_write_unity_batches(context);
+    }
+    if (options.depfile_dir) {
+        analyzer_write_depfiles(context);
+    }
+    if (snapshot_file) {
+        analyzer_save_snapshot(context, snapshot_file);
+    }
 
     // Enhanced Console summary
     int total_overloads = 0, total_static_duplicates = 0;
@@ -1138,39 +10236,45 @@ int main(int argc, char* argv[]) {
     int independent_files = 0;
     int heavy_files = 0;
     int used_files = 0;
-
-    for (int i = 0; i < file_count; i++) {
-        if (files[i].is_used || !use_include_tracking) {
+    int identical_copies = 0;
+    long wasted_bytes = 0;
+    int unused_includes = count_unused_includes();
+    int macro_only_includes = count_macro_only_includes();
+    int macro_conflicts = write_macro_conflicts(NULL);
+
+    for (int i = 0; i < ctx->file_count; i++) {
+        if (ctx->files[i].is_used || !ctx->use_include_tracking) {
             used_files++;
-            total_overloads += files[i].overload_count;
-            total_static_duplicates += files[i].static_duplicate_count;
-
-            if (files[i].is_performance_problem) total_performance_problems++;
-            if (files[i].is_circular_include) total_circular_includes++;
-            if (files[i].include_count == 0) independent_files++;
-            if (files[i].include_count > 3) heavy_files++;
-
-            for (int j = 0; j < files[i].include_count; j++) {
-                if (files[i].includes[j].has_backslash) total_backslash_includes++;
-                if (files[i].includes[j].found_via_pragma) total_pragma_includes++;
+            total_overloads += ctx->files[i].overload_count;
+            total_static_duplicates += ctx->files[i].static_duplicate_count;
+
+            if (ctx->files[i].is_performance_problem) total_performance_problems++;
+            if (ctx->files[i].is_circular_include) total_circular_includes++;
+            if (ctx->files[i].include_count == 0) independent_files++;
+            if (ctx->files[i].include_count > 3) heavy_files++;
+            if (ctx->files[i].duplicate_of >= 0) {
+                identical_copies++;
+                wasted_bytes += ctx->files[i].file_size;
             }
 
-            for (int j = 0; j < files[i].pragma_path_count; j++) {
-                if (files[i].pragma_paths[j].has_backslash) total_pragma_backslashes++;
-            }
+            total_backslash_includes += ctx->files[i].backslash_include_count;
+            total_pragma_includes += ctx->files[i].pragma_include_count;
+            total_pragma_backslashes += ctx->files[i].pragma_backslash_count;
         }
     }
 
     printf("\n=== ENHANCED SUMMARY v1.3 FIXED ===\n");
-    printf("Total Files: %d\n", file_count);
+    printf("Total Files: %d\n", ctx->file_count);
     printf("Actually Used: %d\n", used_files);
     printf("Independent Files: %d\n", independent_files);
     printf("Heavy Dependencies: %d\n", heavy_files);
-    printf("PRAGMA_PATH entries: %d\n", global_pragma_path_count);
-    printf("Unique directories: %d\n", used_directory_count);
+    printf("PRAGMA_PATH entries: %d\n", ctx->global_pragma_path_count);
+    printf("Unique directories: %d\n", ctx->used_directory_count);
 
     if (total_overloads > 0 || total_static_duplicates > 0 || total_backslash_includes > 0 ||
-        total_pragma_backslashes > 0 || total_performance_problems > 0 || total_circular_includes > 0) {
+        total_pragma_backslashes > 0 || total_performance_problems > 0 || total_circular_includes > 0 ||
+        identical_copies > 0 || ctx->dead_function_count > 0 || unused_includes > 0 ||
+        macro_only_includes > 0 || macro_conflicts > 0) {
         printf("Issues Found:\n");
         if (total_overloads > 0) {
             printf("  Function Overloads: %d\n", total_overloads);
@@ -1193,6 +10297,21 @@ int main(int argc, char* argv[]) {
         if (total_pragma_includes > 0) {
             printf("  Includes found via PRAGMA_PATH: %d\n", total_pragma_includes);
         }
+        if (identical_copies > 0) {
+            printf("  Identical File Copies: %d (%ld bytes wasted)\n", identical_copies, wasted_bytes);
+        }
+        if (ctx->dead_function_count > 0) {
+            printf("  Dead Functions (never referenced): %d\n", ctx->dead_function_count);
+        }
+        if (unused_includes > 0) {
+            printf("  Unused Header Includes: %d\n", unused_includes);
+        }
+        if (macro_only_includes > 0) {
+            printf("  Includes Used Only for Macros: %d\n", macro_only_includes);
+        }
+        if (macro_conflicts > 0) {
+            printf("  Conflicting Macro Definitions: %d\n", macro_conflicts);
+        }
     } else {
         printf("No issues found!\n");
     }
@@ -1202,11 +10321,22 @@ int main(int argc, char* argv[]) {
     printf("  Heavy dependencies (>3): %d\n", heavy_files);
     printf("  Regular files: %d\n", used_files - independent_files - heavy_files);
 
+    // Budgets zuletzt, damit die Verstöße am Ende der Ausgabe stehen
+    int budget_violations = 0;
+    if (budget_file) {
+        printf("\n");
+        budget_violations = analyzer_check_budgets(context, budget_file, baseline_file, stdout);
+    }
+
+    analyzer_destroy(context);
+
     printf("\nEnhanced analysis complete!\n");
     printf("Check %s for complete details including:\n", output_file);
     printf("  - All INCLUDES, VOID FUNCTIONS, FUNCTIONS, ACTIONS\n");
     printf("  - All STRUCTS, TYPEDEF STRUCTS, STATIC VARIABLES\n");
     printf("  - Complete file structure with directory statistics\n");
     printf("  - Independent files and heavy dependencies analysis\n");
-    return 0;
-}
\ No newline at end of file
+    if (budget_violations < 0) return 1;
+    return budget_violations > 0 ? 2 : 0;
+}
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Test: Include-Budgets
+ *
+ * Erzeugt einen kleinen Beispielbaum und prüft analyzer_check_budgets mit verschiedenen Budgetdateien.
+ * - Kommentare, Leerzeichen, [*], [./verzeichnis/], Dateimuster; das längste passende Muster gewinnt
+ * - Schalter yes/no, Include-Guards, neue Zyklen mit und ohne Baseline-Snapshot
+ * - Fehler in der Budgetdatei liefern -1 und eine Meldung mit Datei und Zeile
+ *
+ * Build (POSIX): gcc -O2 -I../src -DANALYZER_LIBRARY -o budget_test \
+ *                    budget_test.c ../src/analyzer_v1-3.c -lpthread
+ * Aufruf: ./budget_test [arbeitsverzeichnis]   (Standard: /tmp)
+ * Rückgabe 0 bei Erfolg, 1 bei Abweichungen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "analyzer.h"
+
+int failures = 0;
+
+void check(int condition, const char* message) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+void write_test_file(const char* root, const char* name, const char* content) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+// main.c -> engine/a.h -> engine/b.h -> engine/c.h (ohne Guard); main.c -> x.h <-> y.h (Zyklus)
+void create_test_tree(const char* root) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/engine", root);
+    mkdir(path, 0755);
+    write_test_file(root, "main.c", "#include \"engine/a.h\"\n#include \"x.h\"\nfunction main() { a_fn(); }\n");
+    write_test_file(root, "engine/a.h", "#ifndef A_H\n#define A_H\n#include \"b.h\"\nfunction a_fn() { }\n#endif\n");
+    write_test_file(root, "engine/b.h", "#ifndef B_H\n#define B_H\n#include \"c.h\"\nvar b_value;\n#endif\n");
+    write_test_file(root, "engine/c.h", "var c_value;\n");
+    write_test_file(root, "x.h", "#ifndef X_H\n#define X_H\n#include \"y.h\"\n#endif\n");
+    write_test_file(root, "y.h", "#ifndef Y_H\n#define Y_H\n#include \"x.h\"\n#endif\n");
+}
+
+// Budgetdatei schreiben, prüfen, Ausgabe in output (höchstens size Zeichen); Rückgabe wie analyzer_check_budgets
+int run_budget(AnalysisContext* ctx, const char* root, const char* budget, const char* baseline,
+               char* output, int size) {
+    char budget_file[1024];
+    snprintf(budget_file, sizeof(budget_file), "%s/budgets.ini", root);
+    write_test_file(root, "budgets.ini", budget);
+    FILE* out = tmpfile();
+    if (!out) {
+        fprintf(stderr, "Cannot create temporary file\n");
+        exit(1);
+    }
+    int result = analyzer_check_budgets(ctx, budget_file, baseline, out);
+    rewind(out);
+    size_t length = fread(output, 1, size - 1, out);
+    output[length] = '\0';
+    fclose(out);
+    return result;
+}
+
+void test_budget_rules(AnalysisContext* ctx, const char* root) {
+    char output[8192];
+    int result = run_budget(ctx, root,
+                            "# Grenzen für alle Dateien\n"
+                            "[*]\n"
+                            "  max_include_depth = 1    # Kommentar nach dem Wert\n"
+                            "require_include_guards = yes\n"
+                            "\n"
+                            "[ ./engine/ ]\n"
+                            "max_include_depth=5\n"
+                            "[engine/c.h]\n"
+                            "max_include_depth = 2\n",
+                            NULL, output, sizeof(output));
+    check(result == 3, "expected 3 budget violations");
+    check(strstr(output, "max_include_depth: engine/c.h is included at depth 3 (limit 2, rule [engine/c.h])") != NULL,
+          "file rule does not win over the directory rule");
+    check(strstr(output, "engine/b.h is included") == NULL, "directory rule does not win over [*]");
+    check(strstr(output, "max_include_depth: y.h is included at depth 2 (limit 1, rule [*])") != NULL,
+          "[*] rule not applied to y.h");
+    check(strstr(output, "require_include_guards: engine/c.h has no include guard (rule [*])") != NULL,
+          "missing include guard not reported");
+    check(strstr(output, "no_new_cycles") == NULL, "cycle reported without no_new_cycles");
+    check(strstr(output, "Budget violations: 3") != NULL, "violation count missing from output");
+
+    result = run_budget(ctx, root, "[*]\nrequire_include_guards = no\nmax_include_depth = 10\n", NULL,
+                        output, sizeof(output));
+    check(result == 0 && strstr(output, "All budgets met.") != NULL, "budgets with no violations not met");
+}
+
+void test_new_cycles(AnalysisContext* ctx, const char* root) {
+    char output[8192];
+    int result = run_budget(ctx, root, "[*]\nno_new_cycles = yes\n", NULL, output, sizeof(output));
+    check(result == 1 && strstr(output, "include cycle (2 files)") != NULL, "cycle not reported as violation");
+
+    // Mit einem Snapshot desselben Baums als Baseline ist der Zyklus nicht neu
+    char snapshot_file[1024];
+    snprintf(snapshot_file, sizeof(snapshot_file), "%s/baseline.snap", root);
+    check(analyzer_save_snapshot(ctx, snapshot_file) >= 0, "baseline snapshot not saved");
+    result = run_budget(ctx, root, "[*]\nno_new_cycles = yes\n", snapshot_file, output, sizeof(output));
+    check(result == 0, "cycle from the baseline reported as new");
+}
+
+void test_budget_errors(AnalysisContext* ctx, const char* root) {
+    static const struct {
+        const char* budget;
+        const char* message;
+    } cases[] = {
+        { "max_include_depth = 3\n", "budgets.ini:1: key outside of a [pattern] section" },
+        { "[*]\n# Kommentar\nmax_includes = 3\n", "budgets.ini:3: unknown key 'max_includes'" },
+        { "[*]\nmax_tu_lines = -5\n", "budgets.ini:2: value must be a number >= 0, yes or no" },
+        { "[*]\nno_new_cycles = maybe\n", "budgets.ini:2: value must be a number >= 0, yes or no" },
+        { "[engine/\n", "budgets.ini:1: expected [pattern]" },
+        { "[*]\nmax_tu_lines\n", "budgets.ini:2: expected key = value" },
+    };
+    char output[8192];
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        int result = run_budget(ctx, root, cases[i].budget, NULL, output, sizeof(output));
+        if (result != -1 || !strstr(output, cases[i].message)) {
+            fprintf(stderr, "FAILED: budget error \"%s\" not reported (got %d: %s)\n", cases[i].message, result, output);
+            failures++;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    char root[1024];
+    snprintf(root, sizeof(root), "%s/analyzer_budget_%d", argc > 1 ? argv[1] : "/tmp", (int)getpid());
+    mkdir(root, 0755);
+    create_test_tree(root);
+
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    AnalysisContext* ctx = analyzer_create(root, &options);
+    if (!ctx || analyzer_run(ctx, "main.c") != 0) {
+        fprintf(stderr, "FAILED: analysis of the test tree\n");
+        failures++;
+    } else {
+        test_budget_rules(ctx, root);
+        test_new_cycles(ctx, root);
+        test_budget_errors(ctx, root);
+    }
+    analyzer_destroy(ctx);
+
+    char command[1100];
+    snprintf(command, sizeof(command), "rm -rf '%s'", root);
+    if (system(command) != 0) fprintf(stderr, "Could not remove %s\n", root);
+
+    if (failures > 0) {
+        printf("FAILED: %d budget checks\n", failures);
+        return 1;
+    }
+    printf("OK: budget checks passed\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Test: Dateiliste aus .git/index (AnalyzerOptions.git_index)
+ *
+ * Erzeugt ein kleines Git-Repository mit dem Quellbaum in einem Unterverzeichnis und analysiert es
+ * mit und ohne git_index. Nur Dateien im Index sind sichtbar:
+ * - eine nicht hinzugefügte Datei bleibt unaufgelöst, mit Verzeichnislauf wird sie gefunden
+ * - Index-Version 4 (Präfixkompression) liefert dasselbe Ergebnis wie Version 2
+ * - skip-worktree-Einträge (Version 3) werden ausgelassen
+ * - ein Worktree mit "gitdir:"-Datei wird über diese gefunden
+ * Ohne git im PATH wird der Test übersprungen.
+ *
+ * Build (POSIX): gcc -O2 -I../src -DANALYZER_LIBRARY -o git_index_test \
+ *                    git_index_test.c ../src/analyzer_v1-3.c -lpthread
+ * Aufruf: ./git_index_test [arbeitsverzeichnis]   (Standard: /tmp)
+ * Rückgabe 0 bei Erfolg, 1 bei Abweichungen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "analyzer.h"
+
+#define SUMMARY_SIZE 8192
+
+int failures = 0;
+
+void check(int condition, const char* message) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+void write_test_file(const char* root, const char* name, const char* content) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+// git-Befehl im Repository; 0 bei Erfolg
+int run_git(const char* repository, const char* arguments) {
+    char command[2048];
+    snprintf(command, sizeof(command), "git -C '%s' -c user.name=test -c user.email=test@example.com %s >/dev/null 2>&1",
+             repository, arguments);
+    return system(command);
+}
+
+// Zwei Verzeichnisebenen mit zusammen über 128 Zeichen: in Version 4 folgt auf unit.h ein Eintrag,
+// der mehr als 127 Zeichen des vorigen Namens weglässt (mehrbytige Längenangabe)
+#define LONG_DIRECTORY "engine/deep/long_directory_name_for_prefix_compression_0123456789_abcdefghijklmnopqrstuvwxyz" \
+                       "/second_level_directory_with_another_long_name_0123456789_abcdefghijklmnopqrstuvwxyz"
+
+// repository/game: main.c -> engine/a.h -> engine/b.h, main.c -> engine/deep/... (lange, ähnliche Namen),
+// main.c -> extra.h (nicht im Index)
+void create_test_repository(const char* repository) {
+    char path[1024];
+    mkdir(repository, 0755);
+    snprintf(path, sizeof(path), "%s/game", repository);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/game/engine", repository);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/game/engine/deep", repository);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/game/" LONG_DIRECTORY, repository);
+    *strrchr(path, '/') = '\0';
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/game/" LONG_DIRECTORY, repository);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/tools", repository);
+    mkdir(path, 0755);
+
+    write_test_file(repository, "game/main.c",
+                    "#include \"engine/a.h\"\n#include \"engine/deep/renderer_shadows.h\"\n"
+                    "#include \"engine/deep/renderer_shaders.h\"\n#include \"extra.h\"\n"
+                    "#include \"" LONG_DIRECTORY "/unit.h\"\nfunction main() { }\n");
+    write_test_file(repository, "game/engine/a.h", "#include \"b.h\"\nfunction a_fn() { }\n");
+    write_test_file(repository, "game/engine/b.h", "var b_value;\n");
+    write_test_file(repository, "game/engine/deep/renderer_shadows.h", "var shadows;\n");
+    write_test_file(repository, "game/engine/deep/renderer_shaders.h", "var shaders;\n");
+    write_test_file(repository, "game/" LONG_DIRECTORY "/unit.h", "var unit;\n");
+    write_test_file(repository, "tools/build.h", "var tool;\n");
+    if (run_git(repository, "init -q") != 0 || run_git(repository, "add game tools") != 0 ||
+        run_git(repository, "commit -q -m initial") != 0) {
+        fprintf(stderr, "Cannot create git repository in %s\n", repository);
+        exit(1);
+    }
+    // Erst nach dem Commit anlegen: nur im Arbeitsverzeichnis, nicht im Index
+    write_test_file(repository, "game/extra.h", "var extra;\n");
+}
+
+// Eine Zeile je Datei: Pfad relativ zu source_path und die Include-Ziele (relativ, "-" wenn unaufgelöst)
+int analyze(const char* source_path, int git_index, char* summary) {
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    options.git_index = git_index;
+    AnalysisContext* ctx = analyzer_create(source_path, &options);
+    if (!ctx || analyzer_run(ctx, "main.c") != 0) {
+        analyzer_destroy(ctx);
+        return 0;
+    }
+    size_t root_len = strlen(source_path) + 1;
+    int length = 0;
+    summary[0] = '\0';
+    for (int i = 0; i < analyzer_file_count(ctx); i++) {
+        AnalyzerFile file;
+        AnalyzerDependency dependencies[16];
+        analyzer_get_file(ctx, i, &file);
+        length += snprintf(summary + length, SUMMARY_SIZE - length, "%s:", file.path + root_len);
+        int count = analyzer_get_dependencies(ctx, i, dependencies, 16);
+        for (int k = 0; k < count && k < 16; k++) {
+            if (dependencies[k].type != ANALYZER_EDGE_INCLUDE) continue;
+            AnalyzerFile target;
+            int resolved = dependencies[k].target >= 0 && analyzer_get_file(ctx, dependencies[k].target, &target) == 0;
+            length += snprintf(summary + length, SUMMARY_SIZE - length, " %s", resolved ? target.path + root_len : "-");
+        }
+        length += snprintf(summary + length, SUMMARY_SIZE - length, "\n");
+    }
+    analyzer_destroy(ctx);
+    return 1;
+}
+
+void test_git_index(const char* repository) {
+    char source_path[1024];
+    snprintf(source_path, sizeof(source_path), "%s/game", repository);
+    static char walked[SUMMARY_SIZE], indexed[SUMMARY_SIZE], indexed_v4[SUMMARY_SIZE], skipped[SUMMARY_SIZE];
+
+    check(analyze(source_path, 0, walked), "analysis with directory walk failed");
+    check(analyze(source_path, 1, indexed), "analysis with git index failed");
+    check(strstr(walked, "main.c: engine/a.h engine/deep/renderer_shadows.h engine/deep/renderer_shaders.h extra.h "
+                         LONG_DIRECTORY "/unit.h\n") != NULL,
+          "directory walk does not resolve all includes");
+    check(strstr(indexed, "main.c: engine/a.h engine/deep/renderer_shadows.h engine/deep/renderer_shaders.h - "
+                          LONG_DIRECTORY "/unit.h\n") != NULL,
+          "git index mode resolves a file that is not in the index");
+    check(strstr(indexed, "engine/a.h: engine/b.h\n") != NULL, "git index mode misses engine/b.h");
+
+    check(run_git(repository, "update-index --index-version 4") == 0, "git update-index --index-version 4 failed");
+    check(analyze(source_path, 1, indexed_v4) && strcmp(indexed, indexed_v4) == 0,
+          "index version 4 gives a different result than version 2");
+
+    check(run_git(repository, "update-index --index-version 3") == 0, "git update-index --index-version 3 failed");
+    check(run_git(repository, "update-index --skip-worktree game/engine/b.h") == 0, "git update-index --skip-worktree failed");
+    check(analyze(source_path, 1, skipped) && strstr(skipped, "engine/a.h: -\n") != NULL,
+          "skip-worktree entry is not left out");
+    check(run_git(repository, "update-index --no-skip-worktree game/engine/b.h") == 0, "git update-index --no-skip-worktree failed");
+}
+
+// Worktree: ".git" ist eine Datei mit "gitdir: ..."
+void test_worktree(const char* repository, const char* worktree) {
+    static char walked[SUMMARY_SIZE], indexed[SUMMARY_SIZE];
+    char arguments[1100];
+    snprintf(arguments, sizeof(arguments), "worktree add -q '%s'", worktree);
+    if (run_git(repository, arguments) != 0) {
+        fprintf(stderr, "FAILED: git worktree add failed\n");
+        failures++;
+        return;
+    }
+    write_test_file(worktree, "game/extra.h", "var extra;\n");
+    char source_path[1024];
+    snprintf(source_path, sizeof(source_path), "%s/game", worktree);
+    check(analyze(source_path, 0, walked) && analyze(source_path, 1, indexed), "analysis of the worktree failed");
+    check(strstr(walked, "renderer_shaders.h extra.h ") != NULL && strstr(indexed, "renderer_shaders.h - ") != NULL,
+          "git index of the worktree not found through its gitdir file");
+}
+
+int main(int argc, char* argv[]) {
+    if (system("git --version >/dev/null 2>&1") != 0) {
+        printf("SKIPPED: git not found\n");
+        return 0;
+    }
+    char root[1024], repository[1100], worktree[1100];
+    snprintf(root, sizeof(root), "%s/analyzer_git_index_%d", argc > 1 ? argv[1] : "/tmp", (int)getpid());
+    snprintf(repository, sizeof(repository), "%s/repository", root);
+    snprintf(worktree, sizeof(worktree), "%s/worktree", root);
+    mkdir(root, 0755);
+    create_test_repository(repository);
+
+    test_git_index(repository);
+    test_worktree(repository, worktree);
+
+    char command[1100];
+    snprintf(command, sizeof(command), "rm -rf '%s'", root);
+    if (system(command) != 0) fprintf(stderr, "Could not remove %s\n", root);
+
+    if (failures > 0) {
+        printf("FAILED: %d git index checks\n", failures);
+        return 1;
+    }
+    printf("OK: git index checks passed\n");
+    return 0;
+}
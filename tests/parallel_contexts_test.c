@@ -0,0 +1,194 @@
+/*
+ * Test: mehrere AnalysisContexts parallel in eigenen Threads
+ *
+ * Erzeugt einen Beispielbaum (Header in mehreren Verzeichnissen, ein Include-Zyklus, PRAGMA_PATH),
+ * analysiert ihn einmal sequentiell und dann wiederholt mit mehreren Kontexten gleichzeitig.
+ * Jeder parallele Lauf muss dasselbe Ergebnis liefern wie der sequentielle.
+ *
+ * Build (POSIX): gcc -O2 -I../src -DANALYZER_LIBRARY -o parallel_contexts_test \
+ *                    parallel_contexts_test.c ../src/analyzer_v1-3.c -lpthread
+ * Aufruf: ./parallel_contexts_test [arbeitsverzeichnis]   (Standard: /tmp)
+ * Rückgabe 0 bei Erfolg, 1 bei Abweichungen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "analyzer.h"
+
+#define THREAD_COUNT 4
+#define ROUNDS 20
+#define DIRECTORY_COUNT 4
+#define HEADERS_PER_DIRECTORY 40
+#define SOURCE_COUNT 30
+
+typedef struct {
+    char* text;                     // eine Zeile je Datei: Pfad, Zeilen, Includes, Abhängigkeiten
+    long length;
+    long capacity;
+} Summary;
+
+typedef struct {
+    const char* root;
+    const char* main_file;
+    Summary summary;
+    int status;
+} Job;
+
+void summary_append(Summary* summary, const char* text) {
+    long length = (long)strlen(text);
+    if (summary->length + length + 1 > summary->capacity) {
+        summary->capacity = (summary->length + length + 1) * 2;
+        summary->text = (char*)realloc(summary->text, summary->capacity);
+    }
+    memcpy(summary->text + summary->length, text, length + 1);
+    summary->length += length;
+}
+
+void write_test_file(const char* path, const char* content) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+// Header h<i> in d<i % DIRECTORY_COUNT>/ inkludiert zwei Vorgänger; d0/h0 und d1/h1 bilden einen Zyklus
+void create_test_tree(const char* root) {
+    char path[1024];
+    char content[2048];
+    mkdir(root, 0755);
+    for (int d = 0; d < DIRECTORY_COUNT; d++) {
+        snprintf(path, sizeof(path), "%s/d%d", root, d);
+        mkdir(path, 0755);
+    }
+    int header_count = DIRECTORY_COUNT * HEADERS_PER_DIRECTORY;
+    for (int h = 0; h < header_count; h++) {
+        int length = snprintf(content, sizeof(content), "#ifndef H%d_H\n#define H%d_H\n", h, h);
+        if (h == 0) length += snprintf(content + length, sizeof(content) - length, "#include \"d1/h1.h\"\n");
+        for (int k = 1; k <= 2 && h - k * 3 >= 0; k++) {
+            int target = h - k * 3;
+            length += snprintf(content + length, sizeof(content) - length, "#include \"d%d/h%d.h\"\n",
+                               target % DIRECTORY_COUNT, target);
+        }
+        length += snprintf(content + length, sizeof(content) - length,
+                           "typedef struct S%d { var a; int b[4]; } S%d;\n"
+                           "#define H%d_SIZE %d\n"
+                           "function h%d_update(S%d* s);\n"
+                           "void h%d_reset() { wait(1); }\n#endif\n",
+                           h, h, h, h, h, h, h);
+        snprintf(path, sizeof(path), "%s/d%d/h%d.h", root, h % DIRECTORY_COUNT, h);
+        write_test_file(path, content);
+    }
+    for (int c = 0; c < SOURCE_COUNT; c++) {
+        // ein Header über PRAGMA_PATH, einer mit Verzeichnis
+        int target = (c * 7) % header_count;
+        int second = ((c * 5) % HEADERS_PER_DIRECTORY) * DIRECTORY_COUNT + (c + 1) % DIRECTORY_COUNT;
+        snprintf(content, sizeof(content),
+                 "#define PRAGMA_PATH \"d%d\"\n#include \"h%d.h\"\n#include \"d%d/h%d.h\"\n"
+                 "action unit%d() { while (1) { h%d_update(0); wait(1); } }\n",
+                 target % DIRECTORY_COUNT, target, second % DIRECTORY_COUNT, second, c, target);
+        snprintf(path, sizeof(path), "%s/unit%d.c", root, c);
+        write_test_file(path, content);
+    }
+    snprintf(content, sizeof(content), "#include \"d0/h0.h\"\n#include \"unit0.c\"\n#include \"unit1.c\"\n"
+                                       "function main() { h0_reset(); }\n");
+    snprintf(path, sizeof(path), "%s/main.c", root);
+    write_test_file(path, content);
+}
+
+void run_analysis(Job* job) {
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    AnalysisContext* ctx = analyzer_create(job->root, &options);
+    if (!ctx || analyzer_run(ctx, job->main_file) != 0) {
+        job->status = -1;
+        analyzer_destroy(ctx);
+        return;
+    }
+    char line[1024];
+    int count = analyzer_file_count(ctx);
+    snprintf(line, sizeof(line), "files %d\n", count);
+    summary_append(&job->summary, line);
+    for (int i = 0; i < count; i++) {
+        AnalyzerFile file;
+        AnalyzerDependency dependencies[64];
+        analyzer_get_file(ctx, i, &file);
+        snprintf(line, sizeof(line), "%s dir=%s lines=%d used=%d circular=%d level=%d includes=%d:", file.path,
+                 file.directory, file.line_count, file.is_used, file.is_circular_include, file.build_level,
+                 file.include_count);
+        summary_append(&job->summary, line);
+        int dependency_count = analyzer_get_dependencies(ctx, i, dependencies, 64);
+        for (int k = 0; k < dependency_count && k < 64; k++) {
+            snprintf(line, sizeof(line), " %d/%d/%d", dependencies[k].target, dependencies[k].type, dependencies[k].usage);
+            summary_append(&job->summary, line);
+        }
+        summary_append(&job->summary, "\n");
+    }
+    analyzer_destroy(ctx);
+    job->status = 0;
+}
+
+void* run_analysis_thread(void* argument) {
+    run_analysis((Job*)argument);
+    return NULL;
+}
+
+int compare_mode(const char* root, const char* main_file) {
+    Job reference;
+    memset(&reference, 0, sizeof(Job));
+    reference.root = root;
+    reference.main_file = main_file;
+    run_analysis(&reference);
+    if (reference.status != 0) {
+        fprintf(stderr, "Sequential analysis failed (main file \"%s\")\n", main_file);
+        return 1;
+    }
+
+    int failures = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        Job jobs[THREAD_COUNT];
+        pthread_t threads[THREAD_COUNT];
+        for (int t = 0; t < THREAD_COUNT; t++) {
+            memset(&jobs[t], 0, sizeof(Job));
+            jobs[t].root = root;
+            jobs[t].main_file = main_file;
+            pthread_create(&threads[t], NULL, run_analysis_thread, &jobs[t]);
+        }
+        for (int t = 0; t < THREAD_COUNT; t++) pthread_join(threads[t], NULL);
+        for (int t = 0; t < THREAD_COUNT; t++) {
+            if (jobs[t].status != 0 || !jobs[t].summary.text || strcmp(jobs[t].summary.text, reference.summary.text) != 0) {
+                fprintf(stderr, "Round %d, thread %d (main file \"%s\"): result differs from sequential run\n",
+                        round, t, main_file);
+                failures++;
+            }
+            free(jobs[t].summary.text);
+        }
+    }
+    free(reference.summary.text);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    char root[1024];
+    snprintf(root, sizeof(root), "%s/analyzer_parallel_%d", argc > 1 ? argv[1] : "/tmp", (int)getpid());
+    create_test_tree(root);
+
+    int failures = compare_mode(root, "main.c") + compare_mode(root, "");
+
+    char command[1100];
+    snprintf(command, sizeof(command), "rm -rf '%s'", root);
+    if (system(command) != 0) fprintf(stderr, "Could not remove %s\n", root);
+
+    if (failures > 0) {
+        printf("FAILED: %d parallel runs differ from the sequential run\n", failures);
+        return 1;
+    }
+    printf("OK: %d parallel runs with %d contexts match the sequential run\n", ROUNDS * 2, THREAD_COUNT);
+    return 0;
+}
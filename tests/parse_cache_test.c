@@ -0,0 +1,169 @@
+/*
+ * Test: Parse-Cache (AnalyzerOptions.parse_cache_file)
+ *
+ * Erzeugt einen kleinen Beispielbaum und analysiert ihn wiederholt mit Parse-Cache:
+ * - ohne Änderung werden alle Dateien aus dem Cache übernommen
+ * - nach einer Änderung werden die Datei und alle Dateien, die sie (transitiv) inkludieren, neu geparst
+ * - ein Cache mit fremder Version wird ignoriert
+ * Jeder Lauf mit Cache muss dasselbe Ergebnis liefern wie ein Lauf ohne Cache.
+ * Die Zahl der übernommenen Dateien wird aus der Fortschrittsausgabe (verbose) gelesen.
+ *
+ * Build (POSIX): gcc -O2 -I../src -DANALYZER_LIBRARY -o parse_cache_test \
+ *                    parse_cache_test.c ../src/analyzer_v1-3.c -lpthread
+ * Aufruf: ./parse_cache_test [arbeitsverzeichnis]   (Standard: /tmp)
+ * Rückgabe 0 bei Erfolg, 1 bei Abweichungen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "analyzer.h"
+
+#define SUMMARY_SIZE 16384
+#define FILE_COUNT 5
+
+int failures = 0;
+
+void check(int condition, const char* message) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+void write_test_file(const char* root, const char* name, const char* content) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+// main.c -> a.h -> c.h, main.c -> b.h -> d.h
+void create_test_tree(const char* root) {
+    mkdir(root, 0755);
+    write_test_file(root, "main.c", "#include \"a.h\"\n#include \"b.h\"\n"
+                                    "function main() { a_fn(); b_fn(); }\naction run() { while (1) { c_fn(); wait(1); } }\n");
+    write_test_file(root, "a.h", "#include \"c.h\"\n#define A_SIZE C_SIZE\nfunction a_fn() { c_fn(); }\n");
+    write_test_file(root, "b.h", "#include \"d.h\"\ntypedef struct B_DATA { var x; D_ITEM* item; } B_DATA;\n"
+                                 "function b_fn() { }\n");
+    write_test_file(root, "c.h", "#define C_SIZE 4\nfunction c_fn() { }\n");
+    write_test_file(root, "d.h", "typedef struct D_ITEM { int id; } D_ITEM;\nvar d_values[C_SIZE];\n");
+}
+
+// Ergebnis als Text: je Datei Zeilen, Include-Kanten und Elemente
+void append_summary(AnalysisContext* ctx, const char* root, char* summary) {
+    size_t root_len = strlen(root) + 1;
+    int length = 0;
+    summary[0] = '\0';
+    for (int i = 0; i < analyzer_file_count(ctx); i++) {
+        AnalyzerFile file;
+        AnalyzerDependency dependencies[32];
+        AnalyzerElement elements[64];
+        analyzer_get_file(ctx, i, &file);
+        length += snprintf(summary + length, SUMMARY_SIZE - length, "%s lines=%d:", file.path + root_len,
+                           file.line_count);
+        int count = analyzer_get_dependencies(ctx, i, dependencies, 32);
+        for (int k = 0; k < count && k < 32; k++) {
+            length += snprintf(summary + length, SUMMARY_SIZE - length, " %d/%d/%d/%d", dependencies[k].target,
+                               dependencies[k].type, dependencies[k].usage, dependencies[k].weight);
+        }
+        count = analyzer_get_elements(ctx, i, elements, 64);
+        for (int k = 0; k < count && k < 64; k++) {
+            length += snprintf(summary + length, SUMMARY_SIZE - length, " [%d %s %d]", elements[k].kind,
+                               elements[k].name, elements[k].line);
+        }
+        length += snprintf(summary + length, SUMMARY_SIZE - length, "\n");
+    }
+}
+
+// Analyse mit Cache (cache_file) oder ohne (NULL); Rückgabe: übernommene Dateien laut Fortschrittsausgabe,
+// -1 bei Fehlern
+int analyze(const char* root, const char* cache_file, char* summary) {
+    char log_file[1024];
+    snprintf(log_file, sizeof(log_file), "%s/progress.log", root);
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    options.parse_cache_file = cache_file;
+    options.verbose = 1;
+
+    // Fortschritt geht nach stdout: für die Dauer der Analyse in eine Datei umleiten
+    fflush(stdout);
+    int saved_stdout = dup(1);
+    int log_fd = open(log_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(log_fd, 1);
+    close(log_fd);
+    AnalysisContext* ctx = analyzer_create(root, &options);
+    int status = ctx ? analyzer_run(ctx, "main.c") : -1;
+    fflush(stdout);
+    dup2(saved_stdout, 1);
+    close(saved_stdout);
+    if (status != 0) {
+        analyzer_destroy(ctx);
+        return -1;
+    }
+    append_summary(ctx, root, summary);
+    analyzer_destroy(ctx);
+
+    int reused = 0;
+    char line[1024];
+    FILE* log = fopen(log_file, "r");
+    while (log && fgets(line, sizeof(line), log)) {
+        sscanf(line, "Reused %d cached parse results", &reused);
+    }
+    if (log) fclose(log);
+    return reused;
+}
+
+void test_parse_cache(const char* root) {
+    static char fresh[SUMMARY_SIZE], cached[SUMMARY_SIZE];
+    char cache_file[1024];
+    snprintf(cache_file, sizeof(cache_file), "%s/analyzer.cache", root);
+
+    check(analyze(root, cache_file, cached) == 0, "first run reused files without a cache");
+    check(analyze(root, NULL, fresh) == 0 && strcmp(fresh, cached) == 0, "first cached run differs from a fresh run");
+
+    check(analyze(root, cache_file, cached) == FILE_COUNT, "unchanged files not reused");
+    check(strcmp(fresh, cached) == 0, "run from the cache differs from a fresh run");
+
+    // c.h geändert: c.h, a.h (inkludiert c.h) und main.c (über a.h) werden neu geparst, b.h und d.h nicht
+    write_test_file(root, "c.h", "#define C_SIZE 8\nfunction c_fn() { }\nfunction c_new() { c_fn(); }\n");
+    check(analyze(root, cache_file, cached) == 2, "changed file and its includers not invalidated");
+    check(analyze(root, NULL, fresh) >= 0 && strcmp(fresh, cached) == 0, "run after a change differs from a fresh run");
+
+    // d.h geändert: nur a.h und c.h bleiben
+    write_test_file(root, "d.h", "typedef struct D_ITEM { int id; var weight; } D_ITEM;\nvar d_values[C_SIZE];\n");
+    check(analyze(root, cache_file, cached) == 2, "includers of d.h not invalidated");
+    check(analyze(root, NULL, fresh) >= 0 && strcmp(fresh, cached) == 0, "run after a second change differs from a fresh run");
+
+    // Cache mit fremder Version: alles neu parsen
+    write_test_file(root, "analyzer.cache", "ANALYZER PARSE CACHE 1\nF\tmain.c\t-\t1\t0\t1\t0\n");
+    check(analyze(root, cache_file, cached) == 0, "cache with another version not ignored");
+    check(strcmp(fresh, cached) == 0, "run after an ignored cache differs from a fresh run");
+}
+
+int main(int argc, char* argv[]) {
+    char root[1024];
+    snprintf(root, sizeof(root), "%s/analyzer_parse_cache_%d", argc > 1 ? argv[1] : "/tmp", (int)getpid());
+    create_test_tree(root);
+
+    test_parse_cache(root);
+
+    char command[1100];
+    snprintf(command, sizeof(command), "rm -rf '%s'", root);
+    if (system(command) != 0) fprintf(stderr, "Could not remove %s\n", root);
+
+    if (failures > 0) {
+        printf("FAILED: %d parse cache checks\n", failures);
+        return 1;
+    }
+    printf("OK: parse cache checks passed\n");
+    return 0;
+}
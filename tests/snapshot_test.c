@@ -0,0 +1,228 @@
+/*
+ * Test: Analyse-Snapshots
+ *
+ * Erzeugt kleine Beispielbäume, speichert Snapshots und prüft deren Inhalt und Vergleich.
+ * - PRAGMA_PATH nach einem verschachtelten Include gehört zur definierenden Datei, nicht zum Include
+ * - analyzer_diff_snapshots meldet neue und entfernte Dateien, Include-Kanten, neue, geänderte und
+ *   aufgelöste Zyklen, Überladungen und PRAGMA_PATHs; gleiche Snapshots liefern 0, fehlende -1
+ *
+ * Build (POSIX): gcc -O2 -I../src -DANALYZER_LIBRARY -o snapshot_test \
+ *                    snapshot_test.c ../src/analyzer_v1-3.c -lpthread
+ * Aufruf: ./snapshot_test [arbeitsverzeichnis]   (Standard: /tmp)
+ * Rückgabe 0 bei Erfolg, 1 bei Abweichungen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "analyzer.h"
+
+#define MAX_SNAPSHOT_STRINGS 256
+
+typedef struct {
+    char* text;                     // Dateiinhalt, Zeilen durch '\0' getrennt
+    char* strings[MAX_SNAPSHOT_STRINGS];
+    int string_count;
+} Snapshot;
+
+int failures = 0;
+
+void check(int condition, const char* message) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+void write_test_file(const char* root, const char* name, const char* content) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        exit(1);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+void create_directory(const char* root, const char* name) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    mkdir(path, 0755);
+}
+
+int save_snapshot(const char* root, const char* snapshot_file) {
+    AnalyzerOptions options;
+    analyzer_default_options(&options);
+    AnalysisContext* ctx = analyzer_create(root, &options);
+    int result = ctx && analyzer_run(ctx, "main.c") == 0 ? analyzer_save_snapshot(ctx, snapshot_file) : -1;
+    analyzer_destroy(ctx);
+    return result;
+}
+
+int load_snapshot(const char* snapshot_file, Snapshot* snapshot) {
+    memset(snapshot, 0, sizeof(Snapshot));
+    FILE* file = fopen(snapshot_file, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    snapshot->text = (char*)calloc(size + 1, 1);
+    if (fread(snapshot->text, 1, size, file) != (size_t)size) size = 0;
+    fclose(file);
+    for (char* c = snapshot->text; *c; c++) {
+        if (*c == '\n') *c = '\0';
+    }
+    // Kopfzeile, "strings N", dann N Zeilen
+    char* line = snapshot->text + strlen(snapshot->text) + 1;
+    int count = 0;
+    if (sscanf(line, "strings %d", &count) != 1 || count > MAX_SNAPSHOT_STRINGS) return 0;
+    line += strlen(line) + 1;
+    for (int i = 0; i < count; i++) {
+        snapshot->strings[i] = line;
+        line += strlen(line) + 1;
+    }
+    snapshot->string_count = count;
+    return 1;
+}
+
+// Erste Zeile des Abschnitts section, NULL wenn leer oder nicht vorhanden
+const char* snapshot_first_row(const Snapshot* snapshot, const char* section) {
+    const char* line = snapshot->string_count > 0 ? snapshot->strings[snapshot->string_count - 1] : snapshot->text;
+    size_t length = strlen(section);
+    for (line += strlen(line) + 1; *line; line += strlen(line) + 1) {
+        if (strncmp(line, section, length) == 0 && line[length] == ' ') {
+            return atoi(line + length + 1) > 0 ? line + strlen(line) + 1 : NULL;
+        }
+    }
+    return NULL;
+}
+
+// main.c -> main2.h -> unused.h; PRAGMA_PATH steht in main2.h hinter dem Include
+void test_pragma_after_include(const char* root) {
+    write_test_file(root, "main.c", "#include \"main2.h\"\nfunction main() { }\n");
+    write_test_file(root, "main2.h", "#include \"unused.h\"\n#define PRAGMA_PATH \"sub\"\n");
+    write_test_file(root, "unused.h", "#define UNUSED_VALUE 1\n");
+
+    char snapshot_file[1024];
+    snprintf(snapshot_file, sizeof(snapshot_file), "%s/pragma.snap", root);
+    check(save_snapshot(root, snapshot_file) >= 0, "pragma snapshot not saved");
+
+    Snapshot snapshot;
+    check(load_snapshot(snapshot_file, &snapshot), "pragma snapshot not readable");
+    const char* row = snapshot_first_row(&snapshot, "pragmas");
+    int path_rank = -1, file_rank = -1;
+    if (row) sscanf(row, "%d %d", &path_rank, &file_rank);
+    check(path_rank >= 0 && path_rank < snapshot.string_count && strcmp(snapshot.strings[path_rank], "sub") == 0,
+          "PRAGMA_PATH value missing from snapshot");
+    check(file_rank >= 0 && file_rank < snapshot.string_count && strcmp(snapshot.strings[file_rank], "main2.h") == 0,
+          "PRAGMA_PATH after an include is not attributed to main2.h");
+    free(snapshot.text);
+}
+
+// Vergleich schreiben, Ausgabe in output (höchstens size Zeichen); Rückgabe wie analyzer_diff_snapshots
+int run_diff(const char* old_file, const char* new_file, char* output, int size) {
+    FILE* out = tmpfile();
+    if (!out) {
+        fprintf(stderr, "Cannot create temporary file\n");
+        exit(1);
+    }
+    int result = analyzer_diff_snapshots(old_file, new_file, out);
+    rewind(out);
+    size_t length = fread(output, 1, size - 1, out);
+    output[length] = '\0';
+    fclose(out);
+    return result;
+}
+
+// old: main.c -> a.h -> c.h, main.c -> b.h, main.c -> p.h <-> q.h, main.c -> u.h <-> v.h
+// new: a.h ohne c.h, p.h -> q.h -> r.h -> p.h, u.h ohne v.h, neu d.h (PRAGMA_PATH, zweites shared_fn)
+//      und s.h <-> t.h
+void test_snapshot_diff(const char* root) {
+    create_directory(root, "old");
+    create_directory(root, "new");
+    char old_root[1024], new_root[1024], old_file[1024], new_file[1024], missing_file[1024];
+    snprintf(old_root, sizeof(old_root), "%s/old", root);
+    snprintf(new_root, sizeof(new_root), "%s/new", root);
+    snprintf(old_file, sizeof(old_file), "%s/old.snap", root);
+    snprintf(new_file, sizeof(new_file), "%s/new.snap", root);
+    snprintf(missing_file, sizeof(missing_file), "%s/missing.snap", root);
+
+    write_test_file(old_root, "main.c", "#include \"a.h\"\n#include \"b.h\"\n#include \"p.h\"\n#include \"u.h\"\n"
+                                        "function main() { }\n");
+    write_test_file(old_root, "a.h", "#include \"c.h\"\nvar a;\n");
+    write_test_file(old_root, "b.h", "function shared_fn() { }\n");
+    write_test_file(old_root, "c.h", "var c;\n");
+    write_test_file(old_root, "p.h", "#include \"q.h\"\n");
+    write_test_file(old_root, "q.h", "#include \"p.h\"\n");
+    write_test_file(old_root, "u.h", "#include \"v.h\"\n");
+    write_test_file(old_root, "v.h", "#include \"u.h\"\n");
+    check(save_snapshot(old_root, old_file) >= 0, "old snapshot not saved");
+
+    write_test_file(new_root, "main.c", "#include \"a.h\"\n#include \"b.h\"\n#include \"p.h\"\n#include \"u.h\"\n"
+                                        "#include \"d.h\"\n#include \"s.h\"\nfunction main() { }\n");
+    write_test_file(new_root, "a.h", "var a;\n");
+    write_test_file(new_root, "b.h", "function shared_fn() { }\n");
+    write_test_file(new_root, "d.h", "#define PRAGMA_PATH \"lib\"\nfunction shared_fn(var x) { }\n");
+    write_test_file(new_root, "p.h", "#include \"q.h\"\n");
+    write_test_file(new_root, "q.h", "#include \"r.h\"\n");
+    write_test_file(new_root, "r.h", "#include \"p.h\"\n");
+    write_test_file(new_root, "s.h", "#include \"t.h\"\n");
+    write_test_file(new_root, "t.h", "#include \"s.h\"\n");
+    write_test_file(new_root, "u.h", "var u;\n");
+    create_directory(root, "new/lib");
+    check(save_snapshot(new_root, new_file) >= 0, "new snapshot not saved");
+
+    char output[8192];
+    int result = run_diff(old_file, old_file, output, sizeof(output));
+    check(result == 0 && strstr(output, "No differences.") != NULL, "identical snapshots reported as different");
+
+    result = run_diff(old_file, new_file, output, sizeof(output));
+    check(result == 22 && strstr(output, "Differences: 22\n") != NULL, "expected 22 snapshot differences");
+    check(strstr(output, "ADDED FILES:\n  + d.h\n  + r.h\n  + s.h\n  + t.h\n") != NULL, "added files not reported");
+    check(strstr(output, "REMOVED FILES:\n  - c.h\n  - v.h\n") != NULL, "removed files not reported");
+    check(strstr(output, "  main.c: 7 -> 9 headers, 13 -> 17 preprocessed lines (+4)\n") != NULL,
+          "closure change of main.c not reported");
+    check(strstr(output, "  + main.c -> d.h\n") != NULL && strstr(output, "  + q.h -> r.h\n") != NULL,
+          "added include edges not reported");
+    check(strstr(output, "  - a.h -> c.h\n") != NULL && strstr(output, "  - q.h -> p.h\n") != NULL,
+          "removed include edges not reported");
+    check(strstr(output, "NEW CYCLES:\n  s.h, t.h\n") != NULL, "new cycle not reported");
+    check(strstr(output, "CHANGED CYCLES:\n  was: p.h, q.h\n  now: p.h, q.h, r.h\n") != NULL,
+          "changed cycle not reported");
+    check(strstr(output, "RESOLVED CYCLES:\n  u.h, v.h\n") != NULL, "resolved cycle not reported");
+    check(strstr(output, "NEW OVERLOADS:\n  shared_fn: 0 -> 2 definitions\n") != NULL, "new overload not reported");
+    check(strstr(output, "NEW PRAGMA_PATHS:\n  + \"lib\" in d.h\n") != NULL, "new PRAGMA_PATH not reported");
+
+    // Umgekehrte Richtung: Kanten und PRAGMA_PATH erscheinen gespiegelt
+    result = run_diff(new_file, old_file, output, sizeof(output));
+    check(result > 0 && strstr(output, "  + a.h -> c.h\n") != NULL &&
+          strstr(output, "REMOVED PRAGMA_PATHS:\n  - \"lib\" in d.h\n") != NULL,
+          "reverse diff does not report removed PRAGMA_PATH");
+
+    result = run_diff(old_file, missing_file, output, sizeof(output));
+    check(result == -1 && strstr(output, "Could not read snapshot") != NULL, "missing snapshot not reported");
+}
+
+int main(int argc, char* argv[]) {
+    char root[1024];
+    snprintf(root, sizeof(root), "%s/analyzer_snapshot_%d", argc > 1 ? argv[1] : "/tmp", (int)getpid());
+    mkdir(root, 0755);
+
+    test_pragma_after_include(root);
+    test_snapshot_diff(root);
+
+    char command[1100];
+    snprintf(command, sizeof(command), "rm -rf '%s'", root);
+    if (system(command) != 0) fprintf(stderr, "Could not remove %s\n", root);
+
+    if (failures > 0) {
+        printf("FAILED: %d snapshot checks\n", failures);
+        return 1;
+    }
+    printf("OK: snapshot checks passed\n");
+    return 0;
+}